@@ -0,0 +1,87 @@
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+#include <tfhe/tfhe.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "PIREngine.h"
+#include "optimized/HomLocOPT.h"
+
+// What a thread split is tuned for. Record counts are bucketed to the next power of two,
+// so tables of similar size share an entry.
+struct DatasetShape {
+    BuildingBlock block;
+    int numRecords;
+    int inputLength;
+    int serviceLength;
+    int numThreads;  // budget of a query
+
+    std::string key() const;
+};
+
+// Every mode at every halving split of `num_of_threads` between records and kernels
+// (modes without inner kernels only at the full record split), plus GATE_GRAPH and NONE
+std::vector<ThreadPartition> candidatePartitions(int num_of_threads);
+
+// Calibration prefix: 1/CALIBRATION_FRACTION of the table, so shapes in different record
+// buckets are tuned on different amounts of work, but at least two records per thread (and 8)
+// and at most `cap` records (0 for CALIBRATION_RECORDS_PER_THREAD per thread). Each candidate
+// is timed CALIBRATION_RUNS times and scored by the median.
+constexpr int CALIBRATION_FRACTION = 8;
+constexpr int CALIBRATION_RECORDS_PER_THREAD = 64;
+constexpr int CALIBRATION_RUNS = 3;
+int calibrationSampleSize(int numRecords, int num_of_threads, int cap);
+
+// "NONE", "PARALLEL_LOOP_HOMSUM", ... as spelled in ParallelizationMode; the inverse throws
+// std::invalid_argument for an unknown name
+const char* parallelizationModeName(ParallelizationMode mode);
+ParallelizationMode parallelizationModeFromName(const std::string& name);
+
+// Picks how a query's threads are split between the record loop and the kernels of each
+// record. The best split depends on the machine as much as on the table: few records leave
+// a record-level loop short of work, many records make inner parallel sections pure
+// overhead. The tuner times every candidate on a prefix of the table, keeps the fastest and
+// persists it per DatasetShape in a small text file, so later queries (and later runs on the
+// same machine) skip the calibration.
+class AutoTuner {
+public:
+    // `cachePath` may not exist yet; throws std::runtime_error on a malformed cache.
+    // `calibrationRecords` caps the calibration table (see calibrationSampleSize), 0 for the default cap.
+    explicit AutoTuner(const std::string& cachePath, int calibrationRecords = 0);
+
+    // Cached split for `shape`, if any
+    bool lookup(const DatasetShape& shape, ThreadPartition& partition) const;
+
+    // Split for this query's shape: cached, or calibrated now and appended to the cache.
+    // `second` is unused for BB3. Thread-safe; calibrations run one at a time.
+    ThreadPartition tune(BuildingBlock block, const LweSample* first, const LweSample* second,
+                         const std::vector<std::vector<LweSample*>>& enc_database,
+                         int inputLength, int serviceLength,
+                         const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads);
+
+    // Seconds per candidate of the most recent calibration, for reports
+    std::vector<std::pair<ThreadPartition, double>> lastCalibration() const;
+
+    const std::string& cachePath() const { return cachePath_; }
+
+private:
+    void save(const std::string& key, const ThreadPartition& partition, double seconds);
+
+    std::string cachePath_;
+    int calibrationRecords_;
+    mutable std::mutex mutex_;
+    std::mutex calibrating_;
+    std::map<std::string, ThreadPartition> cache_;
+    std::vector<std::pair<ThreadPartition, double>> lastCalibration_;
+};
+
+// Runs a query with an explicit split (the matching HomLocPIRbb*OPT); returns the encrypted service
+LweSample* HomLocPIRPartitioned(BuildingBlock block, const LweSample* first, const LweSample* second,
+                                const std::vector<std::vector<LweSample*>>& enc_database,
+                                int inputLength, int serviceLength,
+                                const TFheGateBootstrappingCloudKeySet* bk, const ThreadPartition& partition);
+
+#endif // AUTOTUNER_H
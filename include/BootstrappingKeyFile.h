@@ -0,0 +1,81 @@
+#ifndef BOOTSTRAPPINGKEYFILE_H
+#define BOOTSTRAPPINGKEYFILE_H
+
+#include <tfhe/tfhe.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Versioned on-disk cloud key holding the bootstrapping key already in the FFT (Lagrange)
+// domain, so a server never redoes the n * (k+1) * l * (k+1) forward FFTs at startup:
+//
+//   BootstrappingKeyFileHeader | FFT polynomials | keyswitch masks | keyswitch bodies, variances
+//
+// Blocks are page-aligned. FFT polynomials are stored in bkFFT order (TGsw sample, TLwe row,
+// polynomial), N doubles each, in the spqlios layout; keyswitch samples in ks0_raw order.
+// Writing and loading throw std::runtime_error if the linked TFHE uses another FFT backend.
+const uint32_t BK_FILE_MAGIC = 0x4b424950;  // "PIBK"
+const uint32_t BK_FILE_VERSION = 1;
+const size_t BK_FILE_ALIGNMENT = 4096;
+
+struct BootstrappingKeyFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    // Parameter fingerprint, checked on load
+    int32_t n;
+    int32_t N;
+    int32_t k;
+    int32_t l;
+    int32_t Bgbit;
+    int32_t ksLength;
+    int32_t ksBasebit;
+    int32_t ksBase;
+    int32_t ksInputDim;  // N * k
+    uint32_t reserved;
+    // Block offsets
+    uint64_t fftOffset;
+    uint64_t ksMasksOffset;
+    uint64_t ksBodiesOffset;
+    uint64_t ksVariancesOffset;
+    uint64_t fileBytes;
+};
+
+// Export the FFT bootstrapping key and keyswitch key of a cloud key
+void writeBootstrappingKeyFile(const std::string& path, const TFheGateBootstrappingCloudKeySet* bk);
+
+// The same layout in memory: size of the image for `params`, and the image of `bk` written
+// into a caller-provided buffer of at least that many bytes
+size_t bootstrappingKeyImageBytes(const TFheGateBootstrappingParameterSet* params);
+void writeBootstrappingKeyImage(void* image, const TFheGateBootstrappingCloudKeySet* bk);
+
+// Cloud key served from a read-only, prefaulted mapping of a key file. The FFT polynomials
+// and keyswitch masks point into the mapping; no secret key is needed. get() is usable
+// wherever a TFheGateBootstrappingCloudKeySet* is expected, for the lifetime of this object.
+class MappedCloudKey {
+public:
+    // Throws if the file is missing, truncated or built for other parameters
+    MappedCloudKey(const std::string& path, const TFheGateBootstrappingParameterSet* params);
+    // Adopts a mapping of `bytes` bytes holding a key image (anonymous, see KeyPlacement.h, or a
+    // shared memfd, see ShardedEvaluation.h); it is munmapped with this object, or right away
+    // if the image is rejected
+    MappedCloudKey(void* image, size_t bytes, const TFheGateBootstrappingParameterSet* params);
+    ~MappedCloudKey();
+
+    MappedCloudKey(MappedCloudKey&& other) noexcept;
+    MappedCloudKey& operator=(MappedCloudKey&& other) noexcept;
+    MappedCloudKey(const MappedCloudKey&) = delete;
+    MappedCloudKey& operator=(const MappedCloudKey&) = delete;
+
+    const TFheGateBootstrappingCloudKeySet* get() const { return cloud_; }
+    size_t mappedBytes() const { return mappingBytes_; }
+
+private:
+    void adopt(const TFheGateBootstrappingParameterSet* params, const std::string& source);
+    void release();
+
+    void* mapping_ = nullptr;
+    size_t mappingBytes_ = 0;
+    TFheGateBootstrappingCloudKeySet* cloud_ = nullptr;
+};
+
+#endif // BOOTSTRAPPINGKEYFILE_H
@@ -0,0 +1,101 @@
+#ifndef CIPHERTEXT_H
+#define CIPHERTEXT_H
+
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <utility>
+#include <vector>
+
+// Move-only owner of a gate-bootstrapping ciphertext array. Kernels take the raw
+// LweSample* from get() as their output parameter, so a result is written once into
+// the array that finally holds it and is freed exactly once.
+class CiphertextArray {
+public:
+    CiphertextArray() : samples_(nullptr), length_(0) {}
+    CiphertextArray(int length, const TFheGateBootstrappingParameterSet* params)
+        : samples_(new_gate_bootstrapping_ciphertext_array(length, params)), length_(length) {}
+
+    // Take ownership of an array returned by new_gate_bootstrapping_ciphertext_array
+    static CiphertextArray adopt(LweSample* samples, int length) {
+        CiphertextArray owner;
+        owner.samples_ = samples;
+        owner.length_ = length;
+        return owner;
+    }
+
+    ~CiphertextArray() { reset(); }
+
+    CiphertextArray(CiphertextArray&& other) noexcept
+        : samples_(other.samples_), length_(other.length_) {
+        other.samples_ = nullptr;
+        other.length_ = 0;
+    }
+    CiphertextArray& operator=(CiphertextArray&& other) noexcept {
+        if (this != &other) {
+            reset();
+            std::swap(samples_, other.samples_);
+            std::swap(length_, other.length_);
+        }
+        return *this;
+    }
+    CiphertextArray(const CiphertextArray&) = delete;
+    CiphertextArray& operator=(const CiphertextArray&) = delete;
+
+    LweSample* get() const { return samples_; }
+    int length() const { return length_; }
+    LweSample& operator[](int i) const { return samples_[i]; }
+    explicit operator bool() const { return samples_ != nullptr; }
+
+    // Hand the array to a caller that frees it with delete_gate_bootstrapping_ciphertext_array
+    LweSample* release() {
+        LweSample* samples = samples_;
+        samples_ = nullptr;
+        length_ = 0;
+        return samples;
+    }
+
+    void reset() {
+        if (samples_ != nullptr) {
+            delete_gate_bootstrapping_ciphertext_array(length_, samples_);
+            samples_ = nullptr;
+            length_ = 0;
+        }
+    }
+
+private:
+    LweSample* samples_;
+    int length_;
+};
+
+// Single encrypted bit (validation results, selector bits)
+class CiphertextBit {
+public:
+    explicit CiphertextBit(const TFheGateBootstrappingParameterSet* params) : array_(1, params) {}
+
+    LweSample* get() const { return array_.get(); }
+    LweSample* release() { return array_.release(); }
+
+private:
+    CiphertextArray array_;
+};
+
+// Allocate `count` owned arrays of `length` bits each
+inline std::vector<CiphertextArray> newCiphertextArrays(int count, int length, const TFheGateBootstrappingParameterSet* params) {
+    std::vector<CiphertextArray> arrays;
+    arrays.reserve(count);
+    for (int i = 0; i < count; i++) {
+        arrays.emplace_back(length, params);
+    }
+    return arrays;
+}
+
+// Borrowed raw pointers, for kernels that take std::vector<LweSample*>
+inline std::vector<LweSample*> ciphertextPointers(const std::vector<CiphertextArray>& arrays) {
+    std::vector<LweSample*> pointers(arrays.size());
+    for (size_t i = 0; i < arrays.size(); i++) {
+        pointers[i] = arrays[i].get();
+    }
+    return pointers;
+}
+
+#endif // CIPHERTEXT_H
@@ -0,0 +1,72 @@
+#ifndef CLOUDKEYCACHE_H
+#define CLOUDKEYCACHE_H
+
+#include <tfhe/tfhe.h>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "BootstrappingKeyFile.h"
+
+// Registry of per-client cloud keys for a multi-tenant server. Every registered key lives on
+// disk as <directory>/<keyId>.bk (see BootstrappingKeyFile.h); at most `capacity` of them are
+// kept mapped and prefaulted, least recently used first out. Keys are handed out as shared
+// pointers, so a query keeps its key alive even if the cache evicts it meanwhile.
+class CloudKeyCache {
+public:
+    CloudKeyCache(const std::string& directory, const TFheGateBootstrappingParameterSet* params, size_t capacity);
+
+    // Key upload: persist a client's cloud key (replacing any previous one) without loading it
+    void registerKey(const std::string& keyId, const TFheGateBootstrappingCloudKeySet* bk);
+
+    // Ready-to-use key for `keyId`; a miss maps it from disk and may evict the LRU entry.
+    // The map happens outside the cache lock, and concurrent misses on one ID share a single
+    // load. Throws if the key was never registered.
+    std::shared_ptr<const MappedCloudKey> acquire(const std::string& keyId);
+
+    // Drop a client's key from memory and disk
+    void removeKey(const std::string& keyId);
+
+    bool isResident(const std::string& keyId) const;
+    size_t residentKeys() const;
+    size_t capacity() const { return capacity_; }
+
+    size_t hits() const;
+    size_t misses() const;
+    size_t evictions() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const MappedCloudKey> key;
+        std::list<std::string>::iterator position;
+    };
+
+    // A key being mapped by the first thread that missed on it; `ticket` tells whether the
+    // load is still current when it finishes (registerKey and removeKey cancel it)
+    struct Load {
+        std::shared_future<std::shared_ptr<const MappedCloudKey>> key;
+        uint64_t ticket;
+    };
+
+    std::string keyPath(const std::string& keyId) const;
+    void evictLocked(const std::string& keyId);
+
+    std::string directory_;
+    const TFheGateBootstrappingParameterSet* params_;
+    size_t capacity_;
+
+    mutable std::mutex mutex_;
+    std::list<std::string> lru_;  // most recently used at the front
+    std::unordered_map<std::string, Entry> resident_;
+    std::unordered_map<std::string, Load> loading_;
+    uint64_t nextTicket_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    size_t evictions_ = 0;
+};
+
+#endif // CLOUDKEYCACHE_H
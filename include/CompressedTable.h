@@ -0,0 +1,71 @@
+#ifndef COMPRESSEDTABLE_H
+#define COMPRESSEDTABLE_H
+
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+#include "EncryptedTable.h"
+#include "SeededMask.h"
+
+// At-rest encrypted database that keeps one mask seed per table and only the body b of
+// every sample (4 bytes instead of 4n + 4). Masks are regenerated from (seed, stream id)
+// into an EncryptedTable block right before the kernels touch a record.
+class CompressedTable {
+public:
+    CompressedTable(const TableSchema& schema, int numRecords,
+                    const TFheGateBootstrappingParameterSet* params, const MaskSeed& seed);
+
+    // Client side: encrypt a cell (integer bits LSB first, or a '0'/'1' string) with seeded masks
+    void encryptCell(int record, int column, int32_t plaintext,
+                     const TFheGateBootstrappingSecretKeySet* key, std::mt19937_64& noise);
+    void encryptCellBits(int record, int column, const std::string& binaryString,
+                         const TFheGateBootstrappingSecretKeySet* key, std::mt19937_64& noise);
+
+    // Server side: rebuild every column of `record` into row `slot` of `block`,
+    // which must have the same schema and parameter set
+    void expandRecord(int record, int slot, EncryptedTable& block) const;
+
+    // How many records' expanded samples fit into `cacheBytes` (at least 1)
+    int recordsPerBlock(size_t cacheBytes) const;
+
+    // Mask stream of (record, column, bit): column in the top 16 bits, sample index below
+    uint64_t streamId(int record, int column, int bit) const;
+
+    const TableSchema& schema() const { return schema_; }
+    int numRecords() const { return numRecords_; }
+    const MaskSeed& seed() const { return seed_; }
+    const TFheGateBootstrappingParameterSet* params() const { return params_; }
+    const std::vector<Torus32>& columnBodies(int column) const { return bodies_[column]; }
+
+    // Resident bytes: bodies plus the seed
+    size_t sizeInBytes() const;
+
+private:
+    TableSchema schema_;
+    int numRecords_;
+    const TFheGateBootstrappingParameterSet* params_;
+    MaskSeed seed_;
+    std::vector<std::vector<Torus32>> bodies_;  // per column, record-major
+};
+
+// Seed-compressed counterparts of encryptDB, encryptDBbb2 and encryptDBbb3
+CompressedTable encryptCompressedTable(const std::vector<std::vector<int32_t>>& encodedDB,
+                                       int inputLength, int serviceLength,
+                                       const TFheGateBootstrappingParameterSet* params,
+                                       const TFheGateBootstrappingSecretKeySet* key,
+                                       const MaskSeed& seed);
+CompressedTable encryptCompressedTableBB2(const std::vector<std::vector<std::string>>& data,
+                                          int inputLength, int serviceLength,
+                                          const TFheGateBootstrappingParameterSet* params,
+                                          const TFheGateBootstrappingSecretKeySet* key,
+                                          const MaskSeed& seed);
+CompressedTable encryptCompressedTableBB3(const std::vector<std::vector<std::string>>& data,
+                                          int inputLength, int serviceLength,
+                                          const TFheGateBootstrappingParameterSet* params,
+                                          const TFheGateBootstrappingSecretKeySet* key,
+                                          const MaskSeed& seed);
+
+#endif // COMPRESSEDTABLE_H
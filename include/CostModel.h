@@ -0,0 +1,110 @@
+#ifndef COSTMODEL_H
+#define COSTMODEL_H
+
+#include <tfhe/tfhe.h>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AutoTuner.h"
+#include "PIREngine.h"
+#include "optimized/HomLocOPT.h"
+
+// Single-core seconds of one bootstrapped gate. A MUX is two bootstrappings.
+struct GateCosts {
+    double gateSeconds;  // AND, XOR, XNOR
+    double muxSeconds;
+};
+
+// Times bootsAND and bootsMUX on the calling thread, `samples` of each after one warm-up
+GateCosts calibrateGateCosts(const TFheGateBootstrappingCloudKeySet* bk, int samples = 32);
+
+// Bootstrapped gates of some part of a query; CONSTANT and COPY are free
+struct GateCount {
+    double gates = 0;
+    double muxes = 0;
+
+    double seconds(const GateCosts& costs) const { return gates * costs.gateSeconds + muxes * costs.muxSeconds; }
+};
+
+GateCount operator+(const GateCount& a, const GateCount& b);
+GateCount operator*(const GateCount& a, double factor);
+
+// Gates of a whole query as the native kernels run it: the building block and the service
+// AND of every record, then the XOR sum
+GateCount queryGates(const DatasetShape& shape);
+
+// Predicted cost of running a query one way
+struct PlanEstimate {
+    std::string name;          // mode and split, e.g. "ALL r4 k2"
+    ThreadPartition partition; // what HomLocPIRPartitioned runs
+    GateCount work;            // every bootstrapped gate
+    GateCount criticalPath;    // longest chain of dependent gates
+    double seconds;            // predicted latency
+};
+
+// Seconds for `work` on `threads` threads that can never beat `path` (Brent's bound):
+// work / threads + path * (1 - 1 / threads)
+double scheduledSeconds(double work, double path, double threads);
+
+// A family of plans the planner can price. estimate() returns one PlanEstimate per variant
+// (thread split) that fits shape.numThreads; new strategies are added as new models.
+class PlanModel {
+public:
+    virtual ~PlanModel() {}
+    virtual std::vector<PlanEstimate> estimate(const DatasetShape& shape, const GateCosts& costs) const = 0;
+};
+
+// Models of the existing plans: the serial loop (NONE, as the native HomLocPIR* functions),
+// the parallel record loop in each ParallelizationMode at every split of candidatePartitions,
+// and GATE_GRAPH
+std::unique_ptr<PlanModel> serialLoopModel();
+std::unique_ptr<PlanModel> recordLoopModel();
+std::unique_ptr<PlanModel> gateGraphModel();
+
+// One line of an SLA report: the fastest plan on `threads` cores, and the most records
+// that plan answers within the SLA
+struct SlaRow {
+    int threads;
+    PlanEstimate best;
+    bool meetsSla;
+    int maxRecords;
+};
+
+// Picks a plan from gate counts and calibrated gate costs, without running anything. Unlike
+// AutoTuner it needs no table or key, so it also answers offline questions: which plan for
+// a table that does not exist yet, and how many cores a latency target takes.
+class StrategyPlanner {
+public:
+    // Starts with the three built-in models
+    explicit StrategyPlanner(const GateCosts& costs);
+
+    void addModel(std::unique_ptr<PlanModel> model);
+
+    // Every plan of every model for `shape`, fastest first; best() is the first one
+    std::vector<PlanEstimate> estimates(const DatasetShape& shape) const;
+    PlanEstimate best(const DatasetShape& shape) const;
+
+    // For 1, 2, 4, ... up to `maxThreads` cores (shape.numThreads is ignored)
+    std::vector<SlaRow> slaReport(const DatasetShape& shape, double slaSeconds, int maxThreads) const;
+    // Fewest cores in that sequence that meet the SLA, 0 if even `maxThreads` do not
+    int threadsForSla(const DatasetShape& shape, double slaSeconds, int maxThreads) const;
+    // slaReport as CSV: "threads,plan,predicted_s,meets_sla,max_records"
+    void writeSlaReport(std::ostream& out, const DatasetShape& shape, double slaSeconds, int maxThreads) const;
+
+    const GateCosts& costs() const { return costs_; }
+
+private:
+    GateCosts costs_;
+    std::vector<std::unique_ptr<PlanModel>> models_;
+};
+
+// Runs a query with the planner's fastest plan for this table on `num_of_threads` threads;
+// returns the encrypted service. `second` is unused for BB3.
+LweSample* HomLocPIRPlanned(const StrategyPlanner& planner, BuildingBlock block,
+                            const LweSample* first, const LweSample* second,
+                            const std::vector<std::vector<LweSample*>>& enc_database,
+                            int inputLength, int serviceLength,
+                            const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads);
+
+#endif // COSTMODEL_H
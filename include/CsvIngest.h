@@ -0,0 +1,116 @@
+#ifndef CSVINGEST_H
+#define CSVINGEST_H
+
+#include <tfhe/tfhe.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "EncryptedTable.h"
+#include "SeededMask.h"
+
+// Streaming CSV ingestion for datasets too large for loadDataFromCSV, which keeps every
+// field as a std::string and lets encodeDB convert the whole table a second time. Here the
+// file is mapped, each record is parsed into views of the mapping, encoded straight into
+// plaintext bits by a declared schema and encrypted batch by batch, so memory is bounded by
+// the batch size rather than the row count.
+
+// Reads records off a read-only mapping of a CSV file. Fields are separated by `delimiter`;
+// a field in double quotes may hold delimiters, line breaks and "" for a quote, which is how
+// the weather services ("0.0, 46.0, 32.0") are stored. Whitespace around a field and CR of
+// CRLF line ends are dropped, blank lines are skipped. Consumed pages are released as the
+// reader advances, so even a multi-gigabyte file stays out of the resident set.
+class CsvReader {
+public:
+    explicit CsvReader(const std::string& path, char delimiter = ',', bool header = true);
+    ~CsvReader();
+
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+
+    // Fields of the next record; the views stay valid until the following call.
+    // False at the end of the file.
+    bool next(std::vector<std::string_view>& fields);
+
+    // Records not yet read, found by a quote-aware scan that does not parse fields
+    int64_t countRemaining();
+
+    int64_t recordsRead() const { return recordsRead_; }
+    int64_t line() const { return line_; }  // line the last record started on, for errors
+    const std::string& path() const { return path_; }
+
+private:
+    void releaseConsumed();
+
+    std::string path_;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t position_ = 0;
+    size_t released_ = 0;
+    char delimiter_;
+    int64_t recordsRead_ = 0;
+    int64_t line_ = 0;
+    int64_t nextLine_ = 1;
+    std::deque<std::string> unescaped_;  // quoted fields containing "", for the current record
+};
+
+// How a table column is derived from a CSV record
+enum class FieldEncoding {
+    FIXED_POINT,  // decimal value, encodeDouble(bits, value) as in encodeDB
+    INTEGER,      // integer value, its low `bits` bits
+    TEXT,         // 8 bits per character, truncated or zero-padded as by textToBinaryString
+    RECORD_INDEX  // no field: the record's position in the file, as in encryptDBbb3
+};
+
+struct CsvField {
+    int field;  // index of the field in the CSV record (ignored for RECORD_INDEX)
+    FieldEncoding encoding;
+};
+
+// Declared schema: the encrypted columns with their bit widths and the source of each.
+// Widths are fixed up front, so no pass over the data (calculateServiceLength) is needed.
+struct CsvSchema {
+    TableSchema table;
+    std::vector<CsvField> fields;  // one per column of `table`
+    char delimiter = ',';
+    bool header = true;
+};
+
+// The data/ layouts of the building blocks: "name,x_left,x_right,y_left,y_right,service"
+// (integer service), "name,x,y,service" (text service) and "name,id,service" (text service,
+// identified by position)
+CsvSchema csvSchemaBB1(int inputLength, int serviceLength);
+CsvSchema csvSchemaBB2(int inputLength, int serviceLength);
+CsvSchema csvSchemaBB3(int inputLength, int serviceLength);
+
+// Bits per record under `schema`, i.e. the sum of the column widths
+int csvRecordBits(const CsvSchema& schema);
+
+// Parse and encode up to `maxRecords` records into `bits` (record-major, csvRecordBits per
+// record, columns in schema order with the bit order of ParallelEncryption.h's encoders).
+// Returns the number of records read, 0 at the end of the file. Throws on malformed fields.
+int readCsvBatch(CsvReader& reader, const CsvSchema& schema, int maxRecords, std::vector<int32_t>& bits);
+
+// Called with every encrypted batch; `firstRecord` is the file position of its record 0
+typedef std::function<void(const EncryptedTable& batch, int64_t firstRecord)> BatchSink;
+
+// Parse, encode and encrypt `csvPath` in one pass, `batchRecords` records at a time, with the
+// per-record streams of `seed` (see ParallelEncryption.h): the batches together are exactly
+// the table the parallel encryptors produce for the same data and seed. Returns the record
+// count. Each batch is a RECORD_MAJOR table that is reused once `sink` returns.
+int64_t ingestCsv(const std::string& csvPath, const CsvSchema& schema,
+                  const TFheGateBootstrappingParameterSet* params,
+                  const TFheGateBootstrappingSecretKeySet* key, const MaskSeed& seed,
+                  int num_of_threads, int batchRecords, const BatchSink& sink);
+
+// Offline builder for large inputs: ingest `csvPath` straight into a table file (see
+// TableFile.h) without holding the encrypted table. Returns the record count.
+int64_t ingestCsvToTableFile(const std::string& csvPath, const CsvSchema& schema, const std::string& tablePath,
+                             const TFheGateBootstrappingParameterSet* params,
+                             const TFheGateBootstrappingSecretKeySet* key, const MaskSeed& seed,
+                             int num_of_threads, int batchRecords = 256);
+
+#endif // CSVINGEST_H
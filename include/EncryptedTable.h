@@ -0,0 +1,123 @@
+#ifndef ENCRYPTEDTABLE_H
+#define ENCRYPTEDTABLE_H
+
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Kind of data a column holds; determines how the plaintext is encoded before encryption
+enum class ColumnType {
+    COORDINATE,  // fixed-point value from encodeDouble
+    IDENTIFIER,  // unsigned record identifier
+    SERVICE      // integer or binary-string service payload
+};
+
+// Placement of the masks inside a column arena
+enum class TableLayout {
+    RECORD_MAJOR,  // all bits of record i are adjacent: mask(i, j) at (i * bits + j) * n
+    BIT_MAJOR      // bit j of all records is adjacent: mask(i, j) at (j * M + i) * n
+};
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType type;
+    int bits;
+};
+
+typedef std::vector<ColumnSpec> TableSchema;
+
+// Schemas of the three building blocks: (x_left, x_right, y_left, y_right, service),
+// (x, y, service) and (id, service)
+TableSchema schemaBB1(int inputLength, int serviceLength);
+TableSchema schemaBB2(int inputLength, int serviceLength);
+TableSchema schemaBB3(int inputLength, int serviceLength);
+
+// Encrypted database whose columns each live in one aligned mask arena.
+// cell() hands out zero-copy LweSample views into the arena, so the existing
+// kernels (BB1/BB2/BB3, HomBitwiseAND, HomLocPIR*) run on it unchanged.
+// The arena of a mapped table is a read-only file mapping, so only in-memory
+// tables hand out writable views.
+class EncryptedTable {
+public:
+    EncryptedTable(const TableSchema& schema, int numRecords,
+                   const TFheGateBootstrappingParameterSet* params,
+                   TableLayout layout = TableLayout::RECORD_MAJOR);
+    ~EncryptedTable();
+
+    EncryptedTable(EncryptedTable&& other) noexcept;
+    EncryptedTable& operator=(EncryptedTable&& other) noexcept;
+    EncryptedTable(const EncryptedTable&) = delete;
+    EncryptedTable& operator=(const EncryptedTable&) = delete;
+
+    // `bits` consecutive LweSample views for one cell
+    const LweSample* cell(int record, int column) const;
+    // Writable views, for encrypting into the table; throws std::logic_error on a mapped table
+    LweSample* mutableCell(int record, int column);
+
+    // Row-of-cells view in the shape expected by HomLocPIR* (no ciphertext is copied). The
+    // kernels only read database cells; on a mapped table a write through these would fault.
+    std::vector<std::vector<LweSample*>> rows() const;
+
+    // Raw mask arena of a column (numRecords * bits * n Torus32 values)
+    Torus32* columnArena(int column) const { return columns_[column].masks; }
+
+    const TableSchema& schema() const { return schema_; }
+    TableLayout layout() const { return layout_; }
+    int numRecords() const { return numRecords_; }
+    int numColumns() const { return static_cast<int>(schema_.size()); }
+    const TFheGateBootstrappingParameterSet* params() const { return params_; }
+
+    // Resident bytes of masks, bodies and views
+    size_t sizeInBytes() const;
+
+    // True when the mask arenas live in a read-only file mapping (see TableFile.h)
+    bool isMapped() const { return mapping_ != nullptr; }
+
+private:
+    struct Column {
+        Torus32* masks;
+        LweSample* views;
+    };
+
+    friend EncryptedTable mapTableFileRange(const std::string& path, const TFheGateBootstrappingParameterSet* params,
+                                            int firstRecord, int numRecords);
+
+    // Adopts mask arenas that live inside `mapping`, which is unmapped on release
+    EncryptedTable(const TableSchema& schema, int numRecords,
+                   const TFheGateBootstrappingParameterSet* params, TableLayout layout,
+                   const std::vector<Torus32*>& masks, void* mapping, size_t mappingBytes);
+
+    void buildViews(Column& column, int bits);
+    LweSample* view(int record, int column) const;
+    void release();
+
+    TableSchema schema_;
+    int numRecords_;
+    int n_;
+    const TFheGateBootstrappingParameterSet* params_;
+    TableLayout layout_;
+    std::vector<Column> columns_;
+    void* mapping_ = nullptr;
+    size_t mappingBytes_ = 0;
+};
+
+// Arena-backed counterparts of encryptDB, encryptDBbb2 and encryptDBbb3
+EncryptedTable encryptTable(const std::vector<std::vector<int32_t>>& encodedDB,
+                            int inputLength, int serviceLength,
+                            const TFheGateBootstrappingParameterSet* params,
+                            const TFheGateBootstrappingSecretKeySet* key,
+                            TableLayout layout = TableLayout::RECORD_MAJOR);
+EncryptedTable encryptTableBB2(const std::vector<std::vector<std::string>>& data,
+                               int inputLength, int serviceLength,
+                               const TFheGateBootstrappingParameterSet* params,
+                               const TFheGateBootstrappingSecretKeySet* key,
+                               TableLayout layout = TableLayout::RECORD_MAJOR);
+EncryptedTable encryptTableBB3(const std::vector<std::vector<std::string>>& data,
+                               int inputLength, int serviceLength,
+                               const TFheGateBootstrappingParameterSet* params,
+                               const TFheGateBootstrappingSecretKeySet* key,
+                               TableLayout layout = TableLayout::RECORD_MAJOR);
+
+#endif // ENCRYPTEDTABLE_H
@@ -0,0 +1,47 @@
+#ifndef EXECUTIONBACKEND_H
+#define EXECUTIONBACKEND_H
+
+#include <functional>
+#include <string>
+
+class ThreadPool;
+
+enum class BackendKind {
+    SERIAL,      // calling thread only
+    OPENMP,      // host OpenMP parallel for, dynamic schedule
+    THREAD_POOL  // persistent ThreadPool, one worker per hardware thread besides the caller
+};
+
+// Where the data-parallel loops of the optimized kernels run. The kernels used to carry an
+// OpenMP host variant and an `omp target` variant of every loop; TFHE gates cannot run on
+// an offload device, so the target regions only ever fell back to the host, and the
+// pairs differed in nothing but the pragma. Every loop now goes through the current backend,
+// which is chosen at run time (setBackend, or LOCPIR_BACKEND=serial|openmp|threadpool).
+class ExecutionBackend {
+public:
+    virtual ~ExecutionBackend() = default;
+
+    // Run body(i) for every i in [begin, end) on at most `num_of_threads` threads; returns once
+    // every index is done and rethrows the first exception a body threw
+    virtual void parallelFor(int begin, int end, int num_of_threads, const std::function<void(int)>& body) = 0;
+
+    virtual BackendKind kind() const = 0;
+};
+
+// One shared instance per kind, created on first use
+ExecutionBackend& backend(BackendKind kind);
+
+// The persistent pool behind THREAD_POOL, for schedules that drive a ThreadPool directly
+// (the gate graph) without starting threads of their own on every query
+ThreadPool& sharedThreadPool();
+
+// Backend of the kernels; OPENMP unless LOCPIR_BACKEND says otherwise. Switching is
+// thread-safe, loops already running finish on the backend they started on.
+ExecutionBackend& currentBackend();
+void setBackend(BackendKind kind);
+
+// "serial", "openmp", "threadpool"; throws std::invalid_argument for anything else
+BackendKind backendKindFromName(const std::string& name);
+const char* backendName(BackendKind kind);
+
+#endif // EXECUTIONBACKEND_H
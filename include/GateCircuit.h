@@ -0,0 +1,110 @@
+#ifndef GATECIRCUIT_H
+#define GATECIRCUIT_H
+
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <vector>
+#include "Ciphertext.h"
+#include "PIREngine.h"
+#include "ThreadPool.h"
+
+enum class GateOp {
+    INPUT,     // caller-owned ciphertext, available from the start
+    CONSTANT,  // trivial encryption, no bootstrapping
+    COPY,      // no bootstrapping
+    XOR,
+    XNOR,
+    AND,
+    MUX        // in[0] ? in[1] : in[2]
+};
+
+// A retrieval query as a dependency graph of single-bit gates. Every gate writes a wire of
+// its own (nothing is updated in place), so the only ordering left is data flow: the XNORs
+// of every record and every comparator stage are independent of each other, and only the
+// MUX chains and reduction trees are sequential.
+//
+// execute() runs the graph on a ThreadPool. Each thread keeps a queue of ready gates,
+// highest first by the number of bootstrapped gates still ahead of them (the critical
+// path) and, among equals, lowest record first, so earlier records drain before later ones
+// start. A thread pushes the gates a finished gate enables onto its own queue, and steals
+// from the others when it runs dry. Temporaries come from the ScratchPool and go back as
+// soon as their last reader has run.
+class GateCircuit {
+public:
+    int input(const LweSample* sample);
+    std::vector<int> inputs(const LweSample* samples, int length);
+    int constant(int value);
+    int gate(GateOp op, int a, int b = -1, int c = -1);
+
+    // Record the gates added from now on belong to, for the scheduling order
+    void setRecord(int record) { record_ = record; }
+
+    // Write `wire` into caller-owned `dest` instead of a temporary; throws
+    // std::invalid_argument for an input wire
+    void bind(int wire, LweSample* dest);
+
+    // Bootstrapped gates, and the most of them on any one path through the graph
+    int numGates() const;
+    int criticalPath() const;
+    int numWires() const { return static_cast<int>(nodes_.size()); }
+
+    // Run every gate on at most `num_of_threads` threads of `pool` (the caller counts as
+    // one); on a placed key each thread reads its NUMA replica
+    void execute(const TFheGateBootstrappingCloudKeySet* bk, ThreadPool& pool, int num_of_threads) const;
+
+private:
+    struct Node {
+        GateOp op;
+        int in[3];
+        int value;
+        const LweSample* input;
+        LweSample* output;  // bound destination, or null for a temporary
+        int record;
+    };
+
+    // Bootstrapped gates from each node to the end of the graph, itself included
+    std::vector<int> heights() const;
+
+    int push(Node node);
+
+    std::vector<Node> nodes_;
+    int record_ = 0;
+};
+
+// Circuit counterparts of the native kernels; buses are LSB first like the ciphertext arrays.
+// Equality is reduced by a balanced AND tree instead of a chain.
+int addCompLE(GateCircuit& circuit, const std::vector<int>& a, const std::vector<int>& b);
+int addCompL(GateCircuit& circuit, const std::vector<int>& a, const std::vector<int>& b);
+int addEqui(GateCircuit& circuit, const std::vector<int>& a, const std::vector<int>& b);
+
+int addBB1(GateCircuit& circuit, const std::vector<int>& x, const std::vector<int>& y,
+           const std::vector<std::vector<int>>& loc);
+int addBB2(GateCircuit& circuit, const std::vector<int>& x, const std::vector<int>& y,
+           const std::vector<std::vector<int>>& loc);
+int addBB3(GateCircuit& circuit, const std::vector<int>& id, const std::vector<int>& targetId);
+
+// Whole query: the building block of every record, ANDed into its service, XORed over the
+// records by a balanced tree per bit and bound to result[0..serviceLength). `second` is
+// unused for BB3.
+void addRetrieval(GateCircuit& circuit, BuildingBlock block, const LweSample* first, const LweSample* second,
+                  const std::vector<std::vector<LweSample*>>& enc_database,
+                  int inputLength, int serviceLength, LweSample* result);
+
+// The same for records [firstRecord, firstRecord + numRecords) only, with `partial` (the sum
+// of earlier records, or null) XORed in; `result` must not alias `partial`
+void addRetrieval(GateCircuit& circuit, BuildingBlock block, const LweSample* first, const LweSample* second,
+                  const std::vector<std::vector<LweSample*>>& enc_database, int firstRecord, int numRecords,
+                  int inputLength, int serviceLength, const LweSample* partial, LweSample* result);
+
+// Records per thread in one circuit of HomLocPIRGraph
+const int GRAPH_RECORDS_PER_THREAD = 4;
+
+// Builds and executes the retrieval circuit one chunk of GRAPH_RECORDS_PER_THREAD records per
+// thread at a time, each chunk folded into the running sum, so the live temporaries stay
+// bounded by the chunk instead of growing with the table; returns the encrypted service
+CiphertextArray HomLocPIRGraph(BuildingBlock block, const LweSample* first, const LweSample* second,
+                               const std::vector<std::vector<LweSample*>>& enc_database,
+                               int inputLength, int serviceLength,
+                               const TFheGateBootstrappingCloudKeySet* bk, ThreadPool& pool, int num_of_threads);
+
+#endif // GATECIRCUIT_H
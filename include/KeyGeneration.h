@@ -0,0 +1,17 @@
+#ifndef KEYGENERATION_H
+#define KEYGENERATION_H
+
+#include <tfhe/tfhe.h>
+#include "SeededMask.h"
+
+// Multi-threaded replacement for new_random_gate_bootstrapping_secret_keyset. Every secret
+// bit, mask polynomial and noise draw comes from its own (seed, stream) pair (see SeededMask.h)
+// rather than TFHE's global generator, so the TGsw encryptions of the n key bits and the rows
+// of the keyswitch key are generated in parallel, and the key set is a function of `seed`
+// alone: any num_of_threads gives a bit-identical result.
+//
+// Anyone holding the seed holds the secret key; seed from randomMaskSeed() outside tests.
+TFheGateBootstrappingSecretKeySet* generateKeySetParallel(const TFheGateBootstrappingParameterSet* params,
+                                                          const MaskSeed& seed, int num_of_threads);
+
+#endif // KEYGENERATION_H
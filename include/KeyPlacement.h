@@ -0,0 +1,84 @@
+#ifndef KEYPLACEMENT_H
+#define KEYPLACEMENT_H
+
+#include <tfhe/tfhe.h>
+#include <cstddef>
+#include <vector>
+#include "BootstrappingKeyFile.h"
+#include "ThreadPool.h"
+
+// NUMA nodes and their CPUs as listed in /sys/devices/system/node. A machine (or container)
+// without NUMA information reports a single node holding every CPU the process may run on.
+struct NumaTopology {
+    std::vector<std::vector<int>> nodeCpus;
+    std::vector<int> nodeIds;  // kernel node number of each entry, for memory binding
+
+    int numNodes() const { return static_cast<int>(nodeCpus.size()); }
+    int nodeOfCpu(int cpu) const;  // 0 for CPUs not listed
+};
+
+NumaTopology detectNumaTopology();
+
+// What actually backs a placed key
+enum class PageBacking {
+    SMALL_PAGES,             // 4 KiB pages
+    TRANSPARENT_HUGE_PAGES,  // 2 MiB-aligned region advised with MADV_HUGEPAGE
+    HUGETLB_PAGES            // reserved hugetlbfs pages (vm.nr_hugepages)
+};
+
+struct KeyPlacementPolicy {
+    bool hugePages = true;          // try hugetlbfs pages, then transparent huge pages
+    bool replicatePerNode = false;  // one read-only copy of the key on every NUMA node
+};
+
+// Copy of a cloud key (FFT bootstrapping key and keyswitch key) in memory placed for the
+// record loops: huge pages cut the TLB misses of a blind rotation, which walks ~60 MB of
+// FFT coefficients, and per-node replicas keep those reads off the socket interconnect.
+//
+// Pass get() to the query kernels as usual. Their parallel loops call localCloudKey(), which
+// swaps in the replica of the node the calling thread runs on; pinWorkerThreads (OpenMP)
+// and pinPoolWorkers (ThreadPool) keep the threads from wandering between nodes. The placed key must outlive every query using it.
+class PlacedCloudKey {
+public:
+    PlacedCloudKey(const TFheGateBootstrappingCloudKeySet* bk, KeyPlacementPolicy policy = KeyPlacementPolicy(),
+                   const NumaTopology& topology = detectNumaTopology());
+    ~PlacedCloudKey();
+
+    // Registered by address with localCloudKey, so neither copyable nor movable
+    PlacedCloudKey(const PlacedCloudKey&) = delete;
+    PlacedCloudKey& operator=(const PlacedCloudKey&) = delete;
+
+    const TFheGateBootstrappingCloudKeySet* get() const { return replicas_[0].get(); }
+    const TFheGateBootstrappingCloudKeySet* replica(int node) const;
+    const TFheGateBootstrappingCloudKeySet* local() const;  // replica for the calling thread
+
+    int numReplicas() const { return static_cast<int>(replicas_.size()); }
+    PageBacking backing() const { return backing_; }
+    // False if a replica could not be bound to its node (no kernel NUMA policy support, or
+    // forbidden by a sandbox); its pages then rely on first touch from the pinned filler thread
+    bool nodeBound() const { return nodeBound_; }
+    const NumaTopology& topology() const { return topology_; }
+
+private:
+    NumaTopology topology_;
+    PageBacking backing_ = PageBacking::SMALL_PAGES;
+    bool nodeBound_ = true;
+    std::vector<MappedCloudKey> replicas_;  // one per node, or a single shared copy
+};
+
+// The calling thread's replica when `bk` (or any of its replicas) belongs to a live
+// PlacedCloudKey, otherwise `bk` itself. Each thread caches its last answer until it moves
+// to another CPU or a key is placed or released, so a call per gate takes no lock.
+const TFheGateBootstrappingCloudKeySet* localCloudKey(const TFheGateBootstrappingCloudKeySet* bk);
+
+// Pin OpenMP threads 0..num_of_threads-1 to one CPU each, spread round-robin over the nodes
+// so every replica serves an equal share. libgomp reuses the same threads for later parallel
+// regions of up to num_of_threads threads, so one call before the queries is enough.
+// ThreadPool workers are not OpenMP threads; pin them with pinPoolWorkers.
+void pinWorkerThreads(int num_of_threads, const NumaTopology& topology = detectNumaTopology());
+
+// The same spread for the workers of a ThreadPool (sharedThreadPool(), PIREngine::threadPool());
+// worker w is placed like OpenMP thread w + 1, the caller of a job counting as thread 0
+void pinPoolWorkers(ThreadPool& pool, const NumaTopology& topology = detectNumaTopology());
+
+#endif // KEYPLACEMENT_H
@@ -0,0 +1,55 @@
+#ifndef PIRCLIENT_H
+#define PIRCLIENT_H
+
+#include <tfhe/tfhe.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Ciphertext.h"
+#include "PIRProtocol.h"
+#include "QueryCodec.h"
+#include "ResponseCodec.h"
+
+// Client side of PIRServer: one connection, one request at a time (calls from several
+// threads are serialized). Server-side failures are rethrown as std::runtime_error with the
+// server's message.
+class PIRClient {
+public:
+    // Throws if nothing listens on `socketPath`
+    PIRClient(const std::string& socketPath, const TFheGateBootstrappingParameterSet* params);
+    ~PIRClient();
+
+    PIRClient(const PIRClient&) = delete;
+    PIRClient& operator=(const PIRClient&) = delete;
+
+    // BB1/BB2 query on table `table`; `inputLength` bits per coordinate. Returns the
+    // encrypted service.
+    CiphertextArray query(const std::string& table, const LweSample* enc_x, const LweSample* enc_y, int inputLength);
+
+    // BB3 query on an encrypted identifier
+    CiphertextArray query(const std::string& table, const LweSample* enc_id, int inputLength);
+
+    // The same queries seed-compressed (encryptCompressedQuery, one value per table input),
+    // with the reply in full, modulus-switched or packed form (ResponseCodec.h). Packed
+    // replies need setPackingKey() on this connection first.
+    CiphertextArray query(const std::string& table, const CompressedQuery& query);
+    CompressedResponse queryModulusSwitched(const std::string& table, const CompressedQuery& query);
+    PackedResponse queryPacked(const std::string& table, const CompressedQuery& query);
+    void setPackingKey(const PackingKey& packingKey);
+
+    // Cleartext query on a plaintext table (one value for BB3, two for BB1/BB2); returns the
+    // service bits
+    std::vector<int> queryPlain(const std::string& table, const std::vector<int32_t>& values);
+
+private:
+    std::string roundTrip(const std::string& request);
+    std::string querySeeded(const std::string& table, const CompressedQuery& query, PIRResponseCodec codec);
+    CiphertextArray rawResult(const std::string& reply);
+
+    int fd_ = -1;
+    const TFheGateBootstrappingParameterSet* params_;
+    std::mutex mutex_;
+};
+
+#endif // PIRCLIENT_H
@@ -0,0 +1,73 @@
+#ifndef PIRENGINE_H
+#define PIRENGINE_H
+
+#include <tfhe/tfhe.h>
+#include <memory>
+#include <vector>
+#include "BootstrappingKeyFile.h"
+#include "Ciphertext.h"
+#include "EncryptedTable.h"
+#include "ThreadPool.h"
+
+// Retrieval circuit a table is built for, read off its schema
+enum class BuildingBlock {
+    BB1,  // four coordinate bounds and a service
+    BB2,  // two coordinates and a service
+    BB3   // identifier and service
+};
+
+// Throws std::invalid_argument for a schema that matches no building block
+BuildingBlock buildingBlockOf(const TableSchema& schema);
+
+// How a query is split across the pool
+enum class QuerySchedule {
+    RECORD_LOOP,  // one record per task, then an XOR tree split by pair and bit
+    GATE_GRAPH    // every gate is a task of a DAG, one per chunk of records (see GateCircuit.h)
+};
+
+// Long-lived server object: owns the cloud key (or borrows it), the encrypted database and
+// a persistent ThreadPool, and answers queries with a per-call thread budget. Unlike the
+// HomLocPIR* entry points nothing is set up per query (no OpenMP team, no rows() views,
+// no global thread count), so concurrent queries run side by side without interfering.
+class PIREngine {
+public:
+    // `bk` must outlive the engine; `num_of_threads` is the default budget of a query and
+    // the size of the pool (the calling thread counts as one)
+    PIREngine(const TFheGateBootstrappingCloudKeySet* bk, EncryptedTable&& table, int num_of_threads,
+              QuerySchedule schedule = QuerySchedule::RECORD_LOOP);
+    PIREngine(MappedCloudKey&& key, EncryptedTable&& table, int num_of_threads,
+              QuerySchedule schedule = QuerySchedule::RECORD_LOOP);
+
+    PIREngine(const PIREngine&) = delete;
+    PIREngine& operator=(const PIREngine&) = delete;
+
+    // BB1/BB2 query on an encrypted location; thread-safe. `num_of_threads` caps the threads
+    // of this call, 0 for the default budget. Returns the encrypted service.
+    CiphertextArray query(const LweSample* enc_x, const LweSample* enc_y, int num_of_threads = 0) const;
+
+    // BB3 query on an encrypted identifier
+    CiphertextArray query(const LweSample* enc_id, int num_of_threads = 0) const;
+
+    BuildingBlock buildingBlock() const { return block_; }
+    const EncryptedTable& table() const { return table_; }
+    const TFheGateBootstrappingCloudKeySet* cloudKey() const { return bk_; }
+    int numThreads() const { return numThreads_; }
+    QuerySchedule schedule() const { return schedule_; }
+    ThreadPool& threadPool() const { return *pool_; }  // for pinPoolWorkers (KeyPlacement.h)
+    int inputLength() const { return table_.schema()[0].bits; }
+    int serviceLength() const { return table_.schema().back().bits; }
+
+private:
+    CiphertextArray run(const LweSample* first, const LweSample* second, int num_of_threads) const;
+
+    std::unique_ptr<MappedCloudKey> ownedKey_;
+    const TFheGateBootstrappingCloudKeySet* bk_;
+    EncryptedTable table_;
+    std::vector<std::vector<LweSample*>> rows_;  // built once, shared by every query
+    BuildingBlock block_;
+    int numThreads_;
+    QuerySchedule schedule_;
+    std::unique_ptr<ThreadPool> pool_;
+};
+
+#endif // PIRENGINE_H
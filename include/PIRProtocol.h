@@ -0,0 +1,54 @@
+#ifndef PIRPROTOCOL_H
+#define PIRPROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Wire format between the PIR socket server and its clients (PIRServer.h, PIRClient.h):
+// length-prefixed frames over a stream socket, uint64 payload length then the payload, in
+// native byte order (both ends share a host). ShardedEvaluator uses the same frames.
+//
+// Request: op (uint8) | query codec (uint8) | response codec (uint8) |
+//          table name length (uint16) | table name | body
+//   QUERY_ENCRYPTED, RAW:    count (uint8) | count raw ciphertext arrays (QueryCodec.h) of the
+//                            table's input length
+//   QUERY_ENCRYPTED, SEEDED: compressed query (QueryCodec.h), one value per table input
+//   QUERY_PLAIN:             count (uint8) | count int32 values; both codecs RAW
+//   SET_PACKING_KEY:         packing key (ResponseCodec.h), used for the rest of the
+//                            connection; no table name
+// Reply:   status (uint8) | body
+//   OK:    by response codec, RAW: length (uint32) | raw ciphertext array; MODULUS_SWITCHED:
+//          compressed response; PACKED: packed response (ResponseCodec.h). QUERY_PLAIN: length
+//          (uint32) | one byte per bit. SET_PACKING_KEY: empty.
+//   ERROR: message
+enum class PIROp : uint8_t {
+    QUERY_ENCRYPTED = 1,  // BB1/BB2: (x, y); BB3: (id)
+    QUERY_PLAIN = 2,      // the same values in cleartext, for a plaintext table
+    SET_PACKING_KEY = 3   // needed once before PACKED responses
+};
+
+enum class PIRQueryCodec : uint8_t {
+    RAW = 0,    // full LWE samples
+    SEEDED = 1  // one mask seed plus the bodies (CompressedQuery)
+};
+
+enum class PIRResponseCodec : uint8_t {
+    RAW = 0,               // full LWE samples
+    MODULUS_SWITCHED = 1,  // CompressedResponse at DEFAULT_RESPONSE_MODULUS_BITS
+    PACKED = 2             // PackedResponse under the connection's packing key
+};
+
+const uint8_t PIR_STATUS_OK = 0;
+const uint8_t PIR_STATUS_ERROR = 1;
+
+// Frames above this are treated as a broken stream
+const uint64_t PIR_MAX_FRAME_BYTES = uint64_t(1) << 32;
+
+// Both return false once the peer is gone (EOF, reset) instead of raising SIGPIPE. readFrame
+// also fails on a frame announcing more than `maxBytes`, before reading it, and grows the
+// payload only as bytes arrive, so a peer cannot reserve memory it does not send.
+bool writeFrame(int fd, const std::string& payload);
+bool readFrame(int fd, std::string& payload, uint64_t maxBytes = PIR_MAX_FRAME_BYTES);
+
+#endif // PIRPROTOCOL_H
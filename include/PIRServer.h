@@ -0,0 +1,99 @@
+#ifndef PIRSERVER_H
+#define PIRSERVER_H
+
+#include <tfhe/tfhe.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CloudKeyCache.h"
+#include "PIREngine.h"
+#include "PIRProtocol.h"
+#include "PlainTable.h"
+#include "QueryScheduler.h"
+#include "ResponsePacking.h"
+
+const int PIR_DEFAULT_MAX_CONNECTIONS = 32;
+
+// Long-running PIR service on a UNIX domain socket. Tables are loaded once at startup:
+// encrypted tables from table files (TableFile.h), each bound to a cloud key registered in a
+// CloudKeyCache, and plaintext tables from plaintext table files (PlainTable.h) for the
+// cleartext baseline. Every client connection gets a thread that reads request frames (see
+// PIRProtocol.h) and writes one reply per request; encrypted queries from all connections
+// share the table's threads through a QueryScheduler. At most `maxConnections` are served at
+// once, later ones wait in the listen backlog, and no frame is read past the size of the
+// largest request the registered tables (or a packing key) can take, so memory stays bounded
+// whatever clients send.
+class PIRServer {
+public:
+    // `keys` and `params` must outlive the server; `num_of_threads` per encrypted table
+    PIRServer(const std::string& socketPath, CloudKeyCache& keys,
+              const TFheGateBootstrappingParameterSet* params, int num_of_threads,
+              int maxConnections = PIR_DEFAULT_MAX_CONNECTIONS);
+    ~PIRServer();  // stop()
+
+    PIRServer(const PIRServer&) = delete;
+    PIRServer& operator=(const PIRServer&) = delete;
+
+    // Register tables under `name` before start(); throws on a missing file or key, or a
+    // name already in use
+    void addEncryptedTable(const std::string& name, const std::string& tablePath, const std::string& keyId);
+    void addPlainTable(const std::string& name, const std::string& plainPath);
+
+    // Bind the socket (replacing a stale one) and accept connections on a background thread
+    void start();
+    // Stop accepting, close every connection, wait for in-flight queries, remove the socket
+    void stop();
+
+    uint64_t queriesServed() const { return served_.load(); }
+    uint64_t queriesFailed() const { return failed_.load(); }
+    // Largest request frame accepted, fixed by the tables registered at start()
+    uint64_t maxRequestBytes() const { return maxRequestBytes_; }
+    const std::string& socketPath() const { return socketPath_; }
+
+private:
+    struct EncryptedEntry {
+        std::shared_ptr<const MappedCloudKey> key;  // pinned for the engine's lifetime
+        std::unique_ptr<PIREngine> engine;
+        std::unique_ptr<QueryScheduler> scheduler;
+    };
+
+    void acceptLoop();
+    void serveConnection(int fd);
+    // One request frame in, one reply frame out; failures become ERROR replies. `packingKey`
+    // is the connection's, set by SET_PACKING_KEY.
+    std::string handle(const std::string& request, std::unique_ptr<PackingKey>& packingKey);
+    CiphertextArray queryEncrypted(const std::string& name, PIRQueryCodec codec, std::istream& in,
+                                   size_t bodyBytes);
+    void checkName(const std::string& name) const;
+    uint64_t requestBytesLimit() const;
+
+    std::string socketPath_;
+    CloudKeyCache& keys_;
+    const TFheGateBootstrappingParameterSet* params_;
+    int numThreads_;
+    int maxConnections_;
+    uint64_t maxRequestBytes_ = 0;
+
+    std::map<std::string, EncryptedEntry> encrypted_;
+    std::map<std::string, PlainTable> plain_;
+
+    int listenFd_ = -1;
+    std::thread acceptor_;
+    std::mutex connectionsMutex_;
+    std::condition_variable slotFree_;         // a connection retired, or stopping
+    std::map<int, std::thread> connections_;  // by socket
+    std::vector<std::thread> finished_;       // connections that closed, joined on the next accept
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> served_{0};
+    std::atomic<uint64_t> failed_{0};
+};
+
+#endif // PIRSERVER_H
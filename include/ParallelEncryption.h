@@ -0,0 +1,53 @@
+#ifndef PARALLELENCRYPTION_H
+#define PARALLELENCRYPTION_H
+
+#include <tfhe/tfhe.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "EncryptedTable.h"
+#include "SeededMask.h"
+
+// Multi-threaded table encryption. TFHE's bootsSymEncrypt draws from one global generator,
+// so encryptDB & co. cannot simply be wrapped in OpenMP; here every record owns its streams
+// of `seed` instead (ChaCha20 masks per bit, a seededNoise engine per record) and records
+// are encrypted in parallel, straight into the mask arenas of a preallocated EncryptedTable.
+//
+// The ciphertexts are a function of (seed, data) only, so a fixed seed reproduces the table
+// bit for bit under any thread count. The noise derives from `seed`: keep it secret, and use
+// randomMaskSeed() outside tests.
+
+// Plaintext of cell (record, column): exactly schema[column].bits bits, in the order the
+// cell's samples hold them. Called concurrently, so it must not touch shared state.
+typedef std::function<void(int record, int column, std::vector<int32_t>& bits)> CellEncoder;
+
+// Encrypt every cell of `table` (which must not be a read-only mapped table). `table` may be
+// a batch of a larger one: its record i draws the streams of record firstRecord + i, so a
+// table encrypted batch by batch equals the one encrypted at once. `encode` gets i.
+void encryptIntoTable(EncryptedTable& table, const CellEncoder& encode,
+                      const TFheGateBootstrappingSecretKeySet* key, const MaskSeed& seed,
+                      int num_of_threads, int64_t firstRecord = 0);
+
+// Parallel counterparts of encryptTable, encryptTableBB2 and encryptTableBB3; same schemas
+// and encodings, so the results decrypt identically
+EncryptedTable encryptTableParallel(const std::vector<std::vector<int32_t>>& encodedDB,
+                                    int inputLength, int serviceLength,
+                                    const TFheGateBootstrappingParameterSet* params,
+                                    const TFheGateBootstrappingSecretKeySet* key,
+                                    const MaskSeed& seed, int num_of_threads,
+                                    TableLayout layout = TableLayout::RECORD_MAJOR);
+EncryptedTable encryptTableBB2Parallel(const std::vector<std::vector<std::string>>& data,
+                                       int inputLength, int serviceLength,
+                                       const TFheGateBootstrappingParameterSet* params,
+                                       const TFheGateBootstrappingSecretKeySet* key,
+                                       const MaskSeed& seed, int num_of_threads,
+                                       TableLayout layout = TableLayout::RECORD_MAJOR);
+EncryptedTable encryptTableBB3Parallel(const std::vector<std::vector<std::string>>& data,
+                                       int inputLength, int serviceLength,
+                                       const TFheGateBootstrappingParameterSet* params,
+                                       const TFheGateBootstrappingSecretKeySet* key,
+                                       const MaskSeed& seed, int num_of_threads,
+                                       TableLayout layout = TableLayout::RECORD_MAJOR);
+
+#endif // PARALLELENCRYPTION_H
@@ -0,0 +1,124 @@
+#ifndef PLAINTABLE_H
+#define PLAINTABLE_H
+
+#include <tfhe/tfhe.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CsvIngest.h"
+#include "EncryptedTable.h"
+#include "SeededMask.h"
+
+// Columnar plaintext database, encoded once from CSV and reused by every run: each cell
+// holds the exact plaintext bits it is encrypted to (fixed-point coordinates, identifiers,
+// service bit strings), packed 64 to a word. Nothing is re-derived from text, and the
+// column widths and record count travel with the data instead of being rescanned.
+//
+// On disk:
+//
+//   PlainTableHeader | PlainTableColumn[numColumns] | per column: cell block
+//
+// A cell block holds numRecords * words cells, record-major; bit j of a cell is bit j % 64
+// of its word j / 64. Blocks are PLAIN_TABLE_ALIGNMENT-aligned and used in place by
+// mapPlainTable, which only checks the directory, so loading costs the same for any size.
+const uint32_t PLAIN_TABLE_MAGIC = 0x44524950;  // "PIRD"
+const uint32_t PLAIN_TABLE_VERSION = 1;
+const size_t PLAIN_TABLE_ALIGNMENT = 4096;
+const size_t PLAIN_TABLE_NAME_BYTES = 32;
+
+struct PlainTableHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t numRecords;
+    uint32_t numColumns;
+    uint32_t reserved;
+};
+
+struct PlainTableColumn {
+    char name[PLAIN_TABLE_NAME_BYTES];
+    uint32_t type;    // ColumnType
+    uint32_t bits;
+    uint32_t words;   // 64-bit words per cell
+    uint32_t reserved;
+    uint64_t offset;  // cell block
+};
+
+class PlainTable {
+public:
+    // Zeroed table in memory
+    PlainTable(const TableSchema& schema, int64_t numRecords);
+    ~PlainTable();
+
+    PlainTable(PlainTable&& other) noexcept;
+    PlainTable& operator=(PlainTable&& other) noexcept;
+    PlainTable(const PlainTable&) = delete;
+    PlainTable& operator=(const PlainTable&) = delete;
+
+    // Packed bits of one cell
+    const uint64_t* cellWords(int64_t record, int column) const {
+        return columns_[column] + record * words_[column];
+    }
+    int bit(int64_t record, int column, int j) const {
+        return (cellWords(record, column)[j / 64] >> (j % 64)) & 1;
+    }
+
+    // Unpacked bits (schema[column].bits of them), in the order of a CellEncoder
+    void cellBits(int64_t record, int column, int32_t* bits) const;
+    void setCell(int64_t record, int column, const int32_t* bits);
+
+    const TableSchema& schema() const { return schema_; }
+    int64_t numRecords() const { return numRecords_; }
+    int numColumns() const { return static_cast<int>(schema_.size()); }
+    int wordsPerCell(int column) const { return words_[column]; }
+
+    // True when the cells live in a read-only file mapping
+    bool isMapped() const { return mapping_ != nullptr; }
+
+private:
+    friend PlainTable mapPlainTable(const std::string& path);
+
+    // Adopts cell blocks that live inside `mapping`, which is unmapped on release
+    PlainTable(const TableSchema& schema, int64_t numRecords, const std::vector<uint64_t*>& blocks,
+               void* mapping, size_t mappingBytes);
+
+    void release();
+
+    TableSchema schema_;
+    int64_t numRecords_;
+    std::vector<int> words_;
+    std::vector<uint64_t*> columns_;
+    void* mapping_ = nullptr;
+    size_t mappingBytes_ = 0;
+};
+
+// Offline conversion: parse and encode `csvPath` once (see CsvIngest.h)
+PlainTable encodeCsvToPlainTable(const std::string& csvPath, const CsvSchema& schema);
+
+void writePlainTable(const std::string& path, const PlainTable& table);
+
+// Map `path` read-only and shared; throws if it is not a plaintext table
+PlainTable mapPlainTable(const std::string& path);
+
+// Encrypt a plaintext table with the per-record streams of ParallelEncryption.h: the result
+// equals encryptTable*Parallel on the CSV the table was encoded from
+EncryptedTable encryptPlainTable(const PlainTable& plain,
+                                 const TFheGateBootstrappingParameterSet* params,
+                                 const TFheGateBootstrappingSecretKeySet* key,
+                                 const MaskSeed& seed, int num_of_threads,
+                                 TableLayout layout = TableLayout::RECORD_MAJOR);
+
+// Same, streamed batch by batch into a table file (see TableFile.h)
+void encryptPlainTableToFile(const PlainTable& plain, const std::string& tablePath,
+                             const TFheGateBootstrappingParameterSet* params,
+                             const TFheGateBootstrappingSecretKeySet* key,
+                             const MaskSeed& seed, int num_of_threads, int batchRecords = 256);
+
+// Plaintext server mode: the HomLocPIR* circuits evaluated on cleartext, as a reference and
+// a no-encryption baseline. Queries are encoded like the client's (encodeDouble for
+// coordinates) and the result is the service bits the encrypted query decrypts to.
+std::vector<int> PlainLocPIRbb1(int32_t x, int32_t y, const PlainTable& table);
+std::vector<int> PlainLocPIRbb2(int32_t x, int32_t y, const PlainTable& table);
+std::vector<int> PlainLocPIRbb3(int32_t id, const PlainTable& table);
+
+#endif // PLAINTABLE_H
@@ -0,0 +1,60 @@
+#ifndef QUERYCHECKPOINT_H
+#define QUERYCHECKPOINT_H
+
+#include <tfhe/tfhe.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PIREngine.h"
+#include "optimized/HomLocOPT.h"
+
+// Progress of a query over a large table, so a restarted process resumes where it stopped:
+//
+//   QueryCheckpointHeader | serviceLength partial-sum ciphertexts (a[n], b, variance)
+//
+// The partial sum is the XOR of the filtered services of records [0, nextRecord). Values
+// are in native byte order, as in table files.
+const uint32_t QUERY_CHECKPOINT_MAGIC = 0x4b435051;  // "QPCK"
+const uint32_t QUERY_CHECKPOINT_VERSION = 2;
+
+struct QueryCheckpointHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t n;               // LWE dimension of the partial sum
+    uint32_t block;           // BuildingBlock
+    uint32_t numRecords;      // M of the table being queried
+    uint32_t inputLength;
+    uint32_t serviceLength;
+    uint32_t nextRecord;      // records [0, nextRecord) are in the partial sum
+    uint64_t queryHash;       // FNV-1a of the query ciphertexts, checked on resume
+    uint64_t tableHash;       // FNV-1a of every table body, checked on resume
+};
+
+struct CheckpointConfig {
+    std::string path;         // written to path + ".tmp", then renamed over path
+    int chunkRecords = 256;   // records between checkpoints
+    int maxChunks = 0;        // chunks to run in this call (a job's time slice), 0 for all
+};
+
+// Records of the query already done according to the checkpoint at `path`, -1 if there is
+// none; throws std::runtime_error for a truncated or foreign file
+int queryCheckpointProgress(const std::string& path);
+
+// HomLocPIRPartitioned (AutoTuner.h), run chunkRecords records at a time. After each chunk
+// its result is XORed into the partial sum and the checkpoint is replaced, so a crash loses
+// at most one chunk; a checkpoint left at config.path by an earlier run of the same query
+// on the same table is picked up. Returns the encrypted service and removes the checkpoint,
+// or returns nullptr with the checkpoint in place when maxChunks ran out first.
+//
+// "Same table" means the same ciphertexts, not only the same shape: every call hashes the
+// bodies of enc_database (4 bytes per bit), so a table re-encrypted or updated in between
+// does not resume from a stale partial sum. Each chunk costs serviceLength extra XORs, one
+// file write and two fsyncs. Throws std::runtime_error if the checkpoint belongs to another
+// query or table, or cannot be read or written.
+LweSample* HomLocPIRResumable(BuildingBlock block, const LweSample* first, const LweSample* second,
+                              const std::vector<std::vector<LweSample*>>& enc_database,
+                              int inputLength, int serviceLength,
+                              const TFheGateBootstrappingCloudKeySet* bk, const ThreadPartition& partition,
+                              const CheckpointConfig& config);
+
+#endif // QUERYCHECKPOINT_H
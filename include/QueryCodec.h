@@ -0,0 +1,54 @@
+#ifndef QUERYCODEC_H
+#define QUERYCODEC_H
+
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "Ciphertext.h"
+#include "SeededMask.h"
+
+// Seed-compressed query: the client sends one mask seed plus the body b of every bit,
+// and the server regenerates the masks. A BB1 query (x, y) then costs
+// 32 + 4 * 2 * inputLength bytes instead of 2 * inputLength full LWE samples.
+// The seed must be fresh for every query: reusing (seed, stream) for two different
+// plaintexts would reveal their difference.
+struct CompressedQuery {
+    MaskSeed seed;
+    std::vector<int32_t> lengths;  // bit length of each encrypted value
+    std::vector<Torus32> bodies;   // all values back to back, bits LSB first
+};
+
+// Client side: encrypt each value (bits LSB first, as encryptBoolean) under a fresh seed
+CompressedQuery encryptCompressedQuery(const std::vector<int32_t>& values, int length,
+                                       const TFheGateBootstrappingSecretKeySet* key);
+
+// Server side: rebuild full ciphertext arrays, one per encrypted value. Throws
+// std::invalid_argument if a length is outside [1, 32] or the lengths do not add up to the bodies.
+std::vector<CiphertextArray> expandCompressedQuery(const CompressedQuery& query,
+                                                   const TFheGateBootstrappingParameterSet* params);
+
+// Compact wire format: magic, version, seed, lengths, bodies (little-endian). The importer
+// throws std::runtime_error on a bad header, a length outside [1, 32] or a truncated stream;
+// sizes are checked against what is left in the stream before anything is reserved.
+void exportCompressedQueryToStream(std::ostream& out, const CompressedQuery& query);
+CompressedQuery importCompressedQueryFromStream(std::istream& in);
+
+// Uncompressed wire format built on tfhe_io, for comparison and for response payloads
+void exportCiphertextArrayToStream(std::ostream& out, const LweSample* ciphertext, int length,
+                                   const TFheGateBootstrappingParameterSet* params);
+void importCiphertextArrayFromStream(std::istream& in, LweSample* ciphertext, int length,
+                                     const TFheGateBootstrappingParameterSet* params);
+
+// Uncompressed wire format for bytes from untrusted peers: per sample the n mask words then
+// the body, int32 in native byte order, exactly (n + 1) * 4 bytes and no type tag. tfhe_io
+// aborts the process on a bad tag; this importer throws std::runtime_error on a short stream.
+size_t rawCiphertextArrayBytes(int length, const TFheGateBootstrappingParameterSet* params);
+void exportRawCiphertextArrayToStream(std::ostream& out, const LweSample* ciphertext, int length,
+                                      const TFheGateBootstrappingParameterSet* params);
+void importRawCiphertextArrayFromStream(std::istream& in, LweSample* ciphertext, int length,
+                                        const TFheGateBootstrappingParameterSet* params);
+
+#endif // QUERYCODEC_H
@@ -0,0 +1,134 @@
+#ifndef QUERYSCHEDULER_H
+#define QUERYSCHEDULER_H
+
+#include <tfhe/tfhe.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include "Ciphertext.h"
+#include "PIREngine.h"
+
+// Latencies in log-spaced buckets (each 1.25x the previous, from 10 us up to ~1.5 hours),
+// so percentiles stay within 25% at any scale without keeping every sample
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(double seconds);
+
+    // Upper bound of the bucket holding the p-th percentile (0 < p <= 100); 0 when empty
+    double percentile(double p) const;
+    uint64_t count() const { return count_; }
+    double maxSeconds() const { return max_; }
+
+    // "upper_bound_s,count" for every non-empty bucket
+    void writeCsv(std::ostream& out) const;
+
+    static double bucketUpperBound(int bucket);
+
+private:
+    std::vector<uint64_t> buckets_;
+    uint64_t count_ = 0;
+    double max_ = 0.0;
+};
+
+struct SchedulerConfig {
+    int numThreads = 0;       // threads shared by every in-flight query, 0 for the engine's
+    int maxQueued = 64;       // backpressure: admitted but not yet started queries
+    // Thread-seconds one record costs, before any query has been measured; 0 admits every
+    // query on deadline until the first one completes
+    double initialSecondsPerRecord = 0.0;
+};
+
+enum class AdmissionStatus {
+    ADMITTED,
+    QUEUE_FULL,       // maxQueued queries are already waiting; retry later
+    DEADLINE_MISSED   // the queued work ahead leaves no time to meet the deadline
+};
+
+struct QueryTicket {
+    AdmissionStatus status;
+    std::future<CiphertextArray> result;  // valid only when admitted
+    double estimatedSeconds;              // expected latency at admission
+};
+
+struct SchedulerStats {
+    uint64_t admitted = 0;
+    uint64_t rejectedQueueFull = 0;
+    uint64_t rejectedDeadline = 0;
+    uint64_t completed = 0;
+    uint64_t missedDeadline = 0;  // admitted, but finished late
+    double secondsPerRecord = 0;  // current thread-seconds per record estimate
+};
+
+// Front door for concurrent queries on one PIREngine. Calling the engine (or the
+// HomLocPIR*OPT functions) from several threads lets every call take all cores, so two
+// users already slow each other down and tail latency grows with load. The scheduler
+// queues requests, starts the one with the earliest deadline whenever a thread is free and
+// gives it the threads it needs to finish in time (estimated cost over slack), leaving the
+// rest to the queries behind it. Queries whose deadline cannot be met given the work ahead
+// are refused, and so are new queries once maxQueued are waiting.
+//
+// Cost is learned from completed queries as thread-seconds per record. Query ciphertexts
+// must stay alive until the ticket's future is ready.
+class QueryScheduler {
+public:
+    QueryScheduler(const PIREngine& engine, const SchedulerConfig& config);
+    ~QueryScheduler();  // finishes every admitted query
+
+    QueryScheduler(const QueryScheduler&) = delete;
+    QueryScheduler& operator=(const QueryScheduler&) = delete;
+
+    // `deadlineSeconds` from now; 0 for none
+    QueryTicket submit(const LweSample* enc_x, const LweSample* enc_y, double deadlineSeconds);
+    QueryTicket submit(const LweSample* enc_id, double deadlineSeconds);
+
+    // End-to-end (submit to result) and queueing latency of completed queries
+    LatencyHistogram latency() const;
+    LatencyHistogram queueLatency() const;
+    SchedulerStats stats() const;
+
+    int queued() const;
+    int freeThreads() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Request {
+        const LweSample* first;
+        const LweSample* second;
+        Clock::time_point submitted;
+        Clock::time_point deadline;  // max() for none
+        double cost;                 // estimated thread-seconds
+        std::promise<CiphertextArray> promise;
+    };
+
+    QueryTicket admit(const LweSample* first, const LweSample* second, double deadlineSeconds);
+    void runnerLoop();
+    double estimatedCost() const;
+
+    const PIREngine& engine_;
+    SchedulerConfig config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::unique_ptr<Request>> queue_;  // ordered by deadline
+    int freeThreads_;
+    double backlog_ = 0.0;  // estimated thread-seconds queued or running
+    double secondsPerRecord_;
+    bool stopping_ = false;
+
+    LatencyHistogram latency_;
+    LatencyHistogram queueLatency_;
+    SchedulerStats stats_;
+    std::vector<std::thread> runners_;
+};
+
+#endif // QUERYSCHEDULER_H
@@ -0,0 +1,46 @@
+#ifndef RESPONSECODEC_H
+#define RESPONSECODEC_H
+
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "ResponsePacking.h"
+
+// Default width of a modulus-switched coefficient. The rounding error over n = 630
+// coefficients stays far below the 1/8 decryption margin for anything from 10 bits up.
+const int DEFAULT_RESPONSE_MODULUS_BITS = 14;
+
+// PIR response whose samples were switched from Torus32 to a 2^modulusBits modulus and
+// bit-packed, (n + 1) * modulusBits bits per sample instead of 4n + 12 bytes.
+struct CompressedResponse {
+    int32_t modulusBits;
+    int32_t length;  // number of samples (serviceLength)
+    int32_t n;       // LWE dimension
+    std::vector<uint8_t> packed;
+};
+
+// Server side, just before serialization: no extra bootstrapping is involved
+CompressedResponse compressResponse(const LweSample* result, int length,
+                                    const TFheGateBootstrappingParameterSet* params,
+                                    int modulusBits = DEFAULT_RESPONSE_MODULUS_BITS);
+
+// Unpack coefficient `index` (0..n-1 mask, n body) of sample `sample`
+uint32_t responseCoefficient(const CompressedResponse& response, int sample, int index);
+
+// The importer throws std::runtime_error unless modulusBits is in [2, 31], n is the LWE
+// dimension of `params` and the full length * (n + 1) * modulusBits bit payload is present
+void exportCompressedResponseToStream(std::ostream& out, const CompressedResponse& response);
+CompressedResponse importCompressedResponseFromStream(std::istream& in,
+                                                     const TFheGateBootstrappingParameterSet* params);
+
+// RLWE-packed responses (see ResponsePacking.h) and the packing key the server needs for them.
+// Importers throw std::runtime_error unless the dimensions are those of `params` (N a power
+// of two) and the whole payload is present.
+void exportPackedResponseToStream(std::ostream& out, const PackedResponse& response);
+PackedResponse importPackedResponseFromStream(std::istream& in, const TFheGateBootstrappingParameterSet* params);
+void exportPackingKeyToStream(std::ostream& out, const PackingKey& packingKey);
+PackingKey importPackingKeyFromStream(std::istream& in, const TFheGateBootstrappingParameterSet* params);
+
+#endif // RESPONSECODEC_H
@@ -0,0 +1,56 @@
+#ifndef RESPONSEPACKING_H
+#define RESPONSEPACKING_H
+
+#include <tfhe/tfhe.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Gadget decomposition of the packing key: PACKING_LEVELS digits of PACKING_BASEBIT bits,
+// i.e. mask coefficients are kept to 16 bits of precision before key switching.
+const int PACKING_BASEBIT = 4;
+const int PACKING_LEVELS = 4;
+
+// Client secret for packed responses: a binary polynomial of the TLWE ring Z[X]/(X^N + 1)
+struct PackingSecretKey {
+    int32_t N;
+    std::vector<int32_t> z;
+};
+
+// Public packing key-switching key, sent to the server once per client like the cloud key.
+// Row (i, j) is an RLWE encryption under z of the constant s_i / 2^(basebit * (j + 1)).
+// Stored coefficient-major, a[k * rows + i * levels + j], so packing walks it contiguously.
+struct PackingKey {
+    int32_t n;
+    int32_t N;
+    int32_t basebit;
+    int32_t levels;
+    std::vector<Torus32> a;
+    std::vector<Torus32> b;
+};
+
+// serviceLength LWE results folded into ceil(length / N) RLWE samples, bit m of the
+// response in coefficient m % N of chunk m / N. Downloads a 4N-byte mask per chunk plus 4
+// bytes per bit instead of (4n + 12) bytes per bit; body coefficients past the last bit
+// carry nothing and are not kept.
+struct PackedResponse {
+    int32_t N;
+    int32_t length;
+    std::vector<Torus32> a;  // chunk c occupies [c * N, (c + 1) * N)
+    std::vector<Torus32> b;  // one per bit, length in all
+};
+
+// Client side key generation
+PackingSecretKey newPackingSecretKey(const TFheGateBootstrappingParameterSet* params);
+PackingKey newPackingKey(const PackingSecretKey& packingSecret, const TFheGateBootstrappingSecretKeySet* key,
+                         int num_of_threads = 1);
+
+// Server side: key-switch the LWE result bits of a HomLocPIR* call into RLWE samples
+PackedResponse packResponse(const LweSample* result, int length, const PackingKey& packingKey,
+                            int num_of_threads = 1);
+
+// Client side unpacker; throws std::invalid_argument if the response does not fit the key
+std::vector<int> unpackResponseToBinaryVector(const PackedResponse& response, const PackingSecretKey& packingSecret);
+std::string unpackResponseBinaryString(const PackedResponse& response, const PackingSecretKey& packingSecret);
+
+#endif // RESPONSEPACKING_H
@@ -0,0 +1,20 @@
+#ifndef SCRATCHPOOL_H
+#define SCRATCHPOOL_H
+
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <cstddef>
+
+// Per-thread pool of gate-bootstrapping ciphertext arrays used for kernel temporaries.
+// Arrays are bucketed by LWE dimension and array length, so after the first call of a
+// kernel on a thread every further call reuses the same buffers instead of malloc/free.
+LweSample* acquireScratchArray(int length, const TFheGateBootstrappingParameterSet* params);
+void releaseScratchArray(LweSample* samples, int length, const TFheGateBootstrappingParameterSet* params);
+
+// Free every array cached by the calling thread
+void clearScratchPool();
+
+// Number of arrays the pools had to allocate so far (all threads); stays flat once warmed up
+size_t scratchPoolAllocations();
+
+#endif // SCRATCHPOOL_H
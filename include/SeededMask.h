@@ -0,0 +1,41 @@
+#ifndef SEEDEDMASK_H
+#define SEEDEDMASK_H
+
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <cstdint>
+#include <random>
+
+// 256-bit seed of the mask generator. A seed used only for masks (compressed queries and
+// tables) can be shipped or stored next to the ciphertexts. A seed also handed to
+// seededNoise, as key generation and encryptIntoTable do, keys the noise too and must stay
+// secret.
+struct MaskSeed {
+    uint32_t words[8];
+};
+
+MaskSeed randomMaskSeed();
+MaskSeed maskSeedFromInts(uint32_t a, uint32_t b, uint32_t c);
+
+// Fill `mask` (n Torus32 values) with the ChaCha20 keystream of (seed, stream).
+// Every stream is independent, so any sample can be expanded on its own and in parallel.
+void expandMask(Torus32* mask, int n, const MaskSeed& seed, uint64_t stream);
+
+// Gaussian-noise engine keyed by (seed, stream), for encryption that must be reproducible
+// under any thread count. Unlike masks, whatever it produces is secret, so `seed` must be too.
+std::mt19937_64 seededNoise(const MaskSeed& seed, uint64_t stream);
+
+// seededNoise under a fresh randomMaskSeed(), for encryption that need not be reproducible.
+// Never seed a noise engine from a single random_device word: 2^32 seeds are searchable.
+std::mt19937_64 randomNoise();
+
+// Encrypt one boolean with the mask of (seed, stream); only the returned body b has to be kept.
+// Uses the same encoding as bootsSymEncrypt (+-1/8) and the parameter set's alpha_min noise.
+Torus32 seededSymEncrypt(int32_t message, const MaskSeed& seed, uint64_t stream,
+                         const TFheGateBootstrappingSecretKeySet* key, std::mt19937_64& noise);
+
+// Rebuild the full sample (mask + body) in place
+void expandSample(LweSample* sample, Torus32 body, const MaskSeed& seed, uint64_t stream,
+                  const TFheGateBootstrappingParameterSet* params);
+
+#endif // SEEDEDMASK_H
@@ -0,0 +1,109 @@
+#ifndef SHARDEDEVALUATION_H
+#define SHARDEDEVALUATION_H
+
+#include <tfhe/tfhe.h>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include "BootstrappingKeyFile.h"
+#include "Ciphertext.h"
+#include "EncryptedTable.h"
+#include "PIREngine.h"
+
+// Cloud key image in an anonymous in-memory file (memfd). Its descriptor survives fork, so
+// every worker process maps the same physical pages instead of holding a copy of the key.
+class SharedKeyImage {
+public:
+    explicit SharedKeyImage(const TFheGateBootstrappingCloudKeySet* bk);
+    ~SharedKeyImage();
+
+    SharedKeyImage(SharedKeyImage&& other) noexcept;
+    SharedKeyImage& operator=(SharedKeyImage&& other) noexcept;
+    SharedKeyImage(const SharedKeyImage&) = delete;
+    SharedKeyImage& operator=(const SharedKeyImage&) = delete;
+
+    // Read-only shared mapping of the image, usable as a cloud key
+    MappedCloudKey map(const TFheGateBootstrappingParameterSet* params) const;
+
+    int fd() const { return fd_; }
+    size_t bytes() const { return bytes_; }
+
+private:
+    int fd_ = -1;
+    size_t bytes_ = 0;
+};
+
+// Contiguous record range evaluated by one shard
+struct ShardRange {
+    int firstRecord;
+    int numRecords;
+};
+
+// `numShards` ranges covering [0, numRecords), sizes differing by at most one
+std::vector<ShardRange> shardRanges(int numRecords, int numShards);
+
+// Scale-out evaluation of one table across worker processes. The service is an XOR over the
+// records, so each worker answers the query on its own record range and the coordinator
+// XORs the partial results, one bootstrapped XOR per bit and shard.
+//
+// Each worker is forked at construction. It maps its range of a RECORD_MAJOR table file (see
+// mapTableFileRange) and the shared key image, and serves an engine of `threadsPerShard`
+// threads, so no process holds more than its share of the table. Queries and partial
+// results travel as length-prefixed frames over a UNIX socket pair; a remote shard would
+// speak the same frames over a stream socket.
+//
+// A worker whose socket fails mid-frame is killed and a fresh one is forked for its range;
+// the query that hit it throws, later ones are answered by the replacement. Construct the
+// evaluator before starting other threads in the process, as fork copies only the calling
+// thread; a replacement is forked from the querying thread.
+class ShardedEvaluator {
+public:
+    // `bk` must outlive the evaluator; throws if a worker fails to load its shard
+    ShardedEvaluator(const std::string& tablePath, const TFheGateBootstrappingCloudKeySet* bk,
+                     int numShards, int threadsPerShard);
+    ~ShardedEvaluator();  // closes the sockets and reaps the workers
+
+    ShardedEvaluator(const ShardedEvaluator&) = delete;
+    ShardedEvaluator& operator=(const ShardedEvaluator&) = delete;
+
+    // Same contract as PIREngine::query; queries are serialized, each spans every shard
+    CiphertextArray query(const LweSample* enc_x, const LweSample* enc_y) const;
+    CiphertextArray query(const LweSample* enc_id) const;
+
+    BuildingBlock buildingBlock() const { return block_; }
+    int numShards() const { return static_cast<int>(workers_.size()); }
+    const ShardRange& shard(int s) const { return workers_[s].range; }
+    pid_t workerPid(int s) const { return workers_[s].pid; }  // -1 while the shard is down
+    int numRecords() const { return numRecords_; }
+    int inputLength() const { return inputLength_; }
+    int serviceLength() const { return serviceLength_; }
+
+private:
+    struct Worker {
+        pid_t pid;   // -1 once reaped
+        int socket;  // coordinator end, -1 once closed
+        ShardRange range;
+    };
+
+    CiphertextArray run(const LweSample* first, const LweSample* second) const;
+    Worker spawn(const ShardRange& range) const;
+    bool awaitReady(const Worker& worker, std::string& reason) const;
+    void stop(Worker& worker) const;
+    void respawn(size_t s) const;
+    void shutdown();
+
+    const TFheGateBootstrappingCloudKeySet* bk_;
+    SharedKeyImage key_;
+    std::string tablePath_;
+    int threadsPerShard_;
+    BuildingBlock block_;
+    int numRecords_;
+    int inputLength_;
+    int serviceLength_;
+    mutable std::vector<Worker> workers_;  // dead ones are replaced under mutex_
+    mutable std::mutex mutex_;  // one query in flight on the sockets
+};
+
+#endif // SHARDEDEVALUATION_H
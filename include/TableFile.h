@@ -0,0 +1,87 @@
+#ifndef TABLEFILE_H
+#define TABLEFILE_H
+
+#include <tfhe/tfhe.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "EncryptedTable.h"
+
+// On-disk encrypted table, built offline and mapped by the server:
+//
+//   TableFileHeader | TableFileColumn[numColumns] | per column: mask block, body block
+//
+// Every block starts on a TABLE_FILE_ALIGNMENT boundary, so the mask arenas of a mapped
+// file are used in place with the layout recorded in the header. Values are stored in
+// native byte order; the magic doubles as an endianness check.
+const uint32_t TABLE_FILE_MAGIC = 0x54524950;  // "PIRT"
+const uint32_t TABLE_FILE_VERSION = 1;
+const size_t TABLE_FILE_ALIGNMENT = 4096;
+const size_t TABLE_FILE_NAME_BYTES = 32;
+
+struct TableFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t n;            // LWE dimension the masks were generated for
+    uint32_t layout;       // TableLayout
+    uint32_t numRecords;   // M
+    uint32_t numColumns;
+    double alphaMin;       // parameter fingerprint, checked on load
+};
+
+struct TableFileColumn {
+    char name[TABLE_FILE_NAME_BYTES];
+    uint32_t type;         // ColumnType
+    uint32_t bits;
+    uint64_t masksOffset;  // numRecords * bits * n Torus32
+    uint64_t bodiesOffset; // numRecords * bits Torus32, record-major
+};
+
+// Offline builder: write an encrypted table (any layout) to `path`
+void writeTableFile(const std::string& path, const EncryptedTable& table);
+
+// Streaming builder for tables too large to encrypt in memory at once: the record count is
+// fixed up front and record-major batches of records are appended in order (see CsvIngest.h).
+// The file is RECORD_MAJOR and complete once finish() returns.
+class TableFileWriter {
+public:
+    TableFileWriter(const std::string& path, const TableSchema& schema, int numRecords,
+                    const TFheGateBootstrappingParameterSet* params);
+    ~TableFileWriter();
+
+    TableFileWriter(const TableFileWriter&) = delete;
+    TableFileWriter& operator=(const TableFileWriter&) = delete;
+
+    // Next records of the table; `batch` must be RECORD_MAJOR with the same schema
+    void append(const EncryptedTable& batch);
+
+    // Throws if fewer records than declared were appended
+    void finish();
+
+    int recordsWritten() const { return recordsWritten_; }
+
+private:
+    int fd_ = -1;
+    std::string path_;
+    TableSchema schema_;
+    int numRecords_;
+    int recordsWritten_ = 0;
+    int n_;
+    std::vector<TableFileColumn> directory_;
+};
+
+// Server startup: map `path` read-only and shared, so processes serving the same file share
+// its page cache. Only the O(M * bits) views are built; masks are faulted in by the first scan.
+// Throws if the file does not match `params`.
+EncryptedTable mapTableFile(const std::string& path, const TFheGateBootstrappingParameterSet* params);
+
+// Records [firstRecord, firstRecord + numRecords) of a RECORD_MAJOR file (numRecords < 0 for
+// the rest), for a shard that serves part of the table: only the page-aligned window of each
+// column's masks for the range is mapped, and bodies and views are built for the range only
+EncryptedTable mapTableFileRange(const std::string& path, const TFheGateBootstrappingParameterSet* params,
+                                 int firstRecord, int numRecords);
+
+// Schema and record count from the header, without mapping the file
+TableSchema readTableFileSchema(const std::string& path, int& numRecords);
+
+#endif // TABLEFILE_H
@@ -0,0 +1,48 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent workers for the query loops. An OpenMP parallel region forks (or wakes) a
+// team per call and its size is global state, so concurrent queries fight over it; here
+// every parallelFor is a job of its own with its own thread budget, served by whichever
+// workers are idle. The caller always works on its own job, so a job finishes even when
+// every worker is busy, and a loop body may itself call parallelFor.
+class ThreadPool {
+public:
+    // `num_of_workers` threads besides the callers
+    explicit ThreadPool(int num_of_workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run body(i) for every i in [begin, end) on at most `num_of_threads` threads: the
+    // caller and up to num_of_threads - 1 workers. Returns once every index is done and
+    // rethrows the first exception a body threw (the remaining indices are skipped).
+    void parallelFor(int begin, int end, int num_of_threads, const std::function<void(int)>& body);
+
+    int numWorkers() const { return static_cast<int>(workers_.size()); }
+    // Handle of worker `w`, e.g. to set its CPU affinity (see pinPoolWorkers in KeyPlacement.h)
+    std::thread::native_handle_type nativeHandle(int w) { return workers_[w].native_handle(); }
+
+private:
+    struct Job;
+
+    void workerLoop();
+    static void runJob(Job& job);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::shared_ptr<Job>> jobs_;  // jobs that still take helpers
+    bool stopping_ = false;
+};
+
+#endif // THREADPOOL_H
@@ -3,12 +3,14 @@
 
 #include <tfhe/tfhe.h>
 #include <tfhe/tfhe_io.h>
+#include <vector>
 
 // Perform bitwise AND between a single-bit ciphertext `v` and each bit of a ciphertext array `ct`
 LweSample* HomBitwiseAND(const LweSample* v, const LweSample* ct, const int length, const TFheGateBootstrappingCloudKeySet* bk);
+void HomBitwiseAND(LweSample* result, const LweSample* v, const LweSample* ct, const int length, const TFheGateBootstrappingCloudKeySet* bk);
 
 // Sum up an array of ciphertexts using XOR to perform bitwise addition
 LweSample* HomSum(const std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk);
+bool HomSum(LweSample* result, const std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk);
 
 #endif // HOMSUP_H
-
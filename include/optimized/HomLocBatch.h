@@ -0,0 +1,35 @@
+#ifndef HOM_LOC_BATCH_H
+#define HOM_LOC_BATCH_H
+
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include <vector>
+#include "Ciphertext.h"
+
+// Location-Based PIR for K queries (a trajectory, a fleet) in one pass over the database.
+// The records are handed out to the threads in small chunks, and a thread evaluates every
+// query on a record before moving to the next, so each record is read from memory once per
+// batch instead of once per query. Each running chunk folds the K filtered services into
+// running XOR sums it borrows (one set per thread), which are XORed together at the end.
+//
+// The gate count is that of K single queries; what is saved is database traffic, which
+// dominates once the table outgrows the last-level cache. Returns the K encrypted services
+// in query order; throws std::invalid_argument if enc_x and enc_y differ in size.
+std::vector<CiphertextArray> HomLocPIRbb1Batch(const std::vector<const LweSample*>& enc_x,
+                                               const std::vector<const LweSample*>& enc_y,
+                                               const std::vector<std::vector<LweSample*>>& enc_database,
+                                               const int inputLength, const int serviceLength,
+                                               const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads);
+
+std::vector<CiphertextArray> HomLocPIRbb2Batch(const std::vector<const LweSample*>& enc_x,
+                                               const std::vector<const LweSample*>& enc_y,
+                                               const std::vector<std::vector<LweSample*>>& enc_database,
+                                               const int lengthInterval, const int lengthService,
+                                               const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads);
+
+std::vector<CiphertextArray> HomLocPIRbb3Batch(const std::vector<const LweSample*>& enc_ids,
+                                               const std::vector<std::vector<LweSample*>>& enc_database,
+                                               const int lengthInterval, const int lengthService,
+                                               const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads);
+
+#endif // HOM_LOC_BATCH_H
@@ -0,0 +1,32 @@
+#ifndef HOM_LOC_COMPRESSED_H
+#define HOM_LOC_COMPRESSED_H
+
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include <cstddef>
+#include "CompressedTable.h"
+
+// Default working set for mask expansion: about one L2 cache
+const size_t DEFAULT_EXPANSION_BYTES = 1 << 20;
+
+// Location-Based PIR over a seed-compressed table. Records are processed in blocks of
+// `cacheBytes`; each thread expands the masks of its record just before running BB/AND on it.
+LweSample* HomLocPIRbb1Compressed(const LweSample* enc_x, const LweSample* enc_y,
+                                  const CompressedTable& table,
+                                  const int inputLength, const int serviceLength,
+                                  const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads,
+                                  size_t cacheBytes = DEFAULT_EXPANSION_BYTES);
+
+LweSample* HomLocPIRbb2Compressed(const LweSample* enc_x, const LweSample* enc_y,
+                                  const CompressedTable& table,
+                                  const int lengthInterval, const int lengthService,
+                                  const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads,
+                                  size_t cacheBytes = DEFAULT_EXPANSION_BYTES);
+
+LweSample* HomLocPIRbb3Compressed(const LweSample* enc_id,
+                                  const CompressedTable& table,
+                                  const int lengthInterval, const int lengthService,
+                                  const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads,
+                                  size_t cacheBytes = DEFAULT_EXPANSION_BYTES);
+
+#endif // HOM_LOC_COMPRESSED_H
@@ -9,7 +9,19 @@ enum class ParallelizationMode {
     NONE,                            // No parallelization
     PARALLEL_LOOP_HOMSUM,            // Parallelization of the main loop over M + GPU-accelerated HomSum
     PARALLEL_LOOP_HOMSUM_BB1_BITWISE,// Parallelization of the main loop over M + GPU-accelerated HomSum + BB1OPT + HomBitwiseAND
-    ALL                              // Parallelization of the main loop over M + GPU-accelerated HomSum + HomBitwiseAND + BB1OptGPU
+    ALL,                             // Parallelization of the main loop over M + GPU-accelerated HomSum + HomBitwiseAND + BB1OptGPU
+    GATE_GRAPH                       // Gate DAGs over chunks of records on the shared work-stealing pool (see GateCircuit.h)
+};
+
+// How a query's threads are split: `recordThreads` share the record loop, each record's
+// kernels (BB*OPT/BB*OptGPU, HomBitwiseANDOPT) split over `kernelThreads`, and the final
+// HomSum (or the whole GATE_GRAPH) runs on `reductionThreads`. The entry points taking a
+// plain thread count use it for all three; AutoTuner.h picks a split per dataset shape.
+struct ThreadPartition {
+    ParallelizationMode mode;
+    int recordThreads;
+    int kernelThreads;
+    int reductionThreads;
 };
 
 LweSample* HomLocPIRbb1OPT(const LweSample* enc_x, const LweSample* enc_y, 
@@ -17,18 +29,33 @@ LweSample* HomLocPIRbb1OPT(const LweSample* enc_x, const LweSample* enc_y,
                                const int inputLength, const int serviceLength, 
                                const TFheGateBootstrappingCloudKeySet* bk, 
                                ParallelizationMode mode, int num_of_threads);
+LweSample* HomLocPIRbb1OPT(const LweSample* enc_x, const LweSample* enc_y, 
+                               const std::vector<std::vector<LweSample*>>& enc_database, 
+                               const int inputLength, const int serviceLength, 
+                               const TFheGateBootstrappingCloudKeySet* bk, 
+                               const ThreadPartition& partition);
 
 LweSample* HomLocPIRbb2OPT(const LweSample* enc_x, const LweSample* enc_y, 
                            const std::vector<std::vector<LweSample*>>& enc_database, 
                            const int lengthInterval, const int lengthService, 
                            const TFheGateBootstrappingCloudKeySet* bk, 
-                           ParallelizationMode mode, int num_of_threads); 
+                           ParallelizationMode mode, int num_of_threads);
+LweSample* HomLocPIRbb2OPT(const LweSample* enc_x, const LweSample* enc_y, 
+                           const std::vector<std::vector<LweSample*>>& enc_database, 
+                           const int lengthInterval, const int lengthService, 
+                           const TFheGateBootstrappingCloudKeySet* bk, 
+                           const ThreadPartition& partition); 
  
 LweSample* HomLocPIRbb3OPT(const LweSample* enc_id, 
                            const std::vector<std::vector<LweSample*>>& enc_database,
                            const int lengthInterval, const int lengthService,
                            const TFheGateBootstrappingCloudKeySet* bk, 
-                           ParallelizationMode mode, int num_of_threads); 
+                           ParallelizationMode mode, int num_of_threads);
+LweSample* HomLocPIRbb3OPT(const LweSample* enc_id, 
+                           const std::vector<std::vector<LweSample*>>& enc_database,
+                           const int lengthInterval, const int lengthService,
+                           const TFheGateBootstrappingCloudKeySet* bk, 
+                           const ThreadPartition& partition); 
 
 
 #endif // HOM_LOC_OPT_H
@@ -4,14 +4,25 @@
 #include <tfhe/tfhe.h>
 #include <tfhe/tfhe_io.h>
 #include <vector>
+#include "Ciphertext.h"
+
+// Every loop runs on the current execution backend (see ExecutionBackend.h). The *GPU
+// functions are the *OPT kernels under their earlier names.
 
 // Optimized version of HomBitwiseAND using parallelization
 LweSample* HomBitwiseANDOPT(LweSample* v, LweSample* ct, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads);
 LweSample* HomBitwiseANDGPU(LweSample* v, LweSample* ct, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores);
 LweSample* HomSumOPT(std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads);
-LweSample* HomSumGPU(std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores); 
+LweSample* HomSumGPU(std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores);
 
+// Output-parameter versions: the result is written straight into `result`, inputs are left untouched
+void HomBitwiseANDOPT(LweSample* result, const LweSample* v, const LweSample* ct, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads);
+void HomBitwiseANDGPU(LweSample* result, const LweSample* v, const LweSample* ct, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores);
+void HomSumOPT(LweSample* result, const std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads);
+void HomSumGPU(LweSample* result, const std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores);
 
+// Consuming version: reduces the owned arrays in place and moves the sum out of the first one
+CiphertextArray HomSumOPT(std::vector<CiphertextArray>&& ct_array, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads);
+CiphertextArray HomSumGPU(std::vector<CiphertextArray>&& ct_array, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores);
 
 #endif // HOMSUP_OPT_H
-
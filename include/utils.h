@@ -6,9 +6,13 @@
 #include <vector>
 #include <string>
 
+struct CompressedResponse;  // ResponseCodec.h
+
 // Initialization functions
 TFheGateBootstrappingParameterSet* initializeParams(int minimum_lambda);
+// Fixed-seed key sets, for tests and benchmarks only
 TFheGateBootstrappingSecretKeySet* generateKeySet(TFheGateBootstrappingParameterSet* params);
+TFheGateBootstrappingSecretKeySet* generateKeySet(TFheGateBootstrappingParameterSet* params, int num_of_threads);
 
 // Encoding and decoding functions
 int32_t encodeDouble(int length, double data);
@@ -16,6 +20,7 @@ double decodeDouble(const std::vector<int>& binaryVector);
 
 // Encryption and decryption functions
 LweSample* encryptBoolean(int32_t plaintext, int length, const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key);
+void encryptBooleanTo(LweSample* ciphertext, int32_t plaintext, int length, const TFheGateBootstrappingSecretKeySet* key);
 std::vector<int> decryptToBinaryVector(const LweSample* ciphertext, int length, const TFheGateBootstrappingSecretKeySet* key);
 
 
@@ -25,8 +30,13 @@ std::string binaryStringToText(const std::string& binaryString);
 
 // Binary String to LweSample
 LweSample* encryptBinaryString(const std::string& binaryString, const TFheGateBootstrappingSecretKeySet* key, const TFheGateBootstrappingCloudKeySet* bk); 
+void encryptBinaryStringTo(LweSample* ciphertext, const std::string& binaryString, const TFheGateBootstrappingSecretKeySet* key);
 std::string decryptBinaryString(const LweSample* ciphertext, int length, const TFheGateBootstrappingSecretKeySet* key);
 
+// Modulus-switched responses (see ResponseCodec.h)
+std::vector<int> decryptResponseToBinaryVector(const CompressedResponse& response, const TFheGateBootstrappingSecretKeySet* key);
+std::string decryptResponseBinaryString(const CompressedResponse& response, const TFheGateBootstrappingSecretKeySet* key);
+
 // Data loading and output functions
 void outputToCSV(const std::vector<std::vector<double>>& data, const std::string& fileName);
 
@@ -0,0 +1,206 @@
+#include "AutoTuner.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const ParallelizationMode MODES[] = {
+    ParallelizationMode::NONE,
+    ParallelizationMode::PARALLEL_LOOP_HOMSUM,
+    ParallelizationMode::PARALLEL_LOOP_HOMSUM_BB1_BITWISE,
+    ParallelizationMode::ALL,
+    ParallelizationMode::GATE_GRAPH
+};
+
+const char* blockName(BuildingBlock block) {
+    switch (block) {
+        case BuildingBlock::BB1: return "bb1";
+        case BuildingBlock::BB2: return "bb2";
+        case BuildingBlock::BB3: return "bb3";
+    }
+    return "bb?";
+}
+
+int nextPowerOfTwo(int value) {
+    int power = 1;
+    while (power < value) {
+        power *= 2;
+    }
+    return power;
+}
+
+} // namespace
+
+std::string DatasetShape::key() const {
+    std::ostringstream key;
+    key << blockName(block) << "/M" << nextPowerOfTwo(numRecords) << "/in" << inputLength
+        << "/svc" << serviceLength << "/T" << numThreads;
+    return key.str();
+}
+
+const char* parallelizationModeName(ParallelizationMode mode) {
+    switch (mode) {
+        case ParallelizationMode::NONE: return "NONE";
+        case ParallelizationMode::PARALLEL_LOOP_HOMSUM: return "PARALLEL_LOOP_HOMSUM";
+        case ParallelizationMode::PARALLEL_LOOP_HOMSUM_BB1_BITWISE: return "PARALLEL_LOOP_HOMSUM_BB1_BITWISE";
+        case ParallelizationMode::ALL: return "ALL";
+        case ParallelizationMode::GATE_GRAPH: return "GATE_GRAPH";
+    }
+    return "UNKNOWN";
+}
+
+ParallelizationMode parallelizationModeFromName(const std::string& name) {
+    for (ParallelizationMode mode : MODES) {
+        if (name == parallelizationModeName(mode)) {
+            return mode;
+        }
+    }
+    throw std::invalid_argument("parallelizationModeFromName: unknown mode '" + name + "'");
+}
+
+std::vector<ThreadPartition> candidatePartitions(int num_of_threads) {
+    const int T = std::max(1, num_of_threads);
+    if (T == 1) {
+        return {{ParallelizationMode::NONE, 1, 1, 1}};
+    }
+
+    // NONE stays in: on an oversubscribed host the serial loop can win
+    std::vector<ThreadPartition> candidates = {
+        {ParallelizationMode::NONE, 1, 1, 1},
+        {ParallelizationMode::PARALLEL_LOOP_HOMSUM, T, 1, T},
+        {ParallelizationMode::GATE_GRAPH, T, 1, T}
+    };
+    for (ParallelizationMode mode : {ParallelizationMode::PARALLEL_LOOP_HOMSUM_BB1_BITWISE, ParallelizationMode::ALL}) {
+        for (int records = T; records >= 1; records /= 2) {
+            candidates.push_back({mode, records, std::max(1, T / records), T});
+        }
+    }
+    return candidates;
+}
+
+int calibrationSampleSize(int numRecords, int num_of_threads, int cap) {
+    const int floor = std::max(8, 2 * std::max(1, num_of_threads));
+    if (cap <= 0) {
+        cap = CALIBRATION_RECORDS_PER_THREAD * std::max(1, num_of_threads);
+    }
+    int sample = std::max(floor, numRecords / CALIBRATION_FRACTION);
+    return std::max(0, std::min({sample, cap, numRecords}));
+}
+
+AutoTuner::AutoTuner(const std::string& cachePath, int calibrationRecords)
+    : cachePath_(cachePath), calibrationRecords_(calibrationRecords) {
+    std::ifstream in(cachePath_);
+    std::string line;
+    for (int number = 1; std::getline(in, line); number++) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string key, mode;
+        ThreadPartition partition;
+        double seconds;
+        if (!(fields >> key >> mode >> partition.recordThreads >> partition.kernelThreads
+                     >> partition.reductionThreads >> seconds)) {
+            throw std::runtime_error("AutoTuner: malformed line " + std::to_string(number) + " in " + cachePath_);
+        }
+        partition.mode = parallelizationModeFromName(mode);
+        cache_[key] = partition;  // later lines win
+    }
+}
+
+bool AutoTuner::lookup(const DatasetShape& shape, ThreadPartition& partition) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = cache_.find(shape.key());
+    if (entry == cache_.end()) {
+        return false;
+    }
+    partition = entry->second;
+    return true;
+}
+
+void AutoTuner::save(const std::string& key, const ThreadPartition& partition, double seconds) {
+    std::ofstream out(cachePath_, std::ios::app);
+    if (!out) {
+        throw std::runtime_error("AutoTuner: cannot write " + cachePath_);
+    }
+    out << key << " " << parallelizationModeName(partition.mode) << " " << partition.recordThreads << " "
+        << partition.kernelThreads << " " << partition.reductionThreads << " " << seconds << "\n";
+}
+
+ThreadPartition AutoTuner::tune(BuildingBlock block, const LweSample* first, const LweSample* second,
+                                const std::vector<std::vector<LweSample*>>& enc_database,
+                                int inputLength, int serviceLength,
+                                const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads) {
+    DatasetShape shape{block, static_cast<int>(enc_database.size()), inputLength, serviceLength, num_of_threads};
+    ThreadPartition best;
+    if (lookup(shape, best)) {
+        return best;
+    }
+
+    // One calibration at a time: concurrent ones would time each other
+    std::lock_guard<std::mutex> calibrating(calibrating_);
+    if (lookup(shape, best)) {
+        return best;
+    }
+
+    int sample = calibrationSampleSize(shape.numRecords, num_of_threads, calibrationRecords_);
+    std::vector<std::vector<LweSample*>> prefix(enc_database.begin(), enc_database.begin() + sample);
+    std::vector<ThreadPartition> candidates = candidatePartitions(num_of_threads);
+
+    auto run = [&](const ThreadPartition& partition) {
+        auto start = std::chrono::steady_clock::now();
+        LweSample* result = HomLocPIRPartitioned(block, first, second, prefix, inputLength, serviceLength, bk, partition);
+        auto end = std::chrono::steady_clock::now();
+        delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    // Warm up the scratch pools and caches, then keep the median of a few runs per candidate,
+    // so one descheduled run cannot pick or drop a split
+    run(candidates[0]);
+    std::vector<std::pair<ThreadPartition, double>> timings;
+    double bestSeconds = std::numeric_limits<double>::infinity();
+    for (const ThreadPartition& candidate : candidates) {
+        std::vector<double> runs;
+        for (int r = 0; r < CALIBRATION_RUNS; r++) {
+            runs.push_back(run(candidate));
+        }
+        std::nth_element(runs.begin(), runs.begin() + runs.size() / 2, runs.end());
+        double seconds = runs[runs.size() / 2];
+        timings.push_back({candidate, seconds});
+        if (seconds < bestSeconds) {
+            bestSeconds = seconds;
+            best = candidate;
+        }
+    }
+
+    save(shape.key(), best, bestSeconds);
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_[shape.key()] = best;
+    lastCalibration_ = std::move(timings);
+    return best;
+}
+
+std::vector<std::pair<ThreadPartition, double>> AutoTuner::lastCalibration() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastCalibration_;
+}
+
+LweSample* HomLocPIRPartitioned(BuildingBlock block, const LweSample* first, const LweSample* second,
+                                const std::vector<std::vector<LweSample*>>& enc_database,
+                                int inputLength, int serviceLength,
+                                const TFheGateBootstrappingCloudKeySet* bk, const ThreadPartition& partition) {
+    switch (block) {
+        case BuildingBlock::BB1:
+            return HomLocPIRbb1OPT(first, second, enc_database, inputLength, serviceLength, bk, partition);
+        case BuildingBlock::BB2:
+            return HomLocPIRbb2OPT(first, second, enc_database, inputLength, serviceLength, bk, partition);
+        case BuildingBlock::BB3:
+            return HomLocPIRbb3OPT(first, enc_database, inputLength, serviceLength, bk, partition);
+    }
+    throw std::invalid_argument("HomLocPIRPartitioned: unknown building block");
+}
@@ -0,0 +1,309 @@
+#include "BootstrappingKeyFile.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// tfhe.h only forward-declares LagrangeHalfCPolynomial, and there is no accessor for its
+// coefficients. Key images store and adopt them in place, which relies on the spqlios
+// implementation (lagrangehalfc_impl.h): N doubles (real then imaginary halves) plus the FFT
+// processor shared by all polynomials of a ring dimension. lagrangeProcessor() checks the
+// linked library against this before any coefficient is touched.
+struct SpqliosLagrangePolynomial {
+    double* coefsC;
+    void* proc;
+};
+
+// The linked library's FFT processor for ring dimension N; throws std::runtime_error if its
+// polynomials are not laid out as above
+void* lagrangeProcessor(int N) {
+    LagrangeHalfCPolynomial* first = new_LagrangeHalfCPolynomial(N);
+    LagrangeHalfCPolynomial* second = new_LagrangeHalfCPolynomial(N);
+    const SpqliosLagrangePolynomial* view = reinterpret_cast<const SpqliosLagrangePolynomial*>(first);
+    void* proc = view->proc;
+
+    // Polynomials share one processor, and clearing through the library zeroes the N doubles behind coefsC
+    bool matches = view->coefsC != nullptr && proc != nullptr &&
+                   reinterpret_cast<const SpqliosLagrangePolynomial*>(second)->proc == proc;
+    if (matches) {
+        std::fill(view->coefsC, view->coefsC + N, 1.);
+        LagrangeHalfCPolynomialClear(first);
+        matches = std::all_of(view->coefsC, view->coefsC + N, [](double c) { return c == 0.; });
+    }
+    delete_LagrangeHalfCPolynomial(second);
+    delete_LagrangeHalfCPolynomial(first);
+
+    if (!matches) {
+        throw std::runtime_error("BootstrappingKeyFile: the linked TFHE does not use the spqlios "
+                                 "LagrangeHalfCPolynomial layout");
+    }
+    return proc;
+}
+
+uint64_t alignUp(uint64_t offset) {
+    return (offset + BK_FILE_ALIGNMENT - 1) / BK_FILE_ALIGNMENT * BK_FILE_ALIGNMENT;
+}
+
+void padTo(std::ofstream& out, uint64_t offset) {
+    static const char zeros[BK_FILE_ALIGNMENT] = {};
+    uint64_t position = static_cast<uint64_t>(out.tellp());
+    out.write(zeros, offset - position);
+}
+
+BootstrappingKeyFileHeader expectedHeader(const TFheGateBootstrappingParameterSet* params) {
+    const TGswParams* tgsw = params->tgsw_params;
+    const TLweParams* tlwe = tgsw->tlwe_params;
+
+    BootstrappingKeyFileHeader header = {};
+    header.magic = BK_FILE_MAGIC;
+    header.version = BK_FILE_VERSION;
+    header.n = params->in_out_params->n;
+    header.N = tlwe->N;
+    header.k = tlwe->k;
+    header.l = tgsw->l;
+    header.Bgbit = tgsw->Bgbit;
+    header.ksLength = params->ks_t;
+    header.ksBasebit = params->ks_basebit;
+    header.ksBase = 1 << params->ks_basebit;
+    header.ksInputDim = tlwe->N * tlwe->k;
+
+    uint64_t polys = static_cast<uint64_t>(header.n) * tgsw->kpl * (header.k + 1);
+    uint64_t samples = static_cast<uint64_t>(header.ksInputDim) * header.ksLength * header.ksBase;
+    header.fftOffset = alignUp(sizeof(BootstrappingKeyFileHeader));
+    header.ksMasksOffset = alignUp(header.fftOffset + polys * header.N * sizeof(double));
+    header.ksBodiesOffset = alignUp(header.ksMasksOffset + samples * header.n * sizeof(Torus32));
+    header.ksVariancesOffset = alignUp(header.ksBodiesOffset + samples * sizeof(Torus32));
+    header.fileBytes = header.ksVariancesOffset + samples * sizeof(double);
+    return header;
+}
+
+bool sameParameters(const BootstrappingKeyFileHeader& a, const BootstrappingKeyFileHeader& b) {
+    return a.n == b.n && a.N == b.N && a.k == b.k && a.l == b.l && a.Bgbit == b.Bgbit &&
+           a.ksLength == b.ksLength && a.ksBasebit == b.ksBasebit && a.ksBase == b.ksBase &&
+           a.ksInputDim == b.ksInputDim && a.fileBytes == b.fileBytes;
+}
+
+// Emit every block of the key image for `bk` as sink(offset, data, bytes), in offset order
+template <typename Sink>
+void emitBootstrappingKey(const TFheGateBootstrappingCloudKeySet* bk, const BootstrappingKeyFileHeader& header,
+                          Sink sink) {
+    const int kpl = bk->params->tgsw_params->kpl;
+    const LweKeySwitchKey* ks = bk->bkFFT->ks;
+    const size_t samples = static_cast<size_t>(ks->n) * ks->t * ks->base;
+    if (ks->n != header.ksInputDim || ks->t != header.ksLength || ks->base != header.ksBase) {
+        throw std::invalid_argument("writeBootstrappingKeyFile: keyswitch key does not match the parameter set");
+    }
+
+    lagrangeProcessor(header.N);
+    sink(0, &header, sizeof(header));
+
+    // FFT-domain bootstrapping key, one TGsw sample per LWE key bit
+    const size_t polyBytes = header.N * sizeof(double);
+    uint64_t offset = header.fftOffset;
+    for (int i = 0; i < header.n; i++) {
+        const TransformedTGswSample& gsw = bk->bkFFT->bkFFT[i];
+        for (int row = 0; row < kpl; row++) {
+            const SpqliosLagrangePolynomial* polys =
+                reinterpret_cast<const SpqliosLagrangePolynomial*>(gsw.all_samples[row].a);
+            for (int q = 0; q <= header.k; q++) {
+                sink(offset, polys[q].coefsC, polyBytes);
+                offset += polyBytes;
+            }
+        }
+    }
+
+    // Keyswitch key: masks, then bodies and variances
+    for (size_t s = 0; s < samples; s++) {
+        sink(header.ksMasksOffset + s * header.n * sizeof(Torus32), ks->ks0_raw[s].a, header.n * sizeof(Torus32));
+    }
+    for (size_t s = 0; s < samples; s++) {
+        sink(header.ksBodiesOffset + s * sizeof(Torus32), &ks->ks0_raw[s].b, sizeof(Torus32));
+    }
+    for (size_t s = 0; s < samples; s++) {
+        sink(header.ksVariancesOffset + s * sizeof(double), &ks->ks0_raw[s].current_variance, sizeof(double));
+    }
+}
+
+} // namespace
+
+void writeBootstrappingKeyFile(const std::string& path, const TFheGateBootstrappingCloudKeySet* bk) {
+    const BootstrappingKeyFileHeader header = expectedHeader(bk->params);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("writeBootstrappingKeyFile: cannot open " + path);
+    }
+    emitBootstrappingKey(bk, header, [&](uint64_t offset, const void* data, size_t bytes) {
+        padTo(out, offset);
+        out.write(static_cast<const char*>(data), bytes);
+    });
+
+    if (!out) {
+        throw std::runtime_error("writeBootstrappingKeyFile: write failed for " + path);
+    }
+}
+
+size_t bootstrappingKeyImageBytes(const TFheGateBootstrappingParameterSet* params) {
+    return expectedHeader(params).fileBytes;
+}
+
+void writeBootstrappingKeyImage(void* image, const TFheGateBootstrappingCloudKeySet* bk) {
+    const BootstrappingKeyFileHeader header = expectedHeader(bk->params);
+    char* base = static_cast<char*>(image);
+    emitBootstrappingKey(bk, header, [&](uint64_t offset, const void* data, size_t bytes) {
+        std::memcpy(base + offset, data, bytes);
+    });
+}
+
+MappedCloudKey::MappedCloudKey(const std::string& path, const TFheGateBootstrappingParameterSet* params) {
+    const BootstrappingKeyFileHeader expected = expectedHeader(params);
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("MappedCloudKey: cannot open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) != expected.fileBytes) {
+        close(fd);
+        throw std::runtime_error("MappedCloudKey: size does not match the parameter set: " + path);
+    }
+
+    // MAP_POPULATE prefaults the whole key, so the first bootstrapping does not stall on I/O
+    mappingBytes_ = info.st_size;
+    mapping_ = mmap(nullptr, mappingBytes_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        throw std::runtime_error("MappedCloudKey: mmap failed for " + path);
+    }
+    madvise(mapping_, mappingBytes_, MADV_WILLNEED);
+    adopt(params, path);
+}
+
+MappedCloudKey::MappedCloudKey(void* image, size_t bytes, const TFheGateBootstrappingParameterSet* params)
+    : mapping_(image), mappingBytes_(bytes) {
+    if (bytes < bootstrappingKeyImageBytes(params)) {
+        release();
+        throw std::runtime_error("MappedCloudKey: image too small for the parameter set");
+    }
+    adopt(params, "key image");
+}
+
+void MappedCloudKey::adopt(const TFheGateBootstrappingParameterSet* params, const std::string& source) {
+    const BootstrappingKeyFileHeader expected = expectedHeader(params);
+    char* base = static_cast<char*>(mapping_);
+    const BootstrappingKeyFileHeader* header = reinterpret_cast<const BootstrappingKeyFileHeader*>(base);
+    if (header->magic != BK_FILE_MAGIC || header->version != BK_FILE_VERSION || !sameParameters(*header, expected)) {
+        release();
+        throw std::runtime_error("MappedCloudKey: bad header or parameter set mismatch: " + source);
+    }
+
+    const TGswParams* tgsw = params->tgsw_params;
+    const TLweParams* tlwe = tgsw->tlwe_params;
+    const int n = header->n, N = header->N, k = header->k, kpl = tgsw->kpl;
+
+    // Every polynomial shares the library's FFT processor
+    void* proc = lagrangeProcessor(N);
+
+    // Bootstrapping key skeleton, built with the library constructors; coefficients stay in the mapping
+    double* coefficients = reinterpret_cast<double*>(base + header->fftOffset);
+    TransformedTGswSample* gsw = static_cast<TransformedTGswSample*>(std::malloc(sizeof(TransformedTGswSample) * n));
+    for (int i = 0; i < n; i++) {
+        TLweSampleFFT* rows = static_cast<TLweSampleFFT*>(std::malloc(sizeof(TLweSampleFFT) * kpl));
+        for (int row = 0; row < kpl; row++) {
+            SpqliosLagrangePolynomial* polys =
+                static_cast<SpqliosLagrangePolynomial*>(std::malloc(sizeof(SpqliosLagrangePolynomial) * (k + 1)));
+            for (int q = 0; q <= k; q++) {
+                polys[q].coefsC = coefficients + ((static_cast<size_t>(i) * kpl + row) * (k + 1) + q) * N;
+                polys[q].proc = proc;
+            }
+            new (&rows[row]) TLweSampleFFT(tlwe, reinterpret_cast<LagrangeHalfCPolynomial*>(polys), 0.);
+        }
+        new (&gsw[i]) TransformedTGswSample(tgsw, rows);
+    }
+
+    // Keyswitch key: masks in the mapping, bodies and variances copied next to them
+    const size_t samples = static_cast<size_t>(header->ksInputDim) * header->ksLength * header->ksBase;
+    Torus32* masks = reinterpret_cast<Torus32*>(base + header->ksMasksOffset);
+    const Torus32* bodies = reinterpret_cast<const Torus32*>(base + header->ksBodiesOffset);
+    const double* variances = reinterpret_cast<const double*>(base + header->ksVariancesOffset);
+    LweSample* raw = static_cast<LweSample*>(std::malloc(sizeof(LweSample) * samples));
+    for (size_t s = 0; s < samples; s++) {
+        raw[s].a = masks + s * n;
+        raw[s].b = bodies[s];
+        raw[s].current_variance = variances[s];
+    }
+    LweKeySwitchKey* ks = new LweKeySwitchKey(header->ksInputDim, header->ksLength, header->ksBasebit,
+                                              params->in_out_params, raw);
+
+    LweBootstrappingKeyFFT* bkFFT = new LweBootstrappingKeyFFT(params->in_out_params, tgsw, tlwe,
+                                                               &tlwe->extracted_lweparams, gsw, ks);
+    cloud_ = new TFheGateBootstrappingCloudKeySet(params, nullptr, bkFFT);
+}
+
+MappedCloudKey::~MappedCloudKey() {
+    release();
+}
+
+MappedCloudKey::MappedCloudKey(MappedCloudKey&& other) noexcept
+    : mapping_(other.mapping_), mappingBytes_(other.mappingBytes_), cloud_(other.cloud_) {
+    other.mapping_ = nullptr;
+    other.mappingBytes_ = 0;
+    other.cloud_ = nullptr;
+}
+
+MappedCloudKey& MappedCloudKey::operator=(MappedCloudKey&& other) noexcept {
+    if (this != &other) {
+        release();
+        mapping_ = other.mapping_;
+        mappingBytes_ = other.mappingBytes_;
+        cloud_ = other.cloud_;
+        other.mapping_ = nullptr;
+        other.mappingBytes_ = 0;
+        other.cloud_ = nullptr;
+    }
+    return *this;
+}
+
+void MappedCloudKey::release() {
+    // Only the skeleton is ours to free; coefficients and masks belong to the mapping
+    if (cloud_ != nullptr) {
+        const LweBootstrappingKeyFFT* bkFFT = cloud_->bkFFT;
+        const int n = bkFFT->in_out_params->n;
+        const int kpl = bkFFT->bk_params->kpl;
+        TransformedTGswSample* gsw = const_cast<TransformedTGswSample*>(bkFFT->bkFFT);
+        for (int i = 0; i < n; i++) {
+            TLweSampleFFT* rows = gsw[i].all_samples;
+            for (int row = 0; row < kpl; row++) {
+                void* polys = rows[row].a;
+                rows[row].~TLweSampleFFT();
+                std::free(polys);
+            }
+            gsw[i].~TransformedTGswSample();
+            std::free(rows);
+        }
+        std::free(gsw);
+
+        // The keyswitch destructor frees its index tables, not ks0_raw
+        const LweKeySwitchKey* ks = bkFFT->ks;
+        LweSample* raw = ks->ks0_raw;
+        delete ks;
+        std::free(raw);
+        delete bkFFT;
+        delete cloud_;
+        cloud_ = nullptr;
+    }
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mappingBytes_);
+        mapping_ = nullptr;
+        mappingBytes_ = 0;
+    }
+}
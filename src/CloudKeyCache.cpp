@@ -0,0 +1,155 @@
+#include "CloudKeyCache.h"
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <stdlib.h>
+#include <unistd.h>
+
+CloudKeyCache::CloudKeyCache(const std::string& directory, const TFheGateBootstrappingParameterSet* params,
+                             size_t capacity)
+    : directory_(directory), params_(params), capacity_(capacity) {
+    if (capacity_ == 0) {
+        throw std::invalid_argument("CloudKeyCache: capacity must be at least 1");
+    }
+    std::filesystem::create_directories(directory_);
+}
+
+std::string CloudKeyCache::keyPath(const std::string& keyId) const {
+    // Key IDs become file names, so keep them to a safe alphabet
+    if (keyId.empty()) {
+        throw std::invalid_argument("CloudKeyCache: empty key ID");
+    }
+    for (char c : keyId) {
+        bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+        if (!safe) {
+            throw std::invalid_argument("CloudKeyCache: invalid key ID: " + keyId);
+        }
+    }
+    return directory_ + "/" + keyId + ".bk";
+}
+
+void CloudKeyCache::registerKey(const std::string& keyId, const TFheGateBootstrappingCloudKeySet* bk) {
+    std::string path = keyPath(keyId);
+
+    // Write to a unique temporary name in the same directory and rename, so a concurrent miss
+    // never maps a partial file and concurrent uploads of one ID never share a staging file
+    std::string staging = path + ".XXXXXX";
+    int fd = mkstemp(&staging[0]);
+    if (fd < 0) {
+        throw std::runtime_error("CloudKeyCache: cannot create a staging file for " + keyId);
+    }
+    close(fd);
+    try {
+        writeBootstrappingKeyFile(staging, bk);
+    } catch (...) {
+        std::remove(staging.c_str());
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::filesystem::rename(staging, path);
+    evictLocked(keyId);  // a stale mapping of the previous key must not be served
+    loading_.erase(keyId);
+}
+
+std::shared_ptr<const MappedCloudKey> CloudKeyCache::acquire(const std::string& keyId) {
+    std::string path = keyPath(keyId);
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto found = resident_.find(keyId);
+    if (found != resident_.end()) {
+        hits_++;
+        lru_.splice(lru_.begin(), lru_, found->second.position);
+        return found->second.key;
+    }
+
+    misses_++;
+    auto inFlight = loading_.find(keyId);
+    if (inFlight != loading_.end()) {
+        // Another thread is already mapping this key
+        std::shared_future<std::shared_ptr<const MappedCloudKey>> pending = inFlight->second.key;
+        lock.unlock();
+        return pending.get();
+    }
+
+    std::promise<std::shared_ptr<const MappedCloudKey>> promise;
+    const uint64_t ticket = nextTicket_++;
+    loading_[keyId] = Load{promise.get_future().share(), ticket};
+    lock.unlock();
+
+    // Map and prefault outside the lock, so hits on other keys never wait on the disk
+    std::shared_ptr<const MappedCloudKey> key;
+    try {
+        if (!std::filesystem::exists(path)) {
+            throw std::runtime_error("CloudKeyCache: no key registered for " + keyId);
+        }
+        key = std::make_shared<const MappedCloudKey>(path, params_);
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+        lock.lock();
+        auto current = loading_.find(keyId);
+        if (current != loading_.end() && current->second.ticket == ticket) {
+            loading_.erase(current);
+        }
+        throw;
+    }
+    promise.set_value(key);
+
+    lock.lock();
+    auto current = loading_.find(keyId);
+    if (current == loading_.end() || current->second.ticket != ticket) {
+        // Re-registered or removed meanwhile: serve this caller, but do not cache a stale key
+        return key;
+    }
+    loading_.erase(current);
+    if (resident_.size() >= capacity_) {
+        evictLocked(lru_.back());
+        evictions_++;
+    }
+    lru_.push_front(keyId);
+    resident_[keyId] = Entry{key, lru_.begin()};
+    return key;
+}
+
+void CloudKeyCache::removeKey(const std::string& keyId) {
+    std::string path = keyPath(keyId);
+    std::lock_guard<std::mutex> lock(mutex_);
+    evictLocked(keyId);
+    loading_.erase(keyId);
+    std::remove(path.c_str());
+}
+
+void CloudKeyCache::evictLocked(const std::string& keyId) {
+    auto found = resident_.find(keyId);
+    if (found == resident_.end()) {
+        return;
+    }
+    // In-flight queries still hold their shared_ptr; the mapping goes away with the last one
+    lru_.erase(found->second.position);
+    resident_.erase(found);
+}
+
+bool CloudKeyCache::isResident(const std::string& keyId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resident_.count(keyId) != 0;
+}
+
+size_t CloudKeyCache::residentKeys() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resident_.size();
+}
+
+size_t CloudKeyCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+size_t CloudKeyCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+size_t CloudKeyCache::evictions() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return evictions_;
+}
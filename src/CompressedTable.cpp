@@ -0,0 +1,116 @@
+#include "CompressedTable.h"
+#include "utils.h"
+#include <stdexcept>
+
+CompressedTable::CompressedTable(const TableSchema& schema, int numRecords,
+                                 const TFheGateBootstrappingParameterSet* params, const MaskSeed& seed)
+    : schema_(schema), numRecords_(numRecords), params_(params), seed_(seed) {
+    bodies_.reserve(schema_.size());
+    for (const ColumnSpec& spec : schema_) {
+        bodies_.emplace_back(static_cast<size_t>(numRecords_) * spec.bits, 0);
+    }
+}
+
+uint64_t CompressedTable::streamId(int record, int column, int bit) const {
+    uint64_t sample = static_cast<uint64_t>(record) * schema_[column].bits + bit;
+    return (static_cast<uint64_t>(column) << 48) | sample;
+}
+
+void CompressedTable::encryptCell(int record, int column, int32_t plaintext,
+                                  const TFheGateBootstrappingSecretKeySet* key, std::mt19937_64& noise) {
+    int bits = schema_[column].bits;
+    for (int j = 0; j < bits; j++) {
+        bodies_[column][static_cast<size_t>(record) * bits + j] =
+            seededSymEncrypt((plaintext >> j) & 1, seed_, streamId(record, column, j), key, noise);
+    }
+}
+
+void CompressedTable::encryptCellBits(int record, int column, const std::string& binaryString,
+                                      const TFheGateBootstrappingSecretKeySet* key, std::mt19937_64& noise) {
+    int bits = schema_[column].bits;
+    if (static_cast<int>(binaryString.length()) != bits) {
+        throw std::invalid_argument("encryptCellBits: binary string does not match the column width");
+    }
+    for (int j = 0; j < bits; j++) {
+        bodies_[column][static_cast<size_t>(record) * bits + j] =
+            seededSymEncrypt(binaryString[j] - '0', seed_, streamId(record, column, j), key, noise);
+    }
+}
+
+void CompressedTable::expandRecord(int record, int slot, EncryptedTable& block) const {
+    for (int c = 0; c < static_cast<int>(schema_.size()); c++) {
+        int bits = schema_[c].bits;
+        LweSample* cell = block.mutableCell(slot, c);
+        for (int j = 0; j < bits; j++) {
+            expandSample(&cell[j], bodies_[c][static_cast<size_t>(record) * bits + j],
+                         seed_, streamId(record, c, j), params_);
+        }
+    }
+}
+
+int CompressedTable::recordsPerBlock(size_t cacheBytes) const {
+    size_t recordBytes = 0;
+    for (const ColumnSpec& spec : schema_) {
+        recordBytes += static_cast<size_t>(spec.bits) * (params_->in_out_params->n * sizeof(Torus32) + sizeof(LweSample));
+    }
+    size_t records = cacheBytes / recordBytes;
+    return records == 0 ? 1 : static_cast<int>(records);
+}
+
+size_t CompressedTable::sizeInBytes() const {
+    size_t total = sizeof(MaskSeed);
+    for (const std::vector<Torus32>& bodies : bodies_) {
+        total += bodies.size() * sizeof(Torus32);
+    }
+    return total;
+}
+
+CompressedTable encryptCompressedTable(const std::vector<std::vector<int32_t>>& encodedDB,
+                                       int inputLength, int serviceLength,
+                                       const TFheGateBootstrappingParameterSet* params,
+                                       const TFheGateBootstrappingSecretKeySet* key,
+                                       const MaskSeed& seed) {
+    CompressedTable table(schemaBB1(inputLength, serviceLength), encodedDB.size(), params, seed);
+    std::mt19937_64 noise = randomNoise();  // secret, unlike the public mask seed
+
+    for (size_t i = 0; i < encodedDB.size(); ++i) {
+        for (size_t c = 0; c < encodedDB[i].size(); ++c) {
+            table.encryptCell(i, c, encodedDB[i][c], key, noise);
+        }
+    }
+
+    return table;
+}
+
+CompressedTable encryptCompressedTableBB2(const std::vector<std::vector<std::string>>& data,
+                                          int inputLength, int serviceLength,
+                                          const TFheGateBootstrappingParameterSet* params,
+                                          const TFheGateBootstrappingSecretKeySet* key,
+                                          const MaskSeed& seed) {
+    CompressedTable table(schemaBB2(inputLength, serviceLength), data.size(), params, seed);
+    std::mt19937_64 noise = randomNoise();
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        table.encryptCell(i, 0, encodeDouble(inputLength, std::stod(data[i][0])), key, noise);
+        table.encryptCell(i, 1, encodeDouble(inputLength, std::stod(data[i][1])), key, noise);
+        table.encryptCellBits(i, 2, textToBinaryString(data[i][2], serviceLength), key, noise);
+    }
+
+    return table;
+}
+
+CompressedTable encryptCompressedTableBB3(const std::vector<std::vector<std::string>>& data,
+                                          int inputLength, int serviceLength,
+                                          const TFheGateBootstrappingParameterSet* params,
+                                          const TFheGateBootstrappingSecretKeySet* key,
+                                          const MaskSeed& seed) {
+    CompressedTable table(schemaBB3(inputLength, serviceLength), data.size(), params, seed);
+    std::mt19937_64 noise = randomNoise();
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        table.encryptCell(i, 0, static_cast<int32_t>(i), key, noise);
+        table.encryptCellBits(i, 1, textToBinaryString(data[i][1], serviceLength), key, noise);
+    }
+
+    return table;
+}
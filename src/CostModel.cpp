@@ -0,0 +1,298 @@
+#include "CostModel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include "GateCircuit.h"
+
+namespace {
+
+int ceilLog2(int value) {
+    int levels = 0;
+    while ((1 << levels) < value) {
+        levels++;
+    }
+    return levels;
+}
+
+std::string planName(const ThreadPartition& partition) {
+    std::string name = parallelizationModeName(partition.mode);
+    switch (partition.mode) {
+        case ParallelizationMode::NONE:
+            return name;
+        case ParallelizationMode::PARALLEL_LOOP_HOMSUM:
+            return name + " r" + std::to_string(partition.recordThreads);
+        case ParallelizationMode::GATE_GRAPH:
+            return name + " t" + std::to_string(partition.reductionThreads);
+        default:
+            return name + " r" + std::to_string(partition.recordThreads) + " k" + std::to_string(partition.kernelThreads);
+    }
+}
+
+// One record: its building block and its service AND
+struct RecordCost {
+    GateCount work;
+    GateCount path;
+};
+
+// As the kernels of `mode` evaluate it. NONE and PARALLEL_LOOP_HOMSUM run the serial
+// kernels; PARALLEL_LOOP_HOMSUM_BB1_BITWISE runs the sub-checks side by side, each serial;
+// ALL (and the gate graph) also splits the XNORs and reduces equality by an AND tree.
+RecordCost recordCost(BuildingBlock block, int n, int serviceLength, ParallelizationMode mode) {
+    const bool nested = (mode == ParallelizationMode::ALL || mode == ParallelizationMode::GATE_GRAPH);
+    const bool sections = nested || mode == ParallelizationMode::PARALLEL_LOOP_HOMSUM_BB1_BITWISE;
+    const double tree = ceilLog2(n);
+
+    RecordCost cost;
+    switch (block) {
+        case BuildingBlock::BB1:
+            // Four comparisons of n gates and n MUXes each, then three ANDs
+            cost.work = {4.0 * n + 3, 4.0 * n};
+            cost.path = nested ? GateCount{1 + 2, 1.0 * n} : sections ? GateCount{n + 2.0, 1.0 * n} : cost.work;
+            break;
+        case BuildingBlock::BB2:
+            // Two equality checks (XNOR and AND per bit, 2n - 1 as a tree), then one AND
+            cost.work = nested ? GateCount{2 * (2.0 * n - 1) + 1, 0} : GateCount{4.0 * n + 1, 0};
+            cost.path = nested ? GateCount{1 + tree + 1, 0} : sections ? GateCount{2.0 * n + 1, 0} : cost.work;
+            break;
+        case BuildingBlock::BB3:
+            cost.work = nested ? GateCount{2.0 * n - 1, 0} : GateCount{2.0 * n, 0};
+            cost.path = nested ? GateCount{1 + tree, 0} : cost.work;
+            break;
+    }
+
+    // Service AND: split across the kernel threads unless the kernels are serial
+    cost.work = cost.work + GateCount{1.0 * serviceLength, 0};
+    cost.path = cost.path + (sections ? GateCount{1, 0} : GateCount{1.0 * serviceLength, 0});
+    return cost;
+}
+
+class SerialLoopModel : public PlanModel {
+public:
+    std::vector<PlanEstimate> estimate(const DatasetShape& shape, const GateCosts& costs) const override {
+        PlanEstimate plan;
+        plan.partition = {ParallelizationMode::NONE, 1, 1, 1};
+        plan.name = planName(plan.partition);
+        plan.work = queryGates(shape);
+        plan.criticalPath = plan.work;
+        plan.seconds = plan.work.seconds(costs);
+        return {plan};
+    }
+};
+
+class RecordLoopModel : public PlanModel {
+public:
+    std::vector<PlanEstimate> estimate(const DatasetShape& shape, const GateCosts& costs) const override {
+        const int M = std::max(1, shape.numRecords);
+        const int T = std::max(1, shape.numThreads);
+        const GateCount reduction{static_cast<double>(M - 1) * shape.serviceLength, 0};
+        const GateCount reductionPath{static_cast<double>(ceilLog2(M)), 0};
+
+        std::vector<PlanEstimate> plans;
+        for (const ThreadPartition& partition : candidatePartitions(T)) {
+            if (partition.mode == ParallelizationMode::NONE || partition.mode == ParallelizationMode::GATE_GRAPH) {
+                continue;
+            }
+            RecordCost record = recordCost(shape.block, shape.inputLength, shape.serviceLength, partition.mode);
+            const int records = std::min(partition.recordThreads, M);
+            const int kernel = (partition.mode == ParallelizationMode::PARALLEL_LOOP_HOMSUM) ? 1 : partition.kernelThreads;
+
+            // Rounds of `records` records side by side; more threads than cores share them
+            double perRecord = scheduledSeconds(record.work.seconds(costs), record.path.seconds(costs), kernel);
+            double oversubscription = std::max(1.0, static_cast<double>(records) * kernel / T);
+            double rounds = std::ceil(static_cast<double>(M) / records);
+
+            PlanEstimate plan;
+            plan.partition = partition;
+            plan.name = planName(partition);
+            plan.work = record.work * M + reduction;
+            plan.criticalPath = record.path + reductionPath;
+            plan.seconds = rounds * perRecord * oversubscription +
+                           scheduledSeconds(reduction.seconds(costs), reductionPath.seconds(costs),
+                                            partition.reductionThreads);
+            plans.push_back(plan);
+        }
+        return plans;
+    }
+};
+
+class GateGraphModel : public PlanModel {
+public:
+    std::vector<PlanEstimate> estimate(const DatasetShape& shape, const GateCosts& costs) const override {
+        const int M = std::max(1, shape.numRecords);
+        const int T = std::max(1, shape.numThreads);
+        if (T == 1) {
+            return {};  // the serial loop, with scheduling overhead on top
+        }
+        RecordCost record = recordCost(shape.block, shape.inputLength, shape.serviceLength,
+                                       ParallelizationMode::GATE_GRAPH);
+
+        // HomLocPIRGraph runs one DAG per chunk of GRAPH_RECORDS_PER_THREAD records per thread,
+        // with a barrier between chunks; each later chunk also folds in the sum so far
+        const int chunk = GRAPH_RECORDS_PER_THREAD * T;
+        PlanEstimate plan;
+        plan.partition = {ParallelizationMode::GATE_GRAPH, T, 1, T};
+        plan.name = planName(plan.partition);
+        plan.seconds = 0;
+        for (int start = 0; start < M; start += chunk) {
+            const int records = std::min(chunk, M - start);
+            const int leaves = records + (start > 0 ? 1 : 0);
+            GateCount work = record.work * records + GateCount{static_cast<double>(leaves - 1) * shape.serviceLength, 0};
+            GateCount path = record.path + GateCount{static_cast<double>(ceilLog2(leaves)), 0};
+            plan.work = plan.work + work;
+            plan.criticalPath = plan.criticalPath + path;
+            plan.seconds += scheduledSeconds(work.seconds(costs), path.seconds(costs), T);
+        }
+        return {plan};
+    }
+};
+
+} // namespace
+
+GateCosts calibrateGateCosts(const TFheGateBootstrappingCloudKeySet* bk, int samples) {
+    LweSample* bits = new_gate_bootstrapping_ciphertext_array(4, bk->params);
+    bootsCONSTANT(&bits[0], 1, bk);
+    bootsCONSTANT(&bits[1], 0, bk);
+    bootsCONSTANT(&bits[2], 1, bk);
+
+    auto time = [&](auto gate) {
+        gate();  // warm-up: FFT tables, scratch allocations
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int s = 0; s < samples; s++) {
+            gate();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return elapsed.count() / std::max(1, samples);
+    };
+    GateCosts costs;
+    costs.gateSeconds = time([&] { bootsAND(&bits[3], &bits[0], &bits[1], bk); });
+    costs.muxSeconds = time([&] { bootsMUX(&bits[3], &bits[0], &bits[1], &bits[2], bk); });
+
+    delete_gate_bootstrapping_ciphertext_array(4, bits);
+    return costs;
+}
+
+GateCount operator+(const GateCount& a, const GateCount& b) {
+    return {a.gates + b.gates, a.muxes + b.muxes};
+}
+
+GateCount operator*(const GateCount& a, double factor) {
+    return {a.gates * factor, a.muxes * factor};
+}
+
+GateCount queryGates(const DatasetShape& shape) {
+    RecordCost record = recordCost(shape.block, shape.inputLength, shape.serviceLength, ParallelizationMode::NONE);
+    // HomSum XORs every record into a zero constant
+    return record.work * shape.numRecords + GateCount{static_cast<double>(shape.numRecords) * shape.serviceLength, 0};
+}
+
+double scheduledSeconds(double work, double path, double threads) {
+    threads = std::max(1.0, threads);
+    return work / threads + path * (1.0 - 1.0 / threads);
+}
+
+std::unique_ptr<PlanModel> serialLoopModel() {
+    return std::unique_ptr<PlanModel>(new SerialLoopModel());
+}
+
+std::unique_ptr<PlanModel> recordLoopModel() {
+    return std::unique_ptr<PlanModel>(new RecordLoopModel());
+}
+
+std::unique_ptr<PlanModel> gateGraphModel() {
+    return std::unique_ptr<PlanModel>(new GateGraphModel());
+}
+
+StrategyPlanner::StrategyPlanner(const GateCosts& costs) : costs_(costs) {
+    if (costs.gateSeconds <= 0 || costs.muxSeconds <= 0) {
+        throw std::invalid_argument("StrategyPlanner: gate costs must be positive");
+    }
+    addModel(serialLoopModel());
+    addModel(recordLoopModel());
+    addModel(gateGraphModel());
+}
+
+void StrategyPlanner::addModel(std::unique_ptr<PlanModel> model) {
+    models_.push_back(std::move(model));
+}
+
+std::vector<PlanEstimate> StrategyPlanner::estimates(const DatasetShape& shape) const {
+    std::vector<PlanEstimate> plans;
+    for (const std::unique_ptr<PlanModel>& model : models_) {
+        for (PlanEstimate& plan : model->estimate(shape, costs_)) {
+            plans.push_back(std::move(plan));
+        }
+    }
+    std::stable_sort(plans.begin(), plans.end(),
+                     [](const PlanEstimate& a, const PlanEstimate& b) { return a.seconds < b.seconds; });
+    return plans;
+}
+
+PlanEstimate StrategyPlanner::best(const DatasetShape& shape) const {
+    std::vector<PlanEstimate> plans = estimates(shape);
+    if (plans.empty()) {
+        throw std::runtime_error("StrategyPlanner: no model has a plan for " + shape.key());
+    }
+    return plans.front();
+}
+
+std::vector<SlaRow> StrategyPlanner::slaReport(const DatasetShape& shape, double slaSeconds, int maxThreads) const {
+    std::vector<SlaRow> rows;
+    for (int threads = 1; threads <= std::max(1, maxThreads); threads *= 2) {
+        DatasetShape sized = shape;
+        sized.numThreads = threads;
+
+        SlaRow row;
+        row.threads = threads;
+        row.best = best(sized);
+        row.meetsSla = row.best.seconds <= slaSeconds;
+
+        // Largest table within the SLA: double until it misses, then bisect
+        auto fits = [&](int records) {
+            sized.numRecords = records;
+            return best(sized).seconds <= slaSeconds;
+        };
+        int low = 0, high = 1;
+        while (high < (1 << 30) && fits(high)) {
+            low = high;
+            high *= 2;
+        }
+        while (high - low > 1) {
+            int middle = low + (high - low) / 2;
+            (fits(middle) ? low : high) = middle;
+        }
+        row.maxRecords = low;
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+int StrategyPlanner::threadsForSla(const DatasetShape& shape, double slaSeconds, int maxThreads) const {
+    for (const SlaRow& row : slaReport(shape, slaSeconds, maxThreads)) {
+        if (row.meetsSla) {
+            return row.threads;
+        }
+    }
+    return 0;
+}
+
+void StrategyPlanner::writeSlaReport(std::ostream& out, const DatasetShape& shape, double slaSeconds,
+                                     int maxThreads) const {
+    out << "threads,plan,predicted_s,meets_sla,max_records\n";
+    for (const SlaRow& row : slaReport(shape, slaSeconds, maxThreads)) {
+        out << row.threads << "," << row.best.name << "," << row.best.seconds << ","
+            << (row.meetsSla ? "yes" : "no") << "," << row.maxRecords << "\n";
+    }
+}
+
+LweSample* HomLocPIRPlanned(const StrategyPlanner& planner, BuildingBlock block,
+                            const LweSample* first, const LweSample* second,
+                            const std::vector<std::vector<LweSample*>>& enc_database,
+                            int inputLength, int serviceLength,
+                            const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads) {
+    DatasetShape shape{block, static_cast<int>(enc_database.size()), inputLength, serviceLength, num_of_threads};
+    return HomLocPIRPartitioned(block, first, second, enc_database, inputLength, serviceLength, bk,
+                                planner.best(shape).partition);
+}
@@ -0,0 +1,386 @@
+#include "CsvIngest.h"
+#include "ParallelEncryption.h"
+#include "TableFile.h"
+#include "utils.h"
+#include <charconv>
+#include <climits>
+#include <memory>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Consumed input is handed back to the page cache in chunks of this size
+const size_t RELEASE_CHUNK = size_t(16) << 20;
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Drop [from, to) of a file mapping from the resident set; whole pages only
+void dropPages(const char* base, size_t from, size_t to) {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    from = (from + page - 1) / page * page;
+    to = to / page * page;
+    if (to > from) {
+        madvise(const_cast<char*>(base) + from, to - from, MADV_DONTNEED);
+    }
+}
+
+void integerBits(int64_t value, int32_t* bits, int length) {
+    for (int j = 0; j < length; j++) {
+        bits[j] = (value >> j) & 1;
+    }
+}
+
+// textToBinaryString without the intermediate string: 8 bits per character, MSB first,
+// the first `length` bits of a long text, left-padded with zeros for a short one
+void textBits(std::string_view text, int32_t* bits, int length) {
+    const int64_t total = static_cast<int64_t>(text.size()) * 8;
+    const int64_t padding = total < length ? length - total : 0;
+    for (int j = 0; j < length; j++) {
+        if (j < padding) {
+            bits[j] = 0;
+        } else {
+            int64_t k = j - padding;
+            bits[j] = (static_cast<unsigned char>(text[k / 8]) >> (7 - k % 8)) & 1;
+        }
+    }
+}
+
+[[noreturn]] void fail(const CsvReader& reader, const std::string& reason) {
+    throw std::runtime_error(reader.path() + ":" + std::to_string(reader.line()) + ": " + reason);
+}
+
+template <typename T>
+T parseNumber(const CsvReader& reader, std::string_view field) {
+    if (!field.empty() && field[0] == '+') {
+        field.remove_prefix(1);
+    }
+    T value = T();
+    std::from_chars_result parsed = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (field.empty() || parsed.ec != std::errc() || parsed.ptr != field.data() + field.size()) {
+        fail(reader, "not a number: \"" + std::string(field) + "\"");
+    }
+    return value;
+}
+
+} // namespace
+
+CsvReader::CsvReader(const std::string& path, char delimiter, bool header)
+    : path_(path), delimiter_(delimiter) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("CsvReader: cannot open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("CsvReader: cannot stat " + path);
+    }
+
+    size_ = info.st_size;
+    if (size_ > 0) {
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("CsvReader: mmap failed for " + path);
+        }
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapping);
+    }
+    close(fd);  // the mapping keeps the file referenced
+
+    if (header) {
+        std::vector<std::string_view> fields;
+        next(fields);
+        recordsRead_ = 0;
+    }
+}
+
+CsvReader::~CsvReader() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+void CsvReader::releaseConsumed() {
+    if (position_ - released_ >= RELEASE_CHUNK) {
+        dropPages(data_, released_, position_);
+        released_ = position_;
+    }
+}
+
+bool CsvReader::next(std::vector<std::string_view>& fields) {
+    // Views of the previous record are given up here, so its pages may go
+    releaseConsumed();
+    unescaped_.clear();
+    fields.clear();
+
+    // Skip blank lines
+    size_t p = position_;
+    while (p < size_) {
+        size_t q = p;
+        while (q < size_ && data_[q] != '\n' && isBlank(data_[q])) {
+            q++;
+        }
+        if (q < size_ && data_[q] != '\n') {
+            break;
+        }
+        p = q + 1;
+        nextLine_++;
+    }
+    if (p >= size_) {
+        position_ = size_;
+        return false;
+    }
+    line_ = nextLine_;
+
+    for (;;) {
+        while (p < size_ && (data_[p] == ' ' || data_[p] == '\t')) {
+            p++;
+        }
+
+        std::string_view field;
+        if (p < size_ && data_[p] == '"') {
+            size_t start = ++p;
+            bool escaped = false;
+            for (;;) {
+                if (p >= size_) {
+                    fail(*this, "unterminated quoted field");
+                }
+                if (data_[p] == '"') {
+                    if (p + 1 < size_ && data_[p + 1] == '"') {
+                        escaped = true;
+                        p += 2;
+                        continue;
+                    }
+                    break;
+                }
+                if (data_[p] == '\n') {
+                    nextLine_++;
+                }
+                p++;
+            }
+            field = std::string_view(data_ + start, p - start);
+            p++;  // closing quote
+
+            // Only a quote pair needs a copy; every other field is a view of the mapping
+            if (escaped) {
+                std::string text;
+                text.reserve(field.size());
+                for (size_t k = 0; k < field.size(); k++) {
+                    text.push_back(field[k]);
+                    if (field[k] == '"') {
+                        k++;
+                    }
+                }
+                unescaped_.push_back(std::move(text));
+                field = unescaped_.back();
+            }
+
+            while (p < size_ && isBlank(data_[p])) {
+                p++;
+            }
+            if (p < size_ && data_[p] != delimiter_ && data_[p] != '\n') {
+                fail(*this, "unexpected character after a quoted field");
+            }
+        } else {
+            size_t start = p;
+            while (p < size_ && data_[p] != delimiter_ && data_[p] != '\n') {
+                p++;
+            }
+            size_t end = p;
+            while (end > start && isBlank(data_[end - 1])) {
+                end--;
+            }
+            field = std::string_view(data_ + start, end - start);
+        }
+        fields.push_back(field);
+
+        if (p < size_ && data_[p] == delimiter_) {
+            p++;
+            continue;
+        }
+        if (p < size_) {
+            p++;  // '\n'
+            nextLine_++;
+        }
+        break;
+    }
+
+    position_ = p;
+    recordsRead_++;
+    return true;
+}
+
+int64_t CsvReader::countRemaining() {
+    int64_t count = 0;
+    bool content = false;     // the current record has a non-blank character
+    bool fieldStart = true;   // only whitespace since the last delimiter or line break
+    size_t dropped = position_;
+    for (size_t p = position_; p < size_; p++) {
+        char c = data_[p];
+        if (c == '"' && fieldStart) {
+            // Skip the quoted field, which may span lines
+            for (p++; p < size_; p++) {
+                if (data_[p] == '"') {
+                    if (p + 1 < size_ && data_[p + 1] == '"') {
+                        p++;
+                    } else {
+                        break;
+                    }
+                }
+            }
+            content = true;
+            fieldStart = false;
+        } else if (c == '\n') {
+            count += content;
+            content = false;
+            fieldStart = true;
+        } else if (c == delimiter_) {
+            content = true;
+            fieldStart = true;
+        } else if (!isBlank(c)) {
+            content = true;
+            fieldStart = false;
+        }
+
+        if (p - dropped >= RELEASE_CHUNK) {
+            dropPages(data_, dropped, p);
+            dropped = p;
+        }
+    }
+    return count + content;
+}
+
+CsvSchema csvSchemaBB1(int inputLength, int serviceLength) {
+    CsvSchema schema;
+    schema.table = schemaBB1(inputLength, serviceLength);
+    schema.fields = {{1, FieldEncoding::FIXED_POINT}, {2, FieldEncoding::FIXED_POINT},
+                     {3, FieldEncoding::FIXED_POINT}, {4, FieldEncoding::FIXED_POINT},
+                     {5, FieldEncoding::INTEGER}};
+    return schema;
+}
+
+CsvSchema csvSchemaBB2(int inputLength, int serviceLength) {
+    CsvSchema schema;
+    schema.table = schemaBB2(inputLength, serviceLength);
+    schema.fields = {{1, FieldEncoding::FIXED_POINT}, {2, FieldEncoding::FIXED_POINT},
+                     {3, FieldEncoding::TEXT}};
+    return schema;
+}
+
+CsvSchema csvSchemaBB3(int inputLength, int serviceLength) {
+    CsvSchema schema;
+    schema.table = schemaBB3(inputLength, serviceLength);
+    schema.fields = {{-1, FieldEncoding::RECORD_INDEX}, {2, FieldEncoding::TEXT}};
+    return schema;
+}
+
+int csvRecordBits(const CsvSchema& schema) {
+    int bits = 0;
+    for (const ColumnSpec& column : schema.table) {
+        bits += column.bits;
+    }
+    return bits;
+}
+
+int readCsvBatch(CsvReader& reader, const CsvSchema& schema, int maxRecords, std::vector<int32_t>& bits) {
+    if (schema.fields.size() != schema.table.size()) {
+        throw std::invalid_argument("readCsvBatch: one field is needed per column");
+    }
+    const int recordBits = csvRecordBits(schema);
+    bits.resize(static_cast<size_t>(maxRecords) * recordBits);
+
+    std::vector<std::string_view> fields;
+    int count = 0;
+    while (count < maxRecords && reader.next(fields)) {
+        int32_t* out = bits.data() + static_cast<size_t>(count) * recordBits;
+        for (size_t c = 0; c < schema.table.size(); c++) {
+            const int length = schema.table[c].bits;
+            const CsvField& source = schema.fields[c];
+            if (source.encoding != FieldEncoding::RECORD_INDEX &&
+                (source.field < 0 || source.field >= static_cast<int>(fields.size()))) {
+                fail(reader, "missing field " + std::to_string(source.field) + " of " + std::to_string(fields.size()));
+            }
+
+            switch (source.encoding) {
+                case FieldEncoding::FIXED_POINT:
+                    integerBits(encodeDouble(length, parseNumber<double>(reader, fields[source.field])), out, length);
+                    break;
+                case FieldEncoding::INTEGER:
+                    integerBits(parseNumber<int64_t>(reader, fields[source.field]), out, length);
+                    break;
+                case FieldEncoding::TEXT:
+                    textBits(fields[source.field], out, length);
+                    break;
+                case FieldEncoding::RECORD_INDEX:
+                    integerBits(reader.recordsRead() - 1, out, length);
+                    break;
+            }
+            out += length;
+        }
+        count++;
+    }
+    return count;
+}
+
+int64_t ingestCsv(const std::string& csvPath, const CsvSchema& schema,
+                  const TFheGateBootstrappingParameterSet* params,
+                  const TFheGateBootstrappingSecretKeySet* key, const MaskSeed& seed,
+                  int num_of_threads, int batchRecords, const BatchSink& sink) {
+    if (batchRecords <= 0) {
+        throw std::invalid_argument("ingestCsv: batchRecords must be positive");
+    }
+    CsvReader reader(csvPath, schema.delimiter, schema.header);
+
+    const int recordBits = csvRecordBits(schema);
+    std::vector<int> columnOffset(schema.table.size());
+    for (size_t c = 1; c < schema.table.size(); c++) {
+        columnOffset[c] = columnOffset[c - 1] + schema.table[c - 1].bits;
+    }
+
+    // One batch of plaintext bits and one batch of ciphertexts, reused throughout
+    std::vector<int32_t> bits;
+    std::unique_ptr<EncryptedTable> batch;
+    int64_t firstRecord = 0;
+    for (;;) {
+        int count = readCsvBatch(reader, schema, batchRecords, bits);
+        if (count == 0) {
+            break;
+        }
+        if (!batch || batch->numRecords() != count) {
+            batch.reset(new EncryptedTable(schema.table, count, params));
+        }
+
+        encryptIntoTable(*batch, [&](int record, int column, std::vector<int32_t>& cellBits) {
+            const int32_t* source = bits.data() + static_cast<size_t>(record) * recordBits + columnOffset[column];
+            cellBits.assign(source, source + cellBits.size());
+        }, key, seed, num_of_threads, firstRecord);
+
+        sink(*batch, firstRecord);
+        firstRecord += count;
+    }
+    return firstRecord;
+}
+
+int64_t ingestCsvToTableFile(const std::string& csvPath, const CsvSchema& schema, const std::string& tablePath,
+                             const TFheGateBootstrappingParameterSet* params,
+                             const TFheGateBootstrappingSecretKeySet* key, const MaskSeed& seed,
+                             int num_of_threads, int batchRecords) {
+    // The file directory needs the record count before the first batch is written
+    int64_t records = CsvReader(csvPath, schema.delimiter, schema.header).countRemaining();
+    if (records > INT_MAX) {
+        throw std::runtime_error("ingestCsvToTableFile: too many records in " + csvPath);
+    }
+
+    TableFileWriter writer(tablePath, schema.table, static_cast<int>(records), params);
+    ingestCsv(csvPath, schema, params, key, seed, num_of_threads, batchRecords,
+              [&](const EncryptedTable& batch, int64_t) { writer.append(batch); });
+    writer.finish();
+    return records;
+}
@@ -0,0 +1,232 @@
+#include "EncryptedTable.h"
+#include "utils.h"
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <sys/mman.h>
+
+namespace {
+
+const size_t ARENA_ALIGNMENT = 64;  // one cache line
+
+void* alignedAlloc(size_t bytes) {
+    size_t rounded = (bytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+    void* ptr = std::aligned_alloc(ARENA_ALIGNMENT, rounded == 0 ? ARENA_ALIGNMENT : rounded);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+} // namespace
+
+TableSchema schemaBB1(int inputLength, int serviceLength) {
+    return {
+        {"x_left", ColumnType::COORDINATE, inputLength},
+        {"x_right", ColumnType::COORDINATE, inputLength},
+        {"y_left", ColumnType::COORDINATE, inputLength},
+        {"y_right", ColumnType::COORDINATE, inputLength},
+        {"service", ColumnType::SERVICE, serviceLength}
+    };
+}
+
+TableSchema schemaBB2(int inputLength, int serviceLength) {
+    return {
+        {"x", ColumnType::COORDINATE, inputLength},
+        {"y", ColumnType::COORDINATE, inputLength},
+        {"service", ColumnType::SERVICE, serviceLength}
+    };
+}
+
+TableSchema schemaBB3(int inputLength, int serviceLength) {
+    return {
+        {"id", ColumnType::IDENTIFIER, inputLength},
+        {"service", ColumnType::SERVICE, serviceLength}
+    };
+}
+
+EncryptedTable::EncryptedTable(const TableSchema& schema, int numRecords,
+                               const TFheGateBootstrappingParameterSet* params,
+                               TableLayout layout)
+    : schema_(schema), numRecords_(numRecords), n_(params->in_out_params->n),
+      params_(params), layout_(layout) {
+    columns_.reserve(schema_.size());
+    for (const ColumnSpec& spec : schema_) {
+        size_t cells = static_cast<size_t>(numRecords_) * spec.bits;
+        Column column;
+        column.masks = static_cast<Torus32*>(alignedAlloc(cells * n_ * sizeof(Torus32)));
+        std::memset(column.masks, 0, cells * n_ * sizeof(Torus32));
+        buildViews(column, spec.bits);
+        columns_.push_back(column);
+    }
+}
+
+EncryptedTable::EncryptedTable(const TableSchema& schema, int numRecords,
+                               const TFheGateBootstrappingParameterSet* params, TableLayout layout,
+                               const std::vector<Torus32*>& masks, void* mapping, size_t mappingBytes)
+    : schema_(schema), numRecords_(numRecords), n_(params->in_out_params->n),
+      params_(params), layout_(layout), mapping_(mapping), mappingBytes_(mappingBytes) {
+    columns_.reserve(schema_.size());
+    for (size_t c = 0; c < schema_.size(); c++) {
+        Column column;
+        column.masks = masks[c];
+        buildViews(column, schema_[c].bits);
+        columns_.push_back(column);
+    }
+}
+
+void EncryptedTable::buildViews(Column& column, int bits) {
+    // Views are always record-major so a cell is `bits` consecutive LweSamples;
+    // only the masks they point at follow the requested layout
+    size_t cells = static_cast<size_t>(numRecords_) * bits;
+    column.views = static_cast<LweSample*>(alignedAlloc(cells * sizeof(LweSample)));
+    for (int i = 0; i < numRecords_; i++) {
+        for (int j = 0; j < bits; j++) {
+            size_t maskIndex = (layout_ == TableLayout::RECORD_MAJOR)
+                                   ? static_cast<size_t>(i) * bits + j
+                                   : static_cast<size_t>(j) * numRecords_ + i;
+            LweSample& view = column.views[static_cast<size_t>(i) * bits + j];
+            view.a = column.masks + maskIndex * n_;
+            view.b = 0;
+            view.current_variance = 0.;
+        }
+    }
+}
+
+EncryptedTable::~EncryptedTable() {
+    release();
+}
+
+EncryptedTable::EncryptedTable(EncryptedTable&& other) noexcept
+    : schema_(std::move(other.schema_)), numRecords_(other.numRecords_), n_(other.n_),
+      params_(other.params_), layout_(other.layout_), columns_(std::move(other.columns_)),
+      mapping_(other.mapping_), mappingBytes_(other.mappingBytes_) {
+    other.columns_.clear();
+    other.numRecords_ = 0;
+    other.mapping_ = nullptr;
+    other.mappingBytes_ = 0;
+}
+
+EncryptedTable& EncryptedTable::operator=(EncryptedTable&& other) noexcept {
+    if (this != &other) {
+        release();
+        schema_ = std::move(other.schema_);
+        numRecords_ = other.numRecords_;
+        n_ = other.n_;
+        params_ = other.params_;
+        layout_ = other.layout_;
+        columns_ = std::move(other.columns_);
+        mapping_ = other.mapping_;
+        mappingBytes_ = other.mappingBytes_;
+        other.columns_.clear();
+        other.numRecords_ = 0;
+        other.mapping_ = nullptr;
+        other.mappingBytes_ = 0;
+    }
+    return *this;
+}
+
+void EncryptedTable::release() {
+    // Views do not own their masks, so they are freed as plain memory (never through TFHE)
+    for (Column& column : columns_) {
+        std::free(column.views);
+        if (mapping_ == nullptr) {
+            std::free(column.masks);
+        }
+    }
+    columns_.clear();
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mappingBytes_);
+        mapping_ = nullptr;
+        mappingBytes_ = 0;
+    }
+}
+
+LweSample* EncryptedTable::view(int record, int column) const {
+    return columns_[column].views + static_cast<size_t>(record) * schema_[column].bits;
+}
+
+const LweSample* EncryptedTable::cell(int record, int column) const {
+    return view(record, column);
+}
+
+LweSample* EncryptedTable::mutableCell(int record, int column) {
+    if (isMapped()) {
+        throw std::logic_error("EncryptedTable: a mapped table is read-only");
+    }
+    return view(record, column);
+}
+
+std::vector<std::vector<LweSample*>> EncryptedTable::rows() const {
+    std::vector<std::vector<LweSample*>> table(numRecords_, std::vector<LweSample*>(schema_.size()));
+    for (int i = 0; i < numRecords_; i++) {
+        for (int c = 0; c < numColumns(); c++) {
+            table[i][c] = view(i, c);
+        }
+    }
+    return table;
+}
+
+size_t EncryptedTable::sizeInBytes() const {
+    size_t total = 0;
+    for (const ColumnSpec& spec : schema_) {
+        size_t cells = static_cast<size_t>(numRecords_) * spec.bits;
+        total += cells * (n_ * sizeof(Torus32) + sizeof(LweSample));
+    }
+    return total;
+}
+
+EncryptedTable encryptTable(const std::vector<std::vector<int32_t>>& encodedDB,
+                            int inputLength, int serviceLength,
+                            const TFheGateBootstrappingParameterSet* params,
+                            const TFheGateBootstrappingSecretKeySet* key,
+                            TableLayout layout) {
+    EncryptedTable table(schemaBB1(inputLength, serviceLength), encodedDB.size(), params, layout);
+
+    for (size_t i = 0; i < encodedDB.size(); ++i) {
+        if (encodedDB[i].size() != static_cast<size_t>(table.numColumns())) {
+            throw std::invalid_argument("encryptTable: row does not match the BB1 schema");
+        }
+        for (int c = 0; c < table.numColumns(); ++c) {
+            encryptBooleanTo(table.mutableCell(i, c), encodedDB[i][c], table.schema()[c].bits, key);
+        }
+    }
+
+    return table;
+}
+
+EncryptedTable encryptTableBB2(const std::vector<std::vector<std::string>>& data,
+                               int inputLength, int serviceLength,
+                               const TFheGateBootstrappingParameterSet* params,
+                               const TFheGateBootstrappingSecretKeySet* key,
+                               TableLayout layout) {
+    EncryptedTable table(schemaBB2(inputLength, serviceLength), data.size(), params, layout);
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        // Encrypt the x- and y-coordinates (first and second columns)
+        encryptBooleanTo(table.mutableCell(i, 0), encodeDouble(inputLength, std::stod(data[i][0])), inputLength, key);
+        encryptBooleanTo(table.mutableCell(i, 1), encodeDouble(inputLength, std::stod(data[i][1])), inputLength, key);
+
+        // Encrypt the service data (third column)
+        encryptBinaryStringTo(table.mutableCell(i, 2), textToBinaryString(data[i][2], serviceLength), key);
+    }
+
+    return table;
+}
+
+EncryptedTable encryptTableBB3(const std::vector<std::vector<std::string>>& data,
+                               int inputLength, int serviceLength,
+                               const TFheGateBootstrappingParameterSet* params,
+                               const TFheGateBootstrappingSecretKeySet* key,
+                               TableLayout layout) {
+    EncryptedTable table(schemaBB3(inputLength, serviceLength), data.size(), params, layout);
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        // The identifier is the record index, as in encryptDBbb3
+        encryptBooleanTo(table.mutableCell(i, 0), static_cast<int32_t>(i), inputLength, key);
+        encryptBinaryStringTo(table.mutableCell(i, 1), textToBinaryString(data[i][1], serviceLength), key);
+    }
+
+    return table;
+}
@@ -0,0 +1,133 @@
+#include "ExecutionBackend.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+class SerialBackend : public ExecutionBackend {
+public:
+    void parallelFor(int begin, int end, int, const std::function<void(int)>& body) override {
+        for (int i = begin; i < end; i++) {
+            body(i);
+        }
+    }
+
+    BackendKind kind() const override { return BackendKind::SERIAL; }
+};
+
+class OpenMPBackend : public ExecutionBackend {
+public:
+    void parallelFor(int begin, int end, int num_of_threads, const std::function<void(int)>& body) override {
+        // An exception must not leave the parallel region; keep the first and skip the rest
+        std::exception_ptr failure;
+        std::atomic<bool> failed(false);
+
+        #pragma omp parallel for num_threads(std::max(1, num_of_threads)) schedule(dynamic)
+        for (int i = begin; i < end; i++) {
+            if (failed.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            try {
+                body(i);
+            } catch (...) {
+                #pragma omp critical(OpenMPBackend)
+                {
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                }
+                failed = true;
+            }
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    BackendKind kind() const override { return BackendKind::OPENMP; }
+};
+
+class ThreadPoolBackend : public ExecutionBackend {
+public:
+    ThreadPoolBackend() : pool_(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) - 1) {}
+
+    void parallelFor(int begin, int end, int num_of_threads, const std::function<void(int)>& body) override {
+        pool_.parallelFor(begin, end, num_of_threads, body);
+    }
+
+    BackendKind kind() const override { return BackendKind::THREAD_POOL; }
+
+    ThreadPool& pool() { return pool_; }
+
+private:
+    ThreadPool pool_;
+};
+
+BackendKind initialKind() {
+    const char* name = std::getenv("LOCPIR_BACKEND");
+    return (name && *name) ? backendKindFromName(name) : BackendKind::OPENMP;
+}
+
+std::atomic<ExecutionBackend*>& current() {
+    static std::atomic<ExecutionBackend*> selected(&backend(initialKind()));
+    return selected;
+}
+
+} // namespace
+
+ExecutionBackend& backend(BackendKind kind) {
+    switch (kind) {
+        case BackendKind::SERIAL: {
+            static SerialBackend serial;
+            return serial;
+        }
+        case BackendKind::OPENMP: {
+            static OpenMPBackend openmp;
+            return openmp;
+        }
+        case BackendKind::THREAD_POOL: {
+            static ThreadPoolBackend threadPool;
+            return threadPool;
+        }
+    }
+    throw std::invalid_argument("backend: unknown kind");
+}
+
+ThreadPool& sharedThreadPool() {
+    return static_cast<ThreadPoolBackend&>(backend(BackendKind::THREAD_POOL)).pool();
+}
+
+ExecutionBackend& currentBackend() {
+    return *current().load();
+}
+
+void setBackend(BackendKind kind) {
+    current().store(&backend(kind));
+}
+
+BackendKind backendKindFromName(const std::string& name) {
+    if (name == "serial") {
+        return BackendKind::SERIAL;
+    }
+    if (name == "openmp") {
+        return BackendKind::OPENMP;
+    }
+    if (name == "threadpool") {
+        return BackendKind::THREAD_POOL;
+    }
+    throw std::invalid_argument("backendKindFromName: unknown backend '" + name + "'");
+}
+
+const char* backendName(BackendKind kind) {
+    switch (kind) {
+        case BackendKind::SERIAL: return "serial";
+        case BackendKind::OPENMP: return "openmp";
+        case BackendKind::THREAD_POOL: return "threadpool";
+    }
+    return "unknown";
+}
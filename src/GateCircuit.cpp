@@ -0,0 +1,438 @@
+#include "GateCircuit.h"
+#include "KeyPlacement.h"
+#include "ScratchPool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+int weightOf(GateOp op) {
+    return (op == GateOp::INPUT || op == GateOp::CONSTANT || op == GateOp::COPY) ? 0 : 1;
+}
+
+int arity(GateOp op) {
+    switch (op) {
+        case GateOp::INPUT:
+        case GateOp::CONSTANT:
+            return 0;
+        case GateOp::COPY:
+            return 1;
+        case GateOp::MUX:
+            return 3;
+        default:
+            return 2;
+    }
+}
+
+// Ready gate, ordered so that a max-heap yields the longest remaining path first, then the
+// lowest record, then the gate added first
+struct Ready {
+    int height;
+    int record;
+    int node;
+
+    bool operator<(const Ready& other) const {
+        if (height != other.height) return height < other.height;
+        if (record != other.record) return record > other.record;
+        return node > other.node;
+    }
+};
+
+struct ReadyQueue {
+    std::mutex mutex;
+    std::vector<Ready> heap;
+};
+
+} // namespace
+
+int GateCircuit::push(Node node) {
+    nodes_.push_back(node);
+    return static_cast<int>(nodes_.size()) - 1;
+}
+
+int GateCircuit::input(const LweSample* sample) {
+    return push({GateOp::INPUT, {-1, -1, -1}, 0, sample, nullptr, record_});
+}
+
+std::vector<int> GateCircuit::inputs(const LweSample* samples, int length) {
+    std::vector<int> bus(length);
+    for (int i = 0; i < length; i++) {
+        bus[i] = input(&samples[i]);
+    }
+    return bus;
+}
+
+int GateCircuit::constant(int value) {
+    return push({GateOp::CONSTANT, {-1, -1, -1}, value, nullptr, nullptr, record_});
+}
+
+int GateCircuit::gate(GateOp op, int a, int b, int c) {
+    if (op == GateOp::INPUT || op == GateOp::CONSTANT) {
+        throw std::invalid_argument("GateCircuit::gate: use input() or constant()");
+    }
+    int in[3] = {a, b, c};
+    for (int k = 0; k < 3; k++) {
+        bool used = k < arity(op);
+        if (used && (in[k] < 0 || in[k] >= numWires())) {
+            throw std::invalid_argument("GateCircuit::gate: unknown input wire");
+        }
+        if (!used) {
+            in[k] = -1;
+        }
+    }
+    return push({op, {in[0], in[1], in[2]}, 0, nullptr, nullptr, record_});
+}
+
+void GateCircuit::bind(int wire, LweSample* dest) {
+    if (wire < 0 || wire >= numWires() || nodes_[wire].op == GateOp::INPUT) {
+        throw std::invalid_argument("GateCircuit::bind: not a gate wire");
+    }
+    nodes_[wire].output = dest;
+}
+
+int GateCircuit::numGates() const {
+    int gates = 0;
+    for (const Node& node : nodes_) {
+        gates += weightOf(node.op);
+    }
+    return gates;
+}
+
+std::vector<int> GateCircuit::heights() const {
+    // Wires only read earlier wires, so one backward sweep settles every height
+    std::vector<int> height(nodes_.size(), 0);
+    for (int n = numWires() - 1; n >= 0; n--) {
+        height[n] += weightOf(nodes_[n].op);
+        for (int k = 0; k < arity(nodes_[n].op); k++) {
+            int in = nodes_[n].in[k];
+            height[in] = std::max(height[in], height[n]);
+        }
+    }
+    return height;
+}
+
+int GateCircuit::criticalPath() const {
+    std::vector<int> height = heights();
+    return height.empty() ? 0 : *std::max_element(height.begin(), height.end());
+}
+
+void GateCircuit::execute(const TFheGateBootstrappingCloudKeySet* bk, ThreadPool& pool, int num_of_threads) const {
+    const int N = numWires();
+    const int threads = std::max(1, std::min(num_of_threads, pool.numWorkers() + 1));
+    std::vector<int> height = heights();
+
+    // Readers of every wire, and the inputs each gate still waits for
+    std::vector<int> readerStart(N + 1, 0);
+    for (const Node& node : nodes_) {
+        for (int k = 0; k < arity(node.op); k++) {
+            readerStart[node.in[k] + 1]++;
+        }
+    }
+    for (int n = 0; n < N; n++) {
+        readerStart[n + 1] += readerStart[n];
+    }
+    std::vector<int> readers(readerStart[N]);
+    std::vector<int> fill(readerStart.begin(), readerStart.end() - 1);
+    std::vector<std::atomic<int>> waiting(N);
+    std::vector<std::atomic<int>> unread(N);
+    for (int n = 0; n < N; n++) {
+        unread[n].store(readerStart[n + 1] - readerStart[n], std::memory_order_relaxed);
+        int inputs = 0;
+        for (int k = 0; k < arity(nodes_[n].op); k++) {
+            int in = nodes_[n].in[k];
+            readers[fill[in]++] = n;
+            inputs += (nodes_[in].op != GateOp::INPUT);
+        }
+        waiting[n].store(inputs, std::memory_order_relaxed);
+    }
+
+    std::vector<LweSample*> value(N, nullptr);
+    std::vector<ReadyQueue> queues(threads);
+    std::atomic<int> remaining(0), queued(0), sleepers(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr failure;
+    std::mutex idleMutex;
+    std::condition_variable idle;
+
+    for (int n = 0, next = 0; n < N; n++) {
+        if (nodes_[n].op == GateOp::INPUT) {
+            value[n] = const_cast<LweSample*>(nodes_[n].input);
+            continue;
+        }
+        remaining++;
+        if (waiting[n].load(std::memory_order_relaxed) == 0) {
+            queues[next].heap.push_back({height[n], nodes_[n].record, n});
+            next = (next + 1) % threads;
+            queued++;
+        }
+    }
+    for (ReadyQueue& queue : queues) {
+        std::make_heap(queue.heap.begin(), queue.heap.end());
+    }
+
+    auto wakeAll = [&] {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        idle.notify_all();
+    };
+
+    auto enqueue = [&](int self, int n) {
+        {
+            std::lock_guard<std::mutex> lock(queues[self].mutex);
+            queues[self].heap.push_back({height[n], nodes_[n].record, n});
+            std::push_heap(queues[self].heap.begin(), queues[self].heap.end());
+        }
+        queued++;
+        if (sleepers.load() > 0) {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            idle.notify_one();
+        }
+    };
+
+    // Own queue first, then the others starting from the next thread
+    auto dequeue = [&](int self, int& n) {
+        for (int t = 0; t < threads; t++) {
+            ReadyQueue& queue = queues[(self + t) % threads];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.heap.empty()) {
+                std::pop_heap(queue.heap.begin(), queue.heap.end());
+                n = queue.heap.back().node;
+                queue.heap.pop_back();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto runGate = [&](int n) {
+        const Node& node = nodes_[n];
+        const TFheGateBootstrappingCloudKeySet* local_bk = localCloudKey(bk);
+        LweSample* out = node.output ? node.output : acquireScratchArray(1, local_bk->params);
+        const LweSample* a = (node.in[0] >= 0) ? value[node.in[0]] : nullptr;
+        const LweSample* b = (node.in[1] >= 0) ? value[node.in[1]] : nullptr;
+        const LweSample* c = (node.in[2] >= 0) ? value[node.in[2]] : nullptr;
+
+        switch (node.op) {
+            case GateOp::CONSTANT: bootsCONSTANT(out, node.value, local_bk); break;
+            case GateOp::COPY:     bootsCOPY(out, a, local_bk); break;
+            case GateOp::XOR:      bootsXOR(out, a, b, local_bk); break;
+            case GateOp::XNOR:     bootsXNOR(out, a, b, local_bk); break;
+            case GateOp::AND:      bootsAND(out, a, b, local_bk); break;
+            case GateOp::MUX:      bootsMUX(out, a, b, c, local_bk); break;
+            case GateOp::INPUT:    break;
+        }
+        value[n] = out;
+
+        // Temporaries go back once their last reader is done; unread ones right away
+        for (int k = 0; k < arity(node.op); k++) {
+            int in = node.in[k];
+            if (nodes_[in].op != GateOp::INPUT && !nodes_[in].output &&
+                unread[in].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                releaseScratchArray(value[in], 1, local_bk->params);
+            }
+        }
+        if (!node.output && readerStart[n + 1] == readerStart[n]) {
+            releaseScratchArray(out, 1, local_bk->params);
+        }
+    };
+
+    pool.parallelFor(0, threads, threads, [&](int self) {
+        int n;
+        while (remaining.load() > 0 && !failed.load()) {
+            if (!dequeue(self, n)) {
+                std::unique_lock<std::mutex> lock(idleMutex);
+                sleepers++;
+                idle.wait(lock, [&] { return queued.load() > 0 || remaining.load() == 0 || failed.load(); });
+                sleepers--;
+                continue;
+            }
+            try {
+                runGate(n);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(idleMutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+                failed = true;
+                idle.notify_all();
+                return;
+            }
+            for (int r = readerStart[n]; r < readerStart[n + 1]; r++) {
+                if (waiting[readers[r]].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    enqueue(self, readers[r]);
+                }
+            }
+            if (remaining.fetch_sub(1) == 1) {
+                wakeAll();
+            }
+        }
+    });
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+namespace {
+
+// Comparators follow HomCompLE/HomCompL gate for gate: `initial` is the answer for a == b
+int addComp(GateCircuit& circuit, const std::vector<int>& a, const std::vector<int>& b, int initial) {
+    const int length = static_cast<int>(a.size());
+    int signsDiffer = circuit.gate(GateOp::XOR, a[length - 1], b[length - 1]);
+    int t = circuit.constant(initial);
+    for (int i = 0; i < length - 1; i++) {
+        int equal = circuit.gate(GateOp::XNOR, a[i], b[i]);
+        t = circuit.gate(GateOp::MUX, equal, t, b[i]);
+    }
+    return circuit.gate(GateOp::MUX, signsDiffer, a[length - 1], t);
+}
+
+int addAndTree(GateCircuit& circuit, std::vector<int> bits) {
+    if (bits.empty()) {
+        return circuit.constant(1);
+    }
+    while (bits.size() > 1) {
+        std::vector<int> next;
+        for (size_t i = 0; i + 1 < bits.size(); i += 2) {
+            next.push_back(circuit.gate(GateOp::AND, bits[i], bits[i + 1]));
+        }
+        if (bits.size() % 2 == 1) {
+            next.push_back(bits.back());
+        }
+        bits.swap(next);
+    }
+    return bits[0];
+}
+
+} // namespace
+
+int addCompLE(GateCircuit& circuit, const std::vector<int>& a, const std::vector<int>& b) {
+    return addComp(circuit, a, b, 1);
+}
+
+int addCompL(GateCircuit& circuit, const std::vector<int>& a, const std::vector<int>& b) {
+    return addComp(circuit, a, b, 0);
+}
+
+int addEqui(GateCircuit& circuit, const std::vector<int>& a, const std::vector<int>& b) {
+    std::vector<int> equal;
+    for (size_t i = 0; i < a.size(); i++) {
+        equal.push_back(circuit.gate(GateOp::XNOR, a[i], b[i]));
+    }
+    return addAndTree(circuit, equal);
+}
+
+int addBB1(GateCircuit& circuit, const std::vector<int>& x, const std::vector<int>& y,
+           const std::vector<std::vector<int>>& loc) {
+    int v_x = circuit.gate(GateOp::AND, addCompLE(circuit, loc[0], x), addCompL(circuit, x, loc[1]));
+    int v_y = circuit.gate(GateOp::AND, addCompLE(circuit, loc[2], y), addCompL(circuit, y, loc[3]));
+    return circuit.gate(GateOp::AND, v_x, v_y);
+}
+
+int addBB2(GateCircuit& circuit, const std::vector<int>& x, const std::vector<int>& y,
+           const std::vector<std::vector<int>>& loc) {
+    return circuit.gate(GateOp::AND, addEqui(circuit, x, loc[0]), addEqui(circuit, y, loc[1]));
+}
+
+int addBB3(GateCircuit& circuit, const std::vector<int>& id, const std::vector<int>& targetId) {
+    return addEqui(circuit, id, targetId);
+}
+
+void addRetrieval(GateCircuit& circuit, BuildingBlock block, const LweSample* first, const LweSample* second,
+                  const std::vector<std::vector<LweSample*>>& enc_database,
+                  int inputLength, int serviceLength, LweSample* result) {
+    addRetrieval(circuit, block, first, second, enc_database, 0, static_cast<int>(enc_database.size()),
+                 inputLength, serviceLength, nullptr, result);
+}
+
+void addRetrieval(GateCircuit& circuit, BuildingBlock block, const LweSample* first, const LweSample* second,
+                  const std::vector<std::vector<LweSample*>>& enc_database, int firstRecord, int numRecords,
+                  int inputLength, int serviceLength, const LweSample* partial, LweSample* result) {
+    std::vector<int> x = circuit.inputs(first, inputLength);
+    std::vector<int> y;
+    if (block != BuildingBlock::BB3) {
+        y = circuit.inputs(second, inputLength);
+    }
+
+    // Service bits of every record, gated by its validation bit, after the earlier records' sum
+    std::vector<std::vector<int>> filtered(serviceLength);
+    if (partial != nullptr) {
+        for (int j = 0; j < serviceLength; j++) {
+            filtered[j].push_back(circuit.input(&partial[j]));
+        }
+    }
+    for (int i = firstRecord; i < firstRecord + numRecords; i++) {
+        const std::vector<LweSample*>& row = enc_database[i];
+        circuit.setRecord(i);
+        int validation = 0;
+        int service = 0;
+        switch (block) {
+            case BuildingBlock::BB1:
+                validation = addBB1(circuit, x, y, {circuit.inputs(row[0], inputLength), circuit.inputs(row[1], inputLength),
+                                                    circuit.inputs(row[2], inputLength), circuit.inputs(row[3], inputLength)});
+                service = 4;
+                break;
+            case BuildingBlock::BB2:
+                validation = addBB2(circuit, x, y, {circuit.inputs(row[0], inputLength), circuit.inputs(row[1], inputLength)});
+                service = 2;
+                break;
+            case BuildingBlock::BB3:
+                validation = addBB3(circuit, x, circuit.inputs(row[0], inputLength));
+                service = 1;
+                break;
+        }
+        for (int j = 0; j < serviceLength; j++) {
+            filtered[j].push_back(circuit.gate(GateOp::AND, validation, circuit.input(&row[service][j])));
+        }
+    }
+
+    // XOR tree per service bit; an empty table answers zeros, and a lone wire (the partial
+    // sum of an empty chunk) is copied out
+    circuit.setRecord(firstRecord + numRecords);
+    for (int j = 0; j < serviceLength; j++) {
+        std::vector<int>& bits = filtered[j];
+        if (bits.empty()) {
+            bits.push_back(circuit.constant(0));
+        }
+        while (bits.size() > 1) {
+            std::vector<int> next;
+            for (size_t i = 0; i + 1 < bits.size(); i += 2) {
+                next.push_back(circuit.gate(GateOp::XOR, bits[i], bits[i + 1]));
+            }
+            if (bits.size() % 2 == 1) {
+                next.push_back(bits.back());
+            }
+            bits.swap(next);
+        }
+        int out = (partial != nullptr && numRecords == 0) ? circuit.gate(GateOp::COPY, bits[0]) : bits[0];
+        circuit.bind(out, &result[j]);
+    }
+}
+
+CiphertextArray HomLocPIRGraph(BuildingBlock block, const LweSample* first, const LweSample* second,
+                               const std::vector<std::vector<LweSample*>>& enc_database,
+                               int inputLength, int serviceLength,
+                               const TFheGateBootstrappingCloudKeySet* bk, ThreadPool& pool, int num_of_threads) {
+    const int M = static_cast<int>(enc_database.size());
+    const int threads = std::max(1, std::min(num_of_threads, pool.numWorkers() + 1));
+    const int chunk = GRAPH_RECORDS_PER_THREAD * threads;
+
+    // The sum so far is an input of the next chunk's circuit, so the two buffers alternate
+    CiphertextArray result(serviceLength, bk->params);
+    CiphertextArray partial(serviceLength, bk->params);
+    for (int start = 0; start == 0 || start < M; start += chunk) {
+        if (start > 0) {
+            std::swap(result, partial);
+        }
+        GateCircuit circuit;
+        addRetrieval(circuit, block, first, second, enc_database, start, std::min(chunk, M - start),
+                     inputLength, serviceLength, (start > 0) ? partial.get() : nullptr, result.get());
+        circuit.execute(bk, pool, threads);
+    }
+    return result;
+}
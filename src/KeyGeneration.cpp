@@ -0,0 +1,121 @@
+#include "KeyGeneration.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Stream domains: the top byte says what a stream is for, the rest indexes the sample
+const uint64_t STREAM_LWE_KEY = uint64_t(1) << 56;
+const uint64_t STREAM_TLWE_KEY = uint64_t(2) << 56;   // | polynomial
+const uint64_t STREAM_BK_MASK = uint64_t(3) << 56;    // | (key bit * kpl + row) * k + polynomial
+const uint64_t STREAM_BK_NOISE = uint64_t(4) << 56;   // | key bit
+const uint64_t STREAM_KS_MASK = uint64_t(5) << 56;    // | keyswitch sample
+const uint64_t STREAM_KS_NOISE = uint64_t(6) << 56;   // | extracted key coefficient
+
+// tGswSymEncryptInt with seeded streams: kpl TLwe encryptions of zero, plus message * h on
+// the diagonal blocks
+void encryptTGswBit(TGswSample* result, int32_t message, double alpha, const TGswKey* key,
+                    const MaskSeed& seed, int index) {
+    const TGswParams* params = key->params;
+    const int N = key->tlwe_params->N, k = key->tlwe_params->k, l = params->l, kpl = params->kpl;
+
+    std::mt19937_64 noise = seededNoise(seed, STREAM_BK_NOISE | index);
+    std::normal_distribution<double> gaussian(0., alpha);
+    for (int row = 0; row < kpl; row++) {
+        TLweSample* sample = &result->all_sample[row];
+        for (int j = 0; j < N; j++) {
+            sample->b->coefsT[j] = dtot32(gaussian(noise));
+        }
+        for (int q = 0; q < k; q++) {
+            uint64_t stream = (static_cast<uint64_t>(index) * kpl + row) * k + q;
+            expandMask(sample->a[q].coefsT, N, seed, STREAM_BK_MASK | stream);
+            torusPolynomialAddMulR(sample->b, &key->key[q], &sample->a[q]);
+        }
+        sample->current_variance = alpha * alpha;
+    }
+
+    for (int bloc = 0; bloc <= k; bloc++) {
+        for (int i = 0; i < l; i++) {
+            result->bloc_sample[bloc][i].a[bloc].coefsT[0] += message * params->h[i];
+        }
+    }
+}
+
+} // namespace
+
+TFheGateBootstrappingSecretKeySet* generateKeySetParallel(const TFheGateBootstrappingParameterSet* params,
+                                                          const MaskSeed& seed, int num_of_threads) {
+    const LweParams* in_out = params->in_out_params;
+    const TGswParams* tgsw = params->tgsw_params;
+    const TLweParams* tlwe = tgsw->tlwe_params;
+    const int n = in_out->n, N = tlwe->N, k = tlwe->k;
+
+    // Binary secret keys: s for LWE, K_0..K_{k-1} for TLwe
+    std::vector<Torus32> bits(std::max(n, N));
+    LweKey* lweKey = new_LweKey(in_out);
+    expandMask(bits.data(), n, seed, STREAM_LWE_KEY);
+    for (int i = 0; i < n; i++) {
+        lweKey->key[i] = bits[i] & 1;
+    }
+    TGswKey* tgswKey = new_TGswKey(tgsw);
+    for (int q = 0; q < k; q++) {
+        expandMask(bits.data(), N, seed, STREAM_TLWE_KEY | q);
+        for (int j = 0; j < N; j++) {
+            tgswKey->key[q].coefs[j] = bits[j] & 1;
+        }
+    }
+
+    LweBootstrappingKey* bk = new_LweBootstrappingKey(params->ks_t, params->ks_basebit, in_out, tgsw);
+
+    // Bootstrapping key: one TGsw encryption of s_i under K per LWE key bit
+    #pragma omp parallel for num_threads(num_of_threads) schedule(dynamic)
+    for (int i = 0; i < n; i++) {
+        encryptTGswBit(&bk->bk[i], lweKey->key[i], tlwe->alpha_min, tgswKey, seed, i);
+    }
+
+    // Keyswitch key: LWE encryptions under s of h * K'_i / base^(j+1), where K' is K read as
+    // an N*k-coefficient LWE key (tLweExtractKey), one row of t * base samples per K'_i
+    LweKeySwitchKey* ks = bk->ks;
+    const int t = ks->t, basebit = ks->basebit, base = ks->base;
+    const double ksAlpha = in_out->alpha_min;
+    std::vector<int64_t> rowError(ks->n, 0);
+    #pragma omp parallel for num_threads(num_of_threads) schedule(dynamic, 16)
+    for (int i = 0; i < ks->n; i++) {
+        const int32_t keyBit = tgswKey->key[i / N].coefs[i % N];
+        std::mt19937_64 noise = seededNoise(seed, STREAM_KS_NOISE | i);
+        std::normal_distribution<double> gaussian(0., ksAlpha);
+        for (int j = 0; j < t; j++) {
+            for (int h = 0; h < base; h++) {
+                LweSample* sample = &ks->ks[i][j][h];
+                uint64_t stream = (static_cast<uint64_t>(i) * t + j) * base + h;
+                expandMask(sample->a, n, seed, STREAM_KS_MASK | stream);
+
+                Torus32 error = dtot32(gaussian(noise));
+                uint32_t body = static_cast<uint32_t>(keyBit * h) << (32 - (j + 1) * basebit);
+                body += static_cast<uint32_t>(error);
+                for (int c = 0; c < n; c++) {
+                    body += static_cast<uint32_t>(sample->a[c]) * static_cast<uint32_t>(lweKey->key[c]);
+                }
+                sample->b = static_cast<Torus32>(body);
+                sample->current_variance = ksAlpha * ksAlpha;
+                rowError[i] += error;
+            }
+        }
+    }
+
+    // Recenter the keyswitch noise on zero, as lweCreateKeySwitchKey does; the integer sum
+    // makes this independent of how rows were split across threads
+    int64_t totalError = 0;
+    for (int64_t error : rowError) {
+        totalError += error;
+    }
+    const Torus32 meanError = static_cast<Torus32>(totalError / (static_cast<int64_t>(ks->n) * t * base));
+    const int samples = ks->n * t * base;
+    for (int s = 0; s < samples; s++) {
+        ks->ks0_raw[s].b -= meanError;
+    }
+
+    LweBootstrappingKeyFFT* bkFFT = new_LweBootstrappingKeyFFT(bk);
+    return new TFheGateBootstrappingSecretKeySet(params, bk, bkFFT, lweKey, tgswKey);
+}
@@ -0,0 +1,359 @@
+#include "KeyPlacement.h"
+#include <omp.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t HUGE_PAGE_BYTES = size_t(2) << 20;
+const int MPOL_BIND_MODE = 2;  // MPOL_BIND from <linux/mempolicy.h>, without a libnuma dependency
+
+size_t roundUpToHugePage(size_t bytes) {
+    return (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+}
+
+// "0-15,32-47" -> {0, ..., 15, 32, ..., 47}
+std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ranges(text);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        if (range.empty() || range == "\n") {
+            continue;
+        }
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+void pinCurrentThread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);  // best effort: a restricted cpuset may refuse
+}
+
+// Anonymous, writable, 2 MiB-aligned region of at least `bytes`; huge pages if asked for and available
+void* mapKeyPages(size_t bytes, bool hugePages, PageBacking& backing, size_t& mappedBytes) {
+    mappedBytes = roundUpToHugePage(bytes);
+
+    if (hugePages) {
+        void* region = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (region != MAP_FAILED) {
+            backing = PageBacking::HUGETLB_PAGES;
+            return region;
+        }
+    }
+
+    // Over-map by one huge page and trim, so the key starts on a 2 MiB boundary THP can back
+    size_t span = mappedBytes + HUGE_PAGE_BYTES;
+    void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::runtime_error("PlacedCloudKey: cannot map " + std::to_string(mappedBytes) + " bytes");
+    }
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    uintptr_t aligned = (start + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+    if (aligned > start) {
+        munmap(raw, aligned - start);
+    }
+    size_t tail = (start + span) - (aligned + mappedBytes);
+    if (tail > 0) {
+        munmap(reinterpret_cast<void*>(aligned + mappedBytes), tail);
+    }
+    void* region = reinterpret_cast<void*>(aligned);
+
+    backing = PageBacking::SMALL_PAGES;
+    if (hugePages && madvise(region, mappedBytes, MADV_HUGEPAGE) == 0) {
+        backing = PageBacking::TRANSPARENT_HUGE_PAGES;
+    }
+    return region;
+}
+
+// Bind a region to one kernel node. The mask is sized for nodeId, so node numbers past 63
+// work. Returns false if the kernel has no NUMA policy support or the sandbox forbids it;
+// throws std::runtime_error on any other failure, e.g. a node that does not exist.
+bool bindToNode(void* region, size_t bytes, int nodeId) {
+    const size_t BITS = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask(nodeId / BITS + 1, 0);
+    mask[nodeId / BITS] = 1UL << (nodeId % BITS);
+    // maxnode counts one past the last bit the kernel may read
+    if (syscall(SYS_mbind, region, bytes, MPOL_BIND_MODE, mask.data(), mask.size() * BITS + 1, 0) == 0) {
+        return true;
+    }
+    if (errno == ENOSYS || errno == EPERM) {
+        return false;
+    }
+    throw std::runtime_error("PlacedCloudKey: mbind to node " + std::to_string(nodeId) +
+                             " failed: " + std::strerror(errno));
+}
+
+// Live placements, looked up by any of their replicas' cloud keys
+std::shared_mutex& registryMutex() {
+    static std::shared_mutex mutex;
+    return mutex;
+}
+
+std::unordered_map<const TFheGateBootstrappingCloudKeySet*, const PlacedCloudKey*>& registry() {
+    static std::unordered_map<const TFheGateBootstrappingCloudKeySet*, const PlacedCloudKey*> placements;
+    return placements;
+}
+
+// Bumped on every registry change, so per-thread lookups cached under an older value are redone
+std::atomic<uint64_t>& registryGeneration() {
+    static std::atomic<uint64_t> generation{0};
+    return generation;
+}
+
+// CPU of thread t in the round-robin spread over the nodes
+int spreadCpu(int t, const NumaTopology& topology) {
+    const std::vector<int>& cpus = topology.nodeCpus[t % topology.numNodes()];
+    return cpus.empty() ? -1 : cpus[(t / topology.numNodes()) % cpus.size()];
+}
+
+} // namespace
+
+int NumaTopology::nodeOfCpu(int cpu) const {
+    for (int node = 0; node < numNodes(); node++) {
+        if (std::find(nodeCpus[node].begin(), nodeCpus[node].end(), cpu) != nodeCpus[node].end()) {
+            return node;
+        }
+    }
+    return 0;
+}
+
+NumaTopology detectNumaTopology() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    // Node directories may be sparse (node0, node2); only nodes with usable CPUs count
+    std::vector<int> nodeIds;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            nodeIds.push_back(std::stoi(name.substr(4)));
+        }
+    }
+    std::sort(nodeIds.begin(), nodeIds.end());
+
+    NumaTopology topology;
+    for (int node : nodeIds) {
+        std::ifstream list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string text;
+        std::getline(list, text);
+        std::vector<int> cpus;
+        for (int cpu : parseCpuList(text)) {
+            if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty()) {
+            topology.nodeCpus.push_back(cpus);
+            topology.nodeIds.push_back(node);
+        }
+    }
+
+    if (topology.nodeCpus.empty()) {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        topology.nodeCpus.push_back(cpus);
+        topology.nodeIds.push_back(0);
+    }
+    return topology;
+}
+
+PlacedCloudKey::PlacedCloudKey(const TFheGateBootstrappingCloudKeySet* bk, KeyPlacementPolicy policy,
+                               const NumaTopology& topology)
+    : topology_(topology) {
+    if (topology_.numNodes() == 0) {
+        throw std::invalid_argument("PlacedCloudKey: empty NUMA topology");
+    }
+    const TFheGateBootstrappingParameterSet* params = bk->params;
+    const size_t imageBytes = bootstrappingKeyImageBytes(params);
+    const int copies = policy.replicatePerNode ? topology_.numNodes() : 1;
+
+    std::vector<void*> regions(copies, nullptr);
+    std::vector<size_t> regionBytes(copies, 0);
+    try {
+        for (int node = 0; node < copies; node++) {
+            PageBacking backing;
+            regions[node] = mapKeyPages(imageBytes, policy.hugePages, backing, regionBytes[node]);
+            // Report the weakest backing any replica got
+            if (node == 0 || backing < backing_) {
+                backing_ = backing;
+            }
+        }
+    } catch (...) {
+        for (int node = 0; node < copies; node++) {
+            if (regions[node] != nullptr) munmap(regions[node], regionBytes[node]);
+        }
+        throw;
+    }
+
+    // Fill each replica from a thread pinned to its node: pages land where they are first
+    // touched, and the explicit bind makes that hold even if the pin is refused
+    std::vector<std::thread> fillers;
+    std::vector<std::exception_ptr> failures(copies);
+    std::vector<char> bound(copies, 1);
+    for (int node = 0; node < copies; node++) {
+        fillers.emplace_back([&, node]() {
+            if (policy.replicatePerNode && topology_.numNodes() > 1) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for (int cpu : topology_.nodeCpus[node]) {
+                    CPU_SET(cpu, &set);
+                }
+                sched_setaffinity(0, sizeof(set), &set);
+            }
+            try {
+                if (policy.replicatePerNode && topology_.numNodes() > 1) {
+                    int nodeId = (node < static_cast<int>(topology_.nodeIds.size())) ? topology_.nodeIds[node] : node;
+                    bound[node] = bindToNode(regions[node], regionBytes[node], nodeId);
+                }
+                writeBootstrappingKeyImage(regions[node], bk);
+                mprotect(regions[node], regionBytes[node], PROT_READ);
+            } catch (...) {
+                failures[node] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread& filler : fillers) {
+        filler.join();
+    }
+    for (int node = 0; node < copies; node++) {
+        if (failures[node]) {
+            for (int other = 0; other < copies; other++) {
+                munmap(regions[other], regionBytes[other]);
+            }
+            std::rethrow_exception(failures[node]);
+        }
+    }
+
+    nodeBound_ = std::all_of(bound.begin(), bound.end(), [](char b) { return b != 0; });
+
+    // Each MappedCloudKey owns its region from here on, including on failure
+    for (int node = 0; node < copies; node++) {
+        try {
+            replicas_.emplace_back(regions[node], regionBytes[node], params);
+        } catch (...) {
+            for (int rest = node + 1; rest < copies; rest++) {
+                munmap(regions[rest], regionBytes[rest]);
+            }
+            throw;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(registryMutex());
+    for (const MappedCloudKey& replica : replicas_) {
+        registry()[replica.get()] = this;
+    }
+    registryGeneration().fetch_add(1, std::memory_order_release);
+}
+
+PlacedCloudKey::~PlacedCloudKey() {
+    std::unique_lock<std::shared_mutex> lock(registryMutex());
+    for (const MappedCloudKey& replica : replicas_) {
+        registry().erase(replica.get());
+    }
+    registryGeneration().fetch_add(1, std::memory_order_release);
+}
+
+const TFheGateBootstrappingCloudKeySet* PlacedCloudKey::replica(int node) const {
+    if (node < 0 || node >= numReplicas()) {
+        return get();
+    }
+    return replicas_[node].get();
+}
+
+const TFheGateBootstrappingCloudKeySet* PlacedCloudKey::local() const {
+    if (numReplicas() == 1) {
+        return get();
+    }
+    int cpu = sched_getcpu();
+    return replica(cpu < 0 ? 0 : topology_.nodeOfCpu(cpu));
+}
+
+const TFheGateBootstrappingCloudKeySet* localCloudKey(const TFheGateBootstrappingCloudKeySet* bk) {
+    struct Resolved {
+        const TFheGateBootstrappingCloudKeySet* bk = nullptr;
+        uint64_t generation = 0;
+        int cpu = -1;
+        const TFheGateBootstrappingCloudKeySet* local = nullptr;
+    };
+    thread_local Resolved cached;
+
+    const uint64_t generation = registryGeneration().load(std::memory_order_acquire);
+    const int cpu = sched_getcpu();
+    if (cached.bk == bk && cached.generation == generation && cached.cpu == cpu) {
+        return cached.local;
+    }
+
+    const TFheGateBootstrappingCloudKeySet* local = bk;
+    {
+        std::shared_lock<std::shared_mutex> lock(registryMutex());
+        auto found = registry().find(bk);
+        if (found != registry().end()) {
+            local = found->second->local();
+        }
+    }
+    cached = {bk, generation, cpu, local};
+    return local;
+}
+
+void pinWorkerThreads(int num_of_threads, const NumaTopology& topology) {
+    if (topology.numNodes() == 0) {
+        return;
+    }
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        // Thread t goes to node t % nodes, taking that node's CPUs in order
+        int cpu = spreadCpu(omp_get_thread_num(), topology);
+        if (cpu >= 0) {
+            pinCurrentThread(cpu);
+        }
+    }
+}
+
+void pinPoolWorkers(ThreadPool& pool, const NumaTopology& topology) {
+    if (topology.numNodes() == 0) {
+        return;
+    }
+    for (int w = 0; w < pool.numWorkers(); w++) {
+        int cpu = spreadCpu(w + 1, topology);
+        if (cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_setaffinity_np(pool.nativeHandle(w), sizeof(set), &set);  // best effort, as pinCurrentThread
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#include "PIRClient.h"
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+void writeRequestHeader(std::ostream& out, PIROp op, const std::string& table,
+                        PIRQueryCodec queryCodec = PIRQueryCodec::RAW,
+                        PIRResponseCodec responseCodec = PIRResponseCodec::RAW) {
+    if (table.size() > UINT16_MAX) {
+        throw std::invalid_argument("PIRClient: table name too long");
+    }
+    uint16_t nameLength = table.size();
+    out.put(static_cast<char>(op));
+    out.put(static_cast<char>(queryCodec));
+    out.put(static_cast<char>(responseCodec));
+    out.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+    out.write(table.data(), nameLength);
+}
+
+} // namespace
+
+PIRClient::PIRClient(const std::string& socketPath, const TFheGateBootstrappingParameterSet* params)
+    : params_(params) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("PIRClient: socket path too long: " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        throw std::runtime_error("PIRClient: cannot connect to " + socketPath);
+    }
+}
+
+PIRClient::~PIRClient() {
+    close(fd_);
+}
+
+std::string PIRClient::roundTrip(const std::string& request) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string reply;
+    if (!writeFrame(fd_, request) || !readFrame(fd_, reply) || reply.empty()) {
+        throw std::runtime_error("PIRClient: connection to the server lost");
+    }
+    if (static_cast<uint8_t>(reply[0]) != PIR_STATUS_OK) {
+        throw std::runtime_error("PIRClient: " + reply.substr(1));
+    }
+    return reply.substr(1);
+}
+
+CiphertextArray PIRClient::rawResult(const std::string& reply) {
+    std::istringstream in(reply);
+    uint32_t length = 0;
+    in.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!in || reply.size() != sizeof(length) + rawCiphertextArrayBytes(length, params_)) {
+        throw std::runtime_error("PIRClient: truncated reply");
+    }
+    CiphertextArray result(length, params_);
+    importRawCiphertextArrayFromStream(in, result.get(), length, params_);
+    return result;
+}
+
+CiphertextArray PIRClient::query(const std::string& table, const LweSample* enc_x, const LweSample* enc_y,
+                                 int inputLength) {
+    std::ostringstream out;
+    writeRequestHeader(out, PIROp::QUERY_ENCRYPTED, table);
+    out.put(static_cast<char>(enc_y ? 2 : 1));
+    exportRawCiphertextArrayToStream(out, enc_x, inputLength, params_);
+    if (enc_y) {
+        exportRawCiphertextArrayToStream(out, enc_y, inputLength, params_);
+    }
+    return rawResult(roundTrip(out.str()));
+}
+
+CiphertextArray PIRClient::query(const std::string& table, const LweSample* enc_id, int inputLength) {
+    return query(table, enc_id, nullptr, inputLength);
+}
+
+std::string PIRClient::querySeeded(const std::string& table, const CompressedQuery& query, PIRResponseCodec codec) {
+    std::ostringstream out;
+    writeRequestHeader(out, PIROp::QUERY_ENCRYPTED, table, PIRQueryCodec::SEEDED, codec);
+    exportCompressedQueryToStream(out, query);
+    return roundTrip(out.str());
+}
+
+CiphertextArray PIRClient::query(const std::string& table, const CompressedQuery& query) {
+    return rawResult(querySeeded(table, query, PIRResponseCodec::RAW));
+}
+
+CompressedResponse PIRClient::queryModulusSwitched(const std::string& table, const CompressedQuery& query) {
+    std::istringstream in(querySeeded(table, query, PIRResponseCodec::MODULUS_SWITCHED));
+    return importCompressedResponseFromStream(in, params_);
+}
+
+PackedResponse PIRClient::queryPacked(const std::string& table, const CompressedQuery& query) {
+    std::istringstream in(querySeeded(table, query, PIRResponseCodec::PACKED));
+    return importPackedResponseFromStream(in, params_);
+}
+
+void PIRClient::setPackingKey(const PackingKey& packingKey) {
+    std::ostringstream out;
+    writeRequestHeader(out, PIROp::SET_PACKING_KEY, "");
+    exportPackingKeyToStream(out, packingKey);
+    roundTrip(out.str());
+}
+
+std::vector<int> PIRClient::queryPlain(const std::string& table, const std::vector<int32_t>& values) {
+    std::ostringstream out;
+    writeRequestHeader(out, PIROp::QUERY_PLAIN, table);
+    out.put(static_cast<char>(values.size()));
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(int32_t));
+
+    std::string reply = roundTrip(out.str());
+    uint32_t length = 0;
+    if (reply.size() < sizeof(length)) {
+        throw std::runtime_error("PIRClient: truncated reply");
+    }
+    std::memcpy(&length, reply.data(), sizeof(length));
+    if (reply.size() != sizeof(length) + length) {
+        throw std::runtime_error("PIRClient: truncated reply");
+    }
+    return std::vector<int>(reply.begin() + sizeof(length), reply.end());
+}
@@ -0,0 +1,114 @@
+#include "PIREngine.h"
+#include "GateCircuit.h"
+#include "KeyPlacement.h"
+#include "ScratchPool.h"
+#include "native/HomBB.h"
+#include "native/HomSup.h"
+#include <stdexcept>
+#include <utility>
+
+BuildingBlock buildingBlockOf(const TableSchema& schema) {
+    auto columnsAre = [&](std::vector<ColumnType> types) {
+        if (schema.size() != types.size()) {
+            return false;
+        }
+        for (size_t c = 0; c < types.size(); c++) {
+            if (schema[c].type != types[c]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    const ColumnType COORD = ColumnType::COORDINATE;
+    if (columnsAre({COORD, COORD, COORD, COORD, ColumnType::SERVICE})) {
+        return BuildingBlock::BB1;
+    }
+    if (columnsAre({COORD, COORD, ColumnType::SERVICE})) {
+        return BuildingBlock::BB2;
+    }
+    if (columnsAre({ColumnType::IDENTIFIER, ColumnType::SERVICE})) {
+        return BuildingBlock::BB3;
+    }
+    throw std::invalid_argument("buildingBlockOf: schema matches no building block");
+}
+
+PIREngine::PIREngine(const TFheGateBootstrappingCloudKeySet* bk, EncryptedTable&& table, int num_of_threads,
+                     QuerySchedule schedule)
+    : bk_(bk), table_(std::move(table)), rows_(table_.rows()), block_(buildingBlockOf(table_.schema())),
+      numThreads_(num_of_threads < 1 ? 1 : num_of_threads), schedule_(schedule),
+      pool_(new ThreadPool(numThreads_ - 1)) {}
+
+PIREngine::PIREngine(MappedCloudKey&& key, EncryptedTable&& table, int num_of_threads, QuerySchedule schedule)
+    : PIREngine(key.get(), std::move(table), num_of_threads, schedule) {
+    ownedKey_.reset(new MappedCloudKey(std::move(key)));
+}
+
+CiphertextArray PIREngine::query(const LweSample* enc_x, const LweSample* enc_y, int num_of_threads) const {
+    if (block_ == BuildingBlock::BB3) {
+        throw std::invalid_argument("PIREngine: a BB3 table is queried by identifier");
+    }
+    return run(enc_x, enc_y, num_of_threads);
+}
+
+CiphertextArray PIREngine::query(const LweSample* enc_id, int num_of_threads) const {
+    if (block_ != BuildingBlock::BB3) {
+        throw std::invalid_argument("PIREngine: a BB1/BB2 table is queried by location");
+    }
+    return run(enc_id, nullptr, num_of_threads);
+}
+
+CiphertextArray PIREngine::run(const LweSample* first, const LweSample* second, int num_of_threads) const {
+    const int budget = (num_of_threads <= 0) ? numThreads_ : num_of_threads;
+    const int M = table_.numRecords();
+    const int length = inputLength();
+    const int service = table_.numColumns() - 1;
+    const int lengthService = serviceLength();
+
+    if (schedule_ == QuerySchedule::GATE_GRAPH) {
+        return HomLocPIRGraph(block_, first, second, rows_, length, lengthService, bk_, *pool_, budget);
+    }
+
+    // Validation bit of every record ANDed into its own slot
+    std::vector<CiphertextArray> filtered = newCiphertextArrays(M, lengthService, bk_->params);
+    pool_->parallelFor(0, M, budget, [&](int i) {
+        // On a placed key, read this thread's NUMA replica
+        const TFheGateBootstrappingCloudKeySet* local_bk = localCloudKey(bk_);
+        LweSample* validation_result = acquireScratchArray(1, local_bk->params);
+        const std::vector<LweSample*>& row = rows_[i];
+
+        switch (block_) {
+            case BuildingBlock::BB1:
+                BB1(validation_result, first, second, {row[0], row[1], row[2], row[3]}, length, local_bk);
+                break;
+            case BuildingBlock::BB2:
+                BB2(validation_result, first, second, {row[0], row[1]}, length, local_bk);
+                break;
+            case BuildingBlock::BB3:
+                BB3(validation_result, first, row[0], length, local_bk);
+                break;
+        }
+        HomBitwiseAND(filtered[i].get(), validation_result, row[service], lengthService, local_bk);
+
+        releaseScratchArray(validation_result, 1, local_bk->params);
+    });
+
+    if (M == 0) {
+        CiphertextArray result(lengthService, bk_->params);
+        for (int j = 0; j < lengthService; j++) {
+            bootsCONSTANT(&result[j], 0, bk_);
+        }
+        return result;
+    }
+
+    // XOR tree over the slots, in place; every level is split by record pair and bit
+    for (int k = 1; k < M; k *= 2) {
+        int pairs = (M - k + 2 * k - 1) / (2 * k);
+        pool_->parallelFor(0, pairs * lengthService, budget, [&](int t) {
+            int i = (t / lengthService) * 2 * k;
+            int j = t % lengthService;
+            bootsXOR(&filtered[i][j], &filtered[i][j], &filtered[i + k][j], localCloudKey(bk_));
+        });
+    }
+    return std::move(filtered[0]);
+}
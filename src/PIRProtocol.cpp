@@ -0,0 +1,66 @@
+#include "PIRProtocol.h"
+#include <algorithm>
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// Large frames are received in steps of this, each allocated only once its bytes are due
+const size_t FRAME_CHUNK_BYTES = size_t(1) << 20;
+
+bool writeAll(int fd, const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t written = send(fd, p, bytes, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        p += written;
+        bytes -= written;
+    }
+    return true;
+}
+
+bool readAll(int fd, void* data, size_t bytes) {
+    char* p = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t got = read(fd, p, bytes);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        p += got;
+        bytes -= got;
+    }
+    return true;
+}
+
+} // namespace
+
+bool writeFrame(int fd, const std::string& payload) {
+    uint64_t length = payload.size();
+    return writeAll(fd, &length, sizeof(length)) && writeAll(fd, payload.data(), payload.size());
+}
+
+bool readFrame(int fd, std::string& payload, uint64_t maxBytes) {
+    uint64_t length;
+    if (!readAll(fd, &length, sizeof(length)) || length > maxBytes || length > PIR_MAX_FRAME_BYTES) {
+        return false;
+    }
+    payload.clear();
+    while (payload.size() < length) {
+        size_t at = payload.size();
+        size_t chunk = std::min<uint64_t>(length - at, FRAME_CHUNK_BYTES);
+        payload.resize(at + chunk);
+        if (!readAll(fd, &payload[at], chunk)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,327 @@
+#include "PIRServer.h"
+#include "QueryCodec.h"
+#include "ResponseCodec.h"
+#include "TableFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+PIRServer::PIRServer(const std::string& socketPath, CloudKeyCache& keys,
+                     const TFheGateBootstrappingParameterSet* params, int num_of_threads, int maxConnections)
+    : socketPath_(socketPath), keys_(keys), params_(params), numThreads_(num_of_threads),
+      maxConnections_(maxConnections) {
+    if (maxConnections < 1) {
+        throw std::invalid_argument("PIRServer: need room for at least one connection");
+    }
+}
+
+PIRServer::~PIRServer() {
+    stop();
+}
+
+void PIRServer::checkName(const std::string& name) const {
+    if (listenFd_ >= 0) {
+        throw std::runtime_error("PIRServer: tables are added before start()");
+    }
+    if (name.empty() || name.size() > UINT16_MAX) {
+        throw std::invalid_argument("PIRServer: bad table name");
+    }
+    if (encrypted_.count(name) || plain_.count(name)) {
+        throw std::invalid_argument("PIRServer: table name already in use: " + name);
+    }
+}
+
+void PIRServer::addEncryptedTable(const std::string& name, const std::string& tablePath, const std::string& keyId) {
+    checkName(name);
+    EncryptedEntry entry;
+    entry.key = keys_.acquire(keyId);
+    entry.engine.reset(new PIREngine(entry.key->get(), mapTableFile(tablePath, params_), numThreads_));
+    entry.scheduler.reset(new QueryScheduler(*entry.engine, SchedulerConfig()));
+    encrypted_.emplace(name, std::move(entry));
+}
+
+void PIRServer::addPlainTable(const std::string& name, const std::string& plainPath) {
+    checkName(name);
+    PlainTable table = mapPlainTable(plainPath);
+    buildingBlockOf(table.schema());  // reject tables no circuit can serve
+    plain_.emplace(name, std::move(table));
+}
+
+uint64_t PIRServer::requestBytesLimit() const {
+    // op, both codecs, the name length and the longest name
+    size_t name = 0;
+    for (const auto& entry : encrypted_) {
+        name = std::max(name, entry.first.size());
+    }
+    for (const auto& entry : plain_) {
+        name = std::max(name, entry.first.size());
+    }
+    const uint64_t header = 3 + sizeof(uint16_t) + name;
+
+    // A packing key at the library's gadget: magic, version, four dimensions, then a and b
+    const uint64_t N = params_->tgsw_params->tlwe_params->N;
+    uint64_t body = 6 * 4 + 2 * N * params_->in_out_params->n * PACKING_LEVELS * sizeof(Torus32);
+
+    // Raw queries are the larger form of every encrypted query: count, then count arrays
+    for (const auto& entry : encrypted_) {
+        const PIREngine& engine = *entry.second.engine;
+        const int count = (engine.buildingBlock() == BuildingBlock::BB3) ? 1 : 2;
+        body = std::max<uint64_t>(body, 1 + count * rawCiphertextArrayBytes(engine.inputLength(), params_));
+    }
+    body = std::max<uint64_t>(body, 1 + 2 * sizeof(int32_t));
+    return header + body;
+}
+
+void PIRServer::start() {
+    if (listenFd_ >= 0) {
+        return;
+    }
+    maxRequestBytes_ = requestBytesLimit();
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath_.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("PIRServer: socket path too long: " + socketPath_);
+    }
+    std::memcpy(address.sun_path, socketPath_.c_str(), socketPath_.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error("PIRServer: socket failed");
+    }
+    unlink(socketPath_.c_str());  // a socket left behind by a previous run
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        throw std::runtime_error("PIRServer: cannot listen on " + socketPath_ + ": " + std::strerror(errno));
+    }
+    listenFd_ = fd;
+    stopping_ = false;
+    acceptor_ = std::thread(&PIRServer::acceptLoop, this);
+}
+
+void PIRServer::stop() {
+    if (listenFd_ < 0) {
+        return;
+    }
+    // Wakes the acceptor, whether it waits for a free slot or in accept(), which fails on a
+    // shut down listening socket
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        stopping_ = true;
+    }
+    slotFree_.notify_all();
+    shutdown(listenFd_, SHUT_RDWR);
+    acceptor_.join();
+    close(listenFd_);
+    listenFd_ = -1;
+    unlink(socketPath_.c_str());
+
+    // Connection threads see EOF; a query in flight finishes and its reply is dropped
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        for (auto& connection : connections_) {
+            shutdown(connection.first, SHUT_RDWR);
+            threads.push_back(std::move(connection.second));
+        }
+        connections_.clear();
+        for (std::thread& thread : finished_) {
+            threads.push_back(std::move(thread));
+        }
+        finished_.clear();
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void PIRServer::acceptLoop() {
+    for (;;) {
+        {
+            // Past the cap, clients queue in the listen backlog rather than in threads
+            std::unique_lock<std::mutex> lock(connectionsMutex_);
+            slotFree_.wait(lock, [this] {
+                return stopping_ || connections_.size() < static_cast<size_t>(maxConnections_);
+            });
+            if (stopping_) {
+                return;
+            }
+        }
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (!stopping_ && (errno == EINTR || errno == ECONNABORTED)) {
+                continue;
+            }
+            return;
+        }
+
+        std::vector<std::thread> finished;
+        {
+            // Held while the thread starts, so it cannot retire before it is registered
+            std::lock_guard<std::mutex> lock(connectionsMutex_);
+            connections_[fd] = std::thread(&PIRServer::serveConnection, this, fd);
+            finished.swap(finished_);
+        }
+        for (std::thread& thread : finished) {
+            thread.join();
+        }
+    }
+}
+
+void PIRServer::serveConnection(int fd) {
+    // An oversized frame ends the connection: the stream cannot be resynchronized after it
+    std::unique_ptr<PackingKey> packingKey;
+    std::string request;
+    while (readFrame(fd, request, maxRequestBytes_)) {
+        if (!writeFrame(fd, handle(request, packingKey))) {
+            break;
+        }
+    }
+
+    // Retire: the acceptor (or stop) joins this thread
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        auto connection = connections_.find(fd);
+        if (connection != connections_.end()) {
+            finished_.push_back(std::move(connection->second));
+            connections_.erase(connection);
+        }
+        close(fd);
+    }
+    slotFree_.notify_one();
+}
+
+CiphertextArray PIRServer::queryEncrypted(const std::string& name, PIRQueryCodec codec, std::istream& in,
+                                          size_t bodyBytes) {
+    auto entry = encrypted_.find(name);
+    if (entry == encrypted_.end()) {
+        throw std::invalid_argument("unknown encrypted table: " + name);
+    }
+    const PIREngine& engine = *entry->second.engine;
+    const int expected = (engine.buildingBlock() == BuildingBlock::BB3) ? 1 : 2;
+    const std::string takes = "table " + name + " takes " + std::to_string(expected) + " values of " +
+                              std::to_string(engine.inputLength()) + " bits";
+
+    // Every size is checked against the table before a ciphertext is parsed
+    std::vector<CiphertextArray> values;
+    if (codec == PIRQueryCodec::RAW) {
+        int count = in.get();
+        if (count != expected || bodyBytes != 1 + count * rawCiphertextArrayBytes(engine.inputLength(), params_)) {
+            throw std::invalid_argument(takes);
+        }
+        values = newCiphertextArrays(count, engine.inputLength(), params_);
+        for (CiphertextArray& value : values) {
+            importRawCiphertextArrayFromStream(in, value.get(), engine.inputLength(), params_);
+        }
+    } else if (codec == PIRQueryCodec::SEEDED) {
+        CompressedQuery query = importCompressedQueryFromStream(in);
+        if (in.peek() != std::istream::traits_type::eof() ||
+            query.lengths != std::vector<int32_t>(expected, engine.inputLength())) {
+            throw std::invalid_argument(takes);
+        }
+        values = expandCompressedQuery(query, params_);
+    } else {
+        throw std::invalid_argument("unknown query codec " + std::to_string(static_cast<int>(codec)));
+    }
+
+    QueryTicket ticket = (expected == 2) ? entry->second.scheduler->submit(values[0].get(), values[1].get(), 0)
+                                         : entry->second.scheduler->submit(values[0].get(), 0);
+    if (ticket.status != AdmissionStatus::ADMITTED) {
+        throw std::runtime_error("server busy");
+    }
+    return ticket.result.get();
+}
+
+std::string PIRServer::handle(const std::string& request, std::unique_ptr<PackingKey>& packingKey) {
+    std::ostringstream out;
+    try {
+        std::istringstream in(request);
+        uint8_t op = static_cast<uint8_t>(in.get());
+        PIRQueryCodec queryCodec = static_cast<PIRQueryCodec>(in.get());
+        PIRResponseCodec responseCodec = static_cast<PIRResponseCodec>(in.get());
+        uint16_t nameLength = 0;
+        in.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
+        std::string name(nameLength, '\0');
+        in.read(&name[0], nameLength);
+        if (!in) {
+            throw std::invalid_argument("malformed request");
+        }
+        const size_t bodyBytes = request.size() - static_cast<size_t>(in.tellg());
+
+        if (op == static_cast<uint8_t>(PIROp::SET_PACKING_KEY)) {
+            PackingKey key = importPackingKeyFromStream(in, params_);
+            if (key.basebit != PACKING_BASEBIT || key.levels != PACKING_LEVELS ||
+                in.peek() != std::istream::traits_type::eof()) {
+                throw std::invalid_argument("packing key is not " + std::to_string(PACKING_LEVELS) + " levels of " +
+                                            std::to_string(PACKING_BASEBIT) + " bits");
+            }
+            packingKey.reset(new PackingKey(std::move(key)));
+            return std::string(1, static_cast<char>(PIR_STATUS_OK));  // not a query
+        } else if (op == static_cast<uint8_t>(PIROp::QUERY_ENCRYPTED)) {
+            // Refuse a reply format before spending a query on it
+            if (responseCodec == PIRResponseCodec::PACKED && !packingKey) {
+                throw std::invalid_argument("packed responses need a packing key first");
+            }
+            if (responseCodec != PIRResponseCodec::RAW && responseCodec != PIRResponseCodec::MODULUS_SWITCHED &&
+                responseCodec != PIRResponseCodec::PACKED) {
+                throw std::invalid_argument("unknown response codec " + std::to_string(static_cast<int>(responseCodec)));
+            }
+            CiphertextArray result = queryEncrypted(name, queryCodec, in, bodyBytes);
+
+            uint32_t length = result.length();
+            out.put(static_cast<char>(PIR_STATUS_OK));
+            if (responseCodec == PIRResponseCodec::RAW) {
+                out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                exportRawCiphertextArrayToStream(out, result.get(), length, params_);
+            } else if (responseCodec == PIRResponseCodec::MODULUS_SWITCHED) {
+                exportCompressedResponseToStream(out, compressResponse(result.get(), length, params_));
+            } else {
+                // Outside the scheduler's thread budget, so on this connection's thread only
+                exportPackedResponseToStream(out, packResponse(result.get(), length, *packingKey, 1));
+            }
+        } else if (op == static_cast<uint8_t>(PIROp::QUERY_PLAIN)) {
+            auto entry = plain_.find(name);
+            if (entry == plain_.end()) {
+                throw std::invalid_argument("unknown plaintext table: " + name);
+            }
+            if (queryCodec != PIRQueryCodec::RAW || responseCodec != PIRResponseCodec::RAW) {
+                throw std::invalid_argument("plaintext tables take raw values only");
+            }
+            const PlainTable& table = entry->second;
+            const BuildingBlock block = buildingBlockOf(table.schema());
+            const int expected = (block == BuildingBlock::BB3) ? 1 : 2;
+            int count = in.get();
+            if (count != expected) {
+                throw std::invalid_argument("table " + name + " takes " + std::to_string(expected) + " values");
+            }
+            int32_t values[2] = {0, 0};
+            in.read(reinterpret_cast<char*>(values), count * sizeof(int32_t));
+            if (!in) {
+                throw std::invalid_argument("truncated query");
+            }
+
+            std::vector<int> bits = (block == BuildingBlock::BB1)   ? PlainLocPIRbb1(values[0], values[1], table)
+                                    : (block == BuildingBlock::BB2) ? PlainLocPIRbb2(values[0], values[1], table)
+                                                                    : PlainLocPIRbb3(values[0], table);
+            uint32_t length = bits.size();
+            out.put(static_cast<char>(PIR_STATUS_OK));
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            for (int bit : bits) {
+                out.put(static_cast<char>(bit));
+            }
+        } else {
+            throw std::invalid_argument("unknown operation " + std::to_string(op));
+        }
+    } catch (const std::exception& e) {
+        failed_++;
+        return std::string(1, static_cast<char>(PIR_STATUS_ERROR)) + e.what();
+    }
+    served_++;
+    return out.str();
+}
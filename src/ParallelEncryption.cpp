@@ -0,0 +1,147 @@
+#include "ParallelEncryption.h"
+#include "utils.h"
+#include <exception>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// Stream domains of the table seed
+const uint64_t STREAM_CELL_MASK = uint64_t(1) << 56;  // | record * recordBits + column offset + bit
+const uint64_t STREAM_RECORD_NOISE = uint64_t(2) << 56;  // | record
+
+// Same +-1/8 encoding as bootsSymEncrypt
+const Torus32 MU = 1 << 29;
+
+// Plaintext bits of an integer, LSB first as in encryptBooleanTo
+void integerBits(int32_t value, std::vector<int32_t>& bits) {
+    for (size_t j = 0; j < bits.size(); j++) {
+        bits[j] = (value >> j) & 1;
+    }
+}
+
+// Plaintext bits of a service string, in string order as in encryptBinaryStringTo
+void serviceBits(const std::string& text, std::vector<int32_t>& bits) {
+    std::string binaryString = textToBinaryString(text, static_cast<int>(bits.size()));
+    for (size_t j = 0; j < bits.size(); j++) {
+        bits[j] = binaryString[j] - '0';
+    }
+}
+
+} // namespace
+
+void encryptIntoTable(EncryptedTable& table, const CellEncoder& encode,
+                      const TFheGateBootstrappingSecretKeySet* key, const MaskSeed& seed,
+                      int num_of_threads, int64_t firstRecord) {
+    if (table.isMapped()) {
+        throw std::invalid_argument("encryptIntoTable: mapped tables are read-only");
+    }
+    const LweParams* lwe = key->params->in_out_params;
+    const int n = lwe->n;
+    const double alpha = lwe->alpha_min;
+    const int M = table.numRecords();
+
+    // Every bit of a record gets its own mask stream
+    std::vector<uint64_t> columnOffset(table.numColumns());
+    uint64_t recordBits = 0;
+    for (int c = 0; c < table.numColumns(); c++) {
+        columnOffset[c] = recordBits;
+        recordBits += table.schema()[c].bits;
+    }
+
+    std::exception_ptr failure;
+    #pragma omp parallel for num_threads(num_of_threads) schedule(dynamic, 16)
+    for (int i = 0; i < M; i++) {
+        try {
+            const uint64_t record = static_cast<uint64_t>(firstRecord + i);
+            std::mt19937_64 noise = seededNoise(seed, STREAM_RECORD_NOISE | record);
+            std::normal_distribution<double> gaussian(0., alpha);
+            std::vector<int32_t> bits;
+            for (int c = 0; c < table.numColumns(); c++) {
+                bits.assign(table.schema()[c].bits, 0);
+                encode(i, c, bits);
+
+                LweSample* cell = table.mutableCell(i, c);
+                for (size_t j = 0; j < bits.size(); j++) {
+                    LweSample* sample = &cell[j];
+                    uint64_t stream = record * recordBits + columnOffset[c] + j;
+                    expandMask(sample->a, n, seed, STREAM_CELL_MASK | stream);
+
+                    // b = <a, s> + mu + e, wrapping like Torus32 arithmetic
+                    uint32_t body = static_cast<uint32_t>(bits[j] ? MU : -MU);
+                    body += static_cast<uint32_t>(dtot32(gaussian(noise)));
+                    for (int k = 0; k < n; k++) {
+                        body += static_cast<uint32_t>(sample->a[k]) * static_cast<uint32_t>(key->lwe_key->key[k]);
+                    }
+                    sample->b = static_cast<Torus32>(body);
+                    sample->current_variance = alpha * alpha;
+                }
+            }
+        } catch (...) {
+            #pragma omp critical(encryptIntoTable)
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+EncryptedTable encryptTableParallel(const std::vector<std::vector<int32_t>>& encodedDB,
+                                    int inputLength, int serviceLength,
+                                    const TFheGateBootstrappingParameterSet* params,
+                                    const TFheGateBootstrappingSecretKeySet* key,
+                                    const MaskSeed& seed, int num_of_threads,
+                                    TableLayout layout) {
+    EncryptedTable table(schemaBB1(inputLength, serviceLength), encodedDB.size(), params, layout);
+    for (const std::vector<int32_t>& row : encodedDB) {
+        if (row.size() != static_cast<size_t>(table.numColumns())) {
+            throw std::invalid_argument("encryptTableParallel: row does not match the BB1 schema");
+        }
+    }
+
+    encryptIntoTable(table, [&](int record, int column, std::vector<int32_t>& bits) {
+        integerBits(encodedDB[record][column], bits);
+    }, key, seed, num_of_threads);
+    return table;
+}
+
+EncryptedTable encryptTableBB2Parallel(const std::vector<std::vector<std::string>>& data,
+                                       int inputLength, int serviceLength,
+                                       const TFheGateBootstrappingParameterSet* params,
+                                       const TFheGateBootstrappingSecretKeySet* key,
+                                       const MaskSeed& seed, int num_of_threads,
+                                       TableLayout layout) {
+    EncryptedTable table(schemaBB2(inputLength, serviceLength), data.size(), params, layout);
+
+    // x and y coordinates as fixed-point values, then the service text
+    encryptIntoTable(table, [&](int record, int column, std::vector<int32_t>& bits) {
+        if (column < 2) {
+            integerBits(encodeDouble(inputLength, std::stod(data[record][column])), bits);
+        } else {
+            serviceBits(data[record][2], bits);
+        }
+    }, key, seed, num_of_threads);
+    return table;
+}
+
+EncryptedTable encryptTableBB3Parallel(const std::vector<std::vector<std::string>>& data,
+                                       int inputLength, int serviceLength,
+                                       const TFheGateBootstrappingParameterSet* params,
+                                       const TFheGateBootstrappingSecretKeySet* key,
+                                       const MaskSeed& seed, int num_of_threads,
+                                       TableLayout layout) {
+    EncryptedTable table(schemaBB3(inputLength, serviceLength), data.size(), params, layout);
+
+    // The identifier is the record index, as in encryptDBbb3
+    encryptIntoTable(table, [&](int record, int column, std::vector<int32_t>& bits) {
+        if (column == 0) {
+            integerBits(record, bits);
+        } else {
+            serviceBits(data[record][1], bits);
+        }
+    }, key, seed, num_of_threads);
+    return table;
+}
@@ -0,0 +1,379 @@
+#include "PlainTable.h"
+#include "ParallelEncryption.h"
+#include "TableFile.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t BLOCK_ALIGNMENT = 64;  // one cache line
+
+// Records encoded per readCsvBatch call during conversion
+const int CONVERT_BATCH = 4096;
+
+int wordsFor(int bits) {
+    return (bits + 63) / 64;
+}
+
+uint64_t alignUp(uint64_t offset) {
+    return (offset + PLAIN_TABLE_ALIGNMENT - 1) / PLAIN_TABLE_ALIGNMENT * PLAIN_TABLE_ALIGNMENT;
+}
+
+// Whether records * words 64-bit words starting at offset fit in a file of `bytes` bytes,
+// without the multiplication overflowing for forged header values
+bool blockFits(uint64_t offset, uint64_t records, uint64_t words, uint64_t bytes) {
+    if (offset > bytes) {
+        return false;
+    }
+    if (records == 0 || words == 0) {
+        return true;
+    }
+    uint64_t available = (bytes - offset) / sizeof(uint64_t);
+    return words <= available && records <= available / words;
+}
+
+// Bit i of a query value, LSB first as encrypted by encryptBooleanTo
+int queryBit(int32_t value, int i) {
+    return (value >> i) & 1;
+}
+
+// The comparison circuits of HomComp.cpp on cleartext: cell(record, column) against `value`
+int plainCompLE(const PlainTable& table, int64_t record, int column, int32_t value, bool cellFirst) {
+    const int length = table.schema()[column].bits;
+    auto a = [&](int i) { return cellFirst ? table.bit(record, column, i) : queryBit(value, i); };
+    auto b = [&](int i) { return cellFirst ? queryBit(value, i) : table.bit(record, column, i); };
+    int result = 1;
+    for (int i = 0; i < length - 1; i++) {
+        if (a(i) != b(i)) {
+            result = b(i);
+        }
+    }
+    return (a(length - 1) != b(length - 1)) ? a(length - 1) : result;
+}
+
+int plainCompL(const PlainTable& table, int64_t record, int column, int32_t value, bool cellFirst) {
+    const int length = table.schema()[column].bits;
+    auto a = [&](int i) { return cellFirst ? table.bit(record, column, i) : queryBit(value, i); };
+    auto b = [&](int i) { return cellFirst ? queryBit(value, i) : table.bit(record, column, i); };
+    int result = 0;
+    for (int i = 0; i < length - 1; i++) {
+        if (a(i) != b(i)) {
+            result = b(i);
+        }
+    }
+    return (a(length - 1) != b(length - 1)) ? a(length - 1) : result;
+}
+
+int plainEqui(const PlainTable& table, int64_t record, int column, int32_t value) {
+    for (int i = 0; i < table.schema()[column].bits; i++) {
+        if (table.bit(record, column, i) != queryBit(value, i)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// HomBitwiseAND + HomSum: XOR of the service cells of every record that passes `valid`
+template <typename Predicate>
+std::vector<int> plainSelect(const PlainTable& table, int expectedColumns, const char* name, Predicate valid) {
+    if (table.numColumns() != expectedColumns) {
+        throw std::invalid_argument(std::string(name) + ": table does not have the building block's schema");
+    }
+    const int service = expectedColumns - 1;
+    std::vector<uint64_t> sum(table.wordsPerCell(service), 0);
+    for (int64_t i = 0; i < table.numRecords(); i++) {
+        if (valid(i)) {
+            const uint64_t* cell = table.cellWords(i, service);
+            for (size_t w = 0; w < sum.size(); w++) {
+                sum[w] ^= cell[w];
+            }
+        }
+    }
+
+    std::vector<int> bits(table.schema()[service].bits);
+    for (size_t j = 0; j < bits.size(); j++) {
+        bits[j] = (sum[j / 64] >> (j % 64)) & 1;
+    }
+    return bits;
+}
+
+} // namespace
+
+PlainTable::PlainTable(const TableSchema& schema, int64_t numRecords)
+    : schema_(schema), numRecords_(numRecords) {
+    for (const ColumnSpec& spec : schema_) {
+        words_.push_back(wordsFor(spec.bits));
+        size_t bytes = static_cast<size_t>(numRecords_) * words_.back() * sizeof(uint64_t);
+        size_t rounded = (bytes + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+        void* block = std::aligned_alloc(BLOCK_ALIGNMENT, rounded == 0 ? BLOCK_ALIGNMENT : rounded);
+        if (block == nullptr) {
+            release();
+            throw std::bad_alloc();
+        }
+        std::memset(block, 0, bytes);
+        columns_.push_back(static_cast<uint64_t*>(block));
+    }
+}
+
+PlainTable::PlainTable(const TableSchema& schema, int64_t numRecords, const std::vector<uint64_t*>& blocks,
+                       void* mapping, size_t mappingBytes)
+    : schema_(schema), numRecords_(numRecords), columns_(blocks),
+      mapping_(mapping), mappingBytes_(mappingBytes) {
+    for (const ColumnSpec& spec : schema_) {
+        words_.push_back(wordsFor(spec.bits));
+    }
+}
+
+PlainTable::~PlainTable() {
+    release();
+}
+
+PlainTable::PlainTable(PlainTable&& other) noexcept
+    : schema_(std::move(other.schema_)), numRecords_(other.numRecords_), words_(std::move(other.words_)),
+      columns_(std::move(other.columns_)), mapping_(other.mapping_), mappingBytes_(other.mappingBytes_) {
+    other.columns_.clear();
+    other.numRecords_ = 0;
+    other.mapping_ = nullptr;
+    other.mappingBytes_ = 0;
+}
+
+PlainTable& PlainTable::operator=(PlainTable&& other) noexcept {
+    if (this != &other) {
+        release();
+        schema_ = std::move(other.schema_);
+        numRecords_ = other.numRecords_;
+        words_ = std::move(other.words_);
+        columns_ = std::move(other.columns_);
+        mapping_ = other.mapping_;
+        mappingBytes_ = other.mappingBytes_;
+        other.columns_.clear();
+        other.numRecords_ = 0;
+        other.mapping_ = nullptr;
+        other.mappingBytes_ = 0;
+    }
+    return *this;
+}
+
+void PlainTable::release() {
+    if (mapping_) {
+        munmap(mapping_, mappingBytes_);
+        mapping_ = nullptr;
+        mappingBytes_ = 0;
+    } else {
+        for (uint64_t* block : columns_) {
+            std::free(block);
+        }
+    }
+    columns_.clear();
+}
+
+void PlainTable::cellBits(int64_t record, int column, int32_t* bits) const {
+    const uint64_t* words = cellWords(record, column);
+    for (int j = 0; j < schema_[column].bits; j++) {
+        bits[j] = (words[j / 64] >> (j % 64)) & 1;
+    }
+}
+
+void PlainTable::setCell(int64_t record, int column, const int32_t* bits) {
+    if (isMapped()) {
+        throw std::logic_error("PlainTable: mapped tables are read-only");
+    }
+    uint64_t* words = columns_[column] + record * words_[column];
+    std::memset(words, 0, words_[column] * sizeof(uint64_t));
+    for (int j = 0; j < schema_[column].bits; j++) {
+        words[j / 64] |= static_cast<uint64_t>(bits[j] & 1) << (j % 64);
+    }
+}
+
+PlainTable encodeCsvToPlainTable(const std::string& csvPath, const CsvSchema& schema) {
+    int64_t records = CsvReader(csvPath, schema.delimiter, schema.header).countRemaining();
+    PlainTable table(schema.table, records);
+
+    CsvReader reader(csvPath, schema.delimiter, schema.header);
+    const int recordBits = csvRecordBits(schema);
+    std::vector<int32_t> bits;
+    int64_t record = 0;
+    while (int count = readCsvBatch(reader, schema, CONVERT_BATCH, bits)) {
+        if (record + count > records) {
+            throw std::runtime_error("encodeCsvToPlainTable: " + csvPath + " changed while reading");
+        }
+        for (int i = 0; i < count; i++, record++) {
+            const int32_t* source = bits.data() + static_cast<size_t>(i) * recordBits;
+            for (int c = 0; c < table.numColumns(); c++) {
+                table.setCell(record, c, source);
+                source += schema.table[c].bits;
+            }
+        }
+    }
+    return table;
+}
+
+void writePlainTable(const std::string& path, const PlainTable& table) {
+    const TableSchema& schema = table.schema();
+
+    PlainTableHeader header = {};
+    header.magic = PLAIN_TABLE_MAGIC;
+    header.version = PLAIN_TABLE_VERSION;
+    header.numRecords = table.numRecords();
+    header.numColumns = schema.size();
+
+    std::vector<PlainTableColumn> directory(schema.size());
+    uint64_t offset = sizeof(PlainTableHeader) + schema.size() * sizeof(PlainTableColumn);
+    for (size_t c = 0; c < schema.size(); c++) {
+        if (schema[c].name.size() >= PLAIN_TABLE_NAME_BYTES) {
+            throw std::invalid_argument("writePlainTable: column name too long: " + schema[c].name);
+        }
+        PlainTableColumn& entry = directory[c];
+        std::memset(&entry, 0, sizeof(entry));
+        std::memcpy(entry.name, schema[c].name.c_str(), schema[c].name.size());
+        entry.type = static_cast<uint32_t>(schema[c].type);
+        entry.bits = schema[c].bits;
+        entry.words = table.wordsPerCell(c);
+        entry.offset = alignUp(offset);
+        offset = entry.offset + static_cast<uint64_t>(table.numRecords()) * entry.words * sizeof(uint64_t);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("writePlainTable: cannot open " + path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(directory.data()), directory.size() * sizeof(PlainTableColumn));
+
+    static const char zeros[PLAIN_TABLE_ALIGNMENT] = {};
+    for (size_t c = 0; c < schema.size(); c++) {
+        out.write(zeros, directory[c].offset - static_cast<uint64_t>(out.tellp()));
+        out.write(reinterpret_cast<const char*>(table.cellWords(0, c)),
+                  static_cast<uint64_t>(table.numRecords()) * directory[c].words * sizeof(uint64_t));
+    }
+    if (!out) {
+        throw std::runtime_error("writePlainTable: write failed for " + path);
+    }
+}
+
+PlainTable mapPlainTable(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("mapPlainTable: cannot open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(PlainTableHeader)) {
+        close(fd);
+        throw std::runtime_error("mapPlainTable: not a plaintext table: " + path);
+    }
+
+    size_t bytes = info.st_size;
+    void* mapping = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // the mapping keeps the file referenced
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("mapPlainTable: mmap failed for " + path);
+    }
+
+    const char* base = static_cast<const char*>(mapping);
+    const PlainTableHeader* header = reinterpret_cast<const PlainTableHeader*>(base);
+    auto fail = [&](const std::string& reason) {
+        munmap(mapping, bytes);
+        throw std::runtime_error("mapPlainTable: " + reason + ": " + path);
+    };
+
+    if (header->magic != PLAIN_TABLE_MAGIC || header->version != PLAIN_TABLE_VERSION) {
+        fail("bad magic or version");
+    }
+    if (header->numColumns > (bytes - sizeof(PlainTableHeader)) / sizeof(PlainTableColumn)) {
+        fail("truncated directory");
+    }
+    if (header->numRecords > static_cast<uint64_t>(INT64_MAX)) {
+        fail("record count out of range");
+    }
+
+    const PlainTableColumn* directory = reinterpret_cast<const PlainTableColumn*>(base + sizeof(PlainTableHeader));
+    TableSchema schema;
+    std::vector<uint64_t*> blocks;
+    for (uint32_t c = 0; c < header->numColumns; c++) {
+        const PlainTableColumn& entry = directory[c];
+        if (entry.type > static_cast<uint32_t>(ColumnType::SERVICE) || entry.bits < 1 ||
+            entry.bits > static_cast<uint32_t>(INT_MAX) || entry.words != static_cast<uint32_t>(wordsFor(entry.bits))) {
+            fail("bad column description");
+        }
+        // Cells are read as 64-bit words in place
+        if (entry.offset % sizeof(uint64_t) != 0) {
+            fail("misaligned column block");
+        }
+        if (!blockFits(entry.offset, header->numRecords, entry.words, bytes)) {
+            fail("truncated column block");
+        }
+        schema.push_back({std::string(entry.name, strnlen(entry.name, PLAIN_TABLE_NAME_BYTES)),
+                          static_cast<ColumnType>(entry.type), static_cast<int>(entry.bits)});
+        // Read-only mapping: setCell refuses mapped tables
+        blocks.push_back(reinterpret_cast<uint64_t*>(const_cast<char*>(base + entry.offset)));
+    }
+
+    return PlainTable(schema, header->numRecords, blocks, mapping, bytes);
+}
+
+EncryptedTable encryptPlainTable(const PlainTable& plain,
+                                 const TFheGateBootstrappingParameterSet* params,
+                                 const TFheGateBootstrappingSecretKeySet* key,
+                                 const MaskSeed& seed, int num_of_threads,
+                                 TableLayout layout) {
+    if (plain.numRecords() > INT_MAX) {
+        throw std::invalid_argument("encryptPlainTable: too many records for one table");
+    }
+    EncryptedTable table(plain.schema(), static_cast<int>(plain.numRecords()), params, layout);
+    encryptIntoTable(table, [&](int record, int column, std::vector<int32_t>& bits) {
+        plain.cellBits(record, column, bits.data());
+    }, key, seed, num_of_threads);
+    return table;
+}
+
+void encryptPlainTableToFile(const PlainTable& plain, const std::string& tablePath,
+                             const TFheGateBootstrappingParameterSet* params,
+                             const TFheGateBootstrappingSecretKeySet* key,
+                             const MaskSeed& seed, int num_of_threads, int batchRecords) {
+    if (batchRecords <= 0 || plain.numRecords() > INT_MAX) {
+        throw std::invalid_argument("encryptPlainTableToFile: bad batch size or too many records");
+    }
+    TableFileWriter writer(tablePath, plain.schema(), static_cast<int>(plain.numRecords()), params);
+
+    std::unique_ptr<EncryptedTable> batch;
+    for (int64_t first = 0; first < plain.numRecords(); first += batchRecords) {
+        int count = static_cast<int>(std::min<int64_t>(batchRecords, plain.numRecords() - first));
+        if (!batch || batch->numRecords() != count) {
+            batch.reset(new EncryptedTable(plain.schema(), count, params));
+        }
+        encryptIntoTable(*batch, [&](int record, int column, std::vector<int32_t>& bits) {
+            plain.cellBits(first + record, column, bits.data());
+        }, key, seed, num_of_threads, first);
+        writer.append(*batch);
+    }
+    writer.finish();
+}
+
+std::vector<int> PlainLocPIRbb1(int32_t x, int32_t y, const PlainTable& table) {
+    return plainSelect(table, 5, "PlainLocPIRbb1", [&](int64_t i) {
+        return plainCompLE(table, i, 0, x, true) && plainCompL(table, i, 1, x, false) &&
+               plainCompLE(table, i, 2, y, true) && plainCompL(table, i, 3, y, false);
+    });
+}
+
+std::vector<int> PlainLocPIRbb2(int32_t x, int32_t y, const PlainTable& table) {
+    return plainSelect(table, 3, "PlainLocPIRbb2", [&](int64_t i) {
+        return plainEqui(table, i, 0, x) && plainEqui(table, i, 1, y);
+    });
+}
+
+std::vector<int> PlainLocPIRbb3(int32_t id, const PlainTable& table) {
+    return plainSelect(table, 2, "PlainLocPIRbb3", [&](int64_t i) {
+        return plainEqui(table, i, 0, id);
+    });
+}
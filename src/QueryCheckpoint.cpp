@@ -0,0 +1,206 @@
+#include "QueryCheckpoint.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include "AutoTuner.h"
+#include "Ciphertext.h"
+
+namespace {
+
+uint64_t fnv1a(uint64_t hash, const void* data, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i++) {
+        hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t hashQuery(const LweSample* samples, int count, int n, uint64_t hash) {
+    for (int j = 0; j < count; j++) {
+        hash = fnv1a(hash, samples[j].a, n * sizeof(Torus32));
+        hash = fnv1a(hash, &samples[j].b, sizeof(Torus32));
+    }
+    return hash;
+}
+
+// Identity of the table contents: every body of every cell, in record order. A table that
+// was re-encrypted or updated, even with the same shape, has fresh bodies. Masks are skipped,
+// so this reads 4 bytes per bit rather than the whole table.
+uint64_t hashTable(const std::vector<std::vector<LweSample*>>& enc_database, int inputLength, int serviceLength) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const std::vector<LweSample*>& row : enc_database) {
+        for (size_t c = 0; c < row.size(); c++) {
+            const int bits = (c + 1 == row.size()) ? serviceLength : inputLength;
+            for (int j = 0; j < bits; j++) {
+                hash = fnv1a(hash, &row[c][j].b, sizeof(Torus32));
+            }
+        }
+    }
+    return hash;
+}
+
+void writeAll(int fd, const void* data, size_t bytes, const std::string& path) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t written = write(fd, p, bytes);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            throw std::runtime_error("HomLocPIRResumable: write failed for " + path);
+        }
+        p += written;
+        bytes -= written;
+    }
+}
+
+// Durable before visible: the temporary file is synced, renamed over the old checkpoint, and
+// the directory is synced so the rename itself survives a crash
+void saveCheckpoint(const std::string& path, const QueryCheckpointHeader& header, const LweSample* partial) {
+    const std::string temporary = path + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("HomLocPIRResumable: cannot open " + temporary);
+    }
+    try {
+        writeAll(fd, &header, sizeof(header), temporary);
+        for (uint32_t j = 0; j < header.serviceLength; j++) {
+            writeAll(fd, partial[j].a, header.n * sizeof(Torus32), temporary);
+            writeAll(fd, &partial[j].b, sizeof(Torus32), temporary);
+            writeAll(fd, &partial[j].current_variance, sizeof(double), temporary);
+        }
+        if (fsync(fd) != 0) {
+            throw std::runtime_error("HomLocPIRResumable: fsync failed for " + temporary);
+        }
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("HomLocPIRResumable: cannot replace " + path);
+    }
+
+    size_t slash = path.rfind('/');
+    const std::string directory = (slash == std::string::npos) ? "." : (slash == 0) ? "/" : path.substr(0, slash);
+    int dirFd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd < 0) {
+        throw std::runtime_error("HomLocPIRResumable: cannot open " + directory);
+    }
+    int synced = fsync(dirFd);
+    close(dirFd);
+    if (synced != 0) {
+        throw std::runtime_error("HomLocPIRResumable: fsync failed for " + directory);
+    }
+}
+
+// False if there is no checkpoint. With `expected`, the header must match it (nextRecord
+// aside) before the partial sum is read into `partial`, which holds expected->serviceLength
+// samples of dimension expected->n; without, only the header is read.
+bool loadCheckpoint(const std::string& path, QueryCheckpointHeader& header,
+                    const QueryCheckpointHeader* expected, LweSample* partial) {
+    FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        return false;
+    }
+    if (std::fread(&header, sizeof(header), 1, in) != 1 ||
+        header.magic != QUERY_CHECKPOINT_MAGIC || header.version != QUERY_CHECKPOINT_VERSION) {
+        std::fclose(in);
+        throw std::runtime_error("HomLocPIRResumable: truncated or foreign checkpoint " + path);
+    }
+    if (!expected) {
+        std::fclose(in);
+        return true;
+    }
+    if (header.n != expected->n || header.block != expected->block || header.numRecords != expected->numRecords ||
+        header.inputLength != expected->inputLength || header.serviceLength != expected->serviceLength ||
+        header.queryHash != expected->queryHash || header.tableHash != expected->tableHash ||
+        header.nextRecord > expected->numRecords) {
+        std::fclose(in);
+        throw std::runtime_error("HomLocPIRResumable: checkpoint " + path + " belongs to another query or table");
+    }
+
+    bool complete = true;
+    for (uint32_t j = 0; complete && j < expected->serviceLength; j++) {
+        complete = std::fread(partial[j].a, sizeof(Torus32), expected->n, in) == expected->n &&
+                   std::fread(&partial[j].b, sizeof(Torus32), 1, in) == 1 &&
+                   std::fread(&partial[j].current_variance, sizeof(double), 1, in) == 1;
+    }
+    std::fclose(in);
+    if (!complete) {
+        throw std::runtime_error("HomLocPIRResumable: truncated or foreign checkpoint " + path);
+    }
+    return true;
+}
+
+} // namespace
+
+int queryCheckpointProgress(const std::string& path) {
+    QueryCheckpointHeader header;
+    return loadCheckpoint(path, header, nullptr, nullptr) ? static_cast<int>(header.nextRecord) : -1;
+}
+
+LweSample* HomLocPIRResumable(BuildingBlock block, const LweSample* first, const LweSample* second,
+                              const std::vector<std::vector<LweSample*>>& enc_database,
+                              int inputLength, int serviceLength,
+                              const TFheGateBootstrappingCloudKeySet* bk, const ThreadPartition& partition,
+                              const CheckpointConfig& config) {
+    const int M = enc_database.size();
+    const int n = bk->params->in_out_params->n;
+    if (M == 0) {
+        return HomLocPIRPartitioned(block, first, second, enc_database, inputLength, serviceLength, bk, partition);
+    }
+    if (config.chunkRecords <= 0) {
+        throw std::invalid_argument("HomLocPIRResumable: chunkRecords must be positive");
+    }
+
+    QueryCheckpointHeader expected = {};
+    expected.magic = QUERY_CHECKPOINT_MAGIC;
+    expected.version = QUERY_CHECKPOINT_VERSION;
+    expected.n = n;
+    expected.block = static_cast<uint32_t>(block);
+    expected.numRecords = M;
+    expected.inputLength = inputLength;
+    expected.serviceLength = serviceLength;
+    expected.tableHash = hashTable(enc_database, inputLength, serviceLength);
+    expected.queryHash = hashQuery(first, inputLength, n, 14695981039346656037ULL);
+    if (block != BuildingBlock::BB3) {
+        expected.queryHash = hashQuery(second, inputLength, n, expected.queryHash);
+    }
+
+    CiphertextArray partial(serviceLength, bk->params);
+    QueryCheckpointHeader header = expected;
+    loadCheckpoint(config.path, header, &expected, partial.get());
+
+    int chunks = 0;
+    while (static_cast<int>(header.nextRecord) < M) {
+        if (config.maxChunks > 0 && chunks == config.maxChunks) {
+            return nullptr;
+        }
+        const int begin = header.nextRecord;
+        const int end = std::min(M, begin + config.chunkRecords);
+        std::vector<std::vector<LweSample*>> chunk(enc_database.begin() + begin, enc_database.begin() + end);
+        CiphertextArray sum = CiphertextArray::adopt(
+            HomLocPIRPartitioned(block, first, second, chunk, inputLength, serviceLength, bk, partition), serviceLength);
+
+        // The first chunk's sum is the partial sum; later ones are folded in
+        if (begin == 0) {
+            std::swap(partial, sum);
+        } else {
+            for (int j = 0; j < serviceLength; j++) {
+                bootsXOR(&partial[j], &partial[j], &sum[j], bk);
+            }
+        }
+        header.nextRecord = end;
+        chunks++;
+        if (end < M) {
+            saveCheckpoint(config.path, header, partial.get());
+        }
+    }
+
+    std::remove(config.path.c_str());
+    return partial.release();
+}
@@ -0,0 +1,188 @@
+#include "QueryCodec.h"
+#include <istream>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const uint32_t QUERY_MAGIC = 0x51524950;  // "PIRQ"
+const uint32_t QUERY_VERSION = 1;
+const uint32_t QUERY_MAX_BITS = 32;  // values are int32_t
+
+// Bytes left in a seekable stream, or -1 when it cannot tell (a pipe or socket)
+int64_t remainingBytes(std::istream& in) {
+    std::istream::pos_type here = in.tellg();
+    if (here == std::istream::pos_type(-1)) {
+        in.clear();
+        return -1;
+    }
+    in.seekg(0, std::ios::end);
+    std::istream::pos_type end = in.tellg();
+    in.seekg(here);
+    if (end == std::istream::pos_type(-1) || !in) {
+        in.clear();
+        in.seekg(here);
+        return -1;
+    }
+    return static_cast<int64_t>(end - here);
+}
+
+// Each value gets its own 2^32 block of mask streams
+uint64_t queryStream(int value, int bit) {
+    return (static_cast<uint64_t>(value) << 32) | static_cast<uint32_t>(bit);
+}
+
+void writeU32(std::ostream& out, uint32_t v) {
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>(v), static_cast<unsigned char>(v >> 8),
+        static_cast<unsigned char>(v >> 16), static_cast<unsigned char>(v >> 24)
+    };
+    out.write(reinterpret_cast<const char*>(bytes), 4);
+}
+
+uint32_t readU32(std::istream& in) {
+    unsigned char bytes[4];
+    if (!in.read(reinterpret_cast<char*>(bytes), 4)) {
+        throw std::runtime_error("Truncated compressed query");
+    }
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+} // namespace
+
+CompressedQuery encryptCompressedQuery(const std::vector<int32_t>& values, int length,
+                                       const TFheGateBootstrappingSecretKeySet* key) {
+    CompressedQuery query;
+    query.seed = randomMaskSeed();
+    std::mt19937_64 noise = randomNoise();
+
+    for (size_t v = 0; v < values.size(); v++) {
+        query.lengths.push_back(length);
+        for (int j = 0; j < length; j++) {
+            query.bodies.push_back(seededSymEncrypt((values[v] >> j) & 1, query.seed, queryStream(v, j), key, noise));
+        }
+    }
+
+    return query;
+}
+
+std::vector<CiphertextArray> expandCompressedQuery(const CompressedQuery& query,
+                                                   const TFheGateBootstrappingParameterSet* params) {
+    size_t totalBits = 0;
+    for (int32_t length : query.lengths) {
+        if (length < 1 || length > static_cast<int32_t>(QUERY_MAX_BITS)) {
+            throw std::invalid_argument("expandCompressedQuery: bad value length " + std::to_string(length));
+        }
+        totalBits += length;
+    }
+    if (totalBits != query.bodies.size()) {
+        throw std::invalid_argument("expandCompressedQuery: lengths do not match the bodies");
+    }
+
+    std::vector<CiphertextArray> ciphertexts;
+    size_t offset = 0;
+
+    for (size_t v = 0; v < query.lengths.size(); v++) {
+        int length = query.lengths[v];
+        CiphertextArray ciphertext(length, params);
+        for (int j = 0; j < length; j++) {
+            expandSample(&ciphertext[j], query.bodies[offset + j], query.seed, queryStream(v, j), params);
+        }
+        offset += length;
+        ciphertexts.push_back(std::move(ciphertext));
+    }
+
+    return ciphertexts;
+}
+
+void exportCompressedQueryToStream(std::ostream& out, const CompressedQuery& query) {
+    writeU32(out, QUERY_MAGIC);
+    writeU32(out, QUERY_VERSION);
+    for (uint32_t word : query.seed.words) {
+        writeU32(out, word);
+    }
+    writeU32(out, query.lengths.size());
+    for (int32_t length : query.lengths) {
+        writeU32(out, length);
+    }
+    for (Torus32 body : query.bodies) {
+        writeU32(out, static_cast<uint32_t>(body));
+    }
+}
+
+CompressedQuery importCompressedQueryFromStream(std::istream& in) {
+    if (readU32(in) != QUERY_MAGIC || readU32(in) != QUERY_VERSION) {
+        throw std::runtime_error("Not a compressed query (bad magic or version)");
+    }
+
+    CompressedQuery query;
+    for (uint32_t& word : query.seed.words) {
+        word = readU32(in);
+    }
+
+    // Sizes come from the client: check them before anything is allocated from them
+    uint32_t count = readU32(in);
+    int64_t remaining = remainingBytes(in);
+    if (remaining >= 0 && count > static_cast<uint64_t>(remaining) / 4) {
+        throw std::runtime_error("Compressed query claims more values than it holds");
+    }
+    size_t totalBits = 0;
+    for (uint32_t v = 0; v < count; v++) {
+        uint32_t length = readU32(in);
+        if (length < 1 || length > QUERY_MAX_BITS) {
+            throw std::runtime_error("Compressed query value length out of range: " + std::to_string(length));
+        }
+        query.lengths.push_back(static_cast<int32_t>(length));
+        totalBits += length;
+    }
+    if (remaining >= 0 && totalBits > (static_cast<uint64_t>(remaining) - 4ULL * count) / 4) {
+        throw std::runtime_error("Truncated compressed query");
+    }
+    query.bodies.reserve(totalBits);
+    for (size_t i = 0; i < totalBits; i++) {
+        query.bodies.push_back(static_cast<Torus32>(readU32(in)));
+    }
+
+    return query;
+}
+
+void exportCiphertextArrayToStream(std::ostream& out, const LweSample* ciphertext, int length,
+                                   const TFheGateBootstrappingParameterSet* params) {
+    for (int i = 0; i < length; i++) {
+        export_gate_bootstrapping_ciphertext_toStream(out, &ciphertext[i], params);
+    }
+}
+
+void importCiphertextArrayFromStream(std::istream& in, LweSample* ciphertext, int length,
+                                     const TFheGateBootstrappingParameterSet* params) {
+    for (int i = 0; i < length; i++) {
+        import_gate_bootstrapping_ciphertext_fromStream(in, &ciphertext[i], params);
+    }
+}
+
+size_t rawCiphertextArrayBytes(int length, const TFheGateBootstrappingParameterSet* params) {
+    return static_cast<size_t>(length) * (params->in_out_params->n + 1) * sizeof(Torus32);
+}
+
+void exportRawCiphertextArrayToStream(std::ostream& out, const LweSample* ciphertext, int length,
+                                      const TFheGateBootstrappingParameterSet* params) {
+    const int n = params->in_out_params->n;
+    for (int i = 0; i < length; i++) {
+        out.write(reinterpret_cast<const char*>(ciphertext[i].a), n * sizeof(Torus32));
+        out.write(reinterpret_cast<const char*>(&ciphertext[i].b), sizeof(Torus32));
+    }
+}
+
+void importRawCiphertextArrayFromStream(std::istream& in, LweSample* ciphertext, int length,
+                                        const TFheGateBootstrappingParameterSet* params) {
+    const int n = params->in_out_params->n;
+    for (int i = 0; i < length; i++) {
+        if (!in.read(reinterpret_cast<char*>(ciphertext[i].a), n * sizeof(Torus32)) ||
+            !in.read(reinterpret_cast<char*>(&ciphertext[i].b), sizeof(Torus32))) {
+            throw std::runtime_error("Truncated ciphertext array");
+        }
+        ciphertext[i].current_variance = 0.;
+    }
+}
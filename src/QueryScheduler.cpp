@@ -0,0 +1,230 @@
+#include "QueryScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+const double HISTOGRAM_BASE = 1e-5;     // upper bound of the first bucket, seconds
+const double HISTOGRAM_GROWTH = 1.25;
+const int HISTOGRAM_BUCKETS = 90;
+const double COST_SMOOTHING = 0.2;      // weight of the newest measurement
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() : buckets_(HISTOGRAM_BUCKETS, 0) {}
+
+double LatencyHistogram::bucketUpperBound(int bucket) {
+    return HISTOGRAM_BASE * std::pow(HISTOGRAM_GROWTH, bucket);
+}
+
+void LatencyHistogram::record(double seconds) {
+    int bucket = 0;
+    if (seconds > HISTOGRAM_BASE) {
+        bucket = static_cast<int>(std::ceil(std::log(seconds / HISTOGRAM_BASE) / std::log(HISTOGRAM_GROWTH)));
+    }
+    buckets_[std::min(bucket, HISTOGRAM_BUCKETS - 1)]++;
+    count_++;
+    max_ = std::max(max_, seconds);
+}
+
+double LatencyHistogram::percentile(double p) const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * count_));
+    uint64_t seen = 0;
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        seen += buckets_[b];
+        if (seen >= std::max<uint64_t>(rank, 1)) {
+            return std::min(bucketUpperBound(b), max_);
+        }
+    }
+    return max_;
+}
+
+void LatencyHistogram::writeCsv(std::ostream& out) const {
+    out << "upper_bound_s,count\n";
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        if (buckets_[b] > 0) {
+            out << bucketUpperBound(b) << "," << buckets_[b] << "\n";
+        }
+    }
+}
+
+QueryScheduler::QueryScheduler(const PIREngine& engine, const SchedulerConfig& config)
+    : engine_(engine), config_(config), secondsPerRecord_(config.initialSecondsPerRecord) {
+    if (config_.numThreads <= 0) {
+        config_.numThreads = engine_.numThreads();
+    }
+    freeThreads_ = config_.numThreads;
+    // Every running query holds at least one thread, so this many runners are never idle for lack of one
+    for (int t = 0; t < config_.numThreads; t++) {
+        runners_.emplace_back(&QueryScheduler::runnerLoop, this);
+    }
+}
+
+QueryScheduler::~QueryScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (std::thread& runner : runners_) {
+        runner.join();
+    }
+}
+
+double QueryScheduler::estimatedCost() const {
+    return secondsPerRecord_ * engine_.table().numRecords();
+}
+
+QueryTicket QueryScheduler::submit(const LweSample* enc_x, const LweSample* enc_y, double deadlineSeconds) {
+    if (engine_.buildingBlock() == BuildingBlock::BB3) {
+        throw std::invalid_argument("QueryScheduler: a BB3 table is queried by identifier");
+    }
+    return admit(enc_x, enc_y, deadlineSeconds);
+}
+
+QueryTicket QueryScheduler::submit(const LweSample* enc_id, double deadlineSeconds) {
+    if (engine_.buildingBlock() != BuildingBlock::BB3) {
+        throw std::invalid_argument("QueryScheduler: a BB1/BB2 table is queried by location");
+    }
+    return admit(enc_id, nullptr, deadlineSeconds);
+}
+
+QueryTicket QueryScheduler::admit(const LweSample* first, const LweSample* second, double deadlineSeconds) {
+    std::unique_ptr<Request> request(new Request);
+    request->first = first;
+    request->second = second;
+    request->submitted = Clock::now();
+    request->deadline = (deadlineSeconds > 0)
+        ? request->submitted + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(deadlineSeconds))
+        : Clock::time_point::max();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (static_cast<int>(queue_.size()) >= config_.maxQueued) {
+        stats_.rejectedQueueFull++;
+        return {AdmissionStatus::QUEUE_FULL, std::future<CiphertextArray>(), 0.0};
+    }
+
+    // Work that runs before this query (running, or queued with an earlier deadline) plus
+    // its own, spread over every thread
+    request->cost = estimatedCost();
+    double ahead = backlog_;
+    for (const std::unique_ptr<Request>& queued : queue_) {
+        if (queued->deadline > request->deadline) {
+            ahead -= queued->cost;
+        }
+    }
+    double estimated = (ahead + request->cost) / config_.numThreads;
+    if (deadlineSeconds > 0 && request->cost > 0 && estimated > deadlineSeconds) {
+        stats_.rejectedDeadline++;
+        return {AdmissionStatus::DEADLINE_MISSED, std::future<CiphertextArray>(), estimated};
+    }
+
+    QueryTicket ticket{AdmissionStatus::ADMITTED, request->promise.get_future(), estimated};
+    backlog_ += request->cost;
+    stats_.admitted++;
+    auto position = std::upper_bound(queue_.begin(), queue_.end(), request,
+                                     [](const std::unique_ptr<Request>& a, const std::unique_ptr<Request>& b) {
+                                         return a->deadline < b->deadline;
+                                     });
+    queue_.insert(position, std::move(request));
+    ready_.notify_one();
+    return ticket;
+}
+
+void QueryScheduler::runnerLoop() {
+    for (;;) {
+        std::unique_ptr<Request> request;
+        int budget;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [&] { return (stopping_ && queue_.empty()) || (!queue_.empty() && freeThreads_ > 0); });
+            if (queue_.empty()) {
+                return;
+            }
+            request = std::move(queue_.front());
+            queue_.pop_front();
+
+            // A fair share of the free threads leaves room for the queries still waiting;
+            // a tight deadline takes more, up to every free thread
+            budget = std::max(1, freeThreads_ / (1 + static_cast<int>(queue_.size())));
+            if (request->deadline != Clock::time_point::max() && request->cost > 0) {
+                double slack = std::chrono::duration<double>(request->deadline - Clock::now()).count();
+                int needed = (slack > 0) ? static_cast<int>(std::ceil(request->cost / slack)) : freeThreads_;
+                budget = std::max(budget, needed);
+            }
+            budget = std::min(budget, freeThreads_);
+            freeThreads_ -= budget;
+        }
+
+        Clock::time_point started = Clock::now();
+        CiphertextArray result;
+        std::exception_ptr failure;
+        try {
+            result = (request->second != nullptr || engine_.buildingBlock() != BuildingBlock::BB3)
+                ? engine_.query(request->first, request->second, budget)
+                : engine_.query(request->first, budget);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        Clock::time_point finished = Clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            freeThreads_ += budget;
+            backlog_ = std::max(0.0, backlog_ - request->cost);
+            if (!failure) {
+                double measured = std::chrono::duration<double>(finished - started).count() * budget /
+                                  std::max(1, engine_.table().numRecords());
+                secondsPerRecord_ = (secondsPerRecord_ > 0)
+                    ? (1 - COST_SMOOTHING) * secondsPerRecord_ + COST_SMOOTHING * measured
+                    : measured;
+                latency_.record(std::chrono::duration<double>(finished - request->submitted).count());
+                queueLatency_.record(std::chrono::duration<double>(started - request->submitted).count());
+                stats_.completed++;
+                stats_.missedDeadline += (finished > request->deadline);
+            }
+        }
+        ready_.notify_all();
+
+        if (failure) {
+            request->promise.set_exception(failure);
+        } else {
+            request->promise.set_value(std::move(result));
+        }
+    }
+}
+
+LatencyHistogram QueryScheduler::latency() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latency_;
+}
+
+LatencyHistogram QueryScheduler::queueLatency() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queueLatency_;
+}
+
+SchedulerStats QueryScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SchedulerStats stats = stats_;
+    stats.secondsPerRecord = secondsPerRecord_;
+    return stats;
+}
+
+int QueryScheduler::queued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(queue_.size());
+}
+
+int QueryScheduler::freeThreads() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return freeThreads_;
+}
@@ -0,0 +1,217 @@
+#include "ResponseCodec.h"
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const uint32_t RESPONSE_MAGIC = 0x52524950;  // "PIRR"
+const uint32_t RESPONSE_VERSION = 1;
+const uint32_t PACKED_MAGIC = 0x50524950;    // "PIRP"
+const uint32_t PACKING_KEY_MAGIC = 0x4b524950;  // "PIRK"
+
+// Round a Torus32 to the nearest multiple of 2^(32 - bits), expressed modulo 2^bits
+uint32_t switchModulus(Torus32 x, int bits) {
+    uint64_t shifted = static_cast<uint64_t>(static_cast<uint32_t>(x)) + (UINT64_C(1) << (31 - bits));
+    return static_cast<uint32_t>(shifted >> (32 - bits)) & ((UINT32_C(1) << bits) - 1);
+}
+
+void writeU32(std::ostream& out, uint32_t v) {
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>(v), static_cast<unsigned char>(v >> 8),
+        static_cast<unsigned char>(v >> 16), static_cast<unsigned char>(v >> 24)
+    };
+    out.write(reinterpret_cast<const char*>(bytes), 4);
+}
+
+uint32_t readU32(std::istream& in) {
+    unsigned char bytes[4];
+    if (!in.read(reinterpret_cast<char*>(bytes), 4)) {
+        throw std::runtime_error("Truncated compressed response");
+    }
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+void writeTorusArray(std::ostream& out, const std::vector<Torus32>& values) {
+    for (Torus32 value : values) {
+        writeU32(out, static_cast<uint32_t>(value));
+    }
+}
+
+// Grows with what is actually read, so a forged count runs out of stream before memory
+void readTorusArray(std::istream& in, std::vector<Torus32>& values, size_t count) {
+    values.clear();
+    values.reserve(std::min<size_t>(count, 1 << 16));
+    for (size_t i = 0; i < count; i++) {
+        values.push_back(static_cast<Torus32>(readU32(in)));
+    }
+}
+
+// The ring dimension of a packed response or packing key must be the parameter set's
+void checkRingDimension(uint32_t N, const TFheGateBootstrappingParameterSet* params, const char* what) {
+    const uint32_t expected = params->tgsw_params->tlwe_params->N;
+    if (N == 0 || (N & (N - 1)) != 0 || N != expected) {
+        throw std::runtime_error(std::string(what) + ": ring dimension " + std::to_string(N) +
+                                 " does not match the parameter set");
+    }
+}
+
+} // namespace
+
+CompressedResponse compressResponse(const LweSample* result, int length,
+                                    const TFheGateBootstrappingParameterSet* params,
+                                    int modulusBits) {
+    if (modulusBits < 2 || modulusBits > 31) {
+        throw std::invalid_argument("compressResponse: modulusBits must be in [2, 31]");
+    }
+
+    CompressedResponse response;
+    response.modulusBits = modulusBits;
+    response.length = length;
+    response.n = params->in_out_params->n;
+
+    size_t totalBits = static_cast<size_t>(length) * (response.n + 1) * modulusBits;
+    response.packed.assign((totalBits + 7) / 8, 0);
+
+    // Little-endian bit stream: coefficient k occupies bits [k * modulusBits, (k + 1) * modulusBits)
+    size_t bitPos = 0;
+    for (int s = 0; s < length; s++) {
+        for (int k = 0; k <= response.n; k++) {
+            Torus32 coefficient = (k < response.n) ? result[s].a[k] : result[s].b;
+            uint32_t value = switchModulus(coefficient, modulusBits);
+            for (int bit = 0; bit < modulusBits; bit++, bitPos++) {
+                if ((value >> bit) & 1) {
+                    response.packed[bitPos >> 3] |= static_cast<uint8_t>(1 << (bitPos & 7));
+                }
+            }
+        }
+    }
+
+    return response;
+}
+
+uint32_t responseCoefficient(const CompressedResponse& response, int sample, int index) {
+    size_t bitPos = (static_cast<size_t>(sample) * (response.n + 1) + index) * response.modulusBits;
+    uint32_t value = 0;
+    for (int bit = 0; bit < response.modulusBits; bit++, bitPos++) {
+        value |= static_cast<uint32_t>((response.packed[bitPos >> 3] >> (bitPos & 7)) & 1) << bit;
+    }
+    return value;
+}
+
+void exportCompressedResponseToStream(std::ostream& out, const CompressedResponse& response) {
+    writeU32(out, RESPONSE_MAGIC);
+    writeU32(out, RESPONSE_VERSION);
+    writeU32(out, response.modulusBits);
+    writeU32(out, response.length);
+    writeU32(out, response.n);
+    out.write(reinterpret_cast<const char*>(response.packed.data()), response.packed.size());
+}
+
+CompressedResponse importCompressedResponseFromStream(std::istream& in,
+                                                     const TFheGateBootstrappingParameterSet* params) {
+    if (readU32(in) != RESPONSE_MAGIC || readU32(in) != RESPONSE_VERSION) {
+        throw std::runtime_error("Not a compressed response (bad magic or version)");
+    }
+
+    // Same ranges as compressResponse; the dimension must be the client's
+    uint32_t modulusBits = readU32(in);
+    uint32_t length = readU32(in);
+    uint32_t n = readU32(in);
+    if (modulusBits < 2 || modulusBits > 31) {
+        throw std::runtime_error("Compressed response modulusBits out of range: " + std::to_string(modulusBits));
+    }
+    if (length > static_cast<uint32_t>(INT32_MAX) || n != static_cast<uint32_t>(params->in_out_params->n)) {
+        throw std::runtime_error("Compressed response does not match the parameter set");
+    }
+
+    CompressedResponse response;
+    response.modulusBits = modulusBits;
+    response.length = length;
+    response.n = n;
+
+    // The payload is exactly length * (n + 1) * modulusBits bits; it is read in blocks so a
+    // forged length cannot allocate more than the stream holds
+    const uint64_t totalBytes = (static_cast<uint64_t>(length) * (n + 1) * modulusBits + 7) / 8;
+    const size_t BLOCK = 1 << 16;
+    while (response.packed.size() < totalBytes) {
+        size_t offset = response.packed.size();
+        size_t count = static_cast<size_t>(std::min<uint64_t>(BLOCK, totalBytes - offset));
+        response.packed.resize(offset + count);
+        if (!in.read(reinterpret_cast<char*>(response.packed.data() + offset), count)) {
+            throw std::runtime_error("Truncated compressed response");
+        }
+    }
+
+    return response;
+}
+
+void exportPackedResponseToStream(std::ostream& out, const PackedResponse& response) {
+    writeU32(out, PACKED_MAGIC);
+    writeU32(out, RESPONSE_VERSION);
+    writeU32(out, response.N);
+    writeU32(out, response.length);
+    writeTorusArray(out, response.a);
+    writeTorusArray(out, response.b);
+}
+
+PackedResponse importPackedResponseFromStream(std::istream& in, const TFheGateBootstrappingParameterSet* params) {
+    if (readU32(in) != PACKED_MAGIC || readU32(in) != RESPONSE_VERSION) {
+        throw std::runtime_error("Not a packed response (bad magic or version)");
+    }
+
+    uint32_t N = readU32(in);
+    uint32_t length = readU32(in);
+    checkRingDimension(N, params, "Packed response");
+    if (length > static_cast<uint32_t>(INT32_MAX)) {
+        throw std::runtime_error("Packed response length out of range");
+    }
+
+    PackedResponse response;
+    response.N = N;
+    response.length = length;
+    size_t chunks = (static_cast<size_t>(length) + N - 1) / N;
+    readTorusArray(in, response.a, chunks * N);
+    readTorusArray(in, response.b, length);
+    return response;
+}
+
+void exportPackingKeyToStream(std::ostream& out, const PackingKey& packingKey) {
+    writeU32(out, PACKING_KEY_MAGIC);
+    writeU32(out, RESPONSE_VERSION);
+    writeU32(out, packingKey.n);
+    writeU32(out, packingKey.N);
+    writeU32(out, packingKey.basebit);
+    writeU32(out, packingKey.levels);
+    writeTorusArray(out, packingKey.a);
+    writeTorusArray(out, packingKey.b);
+}
+
+PackingKey importPackingKeyFromStream(std::istream& in, const TFheGateBootstrappingParameterSet* params) {
+    if (readU32(in) != PACKING_KEY_MAGIC || readU32(in) != RESPONSE_VERSION) {
+        throw std::runtime_error("Not a packing key (bad magic or version)");
+    }
+
+    uint32_t n = readU32(in);
+    uint32_t N = readU32(in);
+    uint32_t basebit = readU32(in);
+    uint32_t levels = readU32(in);
+    checkRingDimension(N, params, "Packing key");
+    if (n != static_cast<uint32_t>(params->in_out_params->n) ||
+        basebit < 1 || levels < 1 || basebit * levels > 31) {
+        throw std::runtime_error("Packing key does not match the parameter set");
+    }
+
+    PackingKey packingKey;
+    packingKey.n = n;
+    packingKey.N = N;
+    packingKey.basebit = basebit;
+    packingKey.levels = levels;
+    size_t count = static_cast<size_t>(packingKey.N) * packingKey.n * packingKey.levels;
+    readTorusArray(in, packingKey.a, count);
+    readTorusArray(in, packingKey.b, count);
+    return packingKey;
+}
@@ -0,0 +1,197 @@
+#include "ResponsePacking.h"
+#include "SeededMask.h"
+#include <omp.h>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// Signed digits of x in base 2^basebit, most significant first, rounded to levels * basebit bits:
+// x ~ sum_j digits[j] * 2^(32 - basebit * (j + 1)), |digits[j]| <= 2^(basebit - 1)
+void decompose(int32_t* digits, Torus32 x, int basebit, int levels) {
+    const uint32_t halfBase = UINT32_C(1) << (basebit - 1);
+    const uint32_t mask = (UINT32_C(1) << basebit) - 1;
+    uint32_t offset = UINT32_C(1) << (32 - basebit * levels - 1);
+    for (int j = 0; j < levels; j++) {
+        offset += halfBase << (32 - basebit * (j + 1));
+    }
+    uint32_t shifted = static_cast<uint32_t>(x) + offset;
+    for (int j = 0; j < levels; j++) {
+        digits[j] = static_cast<int32_t>((shifted >> (32 - basebit * (j + 1))) & mask) - static_cast<int32_t>(halfBase);
+    }
+}
+
+// result = poly * z in Z[X]/(X^N + 1), z binary
+void multiplyByKey(uint32_t* result, const uint32_t* poly, const std::vector<int32_t>& z, int N) {
+    for (int k = 0; k < N; k++) {
+        result[k] = 0;
+    }
+    for (int l = 0; l < N; l++) {
+        if (!z[l]) continue;
+        for (int k = 0; k < l; k++) {
+            result[k] -= poly[k - l + N];
+        }
+        for (int k = l; k < N; k++) {
+            result[k] += poly[k - l];
+        }
+    }
+}
+
+} // namespace
+
+PackingSecretKey newPackingSecretKey(const TFheGateBootstrappingParameterSet* params) {
+    PackingSecretKey packingSecret;
+    packingSecret.N = params->tgsw_params->tlwe_params->N;
+
+    std::vector<Torus32> bits(packingSecret.N);
+    expandMask(bits.data(), packingSecret.N, randomMaskSeed(), 0);
+    packingSecret.z.resize(packingSecret.N);
+    for (int k = 0; k < packingSecret.N; k++) {
+        packingSecret.z[k] = bits[k] & 1;
+    }
+    return packingSecret;
+}
+
+PackingKey newPackingKey(const PackingSecretKey& packingSecret, const TFheGateBootstrappingSecretKeySet* key,
+                         int num_of_threads) {
+    const int n = key->params->in_out_params->n;
+    const int N = packingSecret.N;
+    const double alpha = key->params->tgsw_params->tlwe_params->alpha_min;
+    const int32_t* s = key->lwe_key->key;
+
+    PackingKey packingKey;
+    packingKey.n = n;
+    packingKey.N = N;
+    packingKey.basebit = PACKING_BASEBIT;
+    packingKey.levels = PACKING_LEVELS;
+
+    const int rows = n * PACKING_LEVELS;
+    packingKey.a.resize(static_cast<size_t>(N) * rows);
+    packingKey.b.resize(static_cast<size_t>(N) * rows);
+
+    // Noise is drawn up front so rows can be built in parallel
+    MaskSeed seed = randomMaskSeed();
+    std::mt19937_64 noise = randomNoise();
+    std::normal_distribution<double> gaussian(0., alpha);
+    std::vector<Torus32> errors(static_cast<size_t>(rows) * N);
+    for (Torus32& e : errors) {
+        e = dtot32(gaussian(noise));
+    }
+
+    #pragma omp parallel for num_threads(num_of_threads)
+    for (int row = 0; row < rows; row++) {
+        const int i = row / PACKING_LEVELS;
+        const int j = row % PACKING_LEVELS;
+        std::vector<Torus32> a(N);
+        std::vector<uint32_t> az(N);
+        expandMask(a.data(), N, seed, row);
+        multiplyByKey(az.data(), reinterpret_cast<const uint32_t*>(a.data()), packingSecret.z, N);
+
+        // b = a * z + e, plus the message s_i / 2^(basebit * (j + 1)) in the constant term
+        for (int k = 0; k < N; k++) {
+            uint32_t body = az[k] + static_cast<uint32_t>(errors[static_cast<size_t>(row) * N + k]);
+            if (k == 0 && s[i]) {
+                body += UINT32_C(1) << (32 - PACKING_BASEBIT * (j + 1));
+            }
+            packingKey.a[static_cast<size_t>(k) * rows + row] = a[k];
+            packingKey.b[static_cast<size_t>(k) * rows + row] = static_cast<Torus32>(body);
+        }
+    }
+
+    return packingKey;
+}
+
+PackedResponse packResponse(const LweSample* result, int length, const PackingKey& packingKey,
+                            int num_of_threads) {
+    const int N = packingKey.N;
+    const int rows = packingKey.n * packingKey.levels;
+    const int chunks = (length + N - 1) / N;
+
+    PackedResponse response;
+    response.N = N;
+    response.length = length;
+    response.a.assign(static_cast<size_t>(chunks) * N, 0);
+    response.b.assign(length, 0);
+
+    // Decomposed masks of every result bit, digits[m * rows + i * levels + j]
+    std::vector<int32_t> digits(static_cast<size_t>(length) * rows);
+    for (int m = 0; m < length; m++) {
+        for (int i = 0; i < packingKey.n; i++) {
+            decompose(&digits[static_cast<size_t>(m) * rows + i * packingKey.levels], result[m].a[i],
+                      packingKey.basebit, packingKey.levels);
+        }
+    }
+
+    // (A, B) = (0, sum_m b_m X^m) - sum_m X^m * sum_{i,j} digit_{m,i,j} * K_{i,j}
+    // Coefficient k of X^m * K is K[k - m], negated when it wraps around X^N = -1
+    for (int c = 0; c < chunks; c++) {
+        const int first = c * N;
+        const int count = (length - first < N) ? length - first : N;
+
+        #pragma omp parallel for num_threads(num_of_threads)
+        for (int k = 0; k < N; k++) {
+            uint32_t accA = 0;
+            uint32_t accB = (k < count) ? static_cast<uint32_t>(result[first + k].b) : 0;
+
+            for (int m = 0; m < count; m++) {
+                int index = k - m;
+                bool wraps = index < 0;
+                if (wraps) index += N;
+
+                const int32_t* d = &digits[static_cast<size_t>(first + m) * rows];
+                const Torus32* keyA = &packingKey.a[static_cast<size_t>(index) * rows];
+                const Torus32* keyB = &packingKey.b[static_cast<size_t>(index) * rows];
+                uint32_t dotA = 0, dotB = 0;
+                for (int r = 0; r < rows; r++) {
+                    dotA += static_cast<uint32_t>(d[r]) * static_cast<uint32_t>(keyA[r]);
+                    dotB += static_cast<uint32_t>(d[r]) * static_cast<uint32_t>(keyB[r]);
+                }
+
+                if (wraps) {
+                    accA += dotA;
+                    accB += dotB;
+                } else {
+                    accA -= dotA;
+                    accB -= dotB;
+                }
+            }
+
+            response.a[static_cast<size_t>(first) + k] = static_cast<Torus32>(accA);
+            if (k < count) {
+                response.b[static_cast<size_t>(first) + k] = static_cast<Torus32>(accB);
+            }
+        }
+    }
+
+    return response;
+}
+
+std::vector<int> unpackResponseToBinaryVector(const PackedResponse& response, const PackingSecretKey& packingSecret) {
+    const int N = response.N;
+    if (N != packingSecret.N || response.length < 0 ||
+        response.a.size() != static_cast<size_t>((response.length + N - 1) / N) * N ||
+        response.b.size() != static_cast<size_t>(response.length)) {
+        throw std::invalid_argument("unpackResponseToBinaryVector: response does not match the packing key");
+    }
+    std::vector<int> binaryVector(response.length);
+    std::vector<uint32_t> az(N);
+
+    for (int first = 0; first < response.length; first += N) {
+        // Phase B - A * z; coefficient m carries bit first + m as +-1/8
+        multiplyByKey(az.data(), reinterpret_cast<const uint32_t*>(&response.a[first]), packingSecret.z, N);
+        for (int m = 0; m < N && first + m < response.length; m++) {
+            int32_t phase = static_cast<int32_t>(static_cast<uint32_t>(response.b[first + m]) - az[m]);
+            binaryVector[first + m] = (phase > 0) ? 1 : 0;
+        }
+    }
+
+    return binaryVector;
+}
+
+std::string unpackResponseBinaryString(const PackedResponse& response, const PackingSecretKey& packingSecret) {
+    std::string binaryString = "";
+    for (int bit : unpackResponseToBinaryVector(response, packingSecret)) {
+        binaryString += std::to_string(bit);
+    }
+    return binaryString;
+}
@@ -0,0 +1,58 @@
+#include "ScratchPool.h"
+#include <atomic>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::atomic<size_t> totalAllocations{0};
+
+// Free lists keyed by (LWE dimension n, array length)
+struct ScratchFreeList {
+    std::map<std::pair<int, int>, std::vector<LweSample*>> freeLists;
+
+    ~ScratchFreeList() { clear(); }
+
+    void clear() {
+        for (auto& entry : freeLists) {
+            for (LweSample* samples : entry.second) {
+                delete_gate_bootstrapping_ciphertext_array(entry.first.second, samples);
+            }
+        }
+        freeLists.clear();
+    }
+};
+
+ScratchFreeList& localPool() {
+    thread_local ScratchFreeList pool;
+    return pool;
+}
+
+} // namespace
+
+LweSample* acquireScratchArray(int length, const TFheGateBootstrappingParameterSet* params) {
+    std::vector<LweSample*>& freeList = localPool().freeLists[{params->in_out_params->n, length}];
+    if (!freeList.empty()) {
+        LweSample* samples = freeList.back();
+        freeList.pop_back();
+        return samples;
+    }
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    return new_gate_bootstrapping_ciphertext_array(length, params);
+}
+
+void releaseScratchArray(LweSample* samples, int length, const TFheGateBootstrappingParameterSet* params) {
+    if (samples == nullptr) {
+        return;
+    }
+    localPool().freeLists[{params->in_out_params->n, length}].push_back(samples);
+}
+
+void clearScratchPool() {
+    localPool().clear();
+}
+
+size_t scratchPoolAllocations() {
+    return totalAllocations.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,119 @@
+#include "SeededMask.h"
+#include <cmath>
+
+namespace {
+
+inline uint32_t rotl(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+inline void quarterRound(uint32_t* s, int a, int b, int c, int d) {
+    s[a] += s[b]; s[d] ^= s[a]; s[d] = rotl(s[d], 16);
+    s[c] += s[d]; s[b] ^= s[c]; s[b] = rotl(s[b], 12);
+    s[a] += s[b]; s[d] ^= s[a]; s[d] = rotl(s[d], 8);
+    s[c] += s[d]; s[b] ^= s[c]; s[b] = rotl(s[b], 7);
+}
+
+// One 64-byte ChaCha20 block; the stream id takes the nonce words
+void chachaBlock(uint32_t out[16], const MaskSeed& seed, uint64_t stream, uint32_t counter) {
+    uint32_t state[16] = {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+        seed.words[0], seed.words[1], seed.words[2], seed.words[3],
+        seed.words[4], seed.words[5], seed.words[6], seed.words[7],
+        counter, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32), 0
+    };
+    uint32_t working[16];
+    for (int i = 0; i < 16; i++) {
+        working[i] = state[i];
+    }
+    for (int round = 0; round < 10; round++) {
+        quarterRound(working, 0, 4, 8, 12);
+        quarterRound(working, 1, 5, 9, 13);
+        quarterRound(working, 2, 6, 10, 14);
+        quarterRound(working, 3, 7, 11, 15);
+        quarterRound(working, 0, 5, 10, 15);
+        quarterRound(working, 1, 6, 11, 12);
+        quarterRound(working, 2, 7, 8, 13);
+        quarterRound(working, 3, 4, 9, 14);
+    }
+    for (int i = 0; i < 16; i++) {
+        out[i] = working[i] + state[i];
+    }
+}
+
+// Same +-1/8 encoding as bootsSymEncrypt
+const Torus32 MU = 1 << 29;
+
+Torus32 doubleToTorus32(double d) {
+    return static_cast<Torus32>(static_cast<int64_t>(std::llround(d * 4294967296.0)));
+}
+
+} // namespace
+
+MaskSeed randomMaskSeed() {
+    std::random_device rd;
+    MaskSeed seed;
+    for (int i = 0; i < 8; i++) {
+        seed.words[i] = rd();
+    }
+    return seed;
+}
+
+MaskSeed maskSeedFromInts(uint32_t a, uint32_t b, uint32_t c) {
+    std::seed_seq seq{a, b, c};
+    MaskSeed seed;
+    seq.generate(seed.words, seed.words + 8);
+    return seed;
+}
+
+void expandMask(Torus32* mask, int n, const MaskSeed& seed, uint64_t stream) {
+    uint32_t block[16];
+    for (int offset = 0, counter = 0; offset < n; offset += 16, counter++) {
+        chachaBlock(block, seed, stream, counter);
+        int count = (n - offset < 16) ? n - offset : 16;
+        for (int i = 0; i < count; i++) {
+            mask[offset + i] = static_cast<Torus32>(block[i]);
+        }
+    }
+}
+
+std::mt19937_64 seededNoise(const MaskSeed& seed, uint64_t stream) {
+    uint32_t block[16];
+    chachaBlock(block, seed, stream, 0);
+    std::seed_seq seq(block, block + 16);
+    return std::mt19937_64(seq);
+}
+
+std::mt19937_64 randomNoise() {
+    return seededNoise(randomMaskSeed(), 0);
+}
+
+Torus32 seededSymEncrypt(int32_t message, const MaskSeed& seed, uint64_t stream,
+                         const TFheGateBootstrappingSecretKeySet* key, std::mt19937_64& noise) {
+    const LweParams* lwe = key->params->in_out_params;
+    const int32_t* s = key->lwe_key->key;
+
+    // b = <a, s> + mu + e, accumulated block by block so the mask is never materialized
+    uint32_t body = 0;
+    uint32_t block[16];
+    for (int offset = 0, counter = 0; offset < lwe->n; offset += 16, counter++) {
+        chachaBlock(block, seed, stream, counter);
+        int count = (lwe->n - offset < 16) ? lwe->n - offset : 16;
+        for (int i = 0; i < count; i++) {
+            body += block[i] * static_cast<uint32_t>(s[offset + i]);
+        }
+    }
+
+    std::normal_distribution<double> gaussian(0., lwe->alpha_min);
+    body += static_cast<uint32_t>(message ? MU : -MU);
+    body += static_cast<uint32_t>(doubleToTorus32(gaussian(noise)));
+    return static_cast<Torus32>(body);
+}
+
+void expandSample(LweSample* sample, Torus32 body, const MaskSeed& seed, uint64_t stream,
+                  const TFheGateBootstrappingParameterSet* params) {
+    const LweParams* lwe = params->in_out_params;
+    expandMask(sample->a, lwe->n, seed, stream);
+    sample->b = body;
+    sample->current_variance = lwe->alpha_min * lwe->alpha_min;
+}
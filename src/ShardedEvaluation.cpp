@@ -0,0 +1,329 @@
+#include "ShardedEvaluation.h"
+#include "PIRProtocol.h"
+#include "QueryCodec.h"
+#include "TableFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+std::string statusFrame(uint8_t status, const std::string& body) {
+    return std::string(1, static_cast<char>(status)) + body;
+}
+
+// Worker side: answer queries on the shard until the coordinator closes the socket
+void serveShard(const PIREngine& engine, int socket) {
+    const TFheGateBootstrappingParameterSet* params = engine.cloudKey()->params;
+    std::string request;
+    while (readFrame(socket, request)) {
+        std::string reply;
+        try {
+            std::istringstream in(request);
+            int count = in.get();
+            CiphertextArray first(engine.inputLength(), params);
+            CiphertextArray second(engine.inputLength(), params);
+            importCiphertextArrayFromStream(in, first.get(), engine.inputLength(), params);
+            if (count == 2) {
+                importCiphertextArrayFromStream(in, second.get(), engine.inputLength(), params);
+            }
+            CiphertextArray partial = (count == 2) ? engine.query(first.get(), second.get())
+                                                   : engine.query(first.get());
+
+            std::ostringstream out;
+            exportCiphertextArrayToStream(out, partial.get(), engine.serviceLength(), params);
+            reply = statusFrame(PIR_STATUS_OK, out.str());
+        } catch (const std::exception& e) {
+            reply = statusFrame(PIR_STATUS_ERROR, e.what());
+        }
+        if (!writeFrame(socket, reply)) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+SharedKeyImage::SharedKeyImage(const TFheGateBootstrappingCloudKeySet* bk)
+    : bytes_(bootstrappingKeyImageBytes(bk->params)) {
+    fd_ = memfd_create("locpir-cloud-key", 0);
+    if (fd_ < 0) {
+        throw std::runtime_error("SharedKeyImage: memfd_create failed");
+    }
+    void* image = MAP_FAILED;
+    if (ftruncate(fd_, bytes_) == 0) {
+        image = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    }
+    if (image == MAP_FAILED) {
+        close(fd_);
+        throw std::runtime_error("SharedKeyImage: cannot size or map the key image");
+    }
+    try {
+        writeBootstrappingKeyImage(image, bk);
+    } catch (...) {
+        munmap(image, bytes_);
+        close(fd_);
+        throw;
+    }
+    munmap(image, bytes_);
+}
+
+SharedKeyImage::~SharedKeyImage() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+SharedKeyImage::SharedKeyImage(SharedKeyImage&& other) noexcept : fd_(other.fd_), bytes_(other.bytes_) {
+    other.fd_ = -1;
+    other.bytes_ = 0;
+}
+
+SharedKeyImage& SharedKeyImage::operator=(SharedKeyImage&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        fd_ = other.fd_;
+        bytes_ = other.bytes_;
+        other.fd_ = -1;
+        other.bytes_ = 0;
+    }
+    return *this;
+}
+
+MappedCloudKey SharedKeyImage::map(const TFheGateBootstrappingParameterSet* params) const {
+    void* image = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED | MAP_POPULATE, fd_, 0);
+    if (image == MAP_FAILED) {
+        throw std::runtime_error("SharedKeyImage: mmap failed");
+    }
+    return MappedCloudKey(image, bytes_, params);
+}
+
+std::vector<ShardRange> shardRanges(int numRecords, int numShards) {
+    if (numShards < 1) {
+        throw std::invalid_argument("shardRanges: need at least one shard");
+    }
+    std::vector<ShardRange> ranges;
+    int first = 0;
+    for (int s = 0; s < numShards; s++) {
+        int size = numRecords / numShards + (s < numRecords % numShards ? 1 : 0);
+        ranges.push_back({first, size});
+        first += size;
+    }
+    return ranges;
+}
+
+ShardedEvaluator::ShardedEvaluator(const std::string& tablePath, const TFheGateBootstrappingCloudKeySet* bk,
+                                   int numShards, int threadsPerShard)
+    : bk_(bk), key_(bk), tablePath_(tablePath), threadsPerShard_(threadsPerShard) {
+    TableSchema schema = readTableFileSchema(tablePath, numRecords_);
+    block_ = buildingBlockOf(schema);
+    inputLength_ = schema[0].bits;
+    serviceLength_ = schema.back().bits;
+
+    // An empty shard would cost a worker and a merge for nothing
+    int shards = std::max(1, std::min(numShards, numRecords_));
+    try {
+        for (const ShardRange& range : shardRanges(numRecords_, shards)) {
+            workers_.push_back(spawn(range));
+        }
+    } catch (...) {
+        shutdown();
+        throw;
+    }
+
+    for (size_t s = 0; s < workers_.size(); s++) {
+        std::string reason;
+        if (!awaitReady(workers_[s], reason)) {
+            shutdown();
+            throw std::runtime_error("ShardedEvaluator: shard " + std::to_string(s) + ": " + reason);
+        }
+    }
+}
+
+ShardedEvaluator::~ShardedEvaluator() {
+    shutdown();
+}
+
+ShardedEvaluator::Worker ShardedEvaluator::spawn(const ShardRange& range) const {
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0) {
+        throw std::runtime_error("ShardedEvaluator: socketpair failed");
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(sockets[0]);
+        close(sockets[1]);
+        throw std::runtime_error("ShardedEvaluator: fork failed");
+    }
+    if (pid == 0) {
+        // Worker: drop the coordinator ends of the other shards, so they see EOF when the
+        // coordinator closes them, then load the shard and report readiness
+        close(sockets[0]);
+        for (const Worker& worker : workers_) {
+            if (worker.socket >= 0) {
+                close(worker.socket);
+            }
+        }
+        int status = 0;
+        try {
+            PIREngine engine(key_.map(bk_->params),
+                             mapTableFileRange(tablePath_, bk_->params, range.firstRecord, range.numRecords),
+                             threadsPerShard_);
+            if (writeFrame(sockets[1], statusFrame(PIR_STATUS_OK, ""))) {
+                serveShard(engine, sockets[1]);
+            }
+        } catch (const std::exception& e) {
+            writeFrame(sockets[1], statusFrame(PIR_STATUS_ERROR, e.what()));
+            status = 1;
+        }
+        // Skip the coordinator's atexit handlers and static destructors
+        _exit(status);
+    }
+    close(sockets[1]);
+    return Worker{pid, sockets[0], range};
+}
+
+bool ShardedEvaluator::awaitReady(const Worker& worker, std::string& reason) const {
+    std::string ready;
+    if (!readFrame(worker.socket, ready) || ready.empty() || ready[0] != PIR_STATUS_OK) {
+        reason = (ready.size() > 1) ? ready.substr(1) : "worker exited";
+        return false;
+    }
+    return true;
+}
+
+void ShardedEvaluator::stop(Worker& worker) const {
+    if (worker.socket >= 0) {
+        close(worker.socket);
+        worker.socket = -1;
+    }
+    if (worker.pid > 0) {
+        kill(worker.pid, SIGKILL);
+        while (waitpid(worker.pid, nullptr, 0) < 0 && errno == EINTR) {}
+        worker.pid = -1;
+    }
+}
+
+void ShardedEvaluator::respawn(size_t s) const {
+    // The socket may hold part of a frame, so the worker is never talked to again
+    stop(workers_[s]);
+    Worker fresh = spawn(workers_[s].range);
+    std::string reason;
+    if (!awaitReady(fresh, reason)) {
+        stop(fresh);
+        throw std::runtime_error("failed to restart: " + reason);
+    }
+    workers_[s] = fresh;
+}
+
+void ShardedEvaluator::shutdown() {
+    for (const Worker& worker : workers_) {
+        if (worker.socket >= 0) {
+            close(worker.socket);
+        }
+    }
+    for (const Worker& worker : workers_) {
+        if (worker.pid > 0) {
+            while (waitpid(worker.pid, nullptr, 0) < 0 && errno == EINTR) {}
+        }
+    }
+    workers_.clear();
+}
+
+CiphertextArray ShardedEvaluator::query(const LweSample* enc_x, const LweSample* enc_y) const {
+    if (block_ == BuildingBlock::BB3) {
+        throw std::invalid_argument("ShardedEvaluator: a BB3 table is queried by identifier");
+    }
+    return run(enc_x, enc_y);
+}
+
+CiphertextArray ShardedEvaluator::query(const LweSample* enc_id) const {
+    if (block_ != BuildingBlock::BB3) {
+        throw std::invalid_argument("ShardedEvaluator: a BB1/BB2 table is queried by location");
+    }
+    return run(enc_id, nullptr);
+}
+
+CiphertextArray ShardedEvaluator::run(const LweSample* first, const LweSample* second) const {
+    std::ostringstream out;
+    out.put(static_cast<char>(second ? 2 : 1));
+    exportCiphertextArrayToStream(out, first, inputLength_, bk_->params);
+    if (second) {
+        exportCiphertextArrayToStream(out, second, inputLength_, bk_->params);
+    }
+    const std::string request = out.str();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Every shard works at once; replies are collected in shard order. A shard whose frame
+    // could not be written or read whole is dead: it is replaced, never read again.
+    std::vector<char> sent(workers_.size(), 0);
+    std::vector<size_t> dead;
+    for (size_t s = 0; s < workers_.size(); s++) {
+        if (workers_[s].socket >= 0 && writeFrame(workers_[s].socket, request)) {
+            sent[s] = 1;
+        } else {
+            dead.push_back(s);
+        }
+    }
+
+    std::vector<CiphertextArray> partials;
+    std::string failure;
+    for (size_t s = 0; s < workers_.size(); s++) {
+        if (!sent[s]) {
+            continue;
+        }
+        std::string reply;
+        if (!readFrame(workers_[s].socket, reply) || reply.empty()) {
+            dead.push_back(s);
+            continue;
+        }
+        if (reply[0] != PIR_STATUS_OK) {
+            // Keep reading, so every live socket is left at a frame boundary
+            failure = "shard " + std::to_string(s) + ": " + reply.substr(1);
+            continue;
+        }
+        std::istringstream in(reply.substr(1));
+        partials.emplace_back(serviceLength_, bk_->params);
+        importCiphertextArrayFromStream(in, partials.back().get(), serviceLength_, bk_->params);
+    }
+
+    if (!dead.empty()) {
+        // This query is lost; the next one finds every shard serving again. A shard that
+        // cannot be restarted now stays closed and is retried by the next query.
+        std::sort(dead.begin(), dead.end());
+        std::string reason = "stopped answering and was restarted";
+        for (size_t s : dead) {
+            try {
+                respawn(s);
+            } catch (const std::exception& e) {
+                reason = e.what();
+            }
+        }
+        throw std::runtime_error("ShardedEvaluator: shard " + std::to_string(dead[0]) + " " + reason);
+    }
+    if (!failure.empty()) {
+        throw std::runtime_error("ShardedEvaluator: " + failure);
+    }
+
+    // Linear merge: the shards' XOR sums XOR into the sum over the whole table
+    CiphertextArray result = std::move(partials[0]);
+    for (size_t s = 1; s < partials.size(); s++) {
+        for (int j = 0; j < serviceLength_; j++) {
+            bootsXOR(&result[j], &result[j], &partials[s][j], bk_);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,401 @@
+#include "TableFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+uint64_t alignUp(uint64_t offset) {
+    return (offset + TABLE_FILE_ALIGNMENT - 1) / TABLE_FILE_ALIGNMENT * TABLE_FILE_ALIGNMENT;
+}
+
+void padTo(std::ofstream& out, uint64_t offset) {
+    static const char zeros[TABLE_FILE_ALIGNMENT] = {};
+    uint64_t position = static_cast<uint64_t>(out.tellp());
+    out.write(zeros, offset - position);
+}
+
+// Header and column directory of a table; returns the file size
+uint64_t layoutTableFile(const TableSchema& schema, int numRecords, TableLayout layout,
+                         const TFheGateBootstrappingParameterSet* params,
+                         TableFileHeader& header, std::vector<TableFileColumn>& directory) {
+    const int n = params->in_out_params->n;
+
+    header = {};
+    header.magic = TABLE_FILE_MAGIC;
+    header.version = TABLE_FILE_VERSION;
+    header.n = n;
+    header.layout = static_cast<uint32_t>(layout);
+    header.numRecords = numRecords;
+    header.numColumns = schema.size();
+    header.alphaMin = params->in_out_params->alpha_min;
+
+    // Lay out the blocks first so the directory can be written up front
+    directory.assign(schema.size(), TableFileColumn());
+    uint64_t offset = sizeof(TableFileHeader) + schema.size() * sizeof(TableFileColumn);
+    for (size_t c = 0; c < schema.size(); c++) {
+        if (schema[c].name.size() >= TABLE_FILE_NAME_BYTES) {
+            throw std::invalid_argument("writeTableFile: column name too long: " + schema[c].name);
+        }
+        uint64_t cells = static_cast<uint64_t>(numRecords) * schema[c].bits;
+        TableFileColumn& entry = directory[c];
+        std::memset(&entry, 0, sizeof(entry));
+        std::memcpy(entry.name, schema[c].name.c_str(), schema[c].name.size());
+        entry.type = static_cast<uint32_t>(schema[c].type);
+        entry.bits = schema[c].bits;
+        entry.masksOffset = alignUp(offset);
+        entry.bodiesOffset = alignUp(entry.masksOffset + cells * n * sizeof(Torus32));
+        offset = entry.bodiesOffset + cells * sizeof(Torus32);
+    }
+    return offset;
+}
+
+// Bodies of one column, record-major as stored in the file
+std::vector<Torus32> gatherBodies(const EncryptedTable& table, int column) {
+    const int bits = table.schema()[column].bits;
+    std::vector<Torus32> bodies(static_cast<size_t>(table.numRecords()) * bits);
+    for (int i = 0; i < table.numRecords(); i++) {
+        const LweSample* cell = table.cell(i, column);
+        for (int j = 0; j < bits; j++) {
+            bodies[static_cast<size_t>(i) * bits + j] = cell[j].b;
+        }
+    }
+    return bodies;
+}
+
+// Whether `count` items of `stride` bytes starting at `offset` lie within `bytes`, without
+// any product that a crafted header could make wrap
+bool blockFits(uint64_t offset, uint64_t records, uint64_t bits, uint64_t stride, uint64_t bytes) {
+    if (offset > bytes) {
+        return false;
+    }
+    if (records == 0 || bits == 0) {
+        return true;
+    }
+    uint64_t available = (bytes - offset) / stride;
+    return bits <= available && records <= available / bits;
+}
+
+// Why a header read from a file of `bytes` bytes cannot be used, or nullptr. Every size
+// comes from the file: checked before multiplying, so nothing can wrap.
+const char* headerProblem(const TableFileHeader& header, uint64_t bytes) {
+    if (header.magic != TABLE_FILE_MAGIC || header.version != TABLE_FILE_VERSION) {
+        return "bad magic or version";
+    }
+    if (header.numColumns > (bytes - sizeof(TableFileHeader)) / sizeof(TableFileColumn)) {
+        return "truncated directory";
+    }
+    if (header.numRecords > static_cast<uint32_t>(INT_MAX)) {
+        return "record count out of range";
+    }
+    if (header.layout != static_cast<uint32_t>(TableLayout::RECORD_MAJOR) &&
+        header.layout != static_cast<uint32_t>(TableLayout::BIT_MAJOR)) {
+        return "unknown layout";
+    }
+    return nullptr;
+}
+
+// The same for one directory entry of that file
+const char* columnProblem(const TableFileColumn& entry, const TableFileHeader& header, uint64_t bytes) {
+    if (entry.type > static_cast<uint32_t>(ColumnType::SERVICE) || entry.bits == 0 ||
+        entry.bits > static_cast<uint32_t>(INT_MAX)) {
+        return "bad column type or width";
+    }
+    if (entry.masksOffset % TABLE_FILE_ALIGNMENT != 0 || entry.bodiesOffset % TABLE_FILE_ALIGNMENT != 0) {
+        return "misaligned column block";
+    }
+    if (!blockFits(entry.masksOffset, header.numRecords, entry.bits,
+                   static_cast<uint64_t>(header.n) * sizeof(Torus32), bytes) ||
+        !blockFits(entry.bodiesOffset, header.numRecords, entry.bits, sizeof(Torus32), bytes)) {
+        return "truncated column block";
+    }
+    return nullptr;
+}
+
+void pwriteAll(int fd, const void* data, size_t bytes, uint64_t offset, const std::string& path) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t written = pwrite(fd, p, bytes, offset);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            throw std::runtime_error("TableFileWriter: write failed for " + path);
+        }
+        p += written;
+        bytes -= written;
+        offset += written;
+    }
+}
+
+} // namespace
+
+void writeTableFile(const std::string& path, const EncryptedTable& table) {
+    const int n = table.params()->in_out_params->n;
+    const TableSchema& schema = table.schema();
+
+    TableFileHeader header;
+    std::vector<TableFileColumn> directory;
+    layoutTableFile(schema, table.numRecords(), table.layout(), table.params(), header, directory);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("writeTableFile: cannot open " + path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(directory.data()), directory.size() * sizeof(TableFileColumn));
+
+    for (size_t c = 0; c < schema.size(); c++) {
+        uint64_t cells = static_cast<uint64_t>(table.numRecords()) * schema[c].bits;
+
+        // The arena is already in the table's layout and is written as is
+        padTo(out, directory[c].masksOffset);
+        out.write(reinterpret_cast<const char*>(table.columnArena(c)), cells * n * sizeof(Torus32));
+
+        padTo(out, directory[c].bodiesOffset);
+        std::vector<Torus32> bodies = gatherBodies(table, c);
+        out.write(reinterpret_cast<const char*>(bodies.data()), cells * sizeof(Torus32));
+    }
+
+    if (!out) {
+        throw std::runtime_error("writeTableFile: write failed for " + path);
+    }
+}
+
+EncryptedTable mapTableFile(const std::string& path, const TFheGateBootstrappingParameterSet* params) {
+    return mapTableFileRange(path, params, 0, -1);
+}
+
+EncryptedTable mapTableFileRange(const std::string& path, const TFheGateBootstrappingParameterSet* params,
+                                 int firstRecord, int numRecords) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("mapTableFile: cannot open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(TableFileHeader)) {
+        close(fd);
+        throw std::runtime_error("mapTableFile: not a table file: " + path);
+    }
+    const uint64_t bytes = info.st_size;
+
+    // Only the range's mask windows are mapped; header, directory and bodies are read
+    void* mapping = MAP_FAILED;
+    size_t mappingBytes = 0;
+    auto fail = [&](const std::string& reason) {
+        if (mapping != MAP_FAILED) {
+            munmap(mapping, mappingBytes);
+        }
+        close(fd);
+        throw std::runtime_error("mapTableFile: " + reason + ": " + path);
+    };
+    auto readAt = [&](void* data, size_t count, uint64_t offset) {
+        char* p = static_cast<char*>(data);
+        while (count > 0) {
+            ssize_t got = pread(fd, p, count, offset);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                fail("read failed");
+            }
+            p += got;
+            count -= got;
+            offset += got;
+        }
+    };
+
+    TableFileHeader header;
+    readAt(&header, sizeof(header), 0);
+    if (const char* problem = headerProblem(header, bytes)) {
+        fail(problem);
+    }
+    if (static_cast<int>(header.n) != params->in_out_params->n || header.alphaMin != params->in_out_params->alpha_min) {
+        fail("parameter set mismatch");
+    }
+
+    const int total = static_cast<int>(header.numRecords);
+    if (numRecords < 0) {
+        numRecords = total - firstRecord;
+    }
+    if (firstRecord < 0 || numRecords < 0 || static_cast<int64_t>(firstRecord) + numRecords > total) {
+        fail("record range out of bounds");
+    }
+    // A record range of a bit-major arena is strided, so only record-major files are split
+    if (numRecords != total && static_cast<TableLayout>(header.layout) != TableLayout::RECORD_MAJOR) {
+        fail("record ranges need a RECORD_MAJOR file");
+    }
+
+    std::vector<TableFileColumn> directory(header.numColumns);
+    readAt(directory.data(), directory.size() * sizeof(TableFileColumn), sizeof(TableFileHeader));
+    TableSchema schema;
+    for (const TableFileColumn& entry : directory) {
+        if (const char* problem = columnProblem(entry, header, bytes)) {
+            fail(problem);
+        }
+        schema.push_back({std::string(entry.name, strnlen(entry.name, TABLE_FILE_NAME_BYTES)),
+                          static_cast<ColumnType>(entry.type), static_cast<int>(entry.bits)});
+    }
+
+    // Page-aligned window of each column's masks for the range, placed side by side in one
+    // reserved region, so a shard's address space holds its share of the table and no more
+    const uint64_t page = sysconf(_SC_PAGESIZE);
+    std::vector<uint64_t> windowStart(directory.size()), windowBytes(directory.size());
+    for (size_t c = 0; c < directory.size(); c++) {
+        const uint64_t stride = static_cast<uint64_t>(directory[c].bits) * header.n * sizeof(Torus32);
+        const uint64_t begin = directory[c].masksOffset + firstRecord * stride;
+        const uint64_t end = begin + numRecords * stride;
+        windowStart[c] = begin / page * page;
+        windowBytes[c] = (numRecords == 0) ? 0 : (end + page - 1) / page * page - windowStart[c];
+        mappingBytes += windowBytes[c];
+    }
+    mappingBytes = std::max<size_t>(mappingBytes, page);
+    mapping = mmap(nullptr, mappingBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED) {
+        fail("cannot reserve the mapping");
+    }
+
+    std::vector<Torus32*> masks;
+    size_t slot = 0;
+    for (size_t c = 0; c < directory.size(); c++) {
+        char* window = static_cast<char*>(mapping) + slot;
+        if (windowBytes[c] > 0 && mmap(window, windowBytes[c], PROT_READ, MAP_SHARED | MAP_FIXED, fd,
+                                       windowStart[c]) == MAP_FAILED) {
+            fail("mmap failed");
+        }
+        // Read-only mapping: the kernels never write to database ciphertexts
+        const uint64_t begin = directory[c].masksOffset +
+                               static_cast<uint64_t>(firstRecord) * directory[c].bits * header.n * sizeof(Torus32);
+        masks.push_back(reinterpret_cast<Torus32*>(window + (begin - windowStart[c])));
+        slot += windowBytes[c];
+    }
+
+    // Bodies are the only per-cell data copied out of the file
+    const double variance = params->in_out_params->alpha_min * params->in_out_params->alpha_min;
+    std::vector<std::vector<Torus32>> bodies(directory.size());
+    for (size_t c = 0; c < directory.size(); c++) {
+        bodies[c].resize(static_cast<size_t>(numRecords) * directory[c].bits);
+        readAt(bodies[c].data(), bodies[c].size() * sizeof(Torus32),
+               directory[c].bodiesOffset + static_cast<uint64_t>(firstRecord) * directory[c].bits * sizeof(Torus32));
+    }
+    close(fd);  // the mapping keeps the file referenced
+
+    EncryptedTable table(schema, numRecords, params, static_cast<TableLayout>(header.layout),
+                         masks, mapping, mappingBytes);
+    for (size_t c = 0; c < directory.size(); c++) {
+        int bits = directory[c].bits;
+        for (int i = 0; i < numRecords; i++) {
+            LweSample* cell = table.view(i, c);  // bodies live in the views, not the mapping
+            for (int j = 0; j < bits; j++) {
+                cell[j].b = bodies[c][static_cast<size_t>(i) * bits + j];
+                cell[j].current_variance = variance;
+            }
+        }
+    }
+
+    return table;
+}
+
+TableSchema readTableFileSchema(const std::string& path, int& numRecords) {
+    // Checked like mapTableFileRange, since callers size their evaluation from the schema
+    std::ifstream in(path, std::ios::binary);
+    TableFileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("readTableFileSchema: not a table file: " + path);
+    }
+    in.seekg(0, std::ios::end);
+    const uint64_t bytes = static_cast<uint64_t>(in.tellg());
+    in.seekg(sizeof(header));
+    if (const char* problem = headerProblem(header, bytes)) {
+        throw std::runtime_error(std::string("readTableFileSchema: ") + problem + ": " + path);
+    }
+    std::vector<TableFileColumn> directory(header.numColumns);
+    if (!in.read(reinterpret_cast<char*>(directory.data()), directory.size() * sizeof(TableFileColumn))) {
+        throw std::runtime_error("readTableFileSchema: truncated directory: " + path);
+    }
+
+    TableSchema schema;
+    for (const TableFileColumn& entry : directory) {
+        if (const char* problem = columnProblem(entry, header, bytes)) {
+            throw std::runtime_error(std::string("readTableFileSchema: ") + problem + ": " + path);
+        }
+        schema.push_back({std::string(entry.name, strnlen(entry.name, TABLE_FILE_NAME_BYTES)),
+                          static_cast<ColumnType>(entry.type), static_cast<int>(entry.bits)});
+    }
+    numRecords = header.numRecords;
+    return schema;
+}
+
+TableFileWriter::TableFileWriter(const std::string& path, const TableSchema& schema, int numRecords,
+                                 const TFheGateBootstrappingParameterSet* params)
+    : path_(path), schema_(schema), numRecords_(numRecords), n_(params->in_out_params->n) {
+    TableFileHeader header;
+    uint64_t bytes = layoutTableFile(schema, numRecords, TableLayout::RECORD_MAJOR, params, header, directory_);
+
+    fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("TableFileWriter: cannot open " + path);
+    }
+    try {
+        // Full size up front; padding and not yet appended blocks read as zeros
+        if (ftruncate(fd_, bytes) != 0) {
+            throw std::runtime_error("TableFileWriter: cannot size " + path);
+        }
+        pwriteAll(fd_, &header, sizeof(header), 0, path_);
+        pwriteAll(fd_, directory_.data(), directory_.size() * sizeof(TableFileColumn), sizeof(header), path_);
+    } catch (...) {
+        close(fd_);
+        throw;
+    }
+}
+
+TableFileWriter::~TableFileWriter() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+void TableFileWriter::append(const EncryptedTable& batch) {
+    if (batch.layout() != TableLayout::RECORD_MAJOR || batch.numColumns() != static_cast<int>(schema_.size())) {
+        throw std::invalid_argument("TableFileWriter: batch does not match the table");
+    }
+    if (recordsWritten_ + batch.numRecords() > numRecords_) {
+        throw std::invalid_argument("TableFileWriter: more records than declared");
+    }
+    for (size_t c = 0; c < schema_.size(); c++) {
+        const uint64_t bits = schema_[c].bits;
+        if (batch.schema()[c].bits != schema_[c].bits) {
+            throw std::invalid_argument("TableFileWriter: batch does not match the table");
+        }
+
+        // Record-major, so the batch is one contiguous run of each block
+        uint64_t cells = static_cast<uint64_t>(batch.numRecords()) * bits;
+        uint64_t first = static_cast<uint64_t>(recordsWritten_) * bits;
+        pwriteAll(fd_, batch.columnArena(c), cells * n_ * sizeof(Torus32),
+                  directory_[c].masksOffset + first * n_ * sizeof(Torus32), path_);
+        std::vector<Torus32> bodies = gatherBodies(batch, c);
+        pwriteAll(fd_, bodies.data(), cells * sizeof(Torus32),
+                  directory_[c].bodiesOffset + first * sizeof(Torus32), path_);
+    }
+    recordsWritten_ += batch.numRecords();
+}
+
+void TableFileWriter::finish() {
+    if (recordsWritten_ != numRecords_) {
+        throw std::runtime_error("TableFileWriter: " + std::to_string(recordsWritten_) + " of " +
+                                 std::to_string(numRecords_) + " records written to " + path_);
+    }
+    int fd = fd_;
+    fd_ = -1;
+    if (close(fd) != 0) {
+        throw std::runtime_error("TableFileWriter: write failed for " + path_);
+    }
+}
@@ -0,0 +1,122 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+struct ThreadPool::Job {
+    const std::function<void(int)>* body;
+    std::atomic<int> next;
+    int end;
+    int helpers;              // worker slots left, guarded by the pool mutex
+    std::atomic<int> active;  // threads inside runJob
+
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr failure;
+};
+
+ThreadPool::ThreadPool(int num_of_workers) {
+    for (int t = 0; t < num_of_workers; t++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::runJob(Job& job) {
+    for (;;) {
+        int i = job.next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= job.end) {
+            break;
+        }
+        try {
+            (*job.body)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            if (!job.failure) {
+                job.failure = std::current_exception();
+            }
+            job.next.store(job.end, std::memory_order_relaxed);
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            // Oldest job first; it leaves the queue once its budget is used up
+            job = jobs_.front();
+            if (--job->helpers == 0) {
+                jobs_.pop_front();
+            }
+            job->active.fetch_add(1);
+        }
+
+        runJob(*job);
+        if (job->active.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int begin, int end, int num_of_threads, const std::function<void(int)>& body) {
+    if (end <= begin) {
+        return;
+    }
+    int helpers = std::min({num_of_threads - 1, end - begin - 1, numWorkers()});
+    if (helpers <= 0) {
+        for (int i = begin; i < end; i++) {
+            body(i);
+        }
+        return;
+    }
+
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->body = &body;
+    job->next.store(begin);
+    job->end = end;
+    job->helpers = helpers;
+    job->active.store(1);  // the caller
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(job);
+    }
+    if (helpers == 1) {
+        wake_.notify_one();
+    } else {
+        wake_.notify_all();
+    }
+
+    runJob(*job);
+
+    // No worker may join once the indices are gone; then wait for those still inside
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto queued = std::find(jobs_.begin(), jobs_.end(), job);
+        if (queued != jobs_.end()) {
+            jobs_.erase(queued);
+        }
+    }
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->active.fetch_sub(1);
+    job->done.wait(lock, [&] { return job->active.load() == 0; });
+    if (job->failure) {
+        std::rethrow_exception(job->failure);
+    }
+}
@@ -2,18 +2,19 @@
 #include <tfhe/tfhe_io.h>
 #include <vector>
 #include "native/HomComp.h"
+#include "ScratchPool.h"
  
 // BB1: Validates if the encrypted coordinates (x, y) are within the encrypted location bounds
 void BB1(LweSample* res, const LweSample* x, const LweSample* y, 
          const std::vector<LweSample*>& loc, const int length, const TFheGateBootstrappingCloudKeySet* bk) {
 
     // Allocate space for the intermediate results (single-bit ciphertexts)
-    LweSample* v_x_left = new_gate_bootstrapping_ciphertext_array(1, bk->params);
-    LweSample* v_x_right = new_gate_bootstrapping_ciphertext_array(1, bk->params);
-    LweSample* v_y_left = new_gate_bootstrapping_ciphertext_array(1, bk->params);
-    LweSample* v_y_right = new_gate_bootstrapping_ciphertext_array(1, bk->params);
-    LweSample* v_x = new_gate_bootstrapping_ciphertext_array(1, bk->params);
-    LweSample* v_y = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+    LweSample* v_x_left = acquireScratchArray(1, bk->params);
+    LweSample* v_x_right = acquireScratchArray(1, bk->params);
+    LweSample* v_y_left = acquireScratchArray(1, bk->params);
+    LweSample* v_y_right = acquireScratchArray(1, bk->params);
+    LweSample* v_x = acquireScratchArray(1, bk->params);
+    LweSample* v_y = acquireScratchArray(1, bk->params);
 
     // Perform homomorphic comparisons for latitude
     HomCompLE(v_x_left, loc[0], x, length, bk);  // loc[0] <= x
@@ -32,13 +33,13 @@ void BB1(LweSample* res, const LweSample* x, const LweSample* y,
     // Final validation by combining both latitude and longitude results
     bootsAND(res, v_x, v_y, bk);
 
-    // Clean up temporary variables
-    delete_gate_bootstrapping_ciphertext_array(1, v_x_left);
-    delete_gate_bootstrapping_ciphertext_array(1, v_x_right);
-    delete_gate_bootstrapping_ciphertext_array(1, v_y_left);
-    delete_gate_bootstrapping_ciphertext_array(1, v_y_right);
-    delete_gate_bootstrapping_ciphertext_array(1, v_x);
-    delete_gate_bootstrapping_ciphertext_array(1, v_y);
+    // Return temporary variables to the scratch pool
+    releaseScratchArray(v_x_left, 1, bk->params);
+    releaseScratchArray(v_x_right, 1, bk->params);
+    releaseScratchArray(v_y_left, 1, bk->params);
+    releaseScratchArray(v_y_right, 1, bk->params);
+    releaseScratchArray(v_x, 1, bk->params);
+    releaseScratchArray(v_y, 1, bk->params);
 }
 
 // BB2: Validates if the encrypted coordinates (x, y) match the encrypted location (loc_x, loc_y)
@@ -46,8 +47,8 @@ void BB2(LweSample* res, const LweSample* x, const LweSample* y,
          const std::vector<LweSample*>& loc, const int length, const TFheGateBootstrappingCloudKeySet* bk) {
 
     // Allocate space for the intermediate results (single-bit ciphertexts)
-    LweSample* v_x = new_gate_bootstrapping_ciphertext_array(1, bk->params);
-    LweSample* v_y = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+    LweSample* v_x = acquireScratchArray(1, bk->params);
+    LweSample* v_y = acquireScratchArray(1, bk->params);
 
     // Perform homomorphic equality check for the x-coordinate
     HomEqui(v_x, x, loc[0], length, bk);  // Check if x == loc_x
@@ -58,9 +59,9 @@ void BB2(LweSample* res, const LweSample* x, const LweSample* y,
     // Final validation by combining both x and y results
     bootsAND(res, v_x, v_y, bk);
 
-    // Clean up temporary variables
-    delete_gate_bootstrapping_ciphertext_array(1, v_x);
-    delete_gate_bootstrapping_ciphertext_array(1, v_y);
+    // Return temporary variables to the scratch pool
+    releaseScratchArray(v_x, 1, bk->params);
+    releaseScratchArray(v_y, 1, bk->params);
 }
 
 // BB3: Validates if the encrypted location identifier `id` matches the encrypted target identifier `targetId`
@@ -1,10 +1,11 @@
 #include <tfhe/tfhe.h>
 #include <tfhe/tfhe_io.h>
+#include "ScratchPool.h"
 
 
 // a <= b returns 1
 void HomCompLE(LweSample* res, const LweSample* a, const LweSample* b, const int length, const TFheGateBootstrappingCloudKeySet* bk) {
-    LweSample* temp = new_gate_bootstrapping_ciphertext_array(3, bk->params);
+    LweSample* temp = acquireScratchArray(3, bk->params);
 
     // Compare sign bits to check if the signs are different
     bootsXOR(&temp[0], &a[length-1], &b[length-1], bk);  // temp[0] = 1 if signs differ
@@ -27,12 +28,12 @@ void HomCompLE(LweSample* res, const LweSample* a, const LweSample* b, const int
     // Use the sign bit of 'a' (a[length-1]) to set the result if signs differ
     bootsMUX(res, &temp[0], &a[length-1], &temp[2], bk);
 
-    delete_gate_bootstrapping_ciphertext_array(3, temp);
+    releaseScratchArray(temp, 3, bk->params);
 }
 
 // a < b returns 1
 void HomCompL(LweSample* res, const LweSample* a, const LweSample* b, const int length, const TFheGateBootstrappingCloudKeySet* bk) {
-    LweSample* temp = new_gate_bootstrapping_ciphertext_array(3, bk->params);
+    LweSample* temp = acquireScratchArray(3, bk->params);
 
     // Compare sign bits to check if the signs are different
     bootsXOR(&temp[0], &a[length-1], &b[length-1], bk);  // temp[0] = 1 if signs differ
@@ -51,13 +52,13 @@ void HomCompL(LweSample* res, const LweSample* a, const LweSample* b, const int
     // If signs are different, determine the result based on the sign of 'a'
     bootsMUX(res, &temp[0], &a[length-1], &temp[2], bk);
 
-    delete_gate_bootstrapping_ciphertext_array(3, temp);
+    releaseScratchArray(temp, 3, bk->params);
 }
 
 // a == b returns 1
 void HomEqui(LweSample* res, const LweSample* a, const LweSample* b, const int length, const TFheGateBootstrappingCloudKeySet* bk) {
 
-    LweSample* temp = new_gate_bootstrapping_ciphertext_array(2, bk->params);       
+    LweSample* temp = acquireScratchArray(2, bk->params);       
 
     bootsCONSTANT(&temp[0], 1, bk);
     for(int i = 0; i < length; i++){        
@@ -67,7 +68,7 @@ void HomEqui(LweSample* res, const LweSample* a, const LweSample* b, const int l
     }
     bootsCOPY(&res[0], &temp[0], bk);
 
-    delete_gate_bootstrapping_ciphertext_array(2, temp);
+    releaseScratchArray(temp, 2, bk->params);
 }
 
 
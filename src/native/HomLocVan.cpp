@@ -1,5 +1,7 @@
 #include "native/HomSup.h"
 #include "native/HomBB.h" 
+#include "ScratchPool.h"
+#include "Ciphertext.h"
 #include <tfhe/tfhe.h>
 #include <tfhe/tfhe_io.h>
 #include <vector>
@@ -13,38 +15,27 @@ LweSample* HomLocPIRbb1(const LweSample* enc_x, const LweSample* enc_y,
 
     int M = enc_database.size();  // Number of records in the database
 
-    // Vector to store the filtered data (service values)
-    std::vector<LweSample*> filtered_data(M);
+    // Owned filtered data (service values); each record's result is written straight into its slot
+    std::vector<CiphertextArray> filtered_data = newCiphertextArrays(M, serviceLength, bk->params);
 
-    // Initialize each element of filtered_data with a new ciphertext array
-    for (int i = 0; i < M; i++) {
-        filtered_data[i] = new_gate_bootstrapping_ciphertext_array(serviceLength, bk->params);
-    }
     for (int i = 0; i < M; i++) {
         // Step 1: Extract location and perform validation using BB1
         std::vector<LweSample*> loc = {enc_database[i][0], enc_database[i][1], enc_database[i][2], enc_database[i][3]};
 
-        LweSample* validation_result = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+        LweSample* validation_result = acquireScratchArray(1, bk->params);
         BB1(validation_result, enc_x, enc_y, loc, inputLength, bk);
 
         // Step 2: Zero Out Unrelated Data (only for the service field)
-        LweSample* filtered_service = HomBitwiseAND(validation_result, enc_database[i][4], serviceLength, bk);
-        for (int j = 0; j < serviceLength; j++) {
-            bootsCOPY(&filtered_data[i][j], &filtered_service[j], bk);
-        }
-        delete_gate_bootstrapping_ciphertext_array(1, validation_result);  // Cleanup
-        delete_gate_bootstrapping_ciphertext_array(serviceLength, filtered_service);  // Cleanup
+        HomBitwiseAND(filtered_data[i].get(), validation_result, enc_database[i][4], serviceLength, bk);
+
+        releaseScratchArray(validation_result, 1, bk->params);  // Cleanup
     }
 
     // Step 3: Aggregation of the filtered service values
-    LweSample* result = HomSum(filtered_data, M, serviceLength, bk);
-
-    // Clean up filtered data
-    for (int i = 0; i < M; i++) {
-        delete_gate_bootstrapping_ciphertext_array(serviceLength, filtered_data[i]);
-    }
+    CiphertextArray result(serviceLength, bk->params);
+    HomSum(result.get(), ciphertextPointers(filtered_data), M, serviceLength, bk);
 
-    return result;  // Return the aggregated result
+    return result.release();  // Return the aggregated result
 }
 
 LweSample* HomLocPIRbb2(const LweSample* enc_x, const LweSample* enc_y, 
@@ -54,31 +45,27 @@ LweSample* HomLocPIRbb2(const LweSample* enc_x, const LweSample* enc_y,
 
     int M = enc_database.size();  // Number of records in the database
 
-    // Vector to store the filtered data (service values)
-    std::vector<LweSample*> filtered_data(M);
+    // Owned filtered data (service values); each record's result is written straight into its slot
+    std::vector<CiphertextArray> filtered_data = newCiphertextArrays(M, lengthService, bk->params);
 
     for (int i = 0; i < M; i++) {
         // Step 1: Extract location and perform validation using BB2
         std::vector<LweSample*> loc = {enc_database[i][0], enc_database[i][1]};
 
-        LweSample* validation_result = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+        LweSample* validation_result = acquireScratchArray(1, bk->params);
         BB2(validation_result, enc_x, enc_y, loc, lengthInterval, bk);
 
         // Step 2: Zero Out Unrelated Data (only for the service field)
-        filtered_data[i] = HomBitwiseAND(validation_result, enc_database[i][2], lengthService, bk);
+        HomBitwiseAND(filtered_data[i].get(), validation_result, enc_database[i][2], lengthService, bk);
 
-        delete_gate_bootstrapping_ciphertext_array(1, validation_result);  // Cleanup
+        releaseScratchArray(validation_result, 1, bk->params);  // Cleanup
     }
 
     // Step 3: Aggregation of the filtered service values
-    LweSample* result = HomSum(filtered_data, M, lengthService, bk);
+    CiphertextArray result(lengthService, bk->params);
+    HomSum(result.get(), ciphertextPointers(filtered_data), M, lengthService, bk);
 
-    // Clean up filtered data
-    for (int i = 0; i < M; i++) {
-        delete_gate_bootstrapping_ciphertext_array(lengthService, filtered_data[i]);
-    }
-
-    return result;  // Return the aggregated result
+    return result.release();  // Return the aggregated result
 }
 
 LweSample* HomLocPIRbb3(const LweSample* enc_id, 
@@ -88,30 +75,26 @@ LweSample* HomLocPIRbb3(const LweSample* enc_id,
 
     int M = enc_database.size();  // Number of records in the database
 
-    // Vector to store the filtered data (service values)
-    std::vector<LweSample*> filtered_data(M);
+    // Owned filtered data (service values); each record's result is written straight into its slot
+    std::vector<CiphertextArray> filtered_data = newCiphertextArrays(M, lengthService, bk->params);
 
     for (int i = 0; i < M; i++) {
         // Step 1: Extract the encrypted identifier and perform validation using BB3
         LweSample* targetId = enc_database[i][0];  // The encrypted identifier for the current record
 
-        LweSample* validation_result = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+        LweSample* validation_result = acquireScratchArray(1, bk->params);
         BB3(validation_result, enc_id, targetId, lengthInterval, bk);  // Perform the comparison
 
         // Step 2: Zero Out Unrelated Data (only for the service field)
-        filtered_data[i] = HomBitwiseAND(validation_result, enc_database[i][1], lengthService, bk);
+        HomBitwiseAND(filtered_data[i].get(), validation_result, enc_database[i][1], lengthService, bk);
 
-        delete_gate_bootstrapping_ciphertext_array(1, validation_result);  // Cleanup
+        releaseScratchArray(validation_result, 1, bk->params);  // Cleanup
     }
 
     // Step 3: Aggregation of the filtered service values
-    LweSample* result = HomSum(filtered_data, M, lengthService, bk);
-
-    // Clean up filtered data
-    for (int i = 0; i < M; i++) {
-        delete_gate_bootstrapping_ciphertext_array(lengthService, filtered_data[i]);
-    }
+    CiphertextArray result(lengthService, bk->params);
+    HomSum(result.get(), ciphertextPointers(filtered_data), M, lengthService, bk);
 
-    return result;  // Return the aggregated result
+    return result.release();  // Return the aggregated result
 }
 
@@ -5,13 +5,16 @@
 LweSample* HomBitwiseAND(const LweSample* v, const LweSample* ct, const int length, const TFheGateBootstrappingCloudKeySet* bk) {
     // Allocate memory for the result array
     LweSample* result = new_gate_bootstrapping_ciphertext_array(length, bk->params);
-    
+    HomBitwiseAND(result, v, ct, length, bk);
+    return result;
+}
+
+// Same as above, writing into a caller-owned array
+void HomBitwiseAND(LweSample* result, const LweSample* v, const LweSample* ct, const int length, const TFheGateBootstrappingCloudKeySet* bk) {
     // Apply the AND operation between `v` and each bit of `ct`
     for (int i = 0; i < length; i++) {
         bootsAND(&result[i], v, &ct[i], bk);
     }
-    
-    return result;  
 }
 
 
@@ -19,6 +22,16 @@ LweSample* HomSum(const std::vector<LweSample*>& ct_array, const int num_element
     // Allocate memory for the result array
     LweSample* result = new_gate_bootstrapping_ciphertext_array(lengthService, bk->params);
 
+    if (!HomSum(result, ct_array, num_elements, lengthService, bk)) {
+        delete_gate_bootstrapping_ciphertext_array(lengthService, result);
+        return nullptr;
+    }
+
+    return result;
+}
+
+// Same as above, writing into a caller-owned array; returns false on a null input
+bool HomSum(LweSample* result, const std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk) {
     // Initialize the result array to encrypted zeros
     for (int j = 0; j < lengthService; j++) {
         bootsCONSTANT(&result[j], 0, bk);
@@ -28,7 +41,7 @@ LweSample* HomSum(const std::vector<LweSample*>& ct_array, const int num_element
     for (int i = 0; i < num_elements; i++) {
         if (ct_array[i] == nullptr) {
             std::cerr << "Null pointer detected in ct_array at index " << i << std::endl;
-            return nullptr;
+            return false;
         }
         // Perform bitwise XOR to sum up the ciphertexts
         for (int j = 0; j < lengthService; j++) {
@@ -36,6 +49,5 @@ LweSample* HomSum(const std::vector<LweSample*>& ct_array, const int num_element
         }
     }
 
-    return result; 
+    return true;
 }
-
@@ -0,0 +1,159 @@
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "native/HomBB.h"
+#include "native/HomSup.h"
+#include "optimized/HomLocBatch.h"
+#include "ExecutionBackend.h"
+#include "KeyPlacement.h"
+#include "ScratchPool.h"
+
+namespace {
+
+// Chunks of records per thread: enough that uneven threads even out, few enough that
+// borrowing an accumulator costs nothing next to a chunk's bootstrappings
+const int BATCH_CHUNKS_PER_THREAD = 8;
+
+// Shared driver: `validate(res, k, row, bk)` computes the bit of query k on one record
+template <typename Validate>
+std::vector<CiphertextArray> batchQuery(int K, const std::vector<std::vector<LweSample*>>& enc_database,
+                                        int serviceColumn, int serviceLength,
+                                        const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads,
+                                        Validate validate) {
+    const int M = enc_database.size();
+    const int sums = std::max(1, std::min(M, num_of_threads));
+
+    // partial[s][k]: XOR sum of query k over the chunks that borrowed accumulator s
+    std::vector<std::vector<CiphertextArray>> partial(sums);
+    for (int s = 0; s < sums; s++) {
+        partial[s] = newCiphertextArrays(K, serviceLength, bk->params);
+    }
+    if (M == 0) {
+        for (CiphertextArray& sum : partial[0]) {
+            for (int j = 0; j < serviceLength; j++) {
+                bootsCONSTANT(&sum[j], 0, bk);
+            }
+        }
+        return std::move(partial[0]);
+    }
+
+    // Records go out in small chunks on the backend's dynamic schedule, so a slow thread
+    // does not hold up the batch. A chunk borrows a free accumulator for its duration; at
+    // most `sums` chunks run at once, so one is always free.
+    const int chunkRecords = std::max(1, M / (sums * BATCH_CHUNKS_PER_THREAD));
+    const int chunks = (M + chunkRecords - 1) / chunkRecords;
+    std::mutex freeMutex;
+    std::vector<int> freeSums(sums);
+    std::iota(freeSums.begin(), freeSums.end(), 0);
+    std::vector<char> started(sums, 0);
+
+    currentBackend().parallelFor(0, chunks, num_of_threads, [&](int c) {
+        int s;
+        {
+            std::lock_guard<std::mutex> lock(freeMutex);
+            s = freeSums.back();
+            freeSums.pop_back();
+        }
+        const TFheGateBootstrappingCloudKeySet* local_bk = localCloudKey(bk);  // NUMA replica, if placed
+        LweSample* validation_result = acquireScratchArray(1, local_bk->params);
+        LweSample* filtered = acquireScratchArray(serviceLength, local_bk->params);
+
+        const int first = c * chunkRecords;
+        const int last = std::min(M, first + chunkRecords);
+        for (int i = first; i < last; i++) {
+            // Every query on this record while its ciphertexts are in cache
+            const std::vector<LweSample*>& row = enc_database[i];
+            for (int k = 0; k < K; k++) {
+                validate(validation_result, k, row, local_bk);
+                if (!started[s]) {
+                    HomBitwiseAND(partial[s][k].get(), validation_result, row[serviceColumn], serviceLength, local_bk);
+                    continue;
+                }
+                HomBitwiseAND(filtered, validation_result, row[serviceColumn], serviceLength, local_bk);
+                for (int j = 0; j < serviceLength; j++) {
+                    bootsXOR(&partial[s][k][j], &partial[s][k][j], &filtered[j], local_bk);
+                }
+            }
+            started[s] = 1;
+        }
+
+        releaseScratchArray(filtered, serviceLength, local_bk->params);
+        releaseScratchArray(validation_result, 1, local_bk->params);
+        std::lock_guard<std::mutex> lock(freeMutex);
+        freeSums.push_back(s);
+    });
+
+    // An accumulator no chunk borrowed holds nothing yet
+    for (int s = 0; s < sums; s++) {
+        if (!started[s]) {
+            for (CiphertextArray& sum : partial[s]) {
+                for (int j = 0; j < serviceLength; j++) {
+                    bootsCONSTANT(&sum[j], 0, bk);
+                }
+            }
+        }
+    }
+
+    // XOR tree over the accumulators, split by pair, query and bit
+    const int slots = K * serviceLength;
+    for (int step = 1; step < sums; step *= 2) {
+        int pairs = (sums - step + 2 * step - 1) / (2 * step);
+        currentBackend().parallelFor(0, pairs * slots, num_of_threads, [&](int t) {
+            int s = (t / slots) * 2 * step;
+            int k = (t % slots) / serviceLength;
+            int j = t % serviceLength;
+            bootsXOR(&partial[s][k][j], &partial[s][k][j], &partial[s + step][k][j], localCloudKey(bk));
+        });
+    }
+    return std::move(partial[0]);
+}
+
+void checkBatch(const std::vector<const LweSample*>& enc_x, const std::vector<const LweSample*>& enc_y) {
+    if (enc_x.size() != enc_y.size()) {
+        throw std::invalid_argument("HomLocPIRBatch: enc_x and enc_y hold different numbers of queries");
+    }
+}
+
+} // namespace
+
+std::vector<CiphertextArray> HomLocPIRbb1Batch(const std::vector<const LweSample*>& enc_x,
+                                               const std::vector<const LweSample*>& enc_y,
+                                               const std::vector<std::vector<LweSample*>>& enc_database,
+                                               const int inputLength, const int serviceLength,
+                                               const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads) {
+    checkBatch(enc_x, enc_y);
+    return batchQuery(enc_x.size(), enc_database, 4, serviceLength, bk, num_of_threads,
+                      [&](LweSample* res, int k, const std::vector<LweSample*>& row,
+                          const TFheGateBootstrappingCloudKeySet* local_bk) {
+                          BB1(res, enc_x[k], enc_y[k], {row[0], row[1], row[2], row[3]}, inputLength, local_bk);
+                      });
+}
+
+std::vector<CiphertextArray> HomLocPIRbb2Batch(const std::vector<const LweSample*>& enc_x,
+                                               const std::vector<const LweSample*>& enc_y,
+                                               const std::vector<std::vector<LweSample*>>& enc_database,
+                                               const int lengthInterval, const int lengthService,
+                                               const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads) {
+    checkBatch(enc_x, enc_y);
+    return batchQuery(enc_x.size(), enc_database, 2, lengthService, bk, num_of_threads,
+                      [&](LweSample* res, int k, const std::vector<LweSample*>& row,
+                          const TFheGateBootstrappingCloudKeySet* local_bk) {
+                          BB2(res, enc_x[k], enc_y[k], {row[0], row[1]}, lengthInterval, local_bk);
+                      });
+}
+
+std::vector<CiphertextArray> HomLocPIRbb3Batch(const std::vector<const LweSample*>& enc_ids,
+                                               const std::vector<std::vector<LweSample*>>& enc_database,
+                                               const int lengthInterval, const int lengthService,
+                                               const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads) {
+    return batchQuery(enc_ids.size(), enc_database, 1, lengthService, bk, num_of_threads,
+                      [&](LweSample* res, int k, const std::vector<LweSample*>& row,
+                          const TFheGateBootstrappingCloudKeySet* local_bk) {
+                          BB3(res, enc_ids[k], row[0], lengthInterval, local_bk);
+                      });
+}
@@ -0,0 +1,96 @@
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include <algorithm>
+#include <vector>
+#include "native/HomBB.h"
+#include "native/HomSup.h"
+#include "optimized/HomLocCompressed.h"
+#include "Ciphertext.h"
+#include "ScratchPool.h"
+#include "KeyPlacement.h"
+
+namespace {
+
+// Shared driver: expand a block of records, validate + filter each one, and fold the
+// block into the running XOR sum. `validate(res, block, slot, bk)` computes the record's bit.
+template <typename Validate>
+LweSample* compressedQuery(const CompressedTable& table, int serviceColumn, int serviceLength,
+                           const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads,
+                           size_t cacheBytes, Validate validate) {
+    int M = table.numRecords();
+    int blockRecords = std::max(table.recordsPerBlock(cacheBytes), num_of_threads);
+    blockRecords = std::max(1, std::min(blockRecords, M));
+
+    // Expansion target and filtered services are reused by every block
+    EncryptedTable block(table.schema(), blockRecords, bk->params);
+    std::vector<CiphertextArray> filtered = newCiphertextArrays(blockRecords, serviceLength, bk->params);
+
+    CiphertextArray result(serviceLength, bk->params);
+    for (int j = 0; j < serviceLength; j++) {
+        bootsCONSTANT(&result[j], 0, bk);
+    }
+
+    for (int first = 0; first < M; first += blockRecords) {
+        int count = std::min(blockRecords, M - first);
+
+        #pragma omp parallel for num_threads(num_of_threads)
+        for (int slot = 0; slot < count; slot++) {
+            // Regenerate this record's masks right before its gates
+            table.expandRecord(first + slot, slot, block);
+            const TFheGateBootstrappingCloudKeySet* local_bk = localCloudKey(bk);  // NUMA replica, if placed
+
+            LweSample* validation_result = acquireScratchArray(1, local_bk->params);
+            validate(validation_result, block, slot, local_bk);
+            HomBitwiseAND(filtered[slot].get(), validation_result, block.cell(slot, serviceColumn), serviceLength, local_bk);
+            releaseScratchArray(validation_result, 1, local_bk->params);
+        }
+
+        // Fold the block into the running sum, one service bit per thread
+        #pragma omp parallel for num_threads(num_of_threads)
+        for (int j = 0; j < serviceLength; j++) {
+            for (int slot = 0; slot < count; slot++) {
+                bootsXOR(&result[j], &result[j], &filtered[slot][j], bk);
+            }
+        }
+    }
+
+    return result.release();
+}
+
+} // namespace
+
+LweSample* HomLocPIRbb1Compressed(const LweSample* enc_x, const LweSample* enc_y,
+                                  const CompressedTable& table,
+                                  const int inputLength, const int serviceLength,
+                                  const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads,
+                                  size_t cacheBytes) {
+    return compressedQuery(table, 4, serviceLength, bk, num_of_threads, cacheBytes,
+        [&](LweSample* res, EncryptedTable& block, int slot, const TFheGateBootstrappingCloudKeySet* local_bk) {
+            std::vector<LweSample*> loc = {block.mutableCell(slot, 0), block.mutableCell(slot, 1),
+                                           block.mutableCell(slot, 2), block.mutableCell(slot, 3)};
+            BB1(res, enc_x, enc_y, loc, inputLength, local_bk);
+        });
+}
+
+LweSample* HomLocPIRbb2Compressed(const LweSample* enc_x, const LweSample* enc_y,
+                                  const CompressedTable& table,
+                                  const int lengthInterval, const int lengthService,
+                                  const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads,
+                                  size_t cacheBytes) {
+    return compressedQuery(table, 2, lengthService, bk, num_of_threads, cacheBytes,
+        [&](LweSample* res, EncryptedTable& block, int slot, const TFheGateBootstrappingCloudKeySet* local_bk) {
+            std::vector<LweSample*> loc = {block.mutableCell(slot, 0), block.mutableCell(slot, 1)};
+            BB2(res, enc_x, enc_y, loc, lengthInterval, local_bk);
+        });
+}
+
+LweSample* HomLocPIRbb3Compressed(const LweSample* enc_id,
+                                  const CompressedTable& table,
+                                  const int lengthInterval, const int lengthService,
+                                  const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads,
+                                  size_t cacheBytes) {
+    return compressedQuery(table, 1, lengthService, bk, num_of_threads, cacheBytes,
+        [&](LweSample* res, EncryptedTable& block, int slot, const TFheGateBootstrappingCloudKeySet* local_bk) {
+            BB3(res, enc_id, block.cell(slot, 0), lengthInterval, local_bk);
+        });
+}
@@ -8,92 +8,92 @@
 #include "optimized/HomSupOPT.h"
 #include "optimized/HomLocOPT.h"
 #include "native/HomSup.h"
+#include "ScratchPool.h"
+#include "Ciphertext.h"
+#include "KeyPlacement.h"
+#include "GateCircuit.h"
+#include "ExecutionBackend.h"
+#include <utility>
 
 LweSample* HomLocPIRbb1OPT(const LweSample* enc_x, const LweSample* enc_y, 
                                const std::vector<std::vector<LweSample*>>& enc_database, 
                                const int inputLength, const int serviceLength, 
                                const TFheGateBootstrappingCloudKeySet* bk, 
                                ParallelizationMode mode, int num_of_threads) {
-    int M = enc_database.size();  // Number of records in the database
-    LweSample** filtered_data = new LweSample*[M];  // Use raw array for GPU processing
+    return HomLocPIRbb1OPT(enc_x, enc_y, enc_database, inputLength, serviceLength,
+                           bk, ThreadPartition{mode, num_of_threads, num_of_threads, num_of_threads});
+}
 
-    // Initialize each element of filtered_data with a new ciphertext array
-    for (int i = 0; i < M; i++) {
-        filtered_data[i] = new_gate_bootstrapping_ciphertext_array(serviceLength, bk->params);
+LweSample* HomLocPIRbb1OPT(const LweSample* enc_x, const LweSample* enc_y, 
+                               const std::vector<std::vector<LweSample*>>& enc_database, 
+                               const int inputLength, const int serviceLength, 
+                               const TFheGateBootstrappingCloudKeySet* bk, 
+                               const ThreadPartition& partition) {
+    ParallelizationMode mode = partition.mode;
+    int num_of_threads = partition.recordThreads;  // record loop
+    int kernel_threads = partition.kernelThreads;
+
+    if (mode == ParallelizationMode::GATE_GRAPH) {
+        return HomLocPIRGraph(BuildingBlock::BB1, enc_x, enc_y, enc_database, inputLength, serviceLength,
+                              bk, sharedThreadPool(), partition.reductionThreads).release();
     }
 
+    int M = enc_database.size();  // Number of records in the database
+
+    // Owned filtered data; each record's result is written straight into its slot
+    std::vector<CiphertextArray> filtered_data = newCiphertextArrays(M, serviceLength, bk->params);
+    std::vector<LweSample*> filtered_ptrs = ciphertextPointers(filtered_data);
+    LweSample** filtered_raw = filtered_ptrs.data();
+
     if (mode != ParallelizationMode::NONE) {
-        // Offload the outer loop to the GPU if parallelization is enabled
-        #pragma omp target teams distribute parallel for map(to: enc_x[0:inputLength], enc_y[0:inputLength], bk[0:1]) map(tofrom: filtered_data[0:M])
-        for (int i = 0; i < M; i++) {
-            // GPU parallel region
+        // Outer loop over the records on the current execution backend
+        currentBackend().parallelFor(0, M, num_of_threads, [&](int i) {
+            // On a placed key, read this thread's NUMA replica
+            const TFheGateBootstrappingCloudKeySet* local_bk = localCloudKey(bk);
             std::vector<LweSample*> loc = {enc_database[i][0], enc_database[i][1], enc_database[i][2], enc_database[i][3]};
-            LweSample* validation_result = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+            LweSample* validation_result = acquireScratchArray(1, local_bk->params);
 
             // Apply BB1 and filtering based on the mode
             if (mode == ParallelizationMode::ALL) {
-                BB1OptGPU(validation_result, enc_x, enc_y, loc, inputLength, bk, num_of_threads);
+                BB1OptGPU(validation_result, enc_x, enc_y, loc, inputLength, local_bk, kernel_threads);
             } else if (mode == ParallelizationMode::PARALLEL_LOOP_HOMSUM_BB1_BITWISE) {
-                BB1OPT(validation_result, enc_x, enc_y, loc, inputLength, bk, num_of_threads);
+                BB1OPT(validation_result, enc_x, enc_y, loc, inputLength, local_bk, kernel_threads);
             } else {
-                BB1(validation_result, enc_x, enc_y, loc, inputLength, bk);
+                BB1(validation_result, enc_x, enc_y, loc, inputLength, local_bk);
             }
 
-            // Apply HomBitwiseAND based on the mode
-            LweSample* filtered_service = nullptr;
+            // Apply HomBitwiseAND based on the mode, writing into this record's slot
             if (mode == ParallelizationMode::PARALLEL_LOOP_HOMSUM_BB1_BITWISE || mode == ParallelizationMode::ALL) {
-                filtered_service = HomBitwiseANDGPU(validation_result, enc_database[i][4], serviceLength, bk, num_of_threads);
+                HomBitwiseANDOPT(filtered_raw[i], validation_result, enc_database[i][4], serviceLength, local_bk, kernel_threads);
             } else {
-                filtered_service = HomBitwiseAND(validation_result, enc_database[i][4], serviceLength, bk);
-            }
-
-            // Copy the filtered_service result to filtered_data
-            for (int j = 0; j < serviceLength; j++) {
-                bootsCOPY(&filtered_data[i][j], &filtered_service[j], bk);
+                HomBitwiseAND(filtered_raw[i], validation_result, enc_database[i][4], serviceLength, local_bk);
             }
 
-            delete_gate_bootstrapping_ciphertext_array(1, validation_result);  // Cleanup
-            delete_gate_bootstrapping_ciphertext_array(serviceLength, filtered_service);  // Cleanup
-        }
+            releaseScratchArray(validation_result, 1, local_bk->params);  // Cleanup
+        });
     } else {
         // Non-parallel version of the main loop
         for (int i = 0; i < M; i++) {
             std::vector<LweSample*> loc = {enc_database[i][0], enc_database[i][1], enc_database[i][2], enc_database[i][3]};
-            LweSample* validation_result = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+            LweSample* validation_result = acquireScratchArray(1, bk->params);
 
             BB1(validation_result, enc_x, enc_y, loc, inputLength, bk);
 
-            LweSample* filtered_service = HomBitwiseAND(validation_result, enc_database[i][4], serviceLength, bk);
-
-            for (int j = 0; j < serviceLength; j++) {
-                bootsCOPY(&filtered_data[i][j], &filtered_service[j], bk);
-            }
+            HomBitwiseAND(filtered_raw[i], validation_result, enc_database[i][4], serviceLength, bk);
 
-            delete_gate_bootstrapping_ciphertext_array(1, validation_result);  
-            delete_gate_bootstrapping_ciphertext_array(serviceLength, filtered_service);  
+            releaseScratchArray(validation_result, 1, bk->params);  
         }
     }
 
-    // Convert filtered_data array to std::vector<LweSample*>
-    std::vector<LweSample*> filtered_data_vector(filtered_data, filtered_data + M);
-
-    // Perform HomSum or HomSumGPU based on the mode
-    LweSample* result;
+    // Perform HomSum or HomSumOPT based on the mode
     if (mode == ParallelizationMode::NONE) {
-        result = HomSum(filtered_data_vector, M, serviceLength, bk);
-    } else {
-        result = HomSumGPU(filtered_data_vector, M, serviceLength, bk, 32);
-    }
-
-    // Clean up filtered data
-    for (int i = 0; i < M; i++) {
-        delete_gate_bootstrapping_ciphertext_array(serviceLength, filtered_data[i]);
+        CiphertextArray result(serviceLength, bk->params);
+        HomSum(result.get(), filtered_ptrs, M, serviceLength, bk);
+        return result.release();
     }
 
-    // Deallocate the filtered_data array
-    delete[] filtered_data;
-
-    return result;  // Return the aggregated result
+    // HomSumOPT consumes filtered_data and reduces it in place, so nothing is copied
+    return HomSumOPT(std::move(filtered_data), serviceLength, bk, partition.reductionThreads).release();  // Return the aggregated result
 }
 
 LweSample* HomLocPIRbb2OPT(const LweSample* enc_x, const LweSample* enc_y, 
@@ -101,87 +101,80 @@ LweSample* HomLocPIRbb2OPT(const LweSample* enc_x, const LweSample* enc_y,
                            const int lengthInterval, const int lengthService, 
                            const TFheGateBootstrappingCloudKeySet* bk, 
                            ParallelizationMode mode, int num_of_threads) {
+    return HomLocPIRbb2OPT(enc_x, enc_y, enc_database, lengthInterval, lengthService,
+                           bk, ThreadPartition{mode, num_of_threads, num_of_threads, num_of_threads});
+}
+
+LweSample* HomLocPIRbb2OPT(const LweSample* enc_x, const LweSample* enc_y, 
+                           const std::vector<std::vector<LweSample*>>& enc_database, 
+                           const int lengthInterval, const int lengthService, 
+                           const TFheGateBootstrappingCloudKeySet* bk, 
+                           const ThreadPartition& partition) {
+    ParallelizationMode mode = partition.mode;
+    int num_of_threads = partition.recordThreads;  // record loop
+    int kernel_threads = partition.kernelThreads;
+
+    if (mode == ParallelizationMode::GATE_GRAPH) {
+        return HomLocPIRGraph(BuildingBlock::BB2, enc_x, enc_y, enc_database, lengthInterval, lengthService,
+                              bk, sharedThreadPool(), partition.reductionThreads).release();
+    }
 
     int M = enc_database.size();  // Number of records in the database
-    LweSample** filtered_data = new LweSample*[M];  // Use raw array for GPU processing
 
-    // Initialize each element of filtered_data with a new ciphertext array
-    for (int i = 0; i < M; i++) {
-        filtered_data[i] = new_gate_bootstrapping_ciphertext_array(lengthService, bk->params);
-    }
+    // Owned filtered data; each record's result is written straight into its slot
+    std::vector<CiphertextArray> filtered_data = newCiphertextArrays(M, lengthService, bk->params);
+    std::vector<LweSample*> filtered_ptrs = ciphertextPointers(filtered_data);
+    LweSample** filtered_raw = filtered_ptrs.data();
 
     if (mode != ParallelizationMode::NONE) {
-        // Offload the outer loop to the GPU if parallelization is enabled
-        #pragma omp target teams distribute parallel for map(to: enc_x[0:lengthInterval], enc_y[0:lengthInterval], bk[0:1]) map(tofrom: filtered_data[0:M])
-        for (int i = 0; i < M; i++) {
-            // GPU parallel region
+        // Outer loop over the records on the current execution backend
+        currentBackend().parallelFor(0, M, num_of_threads, [&](int i) {
+            // On a placed key, read this thread's NUMA replica
+            const TFheGateBootstrappingCloudKeySet* local_bk = localCloudKey(bk);
             std::vector<LweSample*> loc = {enc_database[i][0], enc_database[i][1]};
-            LweSample* validation_result = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+            LweSample* validation_result = acquireScratchArray(1, local_bk->params);
 
             // Apply BB2 and filtering based on the mode
             if (mode == ParallelizationMode::ALL) {
-                BB2OptGPU(validation_result, enc_x, enc_y, loc, lengthInterval, bk, num_of_threads);
+                BB2OptGPU(validation_result, enc_x, enc_y, loc, lengthInterval, local_bk, kernel_threads);
             } else if (mode == ParallelizationMode::PARALLEL_LOOP_HOMSUM_BB1_BITWISE) {
-                BB2OPT(validation_result, enc_x, enc_y, loc, lengthInterval, bk, num_of_threads);
+                BB2OPT(validation_result, enc_x, enc_y, loc, lengthInterval, local_bk, kernel_threads);
             } else {
-                BB2(validation_result, enc_x, enc_y, loc, lengthInterval, bk);
+                BB2(validation_result, enc_x, enc_y, loc, lengthInterval, local_bk);
             }
 
-            // Apply HomBitwiseAND based on the mode
-            LweSample* filtered_service = nullptr;
+            // Apply HomBitwiseAND based on the mode, writing into this record's slot
             if (mode == ParallelizationMode::PARALLEL_LOOP_HOMSUM_BB1_BITWISE || mode == ParallelizationMode::ALL) {
-                filtered_service = HomBitwiseANDGPU(validation_result, enc_database[i][2], lengthService, bk, num_of_threads);
+                HomBitwiseANDOPT(filtered_raw[i], validation_result, enc_database[i][2], lengthService, local_bk, kernel_threads);
             } else {
-                filtered_service = HomBitwiseAND(validation_result, enc_database[i][2], lengthService, bk);
+                HomBitwiseAND(filtered_raw[i], validation_result, enc_database[i][2], lengthService, local_bk);
             }
 
-            // Copy the filtered_service result to filtered_data
-            for (int j = 0; j < lengthService; j++) {
-                bootsCOPY(&filtered_data[i][j], &filtered_service[j], bk);
-            }
-
-            delete_gate_bootstrapping_ciphertext_array(1, validation_result);  // Cleanup
-            delete_gate_bootstrapping_ciphertext_array(lengthService, filtered_service);  // Cleanup
-        }
+            releaseScratchArray(validation_result, 1, local_bk->params);  // Cleanup
+        });
     } else {
         // Non-parallel version of the main loop
         for (int i = 0; i < M; i++) {
             std::vector<LweSample*> loc = {enc_database[i][0], enc_database[i][1]};
-            LweSample* validation_result = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+            LweSample* validation_result = acquireScratchArray(1, bk->params);
 
             BB2(validation_result, enc_x, enc_y, loc, lengthInterval, bk);
 
-            LweSample* filtered_service = HomBitwiseAND(validation_result, enc_database[i][2], lengthService, bk);
-
-            for (int j = 0; j < lengthService; j++) {
-                bootsCOPY(&filtered_data[i][j], &filtered_service[j], bk);
-            }
+            HomBitwiseAND(filtered_raw[i], validation_result, enc_database[i][2], lengthService, bk);
 
-            delete_gate_bootstrapping_ciphertext_array(1, validation_result);  // Cleanup
-            delete_gate_bootstrapping_ciphertext_array(lengthService, filtered_service);  // Cleanup
+            releaseScratchArray(validation_result, 1, bk->params);  // Cleanup
         }
     }
 
-    // Convert filtered_data array to std::vector<LweSample*>
-    std::vector<LweSample*> filtered_data_vector(filtered_data, filtered_data + M);
-
-    // Perform HomSum or HomSumGPU based on the mode
-    LweSample* result;
+    // Perform HomSum or HomSumOPT based on the mode
     if (mode == ParallelizationMode::NONE) {
-        result = HomSum(filtered_data_vector, M, lengthService, bk);
-    } else {
-        result = HomSumGPU(filtered_data_vector, M, lengthService, bk, 32);
-    }
-
-    // Clean up filtered data
-    for (int i = 0; i < M; i++) {
-        delete_gate_bootstrapping_ciphertext_array(lengthService, filtered_data[i]);
+        CiphertextArray result(lengthService, bk->params);
+        HomSum(result.get(), filtered_ptrs, M, lengthService, bk);
+        return result.release();
     }
 
-    // Deallocate the filtered_data array
-    delete[] filtered_data;
-
-    return result;  
+    // HomSumOPT consumes filtered_data and reduces it in place, so nothing is copied
+    return HomSumOPT(std::move(filtered_data), lengthService, bk, partition.reductionThreads).release();
 }
 
 LweSample* HomLocPIRbb3OPT(const LweSample* enc_id, 
@@ -189,86 +182,78 @@ LweSample* HomLocPIRbb3OPT(const LweSample* enc_id,
                            const int lengthInterval, const int lengthService,
                            const TFheGateBootstrappingCloudKeySet* bk, 
                            ParallelizationMode mode, int num_of_threads) {
+    return HomLocPIRbb3OPT(enc_id, enc_database, lengthInterval, lengthService,
+                           bk, ThreadPartition{mode, num_of_threads, num_of_threads, num_of_threads});
+}
 
-    int M = enc_database.size();  
+LweSample* HomLocPIRbb3OPT(const LweSample* enc_id, 
+                           const std::vector<std::vector<LweSample*>>& enc_database,
+                           const int lengthInterval, const int lengthService,
+                           const TFheGateBootstrappingCloudKeySet* bk, 
+                           const ThreadPartition& partition) {
+    ParallelizationMode mode = partition.mode;
+    int num_of_threads = partition.recordThreads;  // record loop
+    int kernel_threads = partition.kernelThreads;
+
+    if (mode == ParallelizationMode::GATE_GRAPH) {
+        return HomLocPIRGraph(BuildingBlock::BB3, enc_id, nullptr, enc_database, lengthInterval, lengthService,
+                              bk, sharedThreadPool(), partition.reductionThreads).release();
+    }
 
-    LweSample** filtered_data = new LweSample*[M];  
+    int M = enc_database.size();  
 
-    // Initialize each element of filtered_data with a new ciphertext array
-    for (int i = 0; i < M; i++) {
-        filtered_data[i] = new_gate_bootstrapping_ciphertext_array(lengthService, bk->params);
-    }
+    // Owned filtered data; each record's result is written straight into its slot
+    std::vector<CiphertextArray> filtered_data = newCiphertextArrays(M, lengthService, bk->params);
+    std::vector<LweSample*> filtered_ptrs = ciphertextPointers(filtered_data);
+    LweSample** filtered_raw = filtered_ptrs.data();
 
     if (mode != ParallelizationMode::NONE) {
-        // Offload the outer loop to the GPU if parallelization is enabled
-        #pragma omp target teams distribute parallel for map(to: enc_id[0:lengthInterval], bk[0:1]) map(tofrom: filtered_data[0:M])
-        for (int i = 0; i < M; i++) {
-            // GPU parallel region
+        // Outer loop over the records on the current execution backend
+        currentBackend().parallelFor(0, M, num_of_threads, [&](int i) {
+            // On a placed key, read this thread's NUMA replica
+            const TFheGateBootstrappingCloudKeySet* local_bk = localCloudKey(bk);
             LweSample* targetId = enc_database[i][0];  // The encrypted identifier for the current record
-            LweSample* validation_result = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+            LweSample* validation_result = acquireScratchArray(1, local_bk->params);
 
             // Apply BB3 and filtering based on the mode
             if (mode == ParallelizationMode::ALL) {
-                BB3OptGPU(validation_result, enc_id, targetId, lengthInterval, bk, num_of_threads);
+                BB3OptGPU(validation_result, enc_id, targetId, lengthInterval, local_bk, kernel_threads);
             } else {
-                BB3(validation_result, enc_id, targetId, lengthInterval, bk);
+                BB3(validation_result, enc_id, targetId, lengthInterval, local_bk);
             }
 
-            // Apply HomBitwiseAND based on the mode
-            LweSample* filtered_service = nullptr;
+            // Apply HomBitwiseAND based on the mode, writing into this record's slot
             if (mode == ParallelizationMode::PARALLEL_LOOP_HOMSUM_BB1_BITWISE || mode == ParallelizationMode::ALL) {
-                filtered_service = HomBitwiseANDGPU(validation_result, enc_database[i][1], lengthService, bk, num_of_threads);
+                HomBitwiseANDOPT(filtered_raw[i], validation_result, enc_database[i][1], lengthService, local_bk, kernel_threads);
             } else {
-                filtered_service = HomBitwiseAND(validation_result, enc_database[i][1], lengthService, bk);
+                HomBitwiseAND(filtered_raw[i], validation_result, enc_database[i][1], lengthService, local_bk);
             }
 
-            // Copy the filtered_service result to filtered_data
-            for (int j = 0; j < lengthService; j++) {
-                bootsCOPY(&filtered_data[i][j], &filtered_service[j], bk);
-            }
-
-            delete_gate_bootstrapping_ciphertext_array(1, validation_result);  
-            delete_gate_bootstrapping_ciphertext_array(lengthService, filtered_service);  
-        }
+            releaseScratchArray(validation_result, 1, local_bk->params);  
+        });
     } else {
         // Non-parallel version of the main loop
         for (int i = 0; i < M; i++) {
             LweSample* targetId = enc_database[i][0];  
-            LweSample* validation_result = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+            LweSample* validation_result = acquireScratchArray(1, bk->params);
 
             BB3(validation_result, enc_id, targetId, lengthInterval, bk);
 
-            LweSample* filtered_service = HomBitwiseAND(validation_result, enc_database[i][1], lengthService, bk);
+            HomBitwiseAND(filtered_raw[i], validation_result, enc_database[i][1], lengthService, bk);
 
-            for (int j = 0; j < lengthService; j++) {
-                bootsCOPY(&filtered_data[i][j], &filtered_service[j], bk);
-            }
-
-            delete_gate_bootstrapping_ciphertext_array(1, validation_result);  
-            delete_gate_bootstrapping_ciphertext_array(lengthService, filtered_service);  
+            releaseScratchArray(validation_result, 1, bk->params);  
         }
     }
 
-    // Convert filtered_data array to std::vector<LweSample*>
-    std::vector<LweSample*> filtered_data_vector(filtered_data, filtered_data + M);
-
-    // Perform HomSum or HomSumGPU based on the mode
-    LweSample* result;
+    // Perform HomSum or HomSumOPT based on the mode
     if (mode == ParallelizationMode::NONE) {
-        result = HomSum(filtered_data_vector, M, lengthService, bk);
-    } else {
-        result = HomSumGPU(filtered_data_vector, M, lengthService, bk, 32);
+        CiphertextArray result(lengthService, bk->params);
+        HomSum(result.get(), filtered_ptrs, M, lengthService, bk);
+        return result.release();
     }
 
-    // Clean up filtered data
-    for (int i = 0; i < M; i++) {
-        delete_gate_bootstrapping_ciphertext_array(lengthService, filtered_data[i]);
-    }
-
-    // Deallocate the filtered_data array
-    delete[] filtered_data;
-
-    return result;  
+    // HomSumOPT consumes filtered_data and reduces it in place, so nothing is copied
+    return HomSumOPT(std::move(filtered_data), lengthService, bk, partition.reductionThreads).release();
 }
 
 
@@ -1,109 +1,143 @@
-#include <omp.h>
 #include <tfhe/tfhe.h>
 #include <tfhe/tfhe_io.h>
 #include <vector>
+#include <utility>
 #include "optimized/HomSupOPT.h"
+#include "ExecutionBackend.h"
 
 // Perform bitwise AND between a single-bit ciphertext `v` and each bit of a ciphertext array `ct` using parallelization
 LweSample* HomBitwiseANDOPT(LweSample* v, LweSample* ct, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads) {
 
     LweSample* result = new_gate_bootstrapping_ciphertext_array(lengthService, bk->params);
+    HomBitwiseANDOPT(result, v, ct, lengthService, bk, num_of_threads);
+    return result;
+}
 
-    // Set the number of threads for OpenMP
-    omp_set_num_threads(num_of_threads);
+void HomBitwiseANDOPT(LweSample* result, const LweSample* v, const LweSample* ct, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads) {
 
-    #pragma omp parallel for
-    for (int i = 0; i < lengthService; i++) {
+    currentBackend().parallelFor(0, lengthService, num_of_threads, [&](int i) {
         // Apply AND operation on each bit of `ct` with `v`
         bootsAND(&result[i], v, &ct[i], bk);
-    }
-
-    return result;  
+    });
 }
 
-// Perform bitwise AND between a single-bit ciphertext `v` and each bit of a ciphertext array `ct` using GPU offloading with OpenMP
+// The *GPU names predate the execution backends and now share the kernels above
 LweSample* HomBitwiseANDGPU(LweSample* v, LweSample* ct, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores) {
-    
-    LweSample* result = new_gate_bootstrapping_ciphertext_array(lengthService, bk->params);
-
-    // Offload computation to the GPU
-    #pragma omp target teams distribute parallel for num_threads(num_of_cores) map(to:v[0:1], bk[0:1]) map(tofrom:ct[0:lengthService])
-    for (int i = 0; i < lengthService; i++) {
-        // Apply AND operation on each bit of `ct` with `v`
-        bootsAND(&result[i], v, &ct[i], bk);
-    }
 
+    LweSample* result = new_gate_bootstrapping_ciphertext_array(lengthService, bk->params);
+    HomBitwiseANDGPU(result, v, ct, lengthService, bk, num_of_cores);
     return result;  // Return the modified ciphertext array
 }
 
+void HomBitwiseANDGPU(LweSample* result, const LweSample* v, const LweSample* ct, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores) {
+    HomBitwiseANDOPT(result, v, ct, lengthService, bk, num_of_cores);
+}
+
 // Optimized version of HomSum using OpenMP for parallel reduction
 LweSample* HomSumOPT(std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads) {
 
     // Allocate memory for the result array
     LweSample* result = new_gate_bootstrapping_ciphertext_array(lengthService, bk->params);
-
-    // Perform parallel reduction using XOR
-    for (int k = 1; k < num_elements; k *= 2) {
-        #pragma omp parallel for num_threads(num_of_threads)
-        for (int i = 0; i < num_elements; i += 2 * k) {
-            if (i + k < num_elements) {
-                for (int j = 0; j < lengthService; j++) {
-                    bootsXOR(&ct_array[i][j], &ct_array[i][j], &ct_array[i + k][j], bk);
-                }
-            }
-        }
-    }
-
-    // Copy the first element (now containing the result) to the result array
-    for (int i = 0; i < lengthService; i++) {
-        bootsCOPY(&result[i], &ct_array[0][i], bk);
-    }
+    HomSumOPT(result, ct_array, num_elements, lengthService, bk, num_of_threads);
 
     // Return the result array
     return result;
 }
 
-LweSample* HomSumGPU(std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores) {
+// The first reduction level reads the inputs and writes pairwise sums into ceil(M/2) work
+// arrays, the remaining levels run in place on those, and the last level writes into `result`.
+// Inputs are therefore neither copied nor overwritten.
+void HomSumOPT(LweSample* result, const std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads) {
 
-    // Convert std::vector<LweSample*> to raw array for GPU processing
-    LweSample** ct_array_raw = new LweSample*[num_elements];
-    for (int i = 0; i < num_elements; ++i) {
-        ct_array_raw[i] = new_gate_bootstrapping_ciphertext_array(lengthService, bk->params);
+    if (num_elements <= 2) {
+        for (int j = 0; j < lengthService; j++) {
+            if (num_elements == 0) {
+                bootsCONSTANT(&result[j], 0, bk);
+            } else if (num_elements == 1) {
+                bootsCOPY(&result[j], &ct_array[0][j], bk);
+            } else {
+                bootsXOR(&result[j], &ct_array[0][j], &ct_array[1][j], bk);
+            }
+        }
+        return;
     }
 
-    // Copy data from the vector to the raw array
-    for (int i = 0; i < num_elements; i++) {
+    int num_work = (num_elements + 1) / 2;
+    std::vector<CiphertextArray> work = newCiphertextArrays(num_work, lengthService, bk->params);
+
+    // First level: pairwise sums of the inputs
+    currentBackend().parallelFor(0, num_work, num_of_threads, [&](int i) {
         for (int j = 0; j < lengthService; j++) {
-            bootsCOPY(&ct_array_raw[i][j], &ct_array[i][j], bk);
+            if (2 * i + 1 < num_elements) {
+                bootsXOR(&work[i][j], &ct_array[2 * i][j], &ct_array[2 * i + 1][j], bk);
+            } else {
+                bootsCOPY(&work[i][j], &ct_array[2 * i][j], bk);
+            }
         }
+    });
+
+    // Perform parallel reduction using XOR, stopping one level early
+    int k = 1;
+    for (; 2 * k < num_work; k *= 2) {
+        currentBackend().parallelFor(0, (num_work - k + 2 * k - 1) / (2 * k), num_of_threads, [&](int p) {
+            int i = p * 2 * k;
+            for (int j = 0; j < lengthService; j++) {
+                bootsXOR(&work[i][j], &work[i][j], &work[i + k][j], bk);
+            }
+        });
     }
 
+    // Last level lands directly in the result
+    currentBackend().parallelFor(0, lengthService, num_of_threads, [&](int j) {
+        bootsXOR(&result[j], &work[0][j], &work[k][j], bk);
+    });
+}
+
+LweSample* HomSumGPU(std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores) {
+
     // Allocate memory for the result array
     LweSample* result = new_gate_bootstrapping_ciphertext_array(lengthService, bk->params);
+    HomSumGPU(result, ct_array, num_elements, lengthService, bk, num_of_cores);
 
-    // Offload the entire reduction process to the GPU
-    for (int k = 1; k < num_elements; k *= 2) {
-        #pragma omp target teams distribute parallel for num_threads(num_of_cores) map(tofrom: ct_array_raw[0:num_elements]) map(to: bk[0:1])
-        for (int i = 0; i < num_elements; i += 2 * k) {
-            if (i + k < num_elements) {
-                for (int j = 0; j < lengthService; j++) {
-                    bootsXOR(&ct_array_raw[i][j], &ct_array_raw[i][j], &ct_array_raw[i + k][j], bk);
-                }
-            }
+    // Return the result array
+    return result;
+}
+
+void HomSumGPU(LweSample* result, const std::vector<LweSample*>& ct_array, const int num_elements, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores) {
+    HomSumOPT(result, ct_array, num_elements, lengthService, bk, num_of_cores);
+}
+
+CiphertextArray HomSumOPT(std::vector<CiphertextArray>&& ct_array, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_threads) {
+
+    int num_elements = ct_array.size();
+    if (num_elements == 0) {
+        CiphertextArray result(lengthService, bk->params);
+        for (int j = 0; j < lengthService; j++) {
+            bootsCONSTANT(&result[j], 0, bk);
         }
+        return result;
     }
 
-    // Copy the first element (now containing the result) to the result array
-    #pragma omp target teams distribute parallel for num_threads(num_of_cores) map(to: bk[0:1]) map(from: result[0:lengthService])
-    for (int i = 0; i < lengthService; i++) {
-        bootsCOPY(&result[i], &ct_array_raw[0][i], bk);
-    }
+    std::vector<LweSample*> ct_ptrs = ciphertextPointers(ct_array);
+    LweSample** ct_raw = ct_ptrs.data();
 
-    // Cleanup the raw array (but not the data it points to)
-    for (int i = 0; i < num_elements; ++i) {
-        delete_gate_bootstrapping_ciphertext_array(lengthService, ct_array_raw[i]);
+    // The caller gave up the arrays, so the whole reduction runs in place; every level is
+    // split by record pair and bit
+    for (int k = 1; k < num_elements; k *= 2) {
+        int pairs = (num_elements - k + 2 * k - 1) / (2 * k);
+        currentBackend().parallelFor(0, pairs * lengthService, num_of_threads, [&](int t) {
+            int i = (t / lengthService) * 2 * k;
+            int j = t % lengthService;
+            bootsXOR(&ct_raw[i][j], &ct_raw[i][j], &ct_raw[i + k][j], bk);
+        });
     }
 
-    // Return the result array
+    // The first array now holds the sum; the others are freed with the vector
+    CiphertextArray result = std::move(ct_array[0]);
+    ct_array.clear();
     return result;
 }
+
+CiphertextArray HomSumGPU(std::vector<CiphertextArray>&& ct_array, const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, int num_of_cores) {
+    return HomSumOPT(std::move(ct_array), lengthService, bk, num_of_cores);
+}
@@ -1,4 +1,6 @@
 #include "utils.h"
+#include "KeyGeneration.h"
+#include "ResponseCodec.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -19,6 +21,13 @@ TFheGateBootstrappingSecretKeySet* generateKeySet(TFheGateBootstrappingParameter
     return new_random_gate_bootstrapping_secret_keyset(params);
 }
 
+// Multi-threaded key generation (see KeyGeneration.h) from the same fixed seed, so
+// benchmark and test runs stay reproducible. Never for keys that protect real data:
+// those come from generateKeySetParallel(params, randomMaskSeed(), num_of_threads).
+TFheGateBootstrappingSecretKeySet* generateKeySet(TFheGateBootstrappingParameterSet* params, int num_of_threads) {
+    return generateKeySetParallel(params, maskSeedFromInts(314, 1592, 657), num_of_threads);
+}
+
 // Encoding and decoding functions
 int32_t encodeDouble(int length, double data) {
     if (length % 2 != 0) {
@@ -74,9 +83,14 @@ double decodeDouble(const std::vector<int>& binaryVector) {
 // Encryption and decryption functions
 LweSample* encryptBoolean(int32_t plaintext, int length, const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
     LweSample* ciphertext = new_gate_bootstrapping_ciphertext_array(length, params);
+    encryptBooleanTo(ciphertext, plaintext, length, key);
+    return ciphertext;
+}
+
+// Encrypt into caller-provided storage (e.g. a table arena view)
+void encryptBooleanTo(LweSample* ciphertext, int32_t plaintext, int length, const TFheGateBootstrappingSecretKeySet* key) {
     for (int i = 0; i < length; i++) 
         bootsSymEncrypt(&ciphertext[i], (plaintext >> i) & 1, key);
-    return ciphertext;
 }
 
 std::vector<int> decryptToBinaryVector(const LweSample* ciphertext, int length, const TFheGateBootstrappingSecretKeySet* key) {
@@ -123,13 +137,16 @@ std::string binaryStringToText(const std::string& binaryString) {
 LweSample* encryptBinaryString(const std::string& binaryString, const TFheGateBootstrappingSecretKeySet* key, const TFheGateBootstrappingCloudKeySet* bk) {
     int length = binaryString.length();
     LweSample* ciphertext = new_gate_bootstrapping_ciphertext_array(length, bk->params);
-    
+    encryptBinaryStringTo(ciphertext, binaryString, key);
+    return ciphertext;
+}
+
+void encryptBinaryStringTo(LweSample* ciphertext, const std::string& binaryString, const TFheGateBootstrappingSecretKeySet* key) {
+    int length = binaryString.length();
     for (int i = 0; i < length; i++) {
         int bit = binaryString[i] - '0';  // Convert '0' or '1' to integer
         bootsSymEncrypt(&ciphertext[i], bit, key);
     }
-    
-    return ciphertext;
 }
 
 std::string decryptBinaryString(const LweSample* ciphertext, int length, const TFheGateBootstrappingSecretKeySet* key) {
@@ -143,6 +160,32 @@ std::string decryptBinaryString(const LweSample* ciphertext, int length, const T
     return binaryString;
 }
 
+// Decrypt a modulus-switched response: the phase b - <a, s> is computed mod 2^modulusBits,
+// +1/8 (bit 1) lands in the lower half of the switched torus and -1/8 (bit 0) in the upper
+std::vector<int> decryptResponseToBinaryVector(const CompressedResponse& response, const TFheGateBootstrappingSecretKeySet* key) {
+    const int32_t* s = key->lwe_key->key;
+    const uint32_t mask = (UINT32_C(1) << response.modulusBits) - 1;
+    std::vector<int> binaryVector(response.length);
+
+    for (int i = 0; i < response.length; i++) {
+        uint32_t phase = responseCoefficient(response, i, response.n);
+        for (int k = 0; k < response.n; k++) {
+            if (s[k]) phase -= responseCoefficient(response, i, k);
+        }
+        phase &= mask;
+        binaryVector[i] = (phase != 0 && phase < (UINT32_C(1) << (response.modulusBits - 1))) ? 1 : 0;
+    }
+    return binaryVector;
+}
+
+std::string decryptResponseBinaryString(const CompressedResponse& response, const TFheGateBootstrappingSecretKeySet* key) {
+    std::string binaryString = "";
+    for (int bit : decryptResponseToBinaryVector(response, key)) {
+        binaryString += std::to_string(bit);
+    }
+    return binaryString;
+}
+
 // Encryption of Database
 std::vector<std::vector<std::string>> loadDataFromCSV(const std::string& filename) {
     std::vector<std::vector<std::string>> data;
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <chrono>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "native/HomBB.h"
+#include "BootstrappingKeyFile.h"
+#include "utils.h"
+
+void test_KeyFileRoundTrip(const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::string path = "testBootstrappingKeyFile.bk";
+    writeBootstrappingKeyFile(path, bk);
+
+    // Server side: only the parameter set and the file are needed
+    auto start = std::chrono::high_resolution_clock::now();
+    MappedCloudKey mapped(path, params);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    const TFheGateBootstrappingCloudKeySet* loaded = mapped.get();
+    std::cout << "Key file (bytes): " << mapped.mappedBytes() << ", load time (s): " << elapsed.count() << std::endl;
+
+    // Test 1: FFT polynomials are bit-identical
+    const int n = params->in_out_params->n;
+    const int N = params->tgsw_params->tlwe_params->N;
+    const int k = params->tgsw_params->tlwe_params->k;
+    const int kpl = params->tgsw_params->kpl;
+    struct Polynomial { double* coefsC; void* proc; };  // spqlios layout
+    for (int i = 0; i < n; i++) {
+        for (int row = 0; row < kpl; row++) {
+            const Polynomial* a = reinterpret_cast<const Polynomial*>(bk->bkFFT->bkFFT[i].all_samples[row].a);
+            const Polynomial* b = reinterpret_cast<const Polynomial*>(loaded->bkFFT->bkFFT[i].all_samples[row].a);
+            for (int q = 0; q <= k; q++) {
+                assert(std::memcmp(a[q].coefsC, b[q].coefsC, N * sizeof(double)) == 0);
+            }
+        }
+    }
+    std::cout << "Test 1 (FFT key) passed." << std::endl;
+
+    // Test 2: Keyswitch key is identical, including the nested views
+    const LweKeySwitchKey* ksA = bk->bkFFT->ks;
+    const LweKeySwitchKey* ksB = loaded->bkFFT->ks;
+    assert(ksA->n == ksB->n && ksA->t == ksB->t && ksA->base == ksB->base);
+    for (int i = 0; i < ksA->n; i += 97) {
+        for (int j = 0; j < ksA->t; j++) {
+            for (int v = 0; v < ksA->base; v++) {
+                const LweSample& a = ksA->ks[i][j][v];
+                const LweSample& b = ksB->ks[i][j][v];
+                assert(a.b == b.b);
+                assert(std::memcmp(a.a, b.a, n * sizeof(Torus32)) == 0);
+            }
+        }
+    }
+    std::cout << "Test 2 (Keyswitch key) passed." << std::endl;
+
+    // Test 3: The mapped key evaluates gates
+    LweSample* x = encryptBoolean(5, 4, params, key);
+    LweSample* y = encryptBoolean(5, 4, params, key);
+    LweSample* res = new_gate_bootstrapping_ciphertext_array(1, params);
+    BB3(res, x, y, 4, loaded);
+    assert(bootsSymDecrypt(res, key) == 1);
+    std::cout << "Test 3 (Gates with the mapped key) passed." << std::endl;
+
+    // Test 4: A truncated file is rejected
+    {
+        std::ofstream truncated(path, std::ios::binary | std::ios::trunc);
+        truncated.write("PIBK", 4);
+    }
+    bool rejected = false;
+    try {
+        MappedCloudKey broken(path, params);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+    std::cout << "Test 4 (Truncated file) passed." << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(1, res);
+    delete_gate_bootstrapping_ciphertext_array(4, x);
+    delete_gate_bootstrapping_ciphertext_array(4, y);
+    std::remove(path.c_str());
+}
+
+int main() {
+    // Initialize parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_KeyFileRoundTrip(params, key);
+
+    // Clean up keys
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All bootstrapping key file tests passed." << std::endl;
+    return 0;
+}
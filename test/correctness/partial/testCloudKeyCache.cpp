@@ -0,0 +1,106 @@
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "native/HomBB.h"
+#include "CloudKeyCache.h"
+#include "utils.h"
+
+void test_LRU(const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    std::string directory = "testCloudKeyCache_keys";
+    CloudKeyCache cache(directory, params, 2);
+
+    // Three tenants (sharing one key here), two resident slots
+    cache.registerKey("alice", &key->cloud);
+    cache.registerKey("bob", &key->cloud);
+    cache.registerKey("carol", &key->cloud);
+    assert(cache.residentKeys() == 0);
+
+    // Test 1: First use misses, repeated use hits
+    std::shared_ptr<const MappedCloudKey> alice = cache.acquire("alice");
+    assert(cache.acquire("alice") == alice);
+    assert(cache.misses() == 1 && cache.hits() == 1);
+    std::cout << "Test 1 (Hit and miss counters) passed." << std::endl;
+
+    // Test 2: Least recently used key is evicted
+    cache.acquire("bob");
+    cache.acquire("alice");  // alice is now most recent
+    cache.acquire("carol");  // evicts bob
+    assert(cache.isResident("alice") && cache.isResident("carol") && !cache.isResident("bob"));
+    assert(cache.residentKeys() == 2 && cache.evictions() == 1);
+    std::cout << "Test 2 (LRU eviction) passed." << std::endl;
+
+    // Test 3: An evicted key stays valid for the query still holding it
+    std::shared_ptr<const MappedCloudKey> held = cache.acquire("bob");  // evicts alice
+    assert(!cache.isResident("alice"));
+    LweSample* x = encryptBoolean(3, 4, params, key);
+    LweSample* res = new_gate_bootstrapping_ciphertext_array(1, params);
+    BB3(res, x, x, 4, alice->get());
+    assert(bootsSymDecrypt(res, key) == 1);
+    BB3(res, x, x, 4, held->get());
+    assert(bootsSymDecrypt(res, key) == 1);
+    std::cout << "Test 3 (Evicted key outlives the cache entry) passed." << std::endl;
+
+    // Test 4: Unknown and malformed IDs are rejected
+    bool unknown = false, malformed = false;
+    try {
+        cache.acquire("mallory");
+    } catch (const std::runtime_error&) {
+        unknown = true;
+    }
+    try {
+        cache.acquire("../alice");
+    } catch (const std::invalid_argument&) {
+        malformed = true;
+    }
+    assert(unknown && malformed);
+    std::cout << "Test 4 (Unknown and malformed IDs) passed." << std::endl;
+
+    // Test 5: Concurrent misses on one ID share a single mapping, and uploads leave no staging files
+    cache.removeKey("carol");
+    cache.registerKey("carol", &key->cloud);
+    std::vector<std::shared_ptr<const MappedCloudKey>> loaded(4);
+    std::vector<std::thread> clients;
+    for (size_t t = 0; t < loaded.size(); t++) {
+        clients.emplace_back([&, t] { loaded[t] = cache.acquire("carol"); });
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    for (const auto& k : loaded) {
+        assert(k == loaded[0] && k == cache.acquire("carol"));
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        assert(entry.path().extension() == ".bk");
+    }
+    std::cout << "Test 5 (Concurrent misses share one load) passed." << std::endl;
+
+    std::cout << "Hits: " << cache.hits() << ", misses: " << cache.misses()
+              << ", evictions: " << cache.evictions() << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(1, res);
+    delete_gate_bootstrapping_ciphertext_array(4, x);
+    cache.removeKey("alice");
+    cache.removeKey("bob");
+    cache.removeKey("carol");
+    std::filesystem::remove_all(directory);
+}
+
+int main() {
+    // Initialize parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_LRU(params, key);
+
+    // Clean up keys
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All cloud key cache tests passed." << std::endl;
+    return 0;
+}
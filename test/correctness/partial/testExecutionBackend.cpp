@@ -0,0 +1,117 @@
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "ExecutionBackend.h"
+#include "native/HomBB.h"
+#include "native/HomComp.h"
+#include "optimized/HomBBOPT.h"
+#include "optimized/HomCompOPT.h"
+#include "optimized/HomSupOPT.h"
+#include "utils.h"
+
+const BackendKind KINDS[] = {BackendKind::SERIAL, BackendKind::OPENMP, BackendKind::THREAD_POOL};
+
+void test_Loops() {
+    // Test 1: Every backend runs each index once and rethrows a failing body
+    for (BackendKind kind : KINDS) {
+        std::vector<std::atomic<int>> hits(100);
+        backend(kind).parallelFor(0, 100, 4, [&](int i) { hits[i]++; });
+        for (std::atomic<int>& hit : hits) {
+            assert(hit.load() == 1);
+        }
+
+        bool thrown = false;
+        try {
+            backend(kind).parallelFor(0, 100, 4, [](int i) {
+                if (i == 42) throw std::runtime_error("index 42");
+            });
+        } catch (const std::runtime_error& e) {
+            thrown = std::string(e.what()) == "index 42";
+        }
+        assert(thrown);
+        assert(backend(kind).kind() == kind);
+    }
+    std::cout << "Test 1 (Backend loops) passed." << std::endl;
+
+    // Test 2: Names round-trip and the selection switches
+    for (BackendKind kind : KINDS) {
+        assert(backendKindFromName(backendName(kind)) == kind);
+        setBackend(kind);
+        assert(currentBackend().kind() == kind);
+    }
+    bool thrown = false;
+    try {
+        backendKindFromName("cuda");
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Test 2 (Backend selection) passed." << std::endl;
+}
+
+void test_Kernels(const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    const int length = 16;
+    LweSample* x = encryptBoolean(encodeDouble(length, 37.5), length, params, key);
+    LweSample* y = encryptBoolean(encodeDouble(length, 126.9), length, params, key);
+    std::vector<LweSample*> loc = {encryptBoolean(encodeDouble(length, 37.0), length, params, key),
+                                   encryptBoolean(encodeDouble(length, 38.0), length, params, key),
+                                   encryptBoolean(encodeDouble(length, 126.5), length, params, key),
+                                   encryptBoolean(encodeDouble(length, 127.5), length, params, key)};
+    LweSample* res = new_gate_bootstrapping_ciphertext_array(1, params);
+
+    // Test 3: The kernels answer the same on every backend
+    for (BackendKind kind : KINDS) {
+        setBackend(kind);
+        HomCompLeOPT(res, loc[0], x, length, bk, 4);
+        assert(bootsSymDecrypt(res, key) == 1);
+        HomCompLOPT(res, x, loc[0], length, bk, 4);
+        assert(bootsSymDecrypt(res, key) == 0);
+        HomEquiOPT(res, x, x, length, bk, 4);
+        assert(bootsSymDecrypt(res, key) == 1);
+        HomEquiOPT(res, x, y, length, bk, 4);
+        assert(bootsSymDecrypt(res, key) == 0);
+        BB1OptGPU(res, x, y, loc, length, bk, 4);
+        assert(bootsSymDecrypt(res, key) == 1);
+        BB2OPT(res, x, y, {x, loc[0]}, length, bk, 4);
+        assert(bootsSymDecrypt(res, key) == 0);
+
+        std::vector<CiphertextArray> parts;
+        for (int p = 0; p < 5; p++) {
+            parts.emplace_back(8, params);
+            encryptBooleanTo(parts.back().get(), 1 << p, 8, key);
+        }
+        CiphertextArray sum = HomSumOPT(std::move(parts), 8, bk, 4);
+        assert(decryptToBinaryVector(sum.get(), 8, key) == std::vector<int>({1, 1, 1, 1, 1, 0, 0, 0}));
+    }
+    setBackend(BackendKind::OPENMP);
+    std::cout << "Test 3 (Kernels on every backend) passed." << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(1, res);
+    delete_gate_bootstrapping_ciphertext_array(length, x);
+    delete_gate_bootstrapping_ciphertext_array(length, y);
+    for (LweSample* bound : loc) {
+        delete_gate_bootstrapping_ciphertext_array(length, bound);
+    }
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_Loops();
+    test_Kernels(params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All execution backend tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <chrono>
+#include <cassert>
+#include <cstring>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "native/HomBB.h"
+#include "KeyGeneration.h"
+#include "utils.h"
+
+bool sameKeySet(const TFheGateBootstrappingSecretKeySet* x, const TFheGateBootstrappingSecretKeySet* y) {
+    const TFheGateBootstrappingParameterSet* params = x->params;
+    const int n = params->in_out_params->n;
+    const int N = params->tgsw_params->tlwe_params->N;
+    const int k = params->tgsw_params->tlwe_params->k;
+    const int kpl = params->tgsw_params->kpl;
+
+    if (std::memcmp(x->lwe_key->key, y->lwe_key->key, n * sizeof(int32_t)) != 0) return false;
+    for (int q = 0; q < k; q++) {
+        if (std::memcmp(x->tgsw_key->key[q].coefs, y->tgsw_key->key[q].coefs, N * sizeof(int32_t)) != 0) return false;
+    }
+    for (int i = 0; i < n; i++) {
+        for (int row = 0; row < kpl; row++) {
+            for (int q = 0; q <= k; q++) {
+                const Torus32* a = x->cloud.bk->bk[i].all_sample[row].a[q].coefsT;
+                const Torus32* b = y->cloud.bk->bk[i].all_sample[row].a[q].coefsT;
+                if (std::memcmp(a, b, N * sizeof(Torus32)) != 0) return false;
+            }
+        }
+    }
+    const LweKeySwitchKey* ksX = x->cloud.bk->ks;
+    const LweKeySwitchKey* ksY = y->cloud.bk->ks;
+    for (int s = 0; s < ksX->n * ksX->t * ksX->base; s++) {
+        if (ksX->ks0_raw[s].b != ksY->ks0_raw[s].b) return false;
+        if (std::memcmp(ksX->ks0_raw[s].a, ksY->ks0_raw[s].a, n * sizeof(Torus32)) != 0) return false;
+    }
+    return true;
+}
+
+void test_KeyGeneration(const TFheGateBootstrappingParameterSet* params) {
+    MaskSeed seed = maskSeedFromInts(7, 8, 9);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    TFheGateBootstrappingSecretKeySet* single = generateKeySetParallel(params, seed, 1);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "Key generation, 1 thread (s): " << elapsed.count() << std::endl;
+
+    start = std::chrono::high_resolution_clock::now();
+    TFheGateBootstrappingSecretKeySet* parallel = generateKeySetParallel(params, seed, 4);
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = end - start;
+    std::cout << "Key generation, 4 threads (s): " << elapsed.count() << std::endl;
+
+    // Test 1: The key set depends on the seed only, not on the thread count
+    assert(sameKeySet(single, parallel));
+    std::cout << "Test 1 (Reproducible across thread counts) passed." << std::endl;
+
+    // Test 2: Keyswitch samples decrypt to h * K'_i / base^(j+1)
+    const LweKeySwitchKey* ks = parallel->cloud.bk->ks;
+    const int N = params->tgsw_params->tlwe_params->N;
+    for (int i = 0; i < ks->n; i += 131) {
+        int32_t keyBit = parallel->tgsw_key->key[i / N].coefs[i % N];
+        for (int j = 0; j < ks->t; j++) {
+            for (int h = 0; h < ks->base; h++) {
+                uint32_t expected = static_cast<uint32_t>(keyBit * h) << (32 - (j + 1) * ks->basebit);
+                int32_t error = static_cast<int32_t>(static_cast<uint32_t>(lwePhase(&ks->ks[i][j][h], parallel->lwe_key)) - expected);
+                assert(error > -(1 << 24) && error < (1 << 24));
+            }
+        }
+    }
+    std::cout << "Test 2 (Keyswitch key) passed." << std::endl;
+
+    // Test 3: The generated key set encrypts and evaluates gates
+    LweSample* x = encryptBoolean(5, 4, params, parallel);
+    LweSample* y = encryptBoolean(5, 4, params, parallel);
+    LweSample* res = new_gate_bootstrapping_ciphertext_array(1, params);
+    assert(decryptToBinaryVector(x, 4, parallel) == std::vector<int>({1, 0, 1, 0}));
+    BB3(res, x, y, 4, &parallel->cloud);
+    assert(bootsSymDecrypt(res, parallel) == 1);
+    std::cout << "Test 3 (Gates with the generated key) passed." << std::endl;
+
+    // Test 4: Another seed gives another key
+    TFheGateBootstrappingSecretKeySet* other = generateKeySetParallel(params, maskSeedFromInts(7, 8, 10), 4);
+    assert(!sameKeySet(parallel, other));
+    std::cout << "Test 4 (Seed changes the key) passed." << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(1, res);
+    delete_gate_bootstrapping_ciphertext_array(4, x);
+    delete_gate_bootstrapping_ciphertext_array(4, y);
+    delete_gate_bootstrapping_secret_keyset(other);
+    delete_gate_bootstrapping_secret_keyset(parallel);
+    delete_gate_bootstrapping_secret_keyset(single);
+}
+
+int main() {
+    auto params = initializeParams(128);
+
+    test_KeyGeneration(params);
+
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All key generation tests passed." << std::endl;
+    return 0;
+}
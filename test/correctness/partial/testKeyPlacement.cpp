@@ -0,0 +1,134 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "native/HomBB.h"
+#include "KeyPlacement.h"
+#include "ThreadPool.h"
+#include "utils.h"
+
+const char* backingName(PageBacking backing) {
+    switch (backing) {
+        case PageBacking::HUGETLB_PAGES: return "hugetlbfs pages";
+        case PageBacking::TRANSPARENT_HUGE_PAGES: return "transparent huge pages";
+        default: return "small pages";
+    }
+}
+
+// BB3 on equal identifiers must come out 1 with any copy of the key
+void checkGates(const TFheGateBootstrappingCloudKeySet* placed, const TFheGateBootstrappingParameterSet* params,
+                const TFheGateBootstrappingSecretKeySet* key) {
+    LweSample* x = encryptBoolean(5, 4, params, key);
+    LweSample* y = encryptBoolean(5, 4, params, key);
+    LweSample* res = new_gate_bootstrapping_ciphertext_array(1, params);
+    BB3(res, x, y, 4, placed);
+    assert(bootsSymDecrypt(res, key) == 1);
+    delete_gate_bootstrapping_ciphertext_array(1, res);
+    delete_gate_bootstrapping_ciphertext_array(4, x);
+    delete_gate_bootstrapping_ciphertext_array(4, y);
+}
+
+void test_KeyPlacement(const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    // Test 1: Every CPU we may run on belongs to exactly one node
+    NumaTopology topology = detectNumaTopology();
+    assert(topology.numNodes() >= 1);
+    assert(topology.nodeIds.size() == topology.nodeCpus.size());
+    for (int node = 0; node < topology.numNodes(); node++) {
+        assert(!topology.nodeCpus[node].empty());
+        for (int cpu : topology.nodeCpus[node]) {
+            assert(topology.nodeOfCpu(cpu) == node);
+        }
+    }
+    std::cout << "NUMA nodes: " << topology.numNodes() << std::endl;
+    std::cout << "Test 1 (Topology) passed." << std::endl;
+
+    // Test 2: A huge-page copy holds the same key and evaluates gates
+    {
+        PlacedCloudKey placed(bk);
+        std::cout << "Backing: " << backingName(placed.backing()) << std::endl;
+        assert(placed.numReplicas() == 1);
+        const LweKeySwitchKey* ksA = bk->bkFFT->ks;
+        const LweKeySwitchKey* ksB = placed.get()->bkFFT->ks;
+        for (int i = 0; i < ksA->n; i += 97) {
+            assert(std::memcmp(ksA->ks[i][0][1].a, ksB->ks[i][0][1].a, params->in_out_params->n * sizeof(Torus32)) == 0);
+        }
+        checkGates(placed.get(), params, key);
+    }
+    std::cout << "Test 2 (Huge-page key) passed." << std::endl;
+
+    // Test 3: Two replicas (one fake node per half of the CPUs) serve the calling thread's node
+    {
+        NumaTopology split;
+        std::vector<int> cpus = topology.nodeCpus[0];
+        size_t half = (cpus.size() + 1) / 2;
+        split.nodeCpus.push_back(std::vector<int>(cpus.begin(), cpus.begin() + half));
+        split.nodeCpus.push_back(cpus.size() > 1 ? std::vector<int>(cpus.begin() + half, cpus.end()) : cpus);
+        split.nodeIds = {topology.nodeIds[0], topology.nodeIds[0]};
+
+        KeyPlacementPolicy policy;
+        policy.replicatePerNode = true;
+        PlacedCloudKey placed(bk, policy, split);
+        assert(placed.numReplicas() == 2);
+        assert(placed.replica(0) != placed.replica(1));
+        assert(placed.replica(0) == placed.get());
+
+        // Any replica resolves to the local one, unplaced keys resolve to themselves
+        const TFheGateBootstrappingCloudKeySet* local = localCloudKey(placed.replica(1));
+        assert(local == placed.replica(0) || local == placed.replica(1));
+        assert(localCloudKey(placed.get()) == placed.local());
+        assert(localCloudKey(bk) == bk);
+
+        checkGates(placed.replica(0), params, key);
+        checkGates(placed.replica(1), params, key);
+
+        // Node numbers past the first mask word are not truncated: node 200 does not exist, so
+        // the bind is refused (or binding is unavailable altogether)
+        split.nodeIds = {topology.nodeIds[0], 200};
+        bool refused = false;
+        try {
+            PlacedCloudKey bad(bk, policy, split);
+            refused = !bad.nodeBound();
+        } catch (const std::runtime_error&) {
+            refused = true;
+        }
+        assert(refused);
+        std::cout << "Replicas bound to their node: " << (placed.nodeBound() ? "yes" : "no") << std::endl;
+    }
+    std::cout << "Test 3 (Per-node replicas) passed." << std::endl;
+
+    // Test 4: Pinning keeps the OpenMP and ThreadPool workers usable, and their cached
+    // lookups follow keys being placed and released
+    pinWorkerThreads(4, topology);
+    ThreadPool pool(3);
+    pinPoolWorkers(pool, topology);
+    for (int round = 0; round < 2; round++) {
+        PlacedCloudKey placed(bk);
+        checkGates(localCloudKey(placed.get()), params, key);
+        std::vector<const TFheGateBootstrappingCloudKeySet*> resolved(16);
+        pool.parallelFor(0, 16, 4, [&](int i) { resolved[i] = localCloudKey(placed.get()); });
+        for (const TFheGateBootstrappingCloudKeySet* local : resolved) {
+            assert(local == placed.get());
+        }
+    }
+    std::cout << "Test 4 (Pinned workers) passed." << std::endl;
+}
+
+int main() {
+    // Initialize parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_KeyPlacement(params, key);
+
+    // Clean up keys
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All key placement tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <cassert>
+#include <vector>
+#include "native/HomBB.h"
+#include "QueryCodec.h"
+#include "utils.h"
+
+void test_QueryRoundTrip(const int length, const TFheGateBootstrappingCloudKeySet* bk, const TFheGateBootstrappingSecretKeySet* key) {
+    double queryX_value = 37.5;
+    double queryY_value = -126.9;
+    int32_t queryX = encodeDouble(length, queryX_value);
+    int32_t queryY = encodeDouble(length, queryY_value);
+
+    // Client: compress and serialize
+    CompressedQuery query = encryptCompressedQuery({queryX, queryY}, length, key);
+    std::stringstream wire;
+    exportCompressedQueryToStream(wire, query);
+    size_t compressedBytes = wire.str().size();
+
+    // Server: deserialize and expand
+    CompressedQuery received = importCompressedQueryFromStream(wire);
+    std::vector<CiphertextArray> expanded = expandCompressedQuery(received, bk->params);
+    assert(expanded.size() == 2);
+
+    // Test 1: Expanded ciphertexts decrypt to the original coordinates
+    std::vector<int> bitsX = decryptToBinaryVector(expanded[0].get(), length, key);
+    std::vector<int> bitsY = decryptToBinaryVector(expanded[1].get(), length, key);
+    for (int i = 0; i < length; i++) {
+        assert(bitsX[i] == ((queryX >> i) & 1));
+        assert(bitsY[i] == ((queryY >> i) & 1));
+    }
+    std::cout << "Test 1 (Round trip) passed." << std::endl;
+
+    // Test 2: Expanded ciphertexts are usable by the kernels
+    LweSample* res = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+    BB3(res, expanded[0].get(), expanded[0].get(), length, bk);
+    assert(bootsSymDecrypt(res, key) == 1);
+    BB3(res, expanded[0].get(), expanded[1].get(), length, bk);
+    assert(bootsSymDecrypt(res, key) == 0);
+    delete_gate_bootstrapping_ciphertext_array(1, res);
+    std::cout << "Test 2 (Kernel on expanded query) passed." << std::endl;
+
+    // Test 3: Size against the full tfhe_io encoding
+    std::stringstream full;
+    exportCiphertextArrayToStream(full, expanded[0].get(), length, bk->params);
+    exportCiphertextArrayToStream(full, expanded[1].get(), length, bk->params);
+    size_t fullBytes = full.str().size();
+    std::cout << "Query upload (bytes): full " << fullBytes << ", compressed " << compressedBytes << std::endl;
+    assert(compressedBytes * 10 < fullBytes);
+
+    // Test 4: Full encoding round trips as well
+    CiphertextArray reread(length, bk->params);
+    importCiphertextArrayFromStream(full, reread.get(), length, bk->params);
+    std::vector<int> rereadBits = decryptToBinaryVector(reread.get(), length, key);
+    assert(rereadBits == bitsX);
+    std::cout << "Test 3 (Size) and Test 4 (tfhe_io round trip) passed." << std::endl;
+
+    // Test 5: Malformed sizes are rejected before anything is allocated from them
+    auto rejects = [](std::string bytes) {
+        std::stringstream stream(bytes);
+        try {
+            importCompressedQueryFromStream(stream);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    std::string valid = wire.str();
+    std::string negativeLength = valid;
+    negativeLength[44] = negativeLength[45] = negativeLength[46] = negativeLength[47] = '\xff';  // lengths[0] = -1
+    std::string hugeCount = valid;
+    hugeCount[43] = '\x7f';  // count ~ 2^31
+    assert(rejects(negativeLength));
+    assert(rejects(hugeCount));
+    assert(rejects(valid.substr(0, valid.size() - 1)));
+    std::cout << "Test 5 (Malformed sizes) passed." << std::endl;
+}
+
+int main() {
+    // Initialize parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    int length = 16;  // Length of the encoded coordinates (in bits)
+
+    // Run tests
+    test_QueryRoundTrip(length, bk, key);
+
+    // Clean up keys
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All query codec tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <cassert>
+#include <string>
+#include "QueryCodec.h"
+#include "ResponseCodec.h"
+#include "utils.h"
+
+void test_ResponseRoundTrip(const int serviceLength, const TFheGateBootstrappingCloudKeySet* bk, const TFheGateBootstrappingSecretKeySet* key) {
+    std::string service = textToBinaryString("Seoul", serviceLength);
+    std::string other = textToBinaryString("Busan", serviceLength);
+
+    // Bootstrapped output, as returned by the PIR kernels (record XOR zero record)
+    LweSample* a = encryptBinaryString(service, key, bk);
+    LweSample* b = encryptBinaryString(other, key, bk);
+    LweSample* result = new_gate_bootstrapping_ciphertext_array(serviceLength, bk->params);
+    for (int i = 0; i < serviceLength; i++) {
+        bootsXOR(&result[i], &a[i], &b[i], bk);
+    }
+    std::string expected = "";
+    for (int i = 0; i < serviceLength; i++) {
+        expected += (service[i] != other[i]) ? '1' : '0';
+    }
+
+    // Test 1: Every supported width decrypts correctly
+    for (int bits = 12; bits <= 16; bits++) {
+        CompressedResponse response = compressResponse(result, serviceLength, bk->params, bits);
+        assert(decryptResponseBinaryString(response, key) == expected);
+    }
+    std::cout << "Test 1 (12-16 bit moduli) passed." << std::endl;
+
+    // Test 2: Wire round trip of the default encoding
+    std::stringstream wire;
+    exportCompressedResponseToStream(wire, compressResponse(result, serviceLength, bk->params));
+    size_t compressedBytes = wire.str().size();
+    CompressedResponse received = importCompressedResponseFromStream(wire, bk->params);
+    assert(received.modulusBits == DEFAULT_RESPONSE_MODULUS_BITS);
+    assert(decryptResponseBinaryString(received, key) == expected);
+    std::cout << "Test 2 (Stream round trip) passed." << std::endl;
+
+    // Test 3: Size against the full tfhe_io encoding
+    std::stringstream full;
+    exportCiphertextArrayToStream(full, result, serviceLength, bk->params);
+    size_t fullBytes = full.str().size();
+    std::cout << "Response download (bytes): full " << fullBytes << ", compressed " << compressedBytes << std::endl;
+    assert(compressedBytes * 2 < fullBytes);
+    std::cout << "Test 3 (Size) passed." << std::endl;
+
+    // Test 4: Headers outside compressResponse's ranges, or a short payload, are rejected
+    auto rejects = [&](std::string bytes) {
+        std::stringstream stream(bytes);
+        try {
+            importCompressedResponseFromStream(stream, bk->params);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    std::string valid = wire.str();
+    for (char bits : {'\x00', '\x01', '\x20', '\x40'}) {
+        std::string badWidth = valid;
+        badWidth[8] = bits;  // modulusBits
+        assert(rejects(badWidth));
+    }
+    std::string badDimension = valid;
+    badDimension[16] ^= 1;  // n
+    assert(rejects(badDimension));
+    std::string longer = valid;
+    longer[12] = longer[12] + 1;  // one more sample than the payload holds
+    assert(rejects(longer));
+    assert(rejects(valid.substr(0, valid.size() - 1)));
+    std::cout << "Test 4 (Malformed header) passed." << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, a);
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, b);
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+}
+
+int main() {
+    // Initialize parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    int serviceLength = 48;  // Length of the service string (in bits)
+
+    // Run tests
+    test_ResponseRoundTrip(serviceLength, bk, key);
+
+    // Clean up keys
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All response codec tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <cassert>
+#include <string>
+#include "QueryCodec.h"
+#include "ResponseCodec.h"
+#include "ResponsePacking.h"
+#include "utils.h"
+
+void test_PackRoundTrip(const int serviceLength, const TFheGateBootstrappingCloudKeySet* bk, const TFheGateBootstrappingSecretKeySet* key) {
+    std::string service = textToBinaryString("Partly cloudy", serviceLength);
+    std::string other = textToBinaryString("Light rain", serviceLength);
+
+    PackingSecretKey packingSecret = newPackingSecretKey(bk->params);
+    PackingKey packingKey = newPackingKey(packingSecret, key, 4);
+
+    // Test 1: Fresh encryptions pack and unpack
+    LweSample* a = encryptBinaryString(service, key, bk);
+    PackedResponse packed = packResponse(a, serviceLength, packingKey, 4);
+    assert(unpackResponseBinaryString(packed, packingSecret) == service);
+    std::cout << "Test 1 (Fresh samples) passed." << std::endl;
+
+    // Test 2: Bootstrapped output, as returned by the PIR kernels
+    LweSample* b = encryptBinaryString(other, key, bk);
+    LweSample* result = new_gate_bootstrapping_ciphertext_array(serviceLength, bk->params);
+    for (int i = 0; i < serviceLength; i++) {
+        bootsXOR(&result[i], &a[i], &b[i], bk);
+    }
+    std::string expected = "";
+    for (int i = 0; i < serviceLength; i++) {
+        expected += (service[i] != other[i]) ? '1' : '0';
+    }
+    packed = packResponse(result, serviceLength, packingKey, 4);
+    assert(unpackResponseBinaryString(packed, packingSecret) == expected);
+    std::cout << "Test 2 (Bootstrapped samples) passed." << std::endl;
+
+    // Test 3: Wire round trip and size against the full tfhe_io encoding
+    std::stringstream wire;
+    exportPackedResponseToStream(wire, packed);
+    size_t packedBytes = wire.str().size();
+    PackedResponse received = importPackedResponseFromStream(wire, bk->params);
+    assert(unpackResponseBinaryString(received, packingSecret) == expected);
+
+    std::stringstream full;
+    exportCiphertextArrayToStream(full, result, serviceLength, bk->params);
+    size_t fullBytes = full.str().size();
+    std::cout << "Response download (bytes): full " << fullBytes << ", packed " << packedBytes << std::endl;
+    assert(packedBytes * (serviceLength / 4) < fullBytes);
+    std::cout << "Test 3 (Stream round trip and size) passed." << std::endl;
+
+    // Test 4: More bits than ring coefficients spill into a second RLWE sample
+    const int longLength = packingKey.N + 8;
+    LweSample* longResult = new_gate_bootstrapping_ciphertext_array(longLength, bk->params);
+    std::string longExpected = "";
+    for (int i = 0; i < longLength; i++) {
+        int bit = (i * 7 + 3) % 5 < 2;
+        bootsSymEncrypt(&longResult[i], bit, key);
+        longExpected += std::to_string(bit);
+    }
+    PackedResponse longPacked = packResponse(longResult, longLength, packingKey, 4);
+    assert(longPacked.a.size() == static_cast<size_t>(2 * packingKey.N));
+    assert(unpackResponseBinaryString(longPacked, packingSecret) == longExpected);
+    assert(longPacked.b.size() == static_cast<size_t>(longLength));
+    std::cout << "Test 4 (Multiple chunks) passed." << std::endl;
+
+    // Test 5: A ring dimension other than the parameter set's (0 included) is rejected
+    auto rejects = [&](std::string bytes) {
+        std::stringstream stream(bytes);
+        try {
+            importPackedResponseFromStream(stream, bk->params);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    std::string valid = wire.str();
+    std::string zeroN = valid;
+    zeroN[8] = zeroN[9] = zeroN[10] = zeroN[11] = '\0';
+    std::string otherN = valid;
+    otherN[9] ^= 1;
+    assert(rejects(zeroN));
+    assert(rejects(otherN));
+    assert(rejects(valid.substr(0, valid.size() - 1)));
+    std::stringstream keyWire;
+    exportPackingKeyToStream(keyWire, packingKey);
+    PackingKey reloaded = importPackingKeyFromStream(keyWire, bk->params);
+    assert(reloaded.a == packingKey.a && reloaded.b == packingKey.b);
+    std::cout << "Test 5 (Malformed response) passed." << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, a);
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, b);
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+    delete_gate_bootstrapping_ciphertext_array(longLength, longResult);
+}
+
+int main() {
+    // Initialize parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    int serviceLength = 128;  // Length of the service string (in bits)
+
+    // Run tests
+    test_PackRoundTrip(serviceLength, bk, key);
+
+    // Clean up keys
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All response packing tests passed." << std::endl;
+    return 0;
+}
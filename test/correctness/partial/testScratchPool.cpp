@@ -0,0 +1,80 @@
+#include <iostream>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include <cassert>
+#include <vector>
+#include "native/HomBB.h"
+#include "optimized/HomBBOPT.h"
+#include "ScratchPool.h"
+#include "utils.h"
+
+void test_ScratchPoolReuse(const int length, const TFheGateBootstrappingCloudKeySet* bk, const TFheGateBootstrappingSecretKeySet* key) {
+    // Query point (2, 3) inside the box [1, 4) x [1, 4)
+    LweSample* x = encryptBoolean(encodeDouble(length, 2.0), length, bk->params, key);
+    LweSample* y = encryptBoolean(encodeDouble(length, 3.0), length, bk->params, key);
+    std::vector<LweSample*> loc = {
+        encryptBoolean(encodeDouble(length, 1.0), length, bk->params, key),
+        encryptBoolean(encodeDouble(length, 4.0), length, bk->params, key),
+        encryptBoolean(encodeDouble(length, 1.0), length, bk->params, key),
+        encryptBoolean(encodeDouble(length, 4.0), length, bk->params, key)
+    };
+    LweSample* res = new_gate_bootstrapping_ciphertext_array(1, bk->params);
+
+    // Warm-up call fills the calling thread's pool
+    BB1(res, x, y, loc, length, bk);
+    assert(bootsSymDecrypt(res, key) == 1);
+    size_t warm = scratchPoolAllocations();
+
+    // Test 1: Repeated kernel calls on the same thread allocate nothing
+    for (int i = 0; i < 3; i++) {
+        BB1(res, x, y, loc, length, bk);
+        assert(bootsSymDecrypt(res, key) == 1);
+        BB2(res, x, y, loc, length, bk);
+        BB3(res, x, x, length, bk);
+        assert(bootsSymDecrypt(res, key) == 1);
+    }
+    size_t afterNative = scratchPoolAllocations();
+    std::cout << "Allocations after warm-up: " << warm << ", after native reruns: " << afterNative << std::endl;
+    assert(afterNative - warm <= 2);  // only BB2/BB3 bucket sizes are new
+    std::cout << "Test 1 (Native kernel reuse) passed." << std::endl;
+
+    // Test 2: Pool survives a second round without growing
+    size_t before = scratchPoolAllocations();
+    BB2(res, x, y, loc, length, bk);
+    BB3(res, x, x, length, bk);
+    assert(scratchPoolAllocations() == before);
+    std::cout << "Test 2 (Steady state) passed." << std::endl;
+
+    // Test 3: Per-thread pools in the parallel kernel give correct results
+    BB1OPT(res, x, y, loc, length, bk, 4);
+    assert(bootsSymDecrypt(res, key) == 1);
+    std::cout << "Test 3 (Parallel kernel) passed." << std::endl;
+
+    // Clean up
+    delete_gate_bootstrapping_ciphertext_array(1, res);
+    delete_gate_bootstrapping_ciphertext_array(length, x);
+    delete_gate_bootstrapping_ciphertext_array(length, y);
+    for (LweSample* bound : loc) {
+        delete_gate_bootstrapping_ciphertext_array(length, bound);
+    }
+    clearScratchPool();
+}
+
+int main() {
+    // Initialize parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    int length = 8;  // Length of the encoded coordinates (in bits)
+
+    // Run tests
+    test_ScratchPoolReuse(length, bk, key);
+
+    // Clean up keys
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All scratch pool tests passed." << std::endl;
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include <cassert>
 #include <vector>
 #include "optimized/HomSupOPT.h"
+#include "Ciphertext.h"
 #include "utils.h"
 
 // Test function for HomBitwiseANDOPT
@@ -126,6 +127,31 @@ void test_HomSumGPU(const int lengthService, const TFheGateBootstrappingCloudKey
     std::cout << "HomSumGPU passed all tests." << std::endl;
 }
 
+// Test function for the consuming HomSumGPU overload on owned arrays
+void test_HomSumGPUConsume(const int lengthService, const TFheGateBootstrappingCloudKeySet* bk, const TFheGateBootstrappingSecretKeySet* key, int num_of_cores) {
+    for (int num_elements : {1, 2, 5, 9}) {
+        // Owned arrays of encrypted zeros with the last element non-zero
+        std::vector<CiphertextArray> ct_array;
+        for (int i = 0; i < num_elements; i++) {
+            double value = (i == num_elements - 1) ? 1.25 : 0.0;
+            ct_array.push_back(CiphertextArray::adopt(encryptBoolean(encodeDouble(lengthService, value), lengthService, bk->params, key), lengthService));
+        }
+
+        // Written into the caller's array without touching the inputs
+        CiphertextArray summed(lengthService, bk->params);
+        HomSumOPT(summed.get(), ciphertextPointers(ct_array), num_elements, lengthService, bk, num_of_cores);
+        assert(decodeDouble(decryptToBinaryVector(summed.get(), lengthService, key)) == 1.25);
+        assert(decodeDouble(decryptToBinaryVector(ct_array[0].get(), lengthService, key)) == (num_elements == 1 ? 1.25 : 0.0));
+
+        // Consumes the arrays and hands back the first one as the sum
+        CiphertextArray result = HomSumGPU(std::move(ct_array), lengthService, bk, num_of_cores);
+        assert(ct_array.empty());
+        assert(decodeDouble(decryptToBinaryVector(result.get(), lengthService, key)) == 1.25);
+    }
+
+    std::cout << "HomSumGPU (consuming) passed all tests." << std::endl;
+}
+
 int main() {
     // Initialize parameters and keys
     auto params = initializeParams(128);
@@ -141,6 +167,7 @@ int main() {
     test_HomBitwiseANDGPU(length, bk, key, num_of_threads);
     test_HomSumOPT(length, bk, key, num_of_threads);
     test_HomSumGPU(length, bk, key, num_of_threads);
+    test_HomSumGPUConsume(length, bk, key, num_of_threads);
 
     // Clean up keys
     delete_gate_bootstrapping_secret_keyset(key);
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "AutoTuner.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "optimized/HomLocOPT.h"
+
+void test_Candidates() {
+    // Test 1: Candidates use the whole budget and shapes bucket their record counts
+    for (const ThreadPartition& partition : candidatePartitions(8)) {
+        if (partition.mode != ParallelizationMode::NONE) {
+            assert(partition.recordThreads * partition.kernelThreads == 8);
+            assert(partition.reductionThreads == 8);
+        }
+    }
+    assert(candidatePartitions(8).size() == 3 + 2 * 4);
+    assert(candidatePartitions(1).size() == 1 && candidatePartitions(1)[0].mode == ParallelizationMode::NONE);
+
+    DatasetShape shape{BuildingBlock::BB1, 56, 16, 22, 8};
+    DatasetShape similar{BuildingBlock::BB1, 64, 16, 22, 8};
+    assert(shape.key() == similar.key());
+    assert(shape.key() == "bb1/M64/in16/svc22/T8");
+    for (ParallelizationMode mode : {ParallelizationMode::NONE, ParallelizationMode::ALL, ParallelizationMode::GATE_GRAPH}) {
+        assert(parallelizationModeFromName(parallelizationModeName(mode)) == mode);
+    }
+    // The calibration prefix grows with the table, within its floor and cap
+    assert(calibrationSampleSize(4, 4, 0) == 4);
+    assert(calibrationSampleSize(64, 4, 0) == 8);
+    assert(calibrationSampleSize(1024, 4, 0) == 128);
+    assert(calibrationSampleSize(2048, 4, 0) > calibrationSampleSize(1024, 4, 0));
+    assert(calibrationSampleSize(1 << 20, 4, 0) == CALIBRATION_RECORDS_PER_THREAD * 4);
+    assert(calibrationSampleSize(1024, 4, 16) == 16);
+    std::cout << "Test 1 (Candidates and shapes) passed." << std::endl;
+}
+
+void test_Tune(int inputLength, int serviceLength,
+               const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(loadDataFromCSV(filename), inputLength);
+    EncryptedTable table = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key,
+                                                maskSeedFromInts(51, 52, 53), 4);
+    LweSample* enc_x = encryptBoolean(encodeDouble(inputLength, 37.5), inputLength, params, key);
+    LweSample* enc_y = encryptBoolean(encodeDouble(inputLength, 126.9), inputLength, params, key);
+    const std::string cachePath = "autotuner_test.cache";
+    std::remove(cachePath.c_str());
+
+    // Test 2: Tuning calibrates every candidate and the chosen split answers correctly
+    AutoTuner tuner(cachePath, 4);
+    ThreadPartition partition = tuner.tune(BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength, serviceLength, bk, 4);
+    assert(tuner.lastCalibration().size() == candidatePartitions(4).size());
+    LweSample* tuned = HomLocPIRPartitioned(BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength, serviceLength, bk, partition);
+    LweSample* expected = HomLocPIRbb1OPT(enc_x, enc_y, table.rows(), inputLength, serviceLength, bk,
+                                          ParallelizationMode::NONE, 1);
+    assert(decryptToBinaryVector(tuned, serviceLength, key) == decryptToBinaryVector(expected, serviceLength, key));
+    std::cout << "Test 2 (Calibration, " << parallelizationModeName(partition.mode) << " "
+              << partition.recordThreads << "x" << partition.kernelThreads << ") passed." << std::endl;
+
+    // Test 3: The choice persists; a new tuner reuses it without calibrating
+    AutoTuner reloaded(cachePath, 4);
+    ThreadPartition cached;
+    assert(reloaded.lookup({BuildingBlock::BB1, table.numRecords(), inputLength, serviceLength, 4}, cached));
+    ThreadPartition again = reloaded.tune(BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength, serviceLength, bk, 4);
+    assert(reloaded.lastCalibration().empty());
+    assert(again.mode == partition.mode && again.recordThreads == partition.recordThreads &&
+           again.kernelThreads == partition.kernelThreads);
+    assert(!reloaded.lookup({BuildingBlock::BB1, table.numRecords(), inputLength, serviceLength, 2}, cached));
+    std::cout << "Test 3 (Persisted choice) passed." << std::endl;
+
+    // Test 4: A malformed cache is rejected
+    std::ofstream(cachePath, std::ios::app) << "bb1/M8/in16/svc9/T2 ALL two 1 2 0.5\n";
+    bool thrown = false;
+    try {
+        AutoTuner broken(cachePath);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Test 4 (Malformed cache) passed." << std::endl;
+
+    std::remove(cachePath.c_str());
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, tuned);
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, expected);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_x);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_y);
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_Candidates();
+    test_Tune(16, 9, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All auto-tuner tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <cassert>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "CompressedTable.h"
+#include "native/HomLocVan.h"
+#include "optimized/HomLocCompressed.h"
+
+int decryptServiceValue(const LweSample* result, int serviceLength, const TFheGateBootstrappingSecretKeySet* key) {
+    std::vector<int> bits = decryptToBinaryVector(result, serviceLength, key);
+    int value = 0;
+    for (size_t i = 0; i < bits.size(); ++i) {
+        value += bits[i] << i;
+    }
+    return value;
+}
+
+void test_CompressedBB1(const std::vector<std::vector<int32_t>>& encodedDB,
+                        int inputLength, int serviceLength,
+                        const TFheGateBootstrappingParameterSet* params,
+                        const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    MaskSeed seed = randomMaskSeed();
+
+    CompressedTable compressed = encryptCompressedTable(encodedDB, inputLength, serviceLength, params, key, seed);
+    EncryptedTable full = encryptTable(encodedDB, inputLength, serviceLength, params, key);
+    std::cout << "Full table (bytes): " << full.sizeInBytes()
+              << ", compressed table (bytes): " << compressed.sizeInBytes() << std::endl;
+    assert(compressed.sizeInBytes() * 100 < full.sizeInBytes());
+
+    // Test 1: Every expanded cell decrypts to the encoded plaintext
+    EncryptedTable block(compressed.schema(), 1, params);
+    for (int i = 0; i < compressed.numRecords(); i++) {
+        compressed.expandRecord(i, 0, block);
+        for (int c = 0; c < block.numColumns(); c++) {
+            int bits = block.schema()[c].bits;
+            std::vector<int> decrypted = decryptToBinaryVector(block.cell(0, c), bits, key);
+            for (int j = 0; j < bits; j++) {
+                assert(decrypted[j] == ((encodedDB[i][c] >> j) & 1));
+            }
+        }
+    }
+    std::cout << "Test 1 (Expansion round trip) passed." << std::endl;
+
+    // Test 2: Query result matches the uncompressed table, for tiny and default blocks
+    LweSample* enc_x = encryptBoolean(encodeDouble(inputLength, 37.5), inputLength, params, key);
+    LweSample* enc_y = encryptBoolean(encodeDouble(inputLength, 126.9), inputLength, params, key);
+
+    LweSample* resultRef = HomLocPIRbb1(enc_x, enc_y, full.rows(), inputLength, serviceLength, bk);
+    int expected = decryptServiceValue(resultRef, serviceLength, key);
+
+    for (size_t cacheBytes : {size_t(1), DEFAULT_EXPANSION_BYTES}) {
+        LweSample* result = HomLocPIRbb1Compressed(enc_x, enc_y, compressed, inputLength, serviceLength, bk, 4, cacheBytes);
+        assert(decryptServiceValue(result, serviceLength, key) == expected);
+        delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+    }
+    std::cout << "Decrypted result value: " << expected << std::endl;
+    std::cout << "Test 2 (Compressed query) passed." << std::endl;
+
+    // Clean up
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, resultRef);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_x);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_y);
+}
+
+void test_CompressedBB3(const TFheGateBootstrappingParameterSet* params,
+                        const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    int inputLength = 2;
+    int serviceLength = 56;
+    std::vector<std::vector<std::string>> data = {{"0", "alpha"}, {"1", "bravo"}, {"2", "charlie"}};
+
+    CompressedTable compressed = encryptCompressedTableBB3(data, inputLength, serviceLength, params, key, randomMaskSeed());
+
+    LweSample* enc_id = encryptBoolean(2, inputLength, params, key);
+    LweSample* result = HomLocPIRbb3Compressed(enc_id, compressed, inputLength, serviceLength, bk, 2);
+    std::string text = binaryStringToText(decryptBinaryString(result, serviceLength, key));
+    assert(text.find("charlie") != std::string::npos);
+    std::cout << "Test 3 (Compressed BB3): " << text << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+}
+
+int main() {
+    // Security parameters
+    int security_param = 128;
+    int inputLength = 16;   // Length for interval values
+    int serviceLength = 9;  // Length for service values
+
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(security_param);
+    auto key = generateKeySet(params);
+
+    // Load and encode the BB1 database
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    std::vector<std::vector<std::string>> data = loadDataFromCSV(filename);
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(data, inputLength);
+
+    test_CompressedBB1(encodedDB, inputLength, serviceLength, params, key);
+    test_CompressedBB3(params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All CompressedTable tests passed." << std::endl;
+    return 0;
+}
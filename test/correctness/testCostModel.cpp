@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "CostModel.h"
+#include "EncryptedTable.h"
+#include "GateCircuit.h"
+#include "ParallelEncryption.h"
+#include "optimized/HomLocOPT.h"
+
+void test_GateCounts() {
+    // Test 1: Native gate counts follow the kernels (n = 16, svc = 9, 10 records)
+    GateCount bb1 = queryGates({BuildingBlock::BB1, 10, 16, 9, 1});
+    assert(bb1.gates == 10 * (4 * 16 + 3 + 9) + 10 * 9 && bb1.muxes == 10 * 4 * 16);
+    GateCount bb2 = queryGates({BuildingBlock::BB2, 10, 16, 9, 1});
+    assert(bb2.gates == 10 * (4 * 16 + 1 + 9) + 10 * 9 && bb2.muxes == 0);
+    GateCount bb3 = queryGates({BuildingBlock::BB3, 10, 16, 9, 1});
+    assert(bb3.gates == 10 * (2 * 16 + 9) + 10 * 9 && bb3.muxes == 0);
+
+    assert(scheduledSeconds(100, 10, 1) == 100);
+    assert(std::fabs(scheduledSeconds(100, 10, 4) - (25 + 7.5)) < 1e-9);
+    std::cout << "Test 1 (Gate counts) passed." << std::endl;
+}
+
+void test_Planner() {
+    StrategyPlanner planner({0.01, 0.02});
+    DatasetShape shape{BuildingBlock::BB1, 256, 16, 22, 8};
+
+    // Test 2: Estimates are sorted, cover every candidate split, and parallel plans win on 8 cores
+    std::vector<PlanEstimate> plans = planner.estimates(shape);
+    assert(plans.size() == candidatePartitions(8).size());
+    for (size_t i = 1; i < plans.size(); i++) {
+        assert(plans[i - 1].seconds <= plans[i].seconds);
+    }
+    PlanEstimate best = planner.best(shape);
+    assert(best.seconds == plans.front().seconds);
+    assert(best.partition.mode != ParallelizationMode::NONE);
+    for (const PlanEstimate& plan : plans) {
+        assert(plan.criticalPath.seconds(planner.costs()) <= plan.work.seconds(planner.costs()));
+    }
+
+    // The gate graph runs GRAPH_RECORDS_PER_THREAD records per thread per DAG, one after another
+    DatasetShape oneChunk{BuildingBlock::BB1, GRAPH_RECORDS_PER_THREAD * 8, 16, 22, 8};
+    DatasetShape twoChunks{BuildingBlock::BB1, 2 * GRAPH_RECORDS_PER_THREAD * 8, 16, 22, 8};
+    PlanEstimate graphOne = gateGraphModel()->estimate(oneChunk, planner.costs())[0];
+    PlanEstimate graphTwo = gateGraphModel()->estimate(twoChunks, planner.costs())[0];
+    assert(graphTwo.criticalPath.gates >= 2 * graphOne.criticalPath.gates);
+    assert(graphTwo.seconds >= 2 * graphOne.seconds);
+
+    shape.numThreads = 1;
+    assert(planner.best(shape).partition.mode == ParallelizationMode::NONE);
+    assert(planner.best(shape).seconds == queryGates(shape).seconds(planner.costs()));
+    std::cout << "Test 2 (Plan ranking, " << best.name << ") passed." << std::endl;
+
+    // Test 3: More cores never shrink the table that fits the SLA; an impossible SLA needs 0 cores
+    std::vector<SlaRow> rows = planner.slaReport(shape, 60.0, 16);
+    assert(rows.size() == 5);
+    for (size_t i = 1; i < rows.size(); i++) {
+        assert(rows[i].threads == 2 * rows[i - 1].threads);
+        assert(rows[i].maxRecords >= rows[i - 1].maxRecords);
+    }
+    DatasetShape probe = shape;
+    probe.numThreads = rows[2].threads;
+    probe.numRecords = rows[2].maxRecords;
+    assert(planner.best(probe).seconds <= 60.0);
+    probe.numRecords++;
+    assert(planner.best(probe).seconds > 60.0);
+
+    int threads = planner.threadsForSla(shape, 60.0, 16);
+    assert(threads >= 1 && threads <= 16);
+    assert(planner.threadsForSla(shape, 1e-3, 16) == 0);
+
+    std::ostringstream csv;
+    planner.writeSlaReport(csv, shape, 60.0, 16);
+    assert(csv.str().find("threads,plan,predicted_s,meets_sla,max_records\n") == 0);
+    std::cout << "Test 3 (SLA report, " << threads << " threads for 60 s) passed." << std::endl;
+}
+
+void test_Planned(int inputLength, int serviceLength,
+                  const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(loadDataFromCSV(filename), inputLength);
+    EncryptedTable table = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key,
+                                                maskSeedFromInts(61, 62, 63), 4);
+    LweSample* enc_x = encryptBoolean(encodeDouble(inputLength, 37.5), inputLength, params, key);
+    LweSample* enc_y = encryptBoolean(encodeDouble(inputLength, 126.9), inputLength, params, key);
+
+    // Test 4: Calibrated costs are positive and the planned query answers like the serial one
+    GateCosts costs = calibrateGateCosts(bk, 4);
+    assert(costs.gateSeconds > 0 && costs.muxSeconds > 0);
+    StrategyPlanner planner(costs);
+    LweSample* planned = HomLocPIRPlanned(planner, BuildingBlock::BB1, enc_x, enc_y, table.rows(),
+                                          inputLength, serviceLength, bk, 4);
+    LweSample* expected = HomLocPIRbb1OPT(enc_x, enc_y, table.rows(), inputLength, serviceLength, bk,
+                                          ParallelizationMode::NONE, 1);
+    assert(decryptToBinaryVector(planned, serviceLength, key) == decryptToBinaryVector(expected, serviceLength, key));
+    std::cout << "Test 4 (Planned query) passed." << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, planned);
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, expected);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_x);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_y);
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_GateCounts();
+    test_Planner();
+    test_Planned(16, 9, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All cost model tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <chrono>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "CsvIngest.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "TableFile.h"
+#include "optimized/HomLocOPT.h"
+
+// Masks and bodies of `batch` match records firstRecord.. of `table`
+bool sameRecords(const EncryptedTable& batch, const EncryptedTable& table, int64_t firstRecord) {
+    const int n = table.params()->in_out_params->n;
+    for (int c = 0; c < table.numColumns(); c++) {
+        for (int i = 0; i < batch.numRecords(); i++) {
+            for (int j = 0; j < table.schema()[c].bits; j++) {
+                const LweSample& a = batch.cell(i, c)[j];
+                const LweSample& b = table.cell(firstRecord + i, c)[j];
+                if (a.b != b.b || std::memcmp(a.a, b.a, n * sizeof(Torus32)) != 0) return false;
+            }
+        }
+    }
+    return true;
+}
+
+void test_Reader() {
+    std::string path = "testCsvIngest_reader.csv";
+    std::ofstream out(path, std::ios::binary);
+    out << "City,City Encoding,Service\r\n"
+        << "Birmingham,0,\"0.0, 46.0, 32.0\"\r\n"
+        << "\n"
+        << "  Huntsville , 1 , \"say \"\"hi\"\"\" \n"
+        << "Mobile,2,\"two\nlines\"\n"
+        << "Montgomery,3,";
+    out.close();
+
+    // Test 1: Quoted fields, escaped quotes, CRLF, blank lines and a missing final line break
+    CsvReader reader(path);
+    assert(reader.countRemaining() == 4);
+    std::vector<std::string_view> fields;
+    assert(reader.next(fields) && fields.size() == 3);
+    assert(fields[0] == "Birmingham" && fields[2] == "0.0, 46.0, 32.0");
+    assert(reader.next(fields) && fields.size() == 3);
+    assert(fields[0] == "Huntsville" && fields[1] == "1" && fields[2] == "say \"hi\"");
+    assert(reader.line() == 4);
+    assert(reader.next(fields) && fields[2] == "two\nlines");
+    assert(reader.countRemaining() == 1);
+    assert(reader.next(fields) && fields.size() == 3 && fields[2].empty());
+    assert(!reader.next(fields));
+    assert(reader.recordsRead() == 4);
+    std::cout << "Test 1 (CSV reader) passed." << std::endl;
+
+    // Test 2: Malformed numbers are reported with their line
+    CsvSchema schema = csvSchemaBB2(16, 8);
+    CsvReader bad(path);
+    std::vector<int32_t> bits;
+    bool thrown = false;
+    try {
+        readCsvBatch(bad, schema, 8, bits);
+    } catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()).find(":2:") != std::string::npos;
+    }
+    assert(thrown);
+    std::cout << "Test 2 (Malformed field) passed." << std::endl;
+
+    std::remove(path.c_str());
+}
+
+void test_IngestBB1(int inputLength, int serviceLength,
+                    const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    MaskSeed seed = maskSeedFromInts(8, 9, 10);
+
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(loadDataFromCSV(filename), inputLength);
+    EncryptedTable expected = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key, seed, 4);
+
+    // Test 3: Batches of the streaming ingester are the records of the in-memory table
+    int batches = 0;
+    int64_t records = ingestCsv(filename, csvSchemaBB1(inputLength, serviceLength), params, key, seed, 4, 3,
+                                [&](const EncryptedTable& batch, int64_t firstRecord) {
+        assert(batch.numRecords() <= 3);
+        assert(sameRecords(batch, expected, firstRecord));
+        batches++;
+    });
+    assert(records == expected.numRecords());
+    assert(batches == (expected.numRecords() + 2) / 3);
+    std::cout << "Test 3 (BB1 batches) passed." << std::endl;
+}
+
+void test_IngestBB3(int inputLength, int serviceLength,
+                    const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::string filename = std::string(DATA_DIR) + "/pir_weather_data_unique.csv";
+    std::string path = "testCsvIngest_weather.pirt";
+    MaskSeed seed = maskSeedFromInts(11, 12, 13);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    int64_t records = ingestCsvToTableFile(filename, csvSchemaBB3(inputLength, serviceLength), path,
+                                           params, key, seed, 4, 16);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "Ingested " << records << " records (s): " << elapsed.count() << std::endl;
+
+    // Test 4: The streamed table file equals the table encrypted from loadDataFromCSVbb3
+    std::vector<std::vector<std::string>> data = loadDataFromCSVbb3(filename);
+    EncryptedTable expected = encryptTableBB3Parallel(data, inputLength, serviceLength, params, key, seed, 4);
+    EncryptedTable mapped = mapTableFile(path, params);
+    assert(records == static_cast<int64_t>(data.size()));
+    assert(mapped.numRecords() == expected.numRecords());
+    assert(sameRecords(mapped, expected, 0));
+    std::cout << "Test 4 (BB3 table file) passed." << std::endl;
+
+    // Test 5: Query a quoted service from the streamed file
+    LweSample* enc_id = encryptBoolean(1, inputLength, params, key);
+    LweSample* result = HomLocPIRbb3OPT(enc_id, mapped.rows(), inputLength, serviceLength, bk,
+                                        ParallelizationMode::PARALLEL_LOOP_HOMSUM, 4);
+    std::string text = binaryStringToText(decryptBinaryString(result, serviceLength, key));
+    assert(text.find(data[1][1]) != std::string::npos);
+    std::cout << "Test 5 (BB3 query): " << text << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+    std::remove(path.c_str());
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_Reader();
+    test_IngestBB1(16, 9, params, key);
+    test_IngestBB3(9, 128, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All CSV ingestion tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <cassert>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "native/HomLocVan.h"
+#include "optimized/HomLocOPT.h"
+
+int decryptServiceValue(const LweSample* result, int serviceLength, const TFheGateBootstrappingSecretKeySet* key) {
+    std::vector<int> bits = decryptToBinaryVector(result, serviceLength, key);
+    int value = 0;
+    for (size_t i = 0; i < bits.size(); ++i) {
+        value += bits[i] << i;
+    }
+    return value;
+}
+
+void test_TableBB1(TableLayout layout, const std::string& layout_name,
+                   const std::vector<std::vector<int32_t>>& encodedDB,
+                   int inputLength, int serviceLength,
+                   const TFheGateBootstrappingParameterSet* params,
+                   const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::cout << "Testing layout: " << layout_name << std::endl;
+
+    EncryptedTable table = encryptTable(encodedDB, inputLength, serviceLength, params, key, layout);
+
+    // Every cell decrypts to the encoded plaintext
+    for (int i = 0; i < table.numRecords(); i++) {
+        for (int c = 0; c < table.numColumns(); c++) {
+            int bits = table.schema()[c].bits;
+            std::vector<int> decrypted = decryptToBinaryVector(table.cell(i, c), bits, key);
+            for (int j = 0; j < bits; j++) {
+                assert(decrypted[j] == ((encodedDB[i][c] >> j) & 1));
+            }
+        }
+    }
+
+    // Existing kernels run unchanged on the zero-copy views
+    int32_t queryX = encodeDouble(inputLength, 37.5);
+    int32_t queryY = encodeDouble(inputLength, 126.9);
+    LweSample* enc_x = encryptBoolean(queryX, inputLength, params, key);
+    LweSample* enc_y = encryptBoolean(queryY, inputLength, params, key);
+
+    std::vector<std::vector<LweSample*>> rows = table.rows();
+    LweSample* resultVan = HomLocPIRbb1(enc_x, enc_y, rows, inputLength, serviceLength, bk);
+    LweSample* resultOpt = HomLocPIRbb1OPT(enc_x, enc_y, rows, inputLength, serviceLength, bk,
+                                           ParallelizationMode::PARALLEL_LOOP_HOMSUM, 4);
+
+    // Reference result from the per-cell database
+    std::vector<std::vector<LweSample*>> encryptedDB = encryptDB(encodedDB, inputLength, serviceLength, params, key);
+    LweSample* resultRef = HomLocPIRbb1(enc_x, enc_y, encryptedDB, inputLength, serviceLength, bk);
+
+    int expected = decryptServiceValue(resultRef, serviceLength, key);
+    assert(decryptServiceValue(resultVan, serviceLength, key) == expected);
+    assert(decryptServiceValue(resultOpt, serviceLength, key) == expected);
+    std::cout << "Decrypted result value: " << expected << std::endl;
+    std::cout << "Table size (bytes): " << table.sizeInBytes() << std::endl;
+
+    // Clean up
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, resultVan);
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, resultOpt);
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, resultRef);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_x);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_y);
+    cleanUpEncryptedDB(encryptedDB, inputLength, serviceLength);
+}
+
+void test_TableBB3(int inputLength, int serviceLength,
+                   const TFheGateBootstrappingParameterSet* params,
+                   const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::vector<std::vector<std::string>> data = {{"0", "alpha"}, {"1", "bravo"}, {"2", "charlie"}};
+
+    EncryptedTable table = encryptTableBB3(data, inputLength, serviceLength, params, key, TableLayout::BIT_MAJOR);
+
+    LweSample* enc_id = encryptBoolean(1, inputLength, params, key);
+    LweSample* result = HomLocPIRbb3(enc_id, table.rows(), inputLength, serviceLength, bk);
+    std::string text = binaryStringToText(decryptBinaryString(result, serviceLength, key));
+    assert(text.find("bravo") != std::string::npos);
+    std::cout << "BB3 table result: " << text << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+}
+
+int main() {
+    // Security parameters
+    int security_param = 128;
+    int inputLength = 16;   // Length for interval values
+    int serviceLength = 9;  // Length for service values
+
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(security_param);
+    auto key = generateKeySet(params);
+
+    // Load and encode the BB1 database
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    std::vector<std::vector<std::string>> data = loadDataFromCSV(filename);
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(data, inputLength);
+
+    test_TableBB1(TableLayout::RECORD_MAJOR, "RECORD_MAJOR", encodedDB, inputLength, serviceLength, params, key);
+    test_TableBB1(TableLayout::BIT_MAJOR, "BIT_MAJOR", encodedDB, inputLength, serviceLength, params, key);
+    test_TableBB3(2, 56, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All EncryptedTable tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "GateCircuit.h"
+#include "PIREngine.h"
+#include "ThreadPool.h"
+#include "native/HomComp.h"
+#include "optimized/HomLocOPT.h"
+
+void test_Comparators(const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    const int length = 4;
+    ThreadPool pool(3);
+
+    // Test 1: Circuit comparators agree with the native kernels on every signed 4-bit pair
+    LweSample* native = new_gate_bootstrapping_ciphertext_array(3, params);
+    CiphertextArray graph(3, params);
+    for (int a = -8; a < 8; a += 3) {
+        for (int b = -8; b < 8; b++) {
+            LweSample* enc_a = encryptBoolean(a, length, params, key);
+            LweSample* enc_b = encryptBoolean(b, length, params, key);
+            HomCompLE(&native[0], enc_a, enc_b, length, bk);
+            HomCompL(&native[1], enc_a, enc_b, length, bk);
+            HomEqui(&native[2], enc_a, enc_b, length, bk);
+
+            GateCircuit circuit;
+            std::vector<int> bus_a = circuit.inputs(enc_a, length);
+            std::vector<int> bus_b = circuit.inputs(enc_b, length);
+            circuit.bind(addCompLE(circuit, bus_a, bus_b), &graph[0]);
+            circuit.bind(addCompL(circuit, bus_a, bus_b), &graph[1]);
+            circuit.bind(addEqui(circuit, bus_a, bus_b), &graph[2]);
+            circuit.execute(bk, pool, 4);
+
+            for (int k = 0; k < 3; k++) {
+                assert(bootsSymDecrypt(&graph[k], key) == bootsSymDecrypt(&native[k], key));
+            }
+            assert(bootsSymDecrypt(&graph[0], key) == (a <= b));
+            assert(bootsSymDecrypt(&graph[2], key) == (a == b));
+            delete_gate_bootstrapping_ciphertext_array(length, enc_a);
+            delete_gate_bootstrapping_ciphertext_array(length, enc_b);
+        }
+    }
+    delete_gate_bootstrapping_ciphertext_array(3, native);
+    std::cout << "Test 1 (Comparator circuits) passed." << std::endl;
+
+    // Test 2: Gate counts and critical path; equality is a tree, comparisons are chains
+    auto zeros = [](GateCircuit& circuit, int bits) {
+        std::vector<int> bus;
+        for (int i = 0; i < bits; i++) {
+            bus.push_back(circuit.constant(0));
+        }
+        return bus;
+    };
+    GateCircuit tree;
+    std::vector<int> bus_tree = zeros(tree, 16);
+    addEqui(tree, bus_tree, bus_tree);
+    assert(tree.numGates() == 16 + 15);
+    assert(tree.criticalPath() == 1 + 4);
+
+    GateCircuit chain;
+    std::vector<int> bus_chain = zeros(chain, 16);
+    addCompLE(chain, bus_chain, bus_chain);
+    assert(chain.numGates() == 1 + 2 * 15 + 1);
+    assert(chain.criticalPath() == 1 + 15 + 1);
+    std::cout << "Test 2 (Critical path) passed." << std::endl;
+}
+
+void test_Retrieval(int inputLength, int serviceLength,
+                    const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(loadDataFromCSV(filename), inputLength);
+    EncryptedTable table = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key,
+                                                maskSeedFromInts(41, 42, 43), 4);
+
+    LweSample* enc_x = encryptBoolean(encodeDouble(inputLength, 37.5), inputLength, params, key);
+    LweSample* enc_y = encryptBoolean(encodeDouble(inputLength, 126.9), inputLength, params, key);
+
+    // Test 3: GATE_GRAPH answers like the serial loop
+    LweSample* expected = HomLocPIRbb1OPT(enc_x, enc_y, table.rows(), inputLength, serviceLength, bk,
+                                          ParallelizationMode::NONE, 1);
+    LweSample* result = HomLocPIRbb1OPT(enc_x, enc_y, table.rows(), inputLength, serviceLength, bk,
+                                        ParallelizationMode::GATE_GRAPH, 4);
+    assert(decryptToBinaryVector(result, serviceLength, key) == decryptToBinaryVector(expected, serviceLength, key));
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+    std::cout << "Test 3 (BB1 gate graph) passed." << std::endl;
+
+    // Test 4: An engine scheduled by gate graph answers BB3 queries, also on an empty table
+    std::vector<std::vector<std::string>> data = {{"0", "alpha"}, {"1", "bravo"}, {"2", "charlie"}};
+    PIREngine engine(bk, encryptTableBB3Parallel(data, 3, 64, params, key, maskSeedFromInts(44, 45, 46), 4), 4,
+                     QuerySchedule::GATE_GRAPH);
+    for (size_t q = 0; q < data.size(); q++) {
+        LweSample* enc_id = encryptBoolean(q, 3, params, key);
+        CiphertextArray answer = engine.query(enc_id);
+        assert(binaryStringToText(decryptBinaryString(answer.get(), 64, key)).find(data[q][1]) != std::string::npos);
+        delete_gate_bootstrapping_ciphertext_array(3, enc_id);
+    }
+    PIREngine empty(bk, encryptTableBB3Parallel({}, 3, 8, params, key, maskSeedFromInts(44, 45, 46), 4), 2,
+                    QuerySchedule::GATE_GRAPH);
+    LweSample* enc_id = encryptBoolean(1, 3, params, key);
+    CiphertextArray zeros = empty.query(enc_id);
+    assert(decryptToBinaryVector(zeros.get(), 8, key) == std::vector<int>(8, 0));
+    delete_gate_bootstrapping_ciphertext_array(3, enc_id);
+    std::cout << "Test 4 (Engine gate graph) passed." << std::endl;
+
+    // Test 5: One thread takes GRAPH_RECORDS_PER_THREAD records per circuit; the chunks fold
+    // into the same answer
+    ThreadPool single(0);
+    assert(static_cast<int>(encodedDB.size()) > GRAPH_RECORDS_PER_THREAD);
+    CiphertextArray chunked = HomLocPIRGraph(BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength,
+                                             serviceLength, bk, single, 1);
+    assert(decryptToBinaryVector(chunked.get(), serviceLength, key) ==
+           decryptToBinaryVector(expected, serviceLength, key));
+    std::cout << "Test 5 (Chunked gate graph) passed." << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, expected);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_x);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_y);
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_Comparators(params, key);
+    test_Retrieval(16, 9, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All gate circuit tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "optimized/HomLocBatch.h"
+#include "optimized/HomLocOPT.h"
+
+void test_BatchBB1(int inputLength, int serviceLength,
+                   const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(loadDataFromCSV(filename), inputLength);
+    EncryptedTable table = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key,
+                                                maskSeedFromInts(71, 72, 73), 4);
+
+    // A short trajectory, inside and outside the regions
+    std::vector<std::pair<double, double>> points = {{37.5, 126.9}, {35.1, 129.0}, {0.0, 0.0}};
+    std::vector<LweSample*> owned;
+    std::vector<const LweSample*> enc_x, enc_y;
+    for (const auto& point : points) {
+        owned.push_back(encryptBoolean(encodeDouble(inputLength, point.first), inputLength, params, key));
+        enc_x.push_back(owned.back());
+        owned.push_back(encryptBoolean(encodeDouble(inputLength, point.second), inputLength, params, key));
+        enc_y.push_back(owned.back());
+    }
+
+    // Test 1: Every point of a batch answers like its own single query, for any thread count
+    for (int threads : {1, 3, 64}) {
+        std::vector<CiphertextArray> results =
+            HomLocPIRbb1Batch(enc_x, enc_y, table.rows(), inputLength, serviceLength, bk, threads);
+        assert(results.size() == points.size());
+        for (size_t k = 0; k < points.size(); k++) {
+            LweSample* single = HomLocPIRbb1OPT(enc_x[k], enc_y[k], table.rows(), inputLength, serviceLength, bk,
+                                                ParallelizationMode::PARALLEL_LOOP_HOMSUM, 4);
+            assert(decryptToBinaryVector(results[k].get(), serviceLength, key) ==
+                   decryptToBinaryVector(single, serviceLength, key));
+            delete_gate_bootstrapping_ciphertext_array(serviceLength, single);
+        }
+    }
+    std::cout << "Test 1 (BB1 batch of " << points.size() << " points) passed." << std::endl;
+
+    // Test 2: Mismatched coordinate lists are rejected; an empty batch is empty
+    bool thrown = false;
+    try {
+        HomLocPIRbb1Batch(enc_x, {enc_y[0]}, table.rows(), inputLength, serviceLength, bk, 4);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(HomLocPIRbb1Batch({}, {}, table.rows(), inputLength, serviceLength, bk, 4).empty());
+    std::cout << "Test 2 (Batch shapes) passed." << std::endl;
+
+    for (LweSample* sample : owned) {
+        delete_gate_bootstrapping_ciphertext_array(inputLength, sample);
+    }
+}
+
+void test_BatchBB3(int inputLength, int serviceLength,
+                   const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    std::vector<std::vector<std::string>> data = {{"0", "alpha"}, {"1", "bravo"}, {"2", "charlie"},
+                                                  {"3", "delta"}, {"4", "echo"}};
+    EncryptedTable table = encryptTableBB3Parallel(data, inputLength, serviceLength, params, key,
+                                                   maskSeedFromInts(74, 75, 76), 4);
+
+    // Test 3: A batch may ask for the same record twice and for every record at once
+    std::vector<int> ids = {4, 0, 2, 2, 1, 3};
+    std::vector<LweSample*> owned;
+    std::vector<const LweSample*> enc_ids;
+    for (int id : ids) {
+        owned.push_back(encryptBoolean(id, inputLength, params, key));
+        enc_ids.push_back(owned.back());
+    }
+    std::vector<CiphertextArray> results = HomLocPIRbb3Batch(enc_ids, table.rows(), inputLength, serviceLength,
+                                                             &key->cloud, 2);
+    for (size_t k = 0; k < ids.size(); k++) {
+        std::string text = binaryStringToText(decryptBinaryString(results[k].get(), serviceLength, key));
+        assert(text.find(data[ids[k]][1]) != std::string::npos);
+    }
+    std::cout << "Test 3 (BB3 batch of " << ids.size() << " identifiers) passed." << std::endl;
+
+    for (LweSample* sample : owned) {
+        delete_gate_bootstrapping_ciphertext_array(inputLength, sample);
+    }
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_BatchBB1(16, 9, params, key);
+    test_BatchBB3(3, 64, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All batched query tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "PIREngine.h"
+#include "ThreadPool.h"
+#include "optimized/HomLocOPT.h"
+
+void test_ThreadPool() {
+    ThreadPool pool(3);
+
+    // Test 1: Every index runs once, within the thread budget, also from nested loops
+    std::vector<std::atomic<int>> hits(200);
+    std::atomic<int> running(0), peak(0);
+    pool.parallelFor(0, 20, 2, [&](int outer) {
+        int now = ++running;
+        int seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+        pool.parallelFor(0, 10, 4, [&](int inner) { hits[outer * 10 + inner]++; });
+        running--;
+    });
+    for (std::atomic<int>& hit : hits) {
+        assert(hit.load() == 1);
+    }
+    assert(peak.load() <= 2);
+    std::cout << "Test 1 (Thread pool coverage and budget) passed." << std::endl;
+
+    // Test 2: A failing body surfaces in the caller and the pool stays usable
+    bool thrown = false;
+    try {
+        pool.parallelFor(0, 100, 4, [](int i) {
+            if (i == 37) throw std::runtime_error("record 37");
+        });
+    } catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()) == "record 37";
+    }
+    assert(thrown);
+    std::atomic<int> count(0);
+    pool.parallelFor(0, 50, 4, [&](int) { count++; });
+    assert(count.load() == 50);
+    std::cout << "Test 2 (Thread pool exceptions) passed." << std::endl;
+}
+
+void test_EngineBB1(int inputLength, int serviceLength,
+                    const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(loadDataFromCSV(filename), inputLength);
+    MaskSeed seed = maskSeedFromInts(31, 32, 33);
+
+    PIREngine engine(bk, encryptTableParallel(encodedDB, inputLength, serviceLength, params, key, seed, 4), 4);
+    assert(engine.buildingBlock() == BuildingBlock::BB1);
+
+    LweSample* enc_x = encryptBoolean(encodeDouble(inputLength, 37.5), inputLength, params, key);
+    LweSample* enc_y = encryptBoolean(encodeDouble(inputLength, 126.9), inputLength, params, key);
+
+    // Test 3: The engine answers like HomLocPIRbb1OPT
+    EncryptedTable table = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key, seed, 4);
+    LweSample* expected = HomLocPIRbb1OPT(enc_x, enc_y, table.rows(), inputLength, serviceLength, bk,
+                                          ParallelizationMode::PARALLEL_LOOP_HOMSUM, 4);
+    CiphertextArray result = engine.query(enc_x, enc_y);
+    assert(decryptToBinaryVector(result.get(), serviceLength, key) ==
+           decryptToBinaryVector(expected, serviceLength, key));
+    CiphertextArray single = engine.query(enc_x, enc_y, 1);
+    assert(decryptToBinaryVector(single.get(), serviceLength, key) ==
+           decryptToBinaryVector(expected, serviceLength, key));
+    std::cout << "Test 3 (BB1 query) passed." << std::endl;
+
+    // Test 4: Location queries need a location table
+    bool thrown = false;
+    try {
+        engine.query(enc_x);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Test 4 (Query kind) passed." << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, expected);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_x);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_y);
+}
+
+void test_EngineConcurrent(int inputLength, int serviceLength,
+                           const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    std::vector<std::vector<std::string>> data = {{"0", "alpha"}, {"1", "bravo"}, {"2", "charlie"},
+                                                  {"3", "delta"}, {"4", "echo"}, {"5", "foxtrot"}};
+    PIREngine engine(&key->cloud, encryptTableBB3Parallel(data, inputLength, serviceLength, params, key,
+                                                          maskSeedFromInts(34, 35, 36), 4), 4);
+
+    std::vector<LweSample*> ids;
+    for (size_t q = 0; q < data.size(); q++) {
+        ids.push_back(encryptBoolean(q, inputLength, params, key));
+    }
+
+    // Test 5: Concurrent callers with their own budgets get their own answers
+    std::vector<std::string> texts(data.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> callers;
+    for (size_t q = 0; q < data.size(); q++) {
+        callers.emplace_back([&, q] {
+            CiphertextArray result = engine.query(ids[q], 1 + q % 3);
+            texts[q] = binaryStringToText(decryptBinaryString(result.get(), serviceLength, key));
+        });
+    }
+    for (std::thread& caller : callers) {
+        caller.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    for (size_t q = 0; q < data.size(); q++) {
+        assert(texts[q].find(data[q][1]) != std::string::npos);
+    }
+    std::cout << "Test 5 (" << data.size() << " concurrent BB3 queries, s): " << elapsed.count() << std::endl;
+
+    for (LweSample* id : ids) {
+        delete_gate_bootstrapping_ciphertext_array(inputLength, id);
+    }
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_ThreadPool();
+    test_EngineBB1(16, 9, params, key);
+    test_EngineConcurrent(3, 64, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All PIR engine tests passed." << std::endl;
+    return 0;
+}
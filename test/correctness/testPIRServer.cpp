@@ -0,0 +1,243 @@
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "CloudKeyCache.h"
+#include "CsvIngest.h"
+#include "PIRClient.h"
+#include "PIRServer.h"
+#include "PlainTable.h"
+#include "QueryCodec.h"
+#include "ResponseCodec.h"
+#include "TableFile.h"
+
+void test_Server(int inputLength, int serviceLength,
+                 const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const std::string directory = "testPIRServer_files";
+    const std::string socketPath = directory + "/pir.sock";
+    std::filesystem::create_directories(directory);
+
+    // The same records as a plaintext table and as an encrypted table file
+    std::vector<std::string> services = {"alpha", "bravo", "charlie", "delta", "echo"};
+    {
+        std::ofstream csv(directory + "/bb3.csv");
+        csv << "name,id,service\n";
+        for (size_t i = 0; i < services.size(); i++) {
+            csv << "r" << i << "," << i << "," << services[i] << "\n";
+        }
+    }
+    PlainTable plain = encodeCsvToPlainTable(directory + "/bb3.csv", csvSchemaBB3(inputLength, serviceLength));
+    writePlainTable(directory + "/bb3.pird", plain);
+    writeTableFile(directory + "/bb3.pirt", encryptPlainTable(plain, params, key, maskSeedFromInts(61, 62, 63), 4));
+
+    CloudKeyCache keys(directory, params, 2);
+    keys.registerKey("tenant", &key->cloud);
+
+    PIRServer server(socketPath, keys, params, 2);
+    server.addEncryptedTable("weather", directory + "/bb3.pirt", "tenant");
+    server.addPlainTable("weatherPlain", directory + "/bb3.pird");
+
+    // Test 1: Tables are checked when they are added
+    bool thrown = false;
+    try {
+        server.addPlainTable("weather", directory + "/bb3.pird");
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        server.addEncryptedTable("other", directory + "/bb3.pirt", "nobody");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Test 1 (Table registration) passed." << std::endl;
+
+    server.start();
+
+    // Test 2: Encrypted and plaintext queries over the socket agree with the local circuits
+    {
+        PIRClient client(socketPath, params);
+        for (size_t q = 0; q < services.size(); q++) {
+            LweSample* enc_id = encryptBoolean(q, inputLength, params, key);
+            CiphertextArray result = client.query("weather", enc_id, inputLength);
+            assert(result.length() == serviceLength);
+            std::vector<int> bits = decryptToBinaryVector(result.get(), serviceLength, key);
+            assert(bits == client.queryPlain("weatherPlain", {static_cast<int32_t>(q)}));
+            assert(bits == PlainLocPIRbb3(q, plain));
+            delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+        }
+    }
+    std::cout << "Test 2 (Encrypted and plaintext queries) passed." << std::endl;
+
+    // Test 3: Several clients at once each get their own answer
+    std::vector<std::vector<int>> answers(services.size());
+    std::vector<std::thread> clients;
+    for (size_t q = 0; q < services.size(); q++) {
+        clients.emplace_back([&, q] {
+            PIRClient client(socketPath, params);
+            LweSample* enc_id = encryptBoolean(q, inputLength, params, key);
+            answers[q] = decryptToBinaryVector(client.query("weather", enc_id, inputLength).get(), serviceLength, key);
+            delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+        });
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    for (size_t q = 0; q < services.size(); q++) {
+        assert(answers[q] == PlainLocPIRbb3(q, plain));
+    }
+    std::cout << "Test 3 (Concurrent clients) passed." << std::endl;
+
+    // Test 4: Bad requests get an error reply and the connection stays usable
+    {
+        PIRClient client(socketPath, params);
+        std::string message;
+        try {
+            client.queryPlain("missing", {0});
+        } catch (const std::runtime_error& e) {
+            message = e.what();
+        }
+        assert(message.find("unknown plaintext table") != std::string::npos);
+        message.clear();
+        try {
+            client.queryPlain("weatherPlain", {0, 1});
+        } catch (const std::runtime_error& e) {
+            message = e.what();
+        }
+        assert(message.find("takes 1 values") != std::string::npos);
+        assert(client.queryPlain("weatherPlain", {1}) == PlainLocPIRbb3(1, plain));
+        assert(server.queriesFailed() == 2);
+    }
+    std::cout << "Test 4 (Error replies) passed." << std::endl;
+
+    // Test 5: Seed-compressed queries, answered in every response codec
+    {
+        PIRClient client(socketPath, params);
+        PackingSecretKey packingSecret = newPackingSecretKey(params);
+        thrown = false;
+        try {
+            client.queryPacked("weather", encryptCompressedQuery({0}, inputLength, key));
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        PackingKey packingKey = newPackingKey(packingSecret, key, 4);
+        PackingKey otherBase = packingKey;
+        otherBase.basebit = PACKING_BASEBIT / 2;  // same levels, digits the server cannot pack with
+        thrown = false;
+        try {
+            client.setPackingKey(otherBase);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        client.setPackingKey(packingKey);
+        for (size_t q = 0; q < services.size(); q++) {
+            std::vector<int> expected = PlainLocPIRbb3(q, plain);
+            CompressedQuery query = encryptCompressedQuery({static_cast<int32_t>(q)}, inputLength, key);
+            assert(decryptToBinaryVector(client.query("weather", query).get(), serviceLength, key) == expected);
+            assert(decryptResponseToBinaryVector(client.queryModulusSwitched("weather", query), key) == expected);
+            assert(unpackResponseToBinaryVector(client.queryPacked("weather", query), packingSecret) == expected);
+        }
+    }
+    std::cout << "Test 5 (Query and response codecs) passed." << std::endl;
+
+    // Test 6: Malformed and oversized requests never reach the ciphertext parser
+    auto connectRaw = [&] {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, socketPath.c_str());
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+        return fd;
+    };
+    {
+        int fd = connectRaw();
+        std::string header = {static_cast<char>(PIROp::QUERY_ENCRYPTED), 0, 0, 7, 0};
+        std::string reply;
+        for (std::string body : {std::string(1, 1), std::string(1, 1) + std::string(100, 'x'), std::string(1, 2)}) {
+            assert(writeFrame(fd, header + "weather" + body) && readFrame(fd, reply));
+            assert(reply[0] == static_cast<char>(PIR_STATUS_ERROR) && reply.find("takes 1 values") != std::string::npos);
+        }
+        std::string seeded = {static_cast<char>(PIROp::QUERY_ENCRYPTED), 1, 0, 7, 0};
+        assert(writeFrame(fd, seeded + "weather" + "PIRQ") && readFrame(fd, reply));
+        assert(reply[0] == static_cast<char>(PIR_STATUS_ERROR));
+
+        // A frame announcing more than any table takes closes the connection unread
+        uint64_t length = server.maxRequestBytes() + 1;
+        assert(write(fd, &length, sizeof(length)) == sizeof(length));
+        assert(!readFrame(fd, reply));
+        close(fd);
+    }
+    std::cout << "Test 6 (Malformed requests) passed." << std::endl;
+
+    // Test 7: Past the connection cap, a client waits until a connection closes
+    {
+        const std::string cappedPath = directory + "/capped.sock";
+        PIRServer capped(cappedPath, keys, params, 1, 1);
+        capped.addPlainTable("weatherPlain", directory + "/bb3.pird");
+        capped.start();
+        std::unique_ptr<PIRClient> first(new PIRClient(cappedPath, params));
+        assert(first->queryPlain("weatherPlain", {2}) == PlainLocPIRbb3(2, plain));
+
+        std::atomic<bool> answered{false};
+        std::thread second([&] {
+            PIRClient client(cappedPath, params);
+            assert(client.queryPlain("weatherPlain", {3}) == PlainLocPIRbb3(3, plain));
+            answered = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        assert(!answered);
+        first.reset();
+        second.join();
+        assert(answered);
+    }
+    std::cout << "Test 7 (Connection cap) passed." << std::endl;
+
+    // Test 8: After stop() the socket is gone
+    server.stop();
+    assert(!std::filesystem::exists(socketPath));
+    thrown = false;
+    try {
+        PIRClient late(socketPath, params);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Test 8 (Shutdown) passed, " << server.queriesServed() << " queries served." << std::endl;
+
+    keys.removeKey("tenant");
+    std::filesystem::remove_all(directory);
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_Server(3, 64, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All PIR server tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <chrono>
+#include <cassert>
+#include <cstring>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "optimized/HomLocOPT.h"
+
+// Masks and bodies of every cell match
+bool sameTable(const EncryptedTable& x, const EncryptedTable& y) {
+    const int n = x.params()->in_out_params->n;
+    for (int c = 0; c < x.numColumns(); c++) {
+        size_t cells = static_cast<size_t>(x.numRecords()) * x.schema()[c].bits;
+        if (std::memcmp(x.columnArena(c), y.columnArena(c), cells * n * sizeof(Torus32)) != 0) return false;
+        for (int i = 0; i < x.numRecords(); i++) {
+            for (int j = 0; j < x.schema()[c].bits; j++) {
+                if (x.cell(i, c)[j].b != y.cell(i, c)[j].b) return false;
+            }
+        }
+    }
+    return true;
+}
+
+void test_ParallelBB1(const std::vector<std::vector<int32_t>>& encodedDB, int inputLength, int serviceLength,
+                      const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    MaskSeed seed = maskSeedFromInts(1, 2, 3);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    EncryptedTable serial = encryptTable(encodedDB, inputLength, serviceLength, params, key);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> serialTime = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    EncryptedTable parallel = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key, seed, 4);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> parallelTime = end - start;
+    std::cout << "Encrypt " << encodedDB.size() << " records (s): serial " << serialTime.count()
+              << ", 4 threads " << parallelTime.count() << std::endl;
+
+    // Test 1: Every cell decrypts to the encoded plaintext
+    for (int i = 0; i < parallel.numRecords(); i++) {
+        for (int c = 0; c < parallel.numColumns(); c++) {
+            int bits = parallel.schema()[c].bits;
+            std::vector<int> decrypted = decryptToBinaryVector(parallel.cell(i, c), bits, key);
+            for (int j = 0; j < bits; j++) {
+                assert(decrypted[j] == ((encodedDB[i][c] >> j) & 1));
+            }
+        }
+    }
+    std::cout << "Test 1 (BB1 plaintexts) passed." << std::endl;
+
+    // Test 2: A fixed seed reproduces the table bit for bit, whatever the thread count
+    EncryptedTable again = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key, seed, 4);
+    EncryptedTable single = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key, seed, 1);
+    EncryptedTable bitMajor = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key, seed, 3,
+                                                   TableLayout::BIT_MAJOR);
+    assert(sameTable(parallel, again));
+    assert(sameTable(parallel, single));
+    for (int i = 0; i < parallel.numRecords(); i++) {
+        assert(std::memcmp(parallel.cell(i, 4)[0].a, bitMajor.cell(i, 4)[0].a, params->in_out_params->n * sizeof(Torus32)) == 0);
+    }
+    std::cout << "Test 2 (Reproducible for a fixed seed) passed." << std::endl;
+
+    // Test 3: Another seed gives other ciphertexts
+    EncryptedTable other = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key,
+                                                maskSeedFromInts(1, 2, 4), 4);
+    assert(!sameTable(parallel, other));
+    std::cout << "Test 3 (Seed changes the ciphertexts) passed." << std::endl;
+}
+
+void test_ParallelBB3(int inputLength, int serviceLength,
+                      const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::vector<std::vector<std::string>> data = {{"0", "alpha"}, {"1", "bravo"}, {"2", "charlie"}};
+
+    // Test 4: Kernels run on the parallel-encrypted table
+    EncryptedTable table = encryptTableBB3Parallel(data, inputLength, serviceLength, params, key,
+                                                   maskSeedFromInts(5, 6, 7), 2, TableLayout::BIT_MAJOR);
+    LweSample* enc_id = encryptBoolean(2, inputLength, params, key);
+    LweSample* result = HomLocPIRbb3OPT(enc_id, table.rows(), inputLength, serviceLength, bk,
+                                        ParallelizationMode::PARALLEL_LOOP_HOMSUM, 2);
+    std::string text = binaryStringToText(decryptBinaryString(result, serviceLength, key));
+    assert(text.find("charlie") != std::string::npos);
+    std::cout << "Test 4 (BB3 query): " << text << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+}
+
+int main() {
+    int inputLength = 16;   // Length for interval values
+    int serviceLength = 9;  // Length for service values
+
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    // Load and encode the BB1 database
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    std::vector<std::vector<std::string>> data = loadDataFromCSV(filename);
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(data, inputLength);
+
+    test_ParallelBB1(encodedDB, inputLength, serviceLength, params, key);
+    test_ParallelBB3(2, 56, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All parallel encryption tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <chrono>
+#include <cassert>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "CsvIngest.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "PlainTable.h"
+#include "TableFile.h"
+#include "optimized/HomLocOPT.h"
+
+// Masks and bodies of every cell match
+bool sameTable(const EncryptedTable& x, const EncryptedTable& y) {
+    const int n = x.params()->in_out_params->n;
+    if (x.numRecords() != y.numRecords()) return false;
+    for (int c = 0; c < x.numColumns(); c++) {
+        for (int i = 0; i < x.numRecords(); i++) {
+            for (int j = 0; j < x.schema()[c].bits; j++) {
+                const LweSample& a = x.cell(i, c)[j];
+                const LweSample& b = y.cell(i, c)[j];
+                if (a.b != b.b || std::memcmp(a.a, b.a, n * sizeof(Torus32)) != 0) return false;
+            }
+        }
+    }
+    return true;
+}
+
+void test_PlainBB1(int inputLength, int serviceLength,
+                   const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    std::string path = "testPlainTable_bb1.pird";
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(loadDataFromCSV(filename), inputLength);
+
+    writePlainTable(path, encodeCsvToPlainTable(filename, csvSchemaBB1(inputLength, serviceLength)));
+    auto start = std::chrono::high_resolution_clock::now();
+    PlainTable plain = mapPlainTable(path);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "Map plaintext table (s): " << elapsed.count() << std::endl;
+
+    // Test 1: The mapped file holds the encodeDB values and the column metadata
+    assert(plain.isMapped());
+    assert(plain.numRecords() == static_cast<int64_t>(encodedDB.size()));
+    assert(plain.numColumns() == 5 && plain.schema()[4].bits == serviceLength);
+    for (int64_t i = 0; i < plain.numRecords(); i++) {
+        for (int c = 0; c < plain.numColumns(); c++) {
+            for (int j = 0; j < plain.schema()[c].bits; j++) {
+                assert(plain.bit(i, c, j) == ((encodedDB[i][c] >> j) & 1));
+            }
+        }
+    }
+    std::cout << "Test 1 (BB1 round trip) passed." << std::endl;
+
+    // Test 2: Encrypting the plaintext table equals encrypting the CSV
+    MaskSeed seed = maskSeedFromInts(21, 22, 23);
+    EncryptedTable encrypted = encryptPlainTable(plain, params, key, seed, 4);
+    assert(sameTable(encrypted, encryptTableParallel(encodedDB, inputLength, serviceLength, params, key, seed, 4)));
+    std::cout << "Test 2 (BB1 encryption) passed." << std::endl;
+
+    // Test 3: The plaintext server answers like the encrypted one
+    int32_t queryX = encodeDouble(inputLength, 37.5);
+    int32_t queryY = encodeDouble(inputLength, 126.9);
+    std::vector<int> expected = PlainLocPIRbb1(queryX, queryY, plain);
+    LweSample* enc_x = encryptBoolean(queryX, inputLength, params, key);
+    LweSample* enc_y = encryptBoolean(queryY, inputLength, params, key);
+    LweSample* result = HomLocPIRbb1OPT(enc_x, enc_y, encrypted.rows(), inputLength, serviceLength, bk,
+                                        ParallelizationMode::PARALLEL_LOOP_HOMSUM, 4);
+    assert(decryptToBinaryVector(result, serviceLength, key) == expected);
+    int service = 0;
+    for (int j = 0; j < serviceLength; j++) {
+        service += expected[j] << j;
+    }
+    std::cout << "Test 3 (BB1 plaintext query): " << service << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_x);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_y);
+    std::remove(path.c_str());
+}
+
+void test_PlainBB3(int inputLength, int serviceLength,
+                   const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    std::string filename = std::string(DATA_DIR) + "/pir_weather_data_unique.csv";
+    std::string path = "testPlainTable_bb3.pird";
+    std::string tablePath = "testPlainTable_bb3.pirt";
+    std::vector<std::vector<std::string>> data = loadDataFromCSVbb3(filename);
+
+    writePlainTable(path, encodeCsvToPlainTable(filename, csvSchemaBB3(inputLength, serviceLength)));
+    PlainTable plain = mapPlainTable(path);
+
+    // Test 4: Streaming a plaintext table into a table file equals encrypting the CSV
+    MaskSeed seed = maskSeedFromInts(24, 25, 26);
+    encryptPlainTableToFile(plain, tablePath, params, key, seed, 4, 50);
+    EncryptedTable mapped = mapTableFile(tablePath, params);
+    assert(sameTable(mapped, encryptTableBB3Parallel(data, inputLength, serviceLength, params, key, seed, 4)));
+    std::cout << "Test 4 (BB3 table file) passed." << std::endl;
+
+    // Test 5: Plaintext identifier lookup
+    std::vector<int> bits = PlainLocPIRbb3(2, plain);
+    std::string binaryString;
+    for (int bit : bits) {
+        binaryString += static_cast<char>('0' + bit);
+    }
+    std::string text = binaryStringToText(binaryString);
+    assert(text.find(data[2][1]) != std::string::npos);
+    std::cout << "Test 5 (BB3 plaintext query): " << text << std::endl;
+
+    std::remove(path.c_str());
+    std::remove(tablePath.c_str());
+}
+
+void test_CraftedHeaders() {
+    std::string path = "testPlainTable_crafted.pird";
+    PlainTable built(schemaBB3(3, 64), 2);
+
+    // Each field is patched in a fresh copy; a crafted file is rejected, never read out of range
+    auto rejectsPatch = [&](size_t offset, const void* value, size_t size) {
+        writePlainTable(path, built);
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offset);
+        file.write(static_cast<const char*>(value), size);
+        file.close();
+        try {
+            mapPlainTable(path);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    const size_t column = sizeof(PlainTableHeader);
+    const uint64_t wrappingRecords = (~uint64_t(0) >> 3) + 2;  // records * 8 bytes wraps to a small size
+    const uint64_t misaligned = PLAIN_TABLE_ALIGNMENT + 4;
+    const uint32_t hugeCount = 0xffffffffu;
+    const uint32_t badEnum = 7;
+    assert(rejectsPatch(offsetof(PlainTableHeader, numRecords), &wrappingRecords, sizeof(wrappingRecords)));
+    assert(rejectsPatch(offsetof(PlainTableHeader, numColumns), &hugeCount, sizeof(hugeCount)));
+    assert(rejectsPatch(column + offsetof(PlainTableColumn, offset), &misaligned, sizeof(misaligned)));
+    assert(rejectsPatch(column + offsetof(PlainTableColumn, bits), &hugeCount, sizeof(hugeCount)));
+    assert(rejectsPatch(column + offsetof(PlainTableColumn, type), &badEnum, sizeof(badEnum)));
+
+    std::remove(path.c_str());
+    std::cout << "Test 6 (Crafted headers) passed." << std::endl;
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_PlainBB1(16, 9, params, key);
+    test_PlainBB3(9, 128, params, key);
+    test_CraftedHeaders();
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All plaintext table tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "QueryCheckpoint.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "optimized/HomLocOPT.h"
+
+void test_Checkpoint(int inputLength, int serviceLength,
+                     const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
+    std::vector<std::vector<int32_t>> encodedDB = encodeDB(loadDataFromCSV(filename), inputLength);
+    EncryptedTable table = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key,
+                                                maskSeedFromInts(71, 72, 73), 4);
+    LweSample* enc_x = encryptBoolean(encodeDouble(inputLength, 37.5), inputLength, params, key);
+    LweSample* enc_y = encryptBoolean(encodeDouble(inputLength, 126.9), inputLength, params, key);
+    LweSample* other_x = encryptBoolean(encodeDouble(inputLength, 35.1), inputLength, params, key);
+    ThreadPartition partition{ParallelizationMode::PARALLEL_LOOP_HOMSUM, 4, 1, 4};
+    const int M = table.numRecords();
+
+    LweSample* expected = HomLocPIRbb1OPT(enc_x, enc_y, table.rows(), inputLength, serviceLength, bk,
+                                          ParallelizationMode::NONE, 1);
+    std::vector<int32_t> answer = decryptToBinaryVector(expected, serviceLength, key);
+
+    CheckpointConfig config;
+    config.path = "query_test.ckpt";
+    config.chunkRecords = 3;
+    std::remove(config.path.c_str());
+
+    // Test 1: An uninterrupted run answers like the serial query and leaves no checkpoint
+    LweSample* whole = HomLocPIRResumable(BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength, serviceLength,
+                                          bk, partition, config);
+    assert(whole && decryptToBinaryVector(whole, serviceLength, key) == answer);
+    assert(queryCheckpointProgress(config.path) == -1);
+    std::cout << "Test 1 (Uninterrupted run) passed." << std::endl;
+
+    // Test 2: A preempted run leaves its progress on disk and a later call finishes it
+    assert(M > 2 * config.chunkRecords);
+    config.maxChunks = 2;
+    assert(HomLocPIRResumable(BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength, serviceLength,
+                              bk, partition, config) == nullptr);
+    assert(queryCheckpointProgress(config.path) == 2 * config.chunkRecords);
+    config.maxChunks = 0;
+    LweSample* resumed = HomLocPIRResumable(BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength, serviceLength,
+                                            bk, partition, config);
+    assert(resumed && decryptToBinaryVector(resumed, serviceLength, key) == answer);
+    assert(queryCheckpointProgress(config.path) == -1);
+    std::cout << "Test 2 (Preempt and resume after " << 2 * config.chunkRecords << " of " << M
+              << " records) passed." << std::endl;
+
+    // Test 3: Another query's checkpoint, or a truncated one, is refused rather than mixed in
+    config.maxChunks = 1;
+    assert(HomLocPIRResumable(BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength, serviceLength,
+                              bk, partition, config) == nullptr);
+    config.maxChunks = 0;
+    bool thrown = false;
+    try {
+        HomLocPIRResumable(BuildingBlock::BB1, other_x, enc_y, table.rows(), inputLength, serviceLength,
+                           bk, partition, config);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::ofstream(config.path, std::ios::trunc) << "QPCK";
+    thrown = false;
+    try {
+        queryCheckpointProgress(config.path);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Test 3 (Foreign checkpoint) passed." << std::endl;
+
+    // Test 4: The same query on a re-encrypted table of the same shape does not resume
+    EncryptedTable reencrypted = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key,
+                                                      maskSeedFromInts(74, 75, 76), 4);
+    std::remove(config.path.c_str());
+    config.maxChunks = 1;
+    assert(HomLocPIRResumable(BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength, serviceLength,
+                              bk, partition, config) == nullptr);
+    config.maxChunks = 0;
+    thrown = false;
+    try {
+        HomLocPIRResumable(BuildingBlock::BB1, enc_x, enc_y, reencrypted.rows(), inputLength, serviceLength,
+                           bk, partition, config);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && queryCheckpointProgress(config.path) == config.chunkRecords);
+    std::cout << "Test 4 (Checkpoint of another table version) passed." << std::endl;
+
+    // Test 5: A checkpoint of a longer service is refused before its partial sum is read
+    QueryCheckpointHeader header;
+    std::string body;
+    {
+        std::ifstream in(config.path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        body.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    header.serviceLength = 8 * serviceLength;
+    {
+        std::ofstream out(config.path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (int copy = 0; copy < 8; copy++) {
+            out << body;
+        }
+    }
+    thrown = false;
+    try {
+        HomLocPIRResumable(BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength, serviceLength,
+                           bk, partition, config);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && queryCheckpointProgress(config.path) == config.chunkRecords);
+    std::cout << "Test 5 (Checkpoint of another service length) passed." << std::endl;
+
+    std::remove(config.path.c_str());
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, whole);
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, resumed);
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, expected);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_x);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_y);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, other_x);
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_Checkpoint(16, 9, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All query checkpoint tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "ParallelEncryption.h"
+#include "PIREngine.h"
+#include "QueryScheduler.h"
+
+void test_LatencyHistogram() {
+    // Test 1: Percentiles land within one bucket (25%) of the exact value
+    LatencyHistogram histogram;
+    assert(histogram.percentile(50) == 0.0);
+    for (int ms = 1; ms <= 100; ms++) {
+        histogram.record(ms / 1000.0);
+    }
+    assert(histogram.count() == 100);
+    assert(histogram.maxSeconds() == 0.1);
+    double p50 = histogram.percentile(50);
+    double p99 = histogram.percentile(99);
+    assert(p50 >= 0.050 && p50 <= 0.050 * 1.25);
+    assert(p99 >= 0.099 && p99 <= 0.1);
+    assert(histogram.percentile(100) == 0.1);
+    std::cout << "Test 1 (Latency histogram percentiles) passed." << std::endl;
+}
+
+void test_Scheduler(int inputLength, int serviceLength,
+                    const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    std::vector<std::vector<std::string>> data = {{"0", "alpha"}, {"1", "bravo"}, {"2", "charlie"},
+                                                  {"3", "delta"}, {"4", "echo"}, {"5", "foxtrot"}};
+    PIREngine engine(&key->cloud, encryptTableBB3Parallel(data, inputLength, serviceLength, params, key,
+                                                          maskSeedFromInts(41, 42, 43), 4), 4);
+
+    std::vector<LweSample*> ids;
+    for (size_t q = 0; q < data.size(); q++) {
+        ids.push_back(encryptBoolean(q, inputLength, params, key));
+    }
+
+    // Test 2: Queries submitted from several threads get their own answers
+    {
+        QueryScheduler scheduler(engine, SchedulerConfig());
+        std::vector<std::future<CiphertextArray>> results(data.size());
+        std::vector<std::thread> callers;
+        for (size_t q = 0; q < data.size(); q++) {
+            callers.emplace_back([&, q] {
+                QueryTicket ticket = scheduler.submit(ids[q], 0);
+                assert(ticket.status == AdmissionStatus::ADMITTED);
+                results[q] = std::move(ticket.result);
+            });
+        }
+        for (std::thread& caller : callers) {
+            caller.join();
+        }
+        for (size_t q = 0; q < data.size(); q++) {
+            CiphertextArray result = results[q].get();
+            std::string text = binaryStringToText(decryptBinaryString(result.get(), serviceLength, key));
+            assert(text.find(data[q][1]) != std::string::npos);
+        }
+        SchedulerStats stats = scheduler.stats();
+        assert(stats.admitted == data.size() && stats.completed == data.size());
+        assert(stats.secondsPerRecord > 0);
+        assert(scheduler.latency().count() == data.size());
+        assert(scheduler.freeThreads() == engine.numThreads());
+        std::cout << "Test 2 (Concurrent submits) passed." << std::endl;
+    }
+
+    // Test 3: Past maxQueued waiting queries new ones are refused, and admitted ones still finish
+    {
+        SchedulerConfig config;
+        config.numThreads = 1;
+        config.maxQueued = 1;
+        QueryScheduler scheduler(engine, config);
+        std::vector<std::future<CiphertextArray>> admitted;
+        int refused = 0;
+        for (int q = 0; q < 16; q++) {
+            QueryTicket ticket = scheduler.submit(ids[q % ids.size()], 0);
+            if (ticket.status == AdmissionStatus::QUEUE_FULL) {
+                assert(!ticket.result.valid());
+                refused++;
+            } else {
+                admitted.push_back(std::move(ticket.result));
+            }
+        }
+        assert(refused > 0);
+        for (std::future<CiphertextArray>& result : admitted) {
+            result.get();
+        }
+        assert(scheduler.stats().rejectedQueueFull == static_cast<uint64_t>(refused));
+        std::cout << "Test 3 (Queue backpressure) passed." << std::endl;
+    }
+
+    // Test 4: A deadline the estimated cost cannot meet is refused up front; none is always admitted
+    {
+        SchedulerConfig config;
+        config.initialSecondsPerRecord = 10.0;
+        QueryScheduler scheduler(engine, config);
+        QueryTicket late = scheduler.submit(ids[0], 1.0);
+        assert(late.status == AdmissionStatus::DEADLINE_MISSED);
+        assert(late.estimatedSeconds > 1.0);
+        QueryTicket open = scheduler.submit(ids[1], 0);
+        assert(open.status == AdmissionStatus::ADMITTED);
+        open.result.get();
+        assert(scheduler.stats().rejectedDeadline == 1);
+
+        bool thrown = false;
+        try {
+            scheduler.submit(ids[0], ids[1], 0);
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+        std::cout << "Test 4 (Deadline admission) passed." << std::endl;
+    }
+
+    for (LweSample* id : ids) {
+        delete_gate_bootstrapping_ciphertext_array(inputLength, id);
+    }
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_LatencyHistogram();
+    test_Scheduler(3, 64, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All query scheduler tests passed." << std::endl;
+    return 0;
+}
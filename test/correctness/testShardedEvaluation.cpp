@@ -0,0 +1,146 @@
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <signal.h>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "PIREngine.h"
+#include "ShardedEvaluation.h"
+#include "TableFile.h"
+
+void test_ShardRanges() {
+    // Test 1: Ranges cover every record once, in order, within one record of each other
+    for (int records : {0, 1, 7, 64}) {
+        for (int shards : {1, 3, 8}) {
+            std::vector<ShardRange> ranges = shardRanges(records, shards);
+            assert(static_cast<int>(ranges.size()) == shards);
+            int next = 0;
+            for (const ShardRange& range : ranges) {
+                assert(range.firstRecord == next);
+                assert(range.numRecords == records / shards || range.numRecords == records / shards + 1);
+                next += range.numRecords;
+            }
+            assert(next == records);
+        }
+    }
+    std::cout << "Test 1 (Shard ranges) passed." << std::endl;
+}
+
+void test_SharedKeyImage(const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    // Test 2: A key mapped from the shared image bootstraps like the original
+    SharedKeyImage image(&key->cloud);
+    assert(image.fd() >= 0 && image.bytes() == bootstrappingKeyImageBytes(params));
+    MappedCloudKey mapped = image.map(params);
+    LweSample* bits = encryptBoolean(0b01, 2, params, key);
+    CiphertextArray out(1, params);
+    bootsXOR(out.get(), &bits[0], &bits[1], mapped.get());
+    assert(bootsSymDecrypt(out.get(), key) == 1);
+    delete_gate_bootstrapping_ciphertext_array(2, bits);
+    std::cout << "Test 2 (Shared key image) passed." << std::endl;
+}
+
+void test_ShardedBB3(int inputLength, int serviceLength,
+                     const TFheGateBootstrappingParameterSet* params, const TFheGateBootstrappingSecretKeySet* key) {
+    std::vector<std::vector<std::string>> data = {{"0", "alpha"}, {"1", "bravo"}, {"2", "charlie"},
+                                                  {"3", "delta"}, {"4", "echo"}, {"5", "foxtrot"}, {"6", "golf"}};
+    const std::string path = "testShardedEvaluation.pirt";
+    writeTableFile(path, encryptTableBB3Parallel(data, inputLength, serviceLength, params, key,
+                                                 maskSeedFromInts(51, 52, 53), 4));
+
+    // Test 3: A record range maps only its records
+    EncryptedTable slice = mapTableFileRange(path, params, 2, 3);
+    assert(slice.numRecords() == 3);
+    EncryptedTable whole = mapTableFile(path, params);
+    assert(slice.cell(0, 1)[0].b == whole.cell(2, 1)[0].b);
+    bool thrown = false;
+    try {
+        mapTableFileRange(path, params, 5, 3);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Test 3 (Table file ranges) passed." << std::endl;
+
+    // Test 4: Every record is found through whichever shard holds it, for any shard count
+    for (int shards : {1, 3, 16}) {
+        ShardedEvaluator evaluator(path, &key->cloud, shards, 2);
+        assert(evaluator.numShards() == std::min(shards, static_cast<int>(data.size())));
+        assert(evaluator.buildingBlock() == BuildingBlock::BB3);
+        for (size_t q = 0; q < data.size(); q++) {
+            LweSample* enc_id = encryptBoolean(q, inputLength, params, key);
+            CiphertextArray result = evaluator.query(enc_id);
+            std::string text = binaryStringToText(decryptBinaryString(result.get(), serviceLength, key));
+            assert(text.find(data[q][1]) != std::string::npos);
+            delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+        }
+    }
+    std::cout << "Test 4 (Sharded BB3 queries) passed." << std::endl;
+
+    // Test 5: Wrong query kind and a missing table are reported, not hung on
+    {
+        ShardedEvaluator evaluator(path, &key->cloud, 2, 1);
+        LweSample* enc = encryptBoolean(0, inputLength, params, key);
+        thrown = false;
+        try {
+            evaluator.query(enc, enc);
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+        delete_gate_bootstrapping_ciphertext_array(inputLength, enc);
+    }
+    thrown = false;
+    try {
+        ShardedEvaluator missing("noSuchTable.pirt", &key->cloud, 2, 1);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Test 5 (Errors) passed." << std::endl;
+
+    // Test 6: A killed worker fails the query in flight and is replaced for the next one
+    {
+        ShardedEvaluator evaluator(path, &key->cloud, 2, 1);
+        LweSample* enc_id = encryptBoolean(1, inputLength, params, key);
+        pid_t killed = evaluator.workerPid(1);
+        kill(killed, SIGKILL);
+        thrown = false;
+        try {
+            evaluator.query(enc_id);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown && evaluator.workerPid(1) > 0 && evaluator.workerPid(1) != killed);
+        CiphertextArray answer = evaluator.query(enc_id);
+        assert(binaryStringToText(decryptBinaryString(answer.get(), serviceLength, key)).find(data[1][1]) !=
+               std::string::npos);
+        delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+    }
+    std::cout << "Test 6 (Worker restart) passed." << std::endl;
+
+    std::remove(path.c_str());
+}
+
+int main() {
+    // Initialize TFHE parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    test_ShardRanges();
+    test_SharedKeyImage(params, key);
+    test_ShardedBB3(3, 64, params, key);
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All sharded evaluation tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tfhe/tfhe.h>
+#include <tfhe/tfhe_io.h>
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "TableFile.h"
+#include "optimized/HomLocOPT.h"
+
+void test_RoundTrip(TableLayout layout, const std::string& layout_name,
+                    int inputLength, int serviceLength,
+                    const TFheGateBootstrappingParameterSet* params,
+                    const TFheGateBootstrappingSecretKeySet* key) {
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+    std::cout << "Testing layout: " << layout_name << std::endl;
+    std::vector<std::vector<std::string>> data = {{"0", "alpha"}, {"1", "bravo"}, {"2", "charlie"}, {"3", "delta"}};
+    std::string path = "testTableFile_" + layout_name + ".pirt";
+
+    EncryptedTable built = encryptTableBB3(data, inputLength, serviceLength, params, key, layout);
+    writeTableFile(path, built);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    EncryptedTable mapped = mapTableFile(path, params);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    // Test 1: Header and schema survive the round trip
+    assert(mapped.isMapped() && !built.isMapped());
+    assert(mapped.numRecords() == built.numRecords());
+    assert(mapped.numColumns() == built.numColumns());
+    assert(mapped.layout() == layout);
+    for (int c = 0; c < mapped.numColumns(); c++) {
+        assert(mapped.schema()[c].name == built.schema()[c].name);
+        assert(mapped.schema()[c].type == built.schema()[c].type);
+        assert(mapped.schema()[c].bits == built.schema()[c].bits);
+    }
+
+    // Test 2: Ciphertexts are bit-identical and masks are used in place, page-aligned
+    const int n = params->in_out_params->n;
+    for (int c = 0; c < mapped.numColumns(); c++) {
+        assert(reinterpret_cast<uintptr_t>(mapped.columnArena(c)) % TABLE_FILE_ALIGNMENT == 0);
+        for (int i = 0; i < mapped.numRecords(); i++) {
+            for (int j = 0; j < mapped.schema()[c].bits; j++) {
+                const LweSample& a = mapped.cell(i, c)[j];
+                const LweSample& b = built.cell(i, c)[j];
+                assert(a.b == b.b);
+                assert(std::memcmp(a.a, b.a, n * sizeof(Torus32)) == 0);
+            }
+        }
+    }
+
+    // Test 3: Kernels run on the mapped table
+    LweSample* enc_id = encryptBoolean(2, inputLength, params, key);
+    LweSample* result = HomLocPIRbb3OPT(enc_id, mapped.rows(), inputLength, serviceLength, bk,
+                                        ParallelizationMode::PARALLEL_LOOP_HOMSUM, 4);
+    std::string text = binaryStringToText(decryptBinaryString(result, serviceLength, key));
+    std::cout << "Decrypted result: " << text << std::endl;
+    assert(text.find("charlie") != std::string::npos);
+    std::cout << "Map time (s): " << elapsed.count() << std::endl;
+
+    delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+    std::remove(path.c_str());
+}
+
+void test_ParameterMismatch(int inputLength, int serviceLength,
+                            const TFheGateBootstrappingParameterSet* params,
+                            const TFheGateBootstrappingSecretKeySet* key) {
+    std::string path = "testTableFile_mismatch.pirt";
+    EncryptedTable built = encryptTableBB3({{"0", "alpha"}}, inputLength, serviceLength, params, key);
+    writeTableFile(path, built);
+
+    // Pretend the file was built for another LWE dimension
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    uint32_t otherN = params->in_out_params->n + 1;
+    file.seekp(offsetof(TableFileHeader, n));
+    file.write(reinterpret_cast<const char*>(&otherN), sizeof(otherN));
+    file.close();
+
+    // It is rejected rather than misread
+    bool rejected = false;
+    try {
+        mapTableFile(path, params);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+
+    std::remove(path.c_str());
+}
+
+void test_CraftedHeaders(int inputLength, int serviceLength,
+                        const TFheGateBootstrappingParameterSet* params,
+                        const TFheGateBootstrappingSecretKeySet* key) {
+    std::string path = "testTableFile_crafted.pirt";
+    EncryptedTable built = encryptTableBB3({{"0", "alpha"}, {"1", "bravo"}}, inputLength, serviceLength, params, key);
+
+    // Each field is patched in a fresh copy; a crafted file is rejected, never mapped out of
+    // range, and its schema is not handed out either
+    auto rejectsPatch = [&](size_t offset, const void* value, size_t size) {
+        writeTableFile(path, built);
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offset);
+        file.write(static_cast<const char*>(value), size);
+        file.close();
+        int rejected = 0;
+        try {
+            mapTableFile(path, params);
+        } catch (const std::runtime_error&) {
+            rejected++;
+        }
+        try {
+            int numRecords = 0;
+            readTableFileSchema(path, numRecords);
+        } catch (const std::runtime_error&) {
+            rejected++;
+        }
+        return rejected == 2;
+    };
+    const size_t column = sizeof(TableFileHeader);
+    const uint64_t wrappingOffset = ~uint64_t(0) - 4095;  // aligned, and offset + size wraps
+    const uint64_t misaligned = TABLE_FILE_ALIGNMENT + 4;
+    const uint32_t hugeCount = 0xffffffffu;
+    const uint32_t badEnum = 7;
+    assert(rejectsPatch(column + offsetof(TableFileColumn, masksOffset), &wrappingOffset, sizeof(wrappingOffset)));
+    assert(rejectsPatch(column + offsetof(TableFileColumn, bodiesOffset), &misaligned, sizeof(misaligned)));
+    assert(rejectsPatch(column + offsetof(TableFileColumn, bits), &hugeCount, sizeof(hugeCount)));
+    assert(rejectsPatch(column + offsetof(TableFileColumn, type), &badEnum, sizeof(badEnum)));
+    assert(rejectsPatch(offsetof(TableFileHeader, layout), &badEnum, sizeof(badEnum)));
+    assert(rejectsPatch(offsetof(TableFileHeader, numRecords), &hugeCount, sizeof(hugeCount)));
+    assert(rejectsPatch(offsetof(TableFileHeader, numColumns), &hugeCount, sizeof(hugeCount)));
+
+    // A mapped table hands out read-only views only
+    writeTableFile(path, built);
+    EncryptedTable mapped = mapTableFile(path, params);
+    bool refused = false;
+    try {
+        mapped.mutableCell(0, 0);
+    } catch (const std::logic_error&) {
+        refused = true;
+    }
+    assert(refused);
+
+    std::remove(path.c_str());
+}
+
+int main() {
+    // Initialize parameters and keys
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+
+    int inputLength = 3;     // Identifier length for 4 records
+    int serviceLength = 64;  // 8 characters
+
+    test_RoundTrip(TableLayout::RECORD_MAJOR, "RECORD_MAJOR", inputLength, serviceLength, params, key);
+    std::cout << "Test 1 (RECORD_MAJOR round trip) passed." << std::endl;
+    test_RoundTrip(TableLayout::BIT_MAJOR, "BIT_MAJOR", inputLength, serviceLength, params, key);
+    std::cout << "Test 2 (BIT_MAJOR round trip) passed." << std::endl;
+    test_ParameterMismatch(inputLength, serviceLength, params, key);
+    std::cout << "Test 3 (Parameter mismatch) passed." << std::endl;
+    test_CraftedHeaders(inputLength, serviceLength, params, key);
+    std::cout << "Test 4 (Crafted headers) passed." << std::endl;
+
+    // Clean up keys
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "All table file tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <csignal>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include <tfhe/tfhe.h>
+#include "utils.h"
+#include "CloudKeyCache.h"
+#include "PIRServer.h"
+
+// Long-running query server over a UNIX socket. Tables are given as
+//   name=table.pirt@keyId   encrypted table file, served with <keyDirectory>/<keyId>.bk
+//   name=table.pird         plaintext table file, cleartext baseline
+// e.g. after buildTableFile and buildPlainTable:
+//   pirServer /tmp/velopir.sock result 8 weather=result/weather_US_bb3.pirt@weather_US_bb3
+//             weatherPlain=result/weather_US_bb3.pird
+// Runs until SIGINT or SIGTERM.
+int main(int argc, char* argv[]) {
+    if (argc < 5) {
+        std::cerr << "usage: " << argv[0] << " <socket> <keyDirectory> <threads> name=table.pirt@keyId|name=table.pird ..."
+                  << std::endl;
+        return 1;
+    }
+    std::string socketPath = argv[1];
+    std::string keyDirectory = argv[2];
+    int numThreads = 0;
+    try {
+        numThreads = std::stoi(argv[3]);
+    } catch (const std::exception&) {
+    }
+    if (numThreads < 1) {
+        std::cerr << "bad thread count: " << argv[3] << std::endl;
+        return 1;
+    }
+
+    // Every thread started from here on inherits the mask; signals are taken by sigwait below
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    // The key cache and server borrow params; any failure to start unwinds them before it is freed
+    auto params = initializeParams(128);
+    int status = 0;
+    try {
+        CloudKeyCache keys(keyDirectory, params, argc - 4);
+        PIRServer server(socketPath, keys, params, numThreads);
+
+        for (int a = 4; a < argc; a++) {
+            std::string spec = argv[a];
+            size_t equals = spec.find('=');
+            if (equals == std::string::npos) {
+                throw std::invalid_argument("bad table spec: " + spec);
+            }
+            std::string name = spec.substr(0, equals);
+            std::string path = spec.substr(equals + 1);
+            size_t at = path.rfind('@');
+            if (at != std::string::npos) {
+                server.addEncryptedTable(name, path.substr(0, at), path.substr(at + 1));
+            } else {
+                server.addPlainTable(name, path);
+            }
+            std::cout << "Loaded " << name << " from " << path << std::endl;
+        }
+
+        server.start();
+        std::cout << "Listening on " << socketPath << std::endl;
+
+        int received = 0;
+        sigwait(&signals, &received);
+        std::cout << "Stopping after " << server.queriesServed() << " queries ("
+                  << server.queriesFailed() << " failed)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "pirServer: " << e.what() << std::endl;
+        status = 1;
+    }
+
+    delete_gate_bootstrapping_parameters(params);
+    return status;
+}
@@ -0,0 +1,53 @@
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <tfhe/tfhe.h>
+#include "utils.h"
+#include "CostModel.h"
+
+// Capacity planning without a table: for a table shape and a latency SLA, prints the fastest
+// plan on 1, 2, 4, ... cores and the largest table each meets the SLA with, and writes the
+// same rows to result/slaReport.csv. Gate costs are measured on this machine unless given.
+//   slaReport <bb1|bb2|bb3> <records> <inputLength> <serviceLength> <sla_s> [maxThreads] [gate_s mux_s]
+int main(int argc, char* argv[]) {
+    if (argc < 6) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <bb1|bb2|bb3> <records> <inputLength> <serviceLength> <sla_s> [maxThreads] [gate_s mux_s]"
+                  << std::endl;
+        return 1;
+    }
+    std::string blockArg = argv[1];
+    BuildingBlock block = blockArg == "bb1" ? BuildingBlock::BB1 : blockArg == "bb2" ? BuildingBlock::BB2 : BuildingBlock::BB3;
+    DatasetShape shape{block, std::stoi(argv[2]), std::stoi(argv[3]), std::stoi(argv[4]), 1};
+    double sla = std::stod(argv[5]);
+    int maxThreads = (argc > 6) ? std::stoi(argv[6]) : 64;
+
+    GateCosts costs;
+    if (argc > 8) {
+        costs = {std::stod(argv[7]), std::stod(argv[8])};
+    } else {
+        auto params = initializeParams(128);
+        auto key = generateKeySet(params);
+        costs = calibrateGateCosts(&key->cloud);
+        delete_gate_bootstrapping_secret_keyset(key);
+        delete_gate_bootstrapping_parameters(params);
+    }
+    std::cout << "Gate (s): " << costs.gateSeconds << ", MUX (s): " << costs.muxSeconds << std::endl;
+
+    StrategyPlanner planner(costs);
+    planner.writeSlaReport(std::cout, shape, sla, maxThreads);
+
+    int threads = planner.threadsForSla(shape, sla, maxThreads);
+    if (threads > 0) {
+        std::cout << "Fewest cores for " << sla << " s: " << threads << std::endl;
+    } else {
+        std::cout << "No core count up to " << maxThreads << " meets " << sla << " s" << std::endl;
+    }
+
+    std::filesystem::create_directory("result");
+    std::ofstream file("result/slaReport.csv");
+    planner.writeSlaReport(file, shape, sla, maxThreads);
+    std::cout << "Report saved to result/slaReport.csv" << std::endl;
+    return 0;
+}
@@ -1,11 +1,13 @@
 #include <iostream>
 #include <chrono>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <filesystem>
 #include <tfhe/tfhe.h>
 #include <tfhe/tfhe_io.h>
 #include "utils.h"
+#include "QueryCodec.h"
 #include "native/HomComp.h"
 #include "optimized/HomBBOPT.h"
 #include "optimized/HomLocOPT.h" 
@@ -51,6 +53,10 @@ int main() {
     std::ofstream file("result/LocPIRbb1_timing_covid_korea.csv");
     file << "Mode,Time(s)\n";  // CSV header
 
+    // Sizes and one-off costs go to their own CSV so the timing table keeps its schema
+    std::ofstream metrics("result/LocPIRbb1_metrics_covid_korea.csv");
+    metrics << "Metric,Value,Unit\n";
+
     // Provide the path to the CSV file
     std::string filename = std::string(DATA_DIR) + "/covid_bb1.csv";
 
@@ -73,8 +79,21 @@ int main() {
 
     int32_t queryX = encodeDouble(inputLength, queryX_value);
     int32_t queryY = encodeDouble(inputLength, queryY_value);
-    LweSample* enc_x = encryptBoolean(queryX, inputLength, params, key);
-    LweSample* enc_y = encryptBoolean(queryY, inputLength, params, key);
+
+    // Client sends a seed-compressed query; the server expands it
+    std::stringstream uploaded;
+    exportCompressedQueryToStream(uploaded, encryptCompressedQuery({queryX, queryY}, inputLength, key));
+    size_t compressedBytes = uploaded.str().size();
+    std::vector<CiphertextArray> query = expandCompressedQuery(importCompressedQueryFromStream(uploaded), params);
+    LweSample* enc_x = query[0].get();
+    LweSample* enc_y = query[1].get();
+
+    std::stringstream fullQuery;
+    exportCiphertextArrayToStream(fullQuery, enc_x, inputLength, params);
+    exportCiphertextArrayToStream(fullQuery, enc_y, inputLength, params);
+    std::cout << "Query upload (bytes): full " << fullQuery.str().size() << ", compressed " << compressedBytes << std::endl;
+    metrics << "QueryBytesFull," << fullQuery.str().size() << ",bytes\n";
+    metrics << "QueryBytesCompressed," << compressedBytes << ",bytes\n";
 
     // Test all parallelization modes and record timings
     double time_NONE = test_HomLocPIRbb1OPT(ParallelizationMode::NONE, "NONE", enc_x, enc_y, encryptedDB, inputLength, serviceLength, bk, 1);
@@ -90,15 +109,14 @@ int main() {
     file << "ALL," << time_ALL << "\n";
 
     file.close();
+    metrics.close();
 
     // Clean up
-    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_x);
-    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_y);
     cleanUpEncryptedDB(encryptedDB, inputLength, serviceLength);
     delete_gate_bootstrapping_secret_keyset(key);
     delete_gate_bootstrapping_parameters(params);
 
-    std::cout << "Test completed and results saved to result/LocPIRbb1_timing_covid_korea.csv" << std::endl;
+    std::cout << "Test completed and results saved to result/LocPIRbb1_timing_covid_korea.csv and result/LocPIRbb1_metrics_covid_korea.csv" << std::endl;
     return 0;
 }
 
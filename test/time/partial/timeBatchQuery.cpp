@@ -0,0 +1,82 @@
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>  // For creating directories
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "optimized/HomLocBatch.h"
+#include "optimized/HomLocOPT.h"
+
+// K BB3 queries answered one pass each (HomLocPIRbb3OPT) against one shared pass
+// (HomLocPIRbb3Batch), at a fixed thread count
+int main(int argc, char* argv[]) {
+    int records = (argc > 1) ? std::stoi(argv[1]) : 64;
+    int numThreads = (argc > 2) ? std::stoi(argv[2]) : 8;
+    int inputLength = 7;      // Length for identifier values
+    int serviceLength = 64;   // Length for service values
+
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    std::vector<std::vector<std::string>> data;
+    for (int i = 0; i < records; i++) {
+        data.push_back({std::to_string(i), "svc" + std::to_string(i)});
+    }
+    EncryptedTable table = encryptTableBB3Parallel(data, inputLength, serviceLength, params, key, randomMaskSeed(), 4);
+    std::vector<std::vector<LweSample*>> rows = table.rows();
+
+    // Create the result directory if it doesn't exist
+    std::filesystem::create_directory("result");
+
+    // Open a CSV file to write results
+    std::ofstream file("result/batchQuery.csv");
+    file << "K,one pass per query (s),shared pass (s)\n";
+
+    std::vector<int> k_values = {1, 4, 16};
+    for (int K : k_values) {
+        std::vector<LweSample*> owned;
+        std::vector<const LweSample*> enc_ids;
+        for (int k = 0; k < K; k++) {
+            owned.push_back(encryptBoolean(k % records, inputLength, params, key));
+            enc_ids.push_back(owned.back());
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int k = 0; k < K; k++) {
+            LweSample* result = HomLocPIRbb3OPT(enc_ids[k], rows, inputLength, serviceLength, bk,
+                                                ParallelizationMode::PARALLEL_LOOP_HOMSUM, numThreads);
+            delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> singleTime = end - start;
+
+        start = std::chrono::high_resolution_clock::now();
+        std::vector<CiphertextArray> results = HomLocPIRbb3Batch(enc_ids, rows, inputLength, serviceLength, bk, numThreads);
+        end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> batchTime = end - start;
+
+        file << K << "," << singleTime.count() << "," << batchTime.count() << "\n";
+
+        // Print progress
+        std::cout << "Finished K=" << K << std::endl;
+
+        for (LweSample* sample : owned) {
+            delete_gate_bootstrapping_ciphertext_array(inputLength, sample);
+        }
+    }
+
+    file.close();
+
+    // Clean up
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "Test completed and results saved to result/batchQuery.csv" << std::endl;
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>  // For creating directories
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include "utils.h"
+#include "CostModel.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+
+// Predicted against measured latency of every plan the planner prices, for a BB3 table
+// at a fixed thread count
+int main(int argc, char* argv[]) {
+    int records = (argc > 1) ? std::stoi(argv[1]) : 64;
+    int numThreads = (argc > 2) ? std::stoi(argv[2]) : 8;
+    int inputLength = 7;      // Length for identifier values
+    int serviceLength = 64;   // Length for service values
+
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    std::vector<std::vector<std::string>> data;
+    for (int i = 0; i < records; i++) {
+        data.push_back({std::to_string(i), "svc" + std::to_string(i)});
+    }
+    EncryptedTable table = encryptTableBB3Parallel(data, inputLength, serviceLength, params, key, randomMaskSeed(), 4);
+    LweSample* enc_id = encryptBoolean(records / 2, inputLength, params, key);
+
+    StrategyPlanner planner(calibrateGateCosts(bk));
+    DatasetShape shape{BuildingBlock::BB3, records, inputLength, serviceLength, numThreads};
+
+    // Create the result directory if it doesn't exist
+    std::filesystem::create_directory("result");
+
+    // Open a CSV file to write results
+    std::ofstream file("result/costModel.csv");
+    file << "plan,predicted (s),measured (s)\n";
+
+    for (const PlanEstimate& plan : planner.estimates(shape)) {
+        auto start = std::chrono::high_resolution_clock::now();
+        LweSample* result = HomLocPIRPartitioned(BuildingBlock::BB3, enc_id, nullptr, table.rows(),
+                                                 inputLength, serviceLength, bk, plan.partition);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+        delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+
+        file << plan.name << "," << plan.seconds << "," << elapsed.count() << "\n";
+
+        // Print progress
+        std::cout << "Finished " << plan.name << std::endl;
+    }
+
+    file.close();
+
+    // Clean up
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "Test completed and results saved to result/costModel.csv" << std::endl;
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>  // For creating directories
+#include <sys/resource.h>
+#include "utils.h"
+#include "CsvIngest.h"
+
+// Peak resident set of the process so far, in MiB
+double peakRssMiB() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+// Synthetic weather-style (BB3) input with quoted services
+void writeSyntheticCSV(const std::string& path, long rows) {
+    std::ofstream out(path);
+    out << "Station.City,City Encoding,Service\n";
+    for (long i = 0; i < rows; i++) {
+        out << "Station" << i << "," << i << ",\"" << (i % 7) << ".0, " << (i % 90) << ".0, " << (i % 40) << ".0\"\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long rows = (argc > 1) ? std::stol(argv[1]) : 2000000;
+    int inputLength = 21;     // Enough identifier bits for the rows
+    int serviceLength = 128;  // Length for service values
+    int batchRecords = 4096;
+    std::string path = "result/csvIngest_input.csv";
+
+    // Create the result directory if it doesn't exist
+    std::filesystem::create_directory("result");
+    writeSyntheticCSV(path, rows);
+    std::cout << "Input: " << rows << " rows, " << std::filesystem::file_size(path) / (1 << 20) << " MiB" << std::endl;
+
+    // Parse and encode to plaintext bits, the part that precedes encryption. The streaming
+    // reader runs first so its peak resident set is not inflated by the in-memory loader.
+    auto start = std::chrono::high_resolution_clock::now();
+    CsvSchema schema = csvSchemaBB3(inputLength, serviceLength);
+    CsvReader reader(path, schema.delimiter, schema.header);
+    std::vector<int32_t> bits;
+    long streamed = 0;
+    while (int count = readCsvBatch(reader, schema, batchRecords, bits)) {
+        streamed += count;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> streamTime = end - start;
+    double streamRss = peakRssMiB();
+
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<std::vector<std::string>> data = loadDataFromCSVbb3(path);
+    long loaded = 0;
+    for (size_t i = 0; i < data.size(); i++) {
+        loaded += textToBinaryString(data[i][1], serviceLength).size() / serviceLength;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> loadTime = end - start;
+    double loadRss = peakRssMiB();
+
+    // Open a CSV file to write results
+    std::ofstream file("result/csvIngest.csv");
+    file << "method,rows,time (s),rows/s,peak RSS (MiB)\n";
+    file << "loadDataFromCSVbb3," << loaded << "," << loadTime.count() << "," << loaded / loadTime.count() << "," << loadRss << "\n";
+    file << "CsvReader+readCsvBatch," << streamed << "," << streamTime.count() << "," << streamed / streamTime.count() << "," << streamRss << "\n";
+    file.close();
+
+    std::cout << "loadDataFromCSVbb3: " << loadTime.count() << " s, peak RSS " << loadRss << " MiB" << std::endl;
+    std::cout << "CsvReader+readCsvBatch: " << streamTime.count() << " s, peak RSS " << streamRss << " MiB" << std::endl;
+
+    std::remove(path.c_str());
+    std::cout << "Test completed and results saved to result/csvIngest.csv" << std::endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>  // For creating directories
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "GateCircuit.h"
+#include "optimized/HomLocOPT.h"
+
+// BB1 on few records, where a record loop cannot keep the threads busy: the record-level
+// loop against the gate DAG, which also overlaps the comparator stages of each record
+int main(int argc, char* argv[]) {
+    int records = (argc > 1) ? std::stoi(argv[1]) : 4;
+    int inputLength = 16;     // Length for coordinate values
+    int serviceLength = 8;    // Length for service values
+
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    std::vector<std::vector<int32_t>> encodedDB;
+    for (int i = 0; i < records; i++) {
+        encodedDB.push_back({encodeDouble(inputLength, i), encodeDouble(inputLength, i + 1),
+                             encodeDouble(inputLength, 0), encodeDouble(inputLength, 10), i});
+    }
+    EncryptedTable table = encryptTableParallel(encodedDB, inputLength, serviceLength, params, key, randomMaskSeed(), 4);
+    LweSample* enc_x = encryptBoolean(encodeDouble(inputLength, 1.5), inputLength, params, key);
+    LweSample* enc_y = encryptBoolean(encodeDouble(inputLength, 5), inputLength, params, key);
+
+    GateCircuit circuit;
+    CiphertextArray sink(serviceLength, bk->params);
+    addRetrieval(circuit, BuildingBlock::BB1, enc_x, enc_y, table.rows(), inputLength, serviceLength, sink.get());
+    std::cout << "Gates: " << circuit.numGates() << ", critical path: " << circuit.criticalPath() << std::endl;
+
+    // Create the result directory if it doesn't exist
+    std::filesystem::create_directory("result");
+
+    // Open a CSV file to write results
+    std::ofstream file("result/gateGraph.csv");
+    file << "threads,PARALLEL_LOOP_HOMSUM (s),GATE_GRAPH (s)\n";
+
+    std::vector<int> np_values = {1, 4, 16, 32};
+    for (int np : np_values) {
+        std::vector<double> times;
+        for (ParallelizationMode mode : {ParallelizationMode::PARALLEL_LOOP_HOMSUM, ParallelizationMode::GATE_GRAPH}) {
+            auto start = std::chrono::high_resolution_clock::now();
+            LweSample* result = HomLocPIRbb1OPT(enc_x, enc_y, table.rows(), inputLength, serviceLength, bk, mode, np);
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> elapsed = end - start;
+            times.push_back(elapsed.count());
+            delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+        }
+        file << np << "," << times[0] << "," << times[1] << "\n";
+
+        // Print progress
+        std::cout << "Finished threads=" << np << std::endl;
+    }
+
+    file.close();
+
+    // Clean up
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_x);
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_y);
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "Test completed and results saved to result/gateGraph.csv" << std::endl;
+    return 0;
+}
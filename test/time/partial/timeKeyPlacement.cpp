@@ -0,0 +1,97 @@
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <vector>
+#include <filesystem>  // For creating directories
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include "utils.h"
+#include "KeyPlacement.h"
+#include <omp.h>
+#include <sched.h>
+
+// Bootstrapped gates per second with `np` threads, each gate on the caller's local key copy
+double gateThroughput(int np, int gatesPerThread, const TFheGateBootstrappingSecretKeySet* key,
+                      const TFheGateBootstrappingCloudKeySet* bk) {
+    int gates = np * gatesPerThread;
+    LweSample* a = new_gate_bootstrapping_ciphertext_array(gates, bk->params);
+    LweSample* b = new_gate_bootstrapping_ciphertext_array(gates, bk->params);
+    LweSample* result = new_gate_bootstrapping_ciphertext_array(gates, bk->params);
+    for (int i = 0; i < gates; i++) {
+        bootsSymEncrypt(&a[i], i & 1, key);
+        bootsSymEncrypt(&b[i], (i >> 1) & 1, key);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    #pragma omp parallel for num_threads(np) schedule(static)
+    for (int i = 0; i < gates; i++) {
+        bootsAND(&result[i], &a[i], &b[i], localCloudKey(bk));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    delete_gate_bootstrapping_ciphertext_array(gates, a);
+    delete_gate_bootstrapping_ciphertext_array(gates, b);
+    delete_gate_bootstrapping_ciphertext_array(gates, result);
+    return gates / elapsed.count();
+}
+
+// Undo pinWorkerThreads: let every worker run on any CPU of the topology again
+void unpinWorkerThreads(int np, const NumaTopology& topology) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const std::vector<int>& cpus : topology.nodeCpus) {
+        for (int cpu : cpus) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    #pragma omp parallel num_threads(np)
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+int main(int argc, char* argv[]) {
+    int gatesPerThread = (argc > 1) ? std::stoi(argv[1]) : 8;
+
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    NumaTopology topology = detectNumaTopology();
+
+    // Create the result directory if it doesn't exist
+    std::filesystem::create_directory("result");
+
+    // Open a CSV file to write results
+    std::ofstream file("result/keyPlacementThroughput.csv");
+    file << "threads,default (gates/s),huge pages (gates/s),huge pages + replicas + pinned (gates/s)\n";
+
+    // The three placements: TFHE's own allocation, one huge-page copy, one copy per node
+    PlacedCloudKey hugePages(&key->cloud);
+    KeyPlacementPolicy replicated;
+    replicated.replicatePerNode = true;
+    PlacedCloudKey perNode(&key->cloud, replicated, topology);
+    std::cout << "NUMA nodes: " << topology.numNodes() << ", replicas: " << perNode.numReplicas() << std::endl;
+
+    std::vector<int> np_values = {16, 32, 64};
+    for (int np : np_values) {
+        file << np;
+        file << "," << gateThroughput(np, gatesPerThread, key, &key->cloud);
+        file << "," << gateThroughput(np, gatesPerThread, key, hugePages.get());
+
+        // Pinning changes the shared thread pool, so it is undone before the next thread count
+        pinWorkerThreads(np, topology);
+        file << "," << gateThroughput(np, gatesPerThread, key, perNode.get());
+        unpinWorkerThreads(np, topology);
+        file << "\n";
+
+        // Print progress
+        std::cout << "Finished threads=" << np << std::endl;
+    }
+
+    file.close();
+
+    // Clean up keys
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "Test completed and results saved to result/keyPlacementThroughput.csv" << std::endl;
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>  // For creating directories
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "PIREngine.h"
+#include "optimized/HomLocOPT.h"
+
+// Average latency of back-to-back BB3 queries on a small table, where per-query setup
+// (thread team start-up, row views) is a visible share of the work
+int main(int argc, char* argv[]) {
+    int queries = (argc > 1) ? std::stoi(argv[1]) : 20;
+    int records = (argc > 2) ? std::stoi(argv[2]) : 16;
+    int inputLength = 5;      // Length for identifier values
+    int serviceLength = 32;   // Length for service values
+
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    std::vector<std::vector<std::string>> data;
+    for (int i = 0; i < records; i++) {
+        data.push_back({std::to_string(i), "svc" + std::to_string(i)});
+    }
+    MaskSeed seed = randomMaskSeed();
+    EncryptedTable table = encryptTableBB3Parallel(data, inputLength, serviceLength, params, key, seed, 4);
+    LweSample* enc_id = encryptBoolean(records / 2, inputLength, params, key);
+
+    // Create the result directory if it doesn't exist
+    std::filesystem::create_directory("result");
+
+    // Open a CSV file to write results
+    std::ofstream file("result/pirEngineLatency.csv");
+    file << "threads,HomLocPIRbb3OPT (s/query),PIREngine (s/query)\n";
+
+    std::vector<int> np_values = {1, 4, 16, 32};
+    for (int np : np_values) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int q = 0; q < queries; q++) {
+            LweSample* result = HomLocPIRbb3OPT(enc_id, table.rows(), inputLength, serviceLength, bk,
+                                                ParallelizationMode::PARALLEL_LOOP_HOMSUM, np);
+            delete_gate_bootstrapping_ciphertext_array(serviceLength, result);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> kernelTime = end - start;
+
+        PIREngine engine(bk, encryptTableBB3Parallel(data, inputLength, serviceLength, params, key, seed, 4), np);
+        start = std::chrono::high_resolution_clock::now();
+        for (int q = 0; q < queries; q++) {
+            CiphertextArray result = engine.query(enc_id);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> engineTime = end - start;
+
+        file << np << "," << kernelTime.count() / queries << "," << engineTime.count() / queries << "\n";
+
+        // Print progress
+        std::cout << "Finished threads=" << np << std::endl;
+    }
+
+    file.close();
+
+    // Clean up
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "Test completed and results saved to result/pirEngineLatency.csv" << std::endl;
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>  // For creating directories
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include "utils.h"
+#include "CloudKeyCache.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "PIRClient.h"
+#include "PIREngine.h"
+#include "PIRServer.h"
+#include "QueryScheduler.h"
+#include "TableFile.h"
+
+// BB3 query latency through the socket server against the same engine called in-process;
+// the difference is serialization plus the round trip over the UNIX socket
+int main(int argc, char* argv[]) {
+    int queries = (argc > 1) ? std::stoi(argv[1]) : 20;
+    int records = (argc > 2) ? std::stoi(argv[2]) : 16;
+    int numThreads = (argc > 3) ? std::stoi(argv[3]) : 4;
+    int inputLength = 5;      // Length for identifier values
+    int serviceLength = 128;  // Length for service values
+
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    // Create the result directory if it doesn't exist
+    std::filesystem::create_directory("result");
+    const std::string prefix = "result/timePIRServer";
+
+    std::vector<std::vector<std::string>> data;
+    for (int i = 0; i < records; i++) {
+        data.push_back({std::to_string(i), "svc" + std::to_string(i)});
+    }
+    writeTableFile(prefix + ".pirt", encryptTableBB3Parallel(data, inputLength, serviceLength, params, key,
+                                                             randomMaskSeed(), 4));
+    CloudKeyCache keys("result", params, 1);
+    keys.registerKey("timePIRServer", bk);
+    LweSample* enc_id = encryptBoolean(records / 2, inputLength, params, key);
+
+    LatencyHistogram local, remote;
+    {
+        PIREngine engine(bk, mapTableFile(prefix + ".pirt", params), numThreads);
+        for (int q = 0; q < queries; q++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            CiphertextArray result = engine.query(enc_id);
+            std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+            local.record(elapsed.count());
+        }
+    }
+    {
+        PIRServer server(prefix + ".sock", keys, params, numThreads);
+        server.addEncryptedTable("bench", prefix + ".pirt", "timePIRServer");
+        server.start();
+        PIRClient client(prefix + ".sock", params);
+        for (int q = 0; q < queries; q++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            CiphertextArray result = client.query("bench", enc_id, inputLength);
+            std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+            remote.record(elapsed.count());
+        }
+    }
+
+    // Open a CSV file to write results
+    std::ofstream file("result/pirServerLatency.csv");
+    file << "path,p50 (s),p99 (s),max (s)\n";
+    file << "in-process," << local.percentile(50) << "," << local.percentile(99) << "," << local.maxSeconds() << "\n";
+    file << "socket," << remote.percentile(50) << "," << remote.percentile(99) << "," << remote.maxSeconds() << "\n";
+    file.close();
+
+    // Clean up
+    keys.removeKey("timePIRServer");
+    std::remove((prefix + ".pirt").c_str());
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "Test completed and results saved to result/pirServerLatency.csv" << std::endl;
+    return 0;
+}
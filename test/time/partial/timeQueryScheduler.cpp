@@ -0,0 +1,96 @@
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include <filesystem>  // For creating directories
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "PIREngine.h"
+#include "QueryScheduler.h"
+
+// Tail latency of BB3 queries under load: `clients` users each send `queries` back-to-back,
+// either calling the engine directly with the full thread budget or through the scheduler
+int main(int argc, char* argv[]) {
+    int queries = (argc > 1) ? std::stoi(argv[1]) : 10;
+    int records = (argc > 2) ? std::stoi(argv[2]) : 16;
+    int numThreads = (argc > 3) ? std::stoi(argv[3]) : 8;
+    int inputLength = 5;      // Length for identifier values
+    int serviceLength = 32;   // Length for service values
+
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    std::vector<std::vector<std::string>> data;
+    for (int i = 0; i < records; i++) {
+        data.push_back({std::to_string(i), "svc" + std::to_string(i)});
+    }
+    PIREngine engine(bk, encryptTableBB3Parallel(data, inputLength, serviceLength, params, key, randomMaskSeed(), 4),
+                     numThreads);
+    LweSample* enc_id = encryptBoolean(records / 2, inputLength, params, key);
+
+    // Create the result directory if it doesn't exist
+    std::filesystem::create_directory("result");
+
+    // Open a CSV file to write results
+    std::ofstream file("result/querySchedulerLatency.csv");
+    file << "clients,direct p50 (s),direct p99 (s),scheduler p50 (s),scheduler p99 (s),scheduler queue p99 (s)\n";
+
+    std::vector<int> client_values = {1, 2, 4, 8};
+    for (int clients : client_values) {
+        LatencyHistogram direct;
+        std::mutex directMutex;
+        std::vector<std::thread> users;
+        for (int c = 0; c < clients; c++) {
+            users.emplace_back([&] {
+                for (int q = 0; q < queries; q++) {
+                    auto start = std::chrono::high_resolution_clock::now();
+                    CiphertextArray result = engine.query(enc_id);
+                    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+                    std::lock_guard<std::mutex> lock(directMutex);
+                    direct.record(elapsed.count());
+                }
+            });
+        }
+        for (std::thread& user : users) {
+            user.join();
+        }
+        users.clear();
+
+        QueryScheduler scheduler(engine, SchedulerConfig());
+        for (int c = 0; c < clients; c++) {
+            users.emplace_back([&] {
+                for (int q = 0; q < queries; q++) {
+                    scheduler.submit(enc_id, 0).result.get();
+                }
+            });
+        }
+        for (std::thread& user : users) {
+            user.join();
+        }
+        LatencyHistogram scheduled = scheduler.latency();
+
+        file << clients << "," << direct.percentile(50) << "," << direct.percentile(99) << ","
+             << scheduled.percentile(50) << "," << scheduled.percentile(99) << ","
+             << scheduler.queueLatency().percentile(99) << "\n";
+
+        // Print progress
+        std::cout << "Finished clients=" << clients << std::endl;
+    }
+
+    file.close();
+
+    // Clean up
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "Test completed and results saved to result/querySchedulerLatency.csv" << std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>  // For creating directories
+#include "tfhe/tfhe.h"
+#include "tfhe/tfhe_io.h"
+#include "utils.h"
+#include "EncryptedTable.h"
+#include "ParallelEncryption.h"
+#include "PIREngine.h"
+#include "ShardedEvaluation.h"
+#include "TableFile.h"
+
+// BB3 query latency with the table split across 1, 2, 4 and 8 worker processes, at the same
+// total thread count, against a single in-process engine
+int main(int argc, char* argv[]) {
+    int queries = (argc > 1) ? std::stoi(argv[1]) : 5;
+    int records = (argc > 2) ? std::stoi(argv[2]) : 64;
+    int totalThreads = (argc > 3) ? std::stoi(argv[3]) : 8;
+    int inputLength = 7;      // Length for identifier values
+    int serviceLength = 32;   // Length for service values
+
+    auto params = initializeParams(128);
+    auto key = generateKeySet(params);
+    const TFheGateBootstrappingCloudKeySet* bk = &key->cloud;
+
+    std::vector<std::vector<std::string>> data;
+    for (int i = 0; i < records; i++) {
+        data.push_back({std::to_string(i), "svc" + std::to_string(i)});
+    }
+    const std::string path = "timeShardedEvaluation.pirt";
+    writeTableFile(path, encryptTableBB3Parallel(data, inputLength, serviceLength, params, key, randomMaskSeed(), 4));
+    LweSample* enc_id = encryptBoolean(records / 2, inputLength, params, key);
+
+    // Create the result directory if it doesn't exist
+    std::filesystem::create_directory("result");
+
+    // Open a CSV file to write results
+    std::ofstream file("result/shardedEvaluation.csv");
+    file << "shards,threads per shard,startup (s),s/query\n";
+
+    // Forked before the in-process engine starts its pool
+    std::vector<int> shard_values = {1, 2, 4, 8};
+    for (int shards : shard_values) {
+        int threadsPerShard = std::max(1, totalThreads / shards);
+        auto start = std::chrono::high_resolution_clock::now();
+        ShardedEvaluator evaluator(path, bk, shards, threadsPerShard);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> startup = end - start;
+
+        start = std::chrono::high_resolution_clock::now();
+        for (int q = 0; q < queries; q++) {
+            CiphertextArray result = evaluator.query(enc_id);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> queryTime = end - start;
+
+        file << shards << "," << threadsPerShard << "," << startup.count() << "," << queryTime.count() / queries << "\n";
+
+        // Print progress
+        std::cout << "Finished shards=" << shards << std::endl;
+    }
+
+    PIREngine engine(bk, mapTableFile(path, params), totalThreads);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int q = 0; q < queries; q++) {
+        CiphertextArray result = engine.query(enc_id);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> engineTime = end - start;
+    file << "in-process," << totalThreads << ",0," << engineTime.count() / queries << "\n";
+
+    file.close();
+
+    // Clean up
+    std::remove(path.c_str());
+    delete_gate_bootstrapping_ciphertext_array(inputLength, enc_id);
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+
+    std::cout << "Test completed and results saved to result/shardedEvaluation.csv" << std::endl;
+    return 0;
+}